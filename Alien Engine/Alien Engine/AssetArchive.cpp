@@ -0,0 +1,522 @@
+#include "Globals.h"
+#include "AssetArchive.h"
+#include "ModuleFileSystem.h"
+#include "AssetDatabase.h"
+#include <stdio.h>
+#include <cctype>
+#include <algorithm>
+
+// LZ4 block format: the matches are 4 bytes or more, the last 5 bytes are always literals and the last match
+// starts 12 bytes before the end or more
+#define LZ4_HASH_BITS 12
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+
+AssetArchive::AssetArchive()
+{
+}
+
+AssetArchive::~AssetArchive()
+{
+	Close();
+}
+
+static bool ReadWholeFile(const char* path, std::vector<char>& buffer)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	buffer.resize((size > 0) ? size : 0);
+	bool ret = size >= 0 && (size == 0 || fread(buffer.data(), 1, size, file) == (size_t)size);
+	fclose(file);
+	return ret;
+}
+
+static void WritePadding(FILE* file, u64* offset)
+{
+	static const char zeros[ASSET_ARCHIVE_ALIGNMENT] = { 0 };
+	uint padding = (uint)((ASSET_ARCHIVE_ALIGNMENT - *offset % ASSET_ARCHIVE_ALIGNMENT) % ASSET_ARCHIVE_ALIGNMENT);
+	if (padding > 0) {
+		fwrite(zeros, 1, padding, file);
+		*offset += padding;
+	}
+}
+
+bool AssetArchive::Pack(const std::vector<std::string>& files, const char* archive_path, bool compress, ArchivePackStats* stats)
+{
+	FILE* output = fopen(archive_path, "wb");
+	if (output == nullptr)
+		return false;
+
+	// written again at the end with the offsets
+	ArchiveHeader header;
+	fwrite(&header, sizeof(ArchiveHeader), 1, output);
+	u64 offset = sizeof(ArchiveHeader);
+
+	ArchivePackStats pack_stats;
+	std::vector<ArchiveEntry> entries;
+	std::string names;
+	std::vector<char> buffer;
+	std::vector<char> compressed;
+
+	std::vector<std::string>::const_iterator item = files.cbegin();
+	for (; item != files.cend(); ++item) {
+		if (!ReadWholeFile((*item).data(), buffer))
+			continue;
+
+		ArchiveEntry entry;
+		std::string name = NormalizePath((*item).data());
+		entry.hash = HashPath(name);
+		entry.original_size = buffer.size();
+		entry.name_offset = names.size();
+		entry.name_size = name.size();
+		names += name;
+
+		const char* payload = buffer.data();
+		entry.size = buffer.size();
+		if (compress && !buffer.empty()) {
+			compressed.resize(GetCompressBound(buffer.size()));
+			uint compressed_size = Compress(buffer.data(), buffer.size(), compressed.data(), compressed.size());
+			if (compressed_size > 0 && compressed_size <= buffer.size() * (1.0F - ASSET_ARCHIVE_MIN_SAVING)) {
+				payload = compressed.data();
+				entry.size = compressed_size;
+				entry.flags |= (uint)ArchiveEntryFlags::LZ4;
+				++pack_stats.compressed;
+			}
+		}
+
+		WritePadding(output, &offset);
+		entry.offset = offset;
+		fwrite(payload, 1, entry.size, output);
+		offset += entry.size;
+
+		entries.push_back(entry);
+		++pack_stats.files;
+		pack_stats.original_bytes += entry.original_size;
+	}
+
+	// open addressing with linear probing, at most half of the slots are used
+	header.entries_count = entries.size();
+	header.table_size = 1;
+	while (header.table_size < entries.size() * 2) {
+		header.table_size <<= 1;
+	}
+	std::vector<uint> table(header.table_size, 0);
+	uint mask = header.table_size - 1;
+	for (uint i = 0; i < entries.size(); ++i) {
+		uint slot = (uint)entries[i].hash & mask;
+		while (table[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		table[slot] = i + 1;
+	}
+
+	WritePadding(output, &offset);
+	header.entries_offset = offset;
+	if (!entries.empty()) {
+		fwrite(entries.data(), sizeof(ArchiveEntry), entries.size(), output);
+	}
+	offset += sizeof(ArchiveEntry) * entries.size();
+
+	header.table_offset = offset;
+	fwrite(table.data(), sizeof(uint), table.size(), output);
+	offset += sizeof(uint) * table.size();
+
+	header.names_offset = offset;
+	header.names_size = names.size();
+	fwrite(names.data(), 1, names.size(), output);
+	offset += names.size();
+
+	fseek(output, 0, SEEK_SET);
+	fwrite(&header, sizeof(ArchiveHeader), 1, output);
+	bool ret = ferror(output) == 0;
+	fclose(output);
+
+	pack_stats.archive_bytes = offset;
+	if (stats != nullptr) {
+		*stats = pack_stats;
+	}
+
+	return ret;
+}
+
+bool AssetArchive::Open(const char* archive_path)
+{
+	Close();
+
+	HANDLE file_handle = CreateFileA(archive_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD file_size = GetFileSize(file_handle, nullptr);
+	if (file_size == INVALID_FILE_SIZE || file_size < sizeof(ArchiveHeader)) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	// copy on write like ModuleFileSystem::Map, so the views of the entries can be too
+	HANDLE file_mapping = CreateFileMappingA(file_handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (file_mapping == nullptr) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	char* view = (char*)MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(file_mapping);
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	file = file_handle;
+	mapping = file_mapping;
+	data = view;
+	size = file_size;
+
+	// everything the table of contents points to must be inside the file
+	const ArchiveHeader* archive_header = (const ArchiveHeader*)data;
+	bool valid = archive_header->magic == ASSET_ARCHIVE_MAGIC && archive_header->version == ASSET_ARCHIVE_VERSION
+		&& archive_header->table_size != 0 && (archive_header->table_size & (archive_header->table_size - 1)) == 0
+		&& archive_header->entries_offset + sizeof(ArchiveEntry) * (u64)archive_header->entries_count <= size
+		&& archive_header->table_offset + sizeof(uint) * (u64)archive_header->table_size <= size
+		&& archive_header->names_offset + archive_header->names_size <= size;
+
+	const ArchiveEntry* archive_entries = (const ArchiveEntry*)(data + archive_header->entries_offset);
+	for (uint i = 0; valid && i < archive_header->entries_count; ++i) {
+		valid = archive_entries[i].offset + archive_entries[i].size <= size
+			&& (u64)archive_entries[i].name_offset + archive_entries[i].name_size <= archive_header->names_size;
+	}
+
+	if (!valid) {
+		Close();
+		return false;
+	}
+
+	header = archive_header;
+	entries = archive_entries;
+	table = (const uint*)(data + header->table_offset);
+	names = data + header->names_offset;
+
+	return true;
+}
+
+void AssetArchive::Close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != nullptr)
+		CloseHandle(file);
+
+	file = nullptr;
+	mapping = nullptr;
+	data = nullptr;
+	size = 0;
+	header = nullptr;
+	entries = nullptr;
+	table = nullptr;
+	names = nullptr;
+}
+
+bool AssetArchive::IsOpen() const
+{
+	return header != nullptr;
+}
+
+const ArchiveEntry* AssetArchive::Find(const char* path) const
+{
+	if (header == nullptr || path == nullptr)
+		return nullptr;
+
+	std::string name = NormalizePath(path);
+	u64 hash = HashPath(name);
+	uint mask = header->table_size - 1;
+
+	uint slot = (uint)hash & mask;
+	for (uint probes = 0; probes < header->table_size; ++probes) {
+		uint index = table[slot];
+		if (index == 0 || index > header->entries_count)
+			return nullptr;
+
+		const ArchiveEntry& entry = entries[index - 1];
+		if (entry.hash == hash && entry.name_size == name.size()) {
+			const char* entry_name = GetName(entry);
+			uint i = 0;
+			while (i < entry.name_size && std::tolower((unsigned char)entry_name[i]) == std::tolower((unsigned char)name[i])) {
+				++i;
+			}
+			if (i == entry.name_size)
+				return &entry;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return nullptr;
+}
+
+char* AssetArchive::Extract(const char* path, uint* size) const
+{
+	const ArchiveEntry* entry = Find(path);
+	if (entry == nullptr)
+		return nullptr;
+
+	char* buffer = new char[entry->original_size + 1];
+	if ((entry->flags & (uint)ArchiveEntryFlags::LZ4) != 0) {
+		if (!Decompress(data + entry->offset, entry->size, buffer, entry->original_size)) {
+			delete[] buffer;
+			return nullptr;
+		}
+	}
+	else {
+		memcpy(buffer, data + entry->offset, entry->size);
+	}
+	// the JSON files are parsed straight from the buffer
+	buffer[entry->original_size] = '\0';
+
+	*size = entry->original_size;
+	return buffer;
+}
+
+bool AssetArchive::Map(const char* path, FileMapping* file_mapping) const
+{
+	const ArchiveEntry* entry = Find(path);
+	if (entry == nullptr || entry->size == 0 || (entry->flags & (uint)ArchiveEntryFlags::LZ4) != 0)
+		return false;
+
+	// a view of its own, the pages the resource changes are copied only for it
+	u64 start = entry->offset - entry->offset % ASSET_ARCHIVE_VIEW_GRANULARITY;
+	uint skip = (uint)(entry->offset - start);
+	char* view = (char*)MapViewOfFile(mapping, FILE_MAP_COPY, (DWORD)(start >> 32), (DWORD)(start & 0xFFFFFFFF), skip + entry->size);
+	if (view == nullptr)
+		return false;
+
+	file_mapping->file = nullptr;
+	file_mapping->mapping = nullptr;
+	file_mapping->view = view;
+	file_mapping->data = view + skip;
+	file_mapping->size = entry->size;
+
+	return true;
+}
+
+void AssetArchive::GetFiles(const char* directory, std::vector<std::string>& files, std::vector<std::string>& directories, bool whole_path) const
+{
+	if (header == nullptr)
+		return;
+
+	std::string folder = NormalizePath(directory);
+	if (!folder.empty() && folder.back() != '/')
+		folder += '/';
+
+	for (uint i = 0; i < header->entries_count; ++i) {
+		const ArchiveEntry& entry = entries[i];
+		if (entry.name_size <= folder.size())
+			continue;
+
+		const char* entry_name = GetName(entry);
+		uint j = 0;
+		while (j < folder.size() && std::tolower((unsigned char)entry_name[j]) == std::tolower((unsigned char)folder[j])) {
+			++j;
+		}
+		if (j != folder.size())
+			continue;
+
+		std::string rest(entry_name + folder.size(), entry.name_size - folder.size());
+		std::string::size_type separator = rest.find('/');
+		if (separator == std::string::npos) {
+			files.push_back(whole_path ? std::string(directory) + rest : rest);
+		}
+		else {
+			std::string sub_directory = rest.substr(0, separator);
+			if (std::find(directories.begin(), directories.end(), sub_directory) == directories.end()) {
+				directories.push_back(sub_directory);
+			}
+		}
+	}
+}
+
+uint AssetArchive::GetEntriesCount() const
+{
+	return (header != nullptr) ? header->entries_count : 0;
+}
+
+u64 AssetArchive::GetSize() const
+{
+	return size;
+}
+
+uint AssetArchive::GetCompressBound(uint size)
+{
+	return size + size / 255 + 16;
+}
+
+static bool WriteSequence(unsigned char* destination, uint* position, uint capacity, const unsigned char* literals, uint literals_size, uint offset, uint match_size)
+{
+	uint match_extra = (match_size > 0) ? match_size - LZ4_MIN_MATCH : 0;
+	uint needed = 1 + literals_size / 255 + 1 + literals_size + ((match_size > 0) ? 2 + match_extra / 255 + 1 : 0);
+	if (*position + needed > capacity)
+		return false;
+
+	uint op = *position;
+	destination[op++] = (unsigned char)((std::min(literals_size, 15U) << 4) | ((match_size > 0) ? std::min(match_extra, 15U) : 0));
+	if (literals_size >= 15) {
+		uint rest = literals_size - 15;
+		for (; rest >= 255; rest -= 255) {
+			destination[op++] = 255;
+		}
+		destination[op++] = (unsigned char)rest;
+	}
+	memcpy(destination + op, literals, literals_size);
+	op += literals_size;
+
+	if (match_size > 0) {
+		destination[op++] = (unsigned char)(offset & 0xFF);
+		destination[op++] = (unsigned char)(offset >> 8);
+		if (match_extra >= 15) {
+			uint rest = match_extra - 15;
+			for (; rest >= 255; rest -= 255) {
+				destination[op++] = 255;
+			}
+			destination[op++] = (unsigned char)rest;
+		}
+	}
+
+	*position = op;
+	return true;
+}
+
+uint AssetArchive::Compress(const char* source, uint size, char* destination, uint capacity)
+{
+	const unsigned char* input = (const unsigned char*)source;
+	unsigned char* output = (unsigned char*)destination;
+	uint position = 0;
+	uint anchor = 0;
+
+	// greedy, the last position of each hash of 4 bytes is the only candidate
+	if (size > LZ4_MATCH_FIND_LIMIT) {
+		std::vector<uint> positions(1 << LZ4_HASH_BITS, 0xFFFFFFFF);
+		uint match_limit = size - LZ4_LAST_LITERALS;
+		uint find_limit = size - LZ4_MATCH_FIND_LIMIT;
+
+		uint ip = 0;
+		while (ip < find_limit) {
+			uint sequence = 0;
+			memcpy(&sequence, input + ip, sizeof(uint));
+			uint hash = (sequence * 2654435761U) >> (32 - LZ4_HASH_BITS);
+			uint candidate = positions[hash];
+			positions[hash] = ip;
+
+			uint candidate_sequence = 0;
+			if (candidate != 0xFFFFFFFF && ip - candidate <= LZ4_MAX_OFFSET) {
+				memcpy(&candidate_sequence, input + candidate, sizeof(uint));
+			}
+			if (candidate == 0xFFFFFFFF || ip - candidate > LZ4_MAX_OFFSET || candidate_sequence != sequence) {
+				++ip;
+				continue;
+			}
+
+			uint length = LZ4_MIN_MATCH;
+			while (ip + length < match_limit && input[candidate + length] == input[ip + length]) {
+				++length;
+			}
+			if (!WriteSequence(output, &position, capacity, input + anchor, ip - anchor, ip - candidate, length))
+				return 0;
+
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	if (!WriteSequence(output, &position, capacity, input + anchor, size - anchor, 0, 0))
+		return 0;
+
+	return position;
+}
+
+bool AssetArchive::Decompress(const char* source, uint source_size, char* destination, uint size)
+{
+	const unsigned char* input = (const unsigned char*)source;
+	const unsigned char* end = input + source_size;
+	uint op = 0;
+
+	while (input < end) {
+		uint token = *input++;
+
+		uint literals = token >> 4;
+		if (literals == 15) {
+			uint extra = 255;
+			while (extra == 255) {
+				if (input >= end)
+					return false;
+				extra = *input++;
+				literals += extra;
+			}
+		}
+		if ((uint)(end - input) < literals || size - op < literals)
+			return false;
+		memcpy(destination + op, input, literals);
+		input += literals;
+		op += literals;
+
+		// the last sequence has only literals
+		if (input == end)
+			break;
+
+		if (end - input < 2)
+			return false;
+		uint offset = input[0] | (input[1] << 8);
+		input += 2;
+		if (offset == 0 || offset > op)
+			return false;
+
+		uint match = (token & 15) + LZ4_MIN_MATCH;
+		if ((token & 15) == 15) {
+			uint extra = 255;
+			while (extra == 255) {
+				if (input >= end)
+					return false;
+				extra = *input++;
+				match += extra;
+			}
+		}
+		if (size - op < match)
+			return false;
+
+		// byte by byte, the match can overlap what it writes
+		for (uint i = 0; i < match; ++i, ++op) {
+			destination[op] = destination[op - offset];
+		}
+	}
+
+	return op == size;
+}
+
+std::string AssetArchive::NormalizePath(const char* path)
+{
+	std::string normalized(path);
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+	return normalized;
+}
+
+u64 AssetArchive::HashPath(const std::string& normalized)
+{
+	// without case, like the file system of windows
+	u64 hash = AssetDatabase::HashBytes(nullptr, 0);
+	for (uint i = 0; i < normalized.size(); ++i) {
+		unsigned char lower = (unsigned char)std::tolower((unsigned char)normalized[i]);
+		hash = AssetDatabase::HashBytes(&lower, 1, hash);
+	}
+	return hash;
+}
+
+const char* AssetArchive::GetName(const ArchiveEntry& entry) const
+{
+	return names + entry.name_offset;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+typedef unsigned long long u64;
+
+struct FileMapping;
+
+#define LIBRARY_ARCHIVE_FILE "Library.pack"
+#define ASSET_ARCHIVE_MAGIC 0x4B415041 // "APAK"
+#define ASSET_ARCHIVE_VERSION 1
+// the data of each entry starts at a multiple of this, the headers of the meshes and textures can be read in place
+#define ASSET_ARCHIVE_ALIGNMENT 64
+// the views of MapViewOfFile start at multiples of this
+#define ASSET_ARCHIVE_VIEW_GRANULARITY 65536
+// the entries are compressed only if it saves this fraction of their size
+#define ASSET_ARCHIVE_MIN_SAVING 0.125F
+
+enum class ArchiveEntryFlags {
+	NONE = 0,
+	LZ4 = 1 << 0
+};
+
+struct ArchiveHeader {
+	uint magic = ASSET_ARCHIVE_MAGIC;
+	uint version = ASSET_ARCHIVE_VERSION;
+	uint entries_count = 0;
+	// slots of the hash table, a power of two
+	uint table_size = 0;
+	u64 entries_offset = 0;
+	u64 table_offset = 0;
+	u64 names_offset = 0;
+	u64 names_size = 0;
+};
+
+struct ArchiveEntry {
+	// FNV-1a of the normalized path
+	u64 hash = 0;
+	u64 offset = 0;
+	// bytes in the archive and after decompressing
+	uint size = 0;
+	uint original_size = 0;
+	uint name_offset = 0;
+	uint name_size = 0;
+	uint flags = (uint)ArchiveEntryFlags::NONE;
+	uint padding = 0;
+};
+
+struct ArchivePackStats {
+	uint files = 0;
+	uint compressed = 0;
+	u64 original_bytes = 0;
+	u64 archive_bytes = 0;
+};
+
+// Read only archive of the library of a game build, one file instead of thousands. The table of contents is a hash
+// table of the paths at the end of the file, the whole archive is mapped and the entries are read from the mapping.
+// The entries that are not compressed can be mapped alone, copy on write like the loose files.
+class AssetArchive {
+
+public:
+
+	AssetArchive();
+	~AssetArchive();
+
+	// write the files in a new archive, the paths are relative to the working directory and are kept as the names
+	static bool Pack(const std::vector<std::string>& files, const char* archive_path, bool compress, ArchivePackStats* stats = nullptr);
+
+	bool Open(const char* archive_path);
+	void Close();
+	bool IsOpen() const;
+
+	// the path is compared without case and with '\' as '/'
+	const ArchiveEntry* Find(const char* path) const;
+	// a new buffer with the entry decompressed and a 0 after it, delete it with delete[]. nullptr if it is not in
+	char* Extract(const char* path, uint* size) const;
+	// a view of an entry that is not compressed, Unmap of the ModuleFileSystem frees it. False if it can't be
+	// mapped, Extract reads it then
+	bool Map(const char* path, FileMapping* file_mapping) const;
+	// the files and folders of the archive directly in the folder
+	void GetFiles(const char* directory, std::vector<std::string>& files, std::vector<std::string>& directories, bool whole_path) const;
+
+	uint GetEntriesCount() const;
+	u64 GetSize() const;
+
+	// LZ4 block format. Compress returns 0 if the output doesn't fit
+	static uint GetCompressBound(uint size);
+	static uint Compress(const char* source, uint size, char* destination, uint capacity);
+	// false if the data is corrupted or doesn't decompress to exactly size bytes
+	static bool Decompress(const char* source, uint source_size, char* destination, uint size);
+
+private:
+
+	static std::string NormalizePath(const char* path);
+	static u64 HashPath(const std::string& normalized);
+	const char* GetName(const ArchiveEntry& entry) const;
+
+private:
+
+	void* file = nullptr;
+	void* mapping = nullptr;
+	char* data = nullptr;
+	u64 size = 0;
+
+	const ArchiveHeader* header = nullptr;
+	const ArchiveEntry* entries = nullptr;
+	const uint* table = nullptr;
+	const char* names = nullptr;
+};
@@ -0,0 +1,363 @@
+#include "AssetDatabase.h"
+#include "Application.h"
+#include "ModuleFileSystem.h"
+#include "ModuleResources.h"
+#include "ModuleImporter.h"
+#include "ResourceMesh.h"
+#include "ResourceTexture.h"
+#include "TextureCooker.h"
+#include <sys/stat.h>
+#include <stdio.h>
+#include <time.h>
+
+#define HASH_FILE_CHUNK 16384
+
+AssetDatabase::AssetDatabase()
+{
+}
+
+AssetDatabase::~AssetDatabase()
+{
+}
+
+// little writer and reader of the records file
+static void WriteBytes(std::string& buffer, const void* data, uint size)
+{
+	buffer.append((const char*)data, size);
+}
+
+static void WriteString(std::string& buffer, const std::string& string)
+{
+	uint size = string.size();
+	WriteBytes(buffer, &size, sizeof(uint));
+	WriteBytes(buffer, string.data(), size);
+}
+
+static bool ReadBytes(const char** cursor, const char* end, void* data, uint size)
+{
+	if ((uint)(end - *cursor) < size)
+		return false;
+	memcpy(data, *cursor, size);
+	*cursor += size;
+	return true;
+}
+
+static bool ReadString(const char** cursor, const char* end, std::string& string)
+{
+	uint size = 0;
+	if (!ReadBytes(cursor, end, &size, sizeof(uint)) || (uint)(end - *cursor) < size)
+		return false;
+	string.assign(*cursor, size);
+	*cursor += size;
+	return true;
+}
+
+bool AssetDatabase::Load(const char* file)
+{
+	Clear();
+
+	if (!App->file_system->Exists(file))
+		return false;
+
+	char* data = nullptr;
+	uint size = App->file_system->Load(file, &data);
+	if (data == nullptr)
+		return false;
+
+	const char* cursor = data;
+	const char* end = data + size;
+
+	uint magic = 0;
+	uint version = 0;
+	uint count = 0;
+	bool ret = ReadBytes(&cursor, end, &magic, sizeof(uint)) && ReadBytes(&cursor, end, &version, sizeof(uint)) && magic == ASSET_DATABASE_MAGIC
+		&& version == ASSET_DATABASE_VERSION && ReadBytes(&cursor, end, &saved_time, sizeof(long long)) && ReadBytes(&cursor, end, &count, sizeof(uint));
+
+	for (uint i = 0; ret && i < count; ++i) {
+		AssetRecord record;
+		int type = 0;
+		uint outputs = 0;
+		uint dependencies = 0;
+		ret = ReadString(&cursor, end, record.path) && ReadBytes(&cursor, end, &type, sizeof(int)) && ReadBytes(&cursor, end, &record.ID, sizeof(u64))
+			&& ReadString(&cursor, end, record.name) && ReadString(&cursor, end, record.library) && ReadBytes(&cursor, end, &record.hash, sizeof(u64))
+			&& ReadBytes(&cursor, end, &record.time, sizeof(long long)) && ReadBytes(&cursor, end, &record.size, sizeof(u64))
+			&& ReadBytes(&cursor, end, &record.settings, sizeof(u64)) && ReadBytes(&cursor, end, &outputs, sizeof(uint));
+
+		for (uint j = 0; ret && j < outputs; ++j) {
+			record.outputs.push_back(std::string());
+			ret = ReadString(&cursor, end, record.outputs.back());
+		}
+		ret = ret && ReadBytes(&cursor, end, &dependencies, sizeof(uint));
+		for (uint j = 0; ret && j < dependencies; ++j) {
+			record.dependencies.push_back(AssetDependency());
+			ret = ReadString(&cursor, end, record.dependencies.back().name) && ReadBytes(&cursor, end, &record.dependencies.back().ID, sizeof(u64));
+		}
+
+		if (ret) {
+			record.type = (ResourceType)type;
+			records[record.path] = record;
+		}
+	}
+	delete[] data;
+
+	// a broken file is like no file, everything is checked again
+	if (!ret) {
+		Clear();
+	}
+
+	return ret;
+}
+
+bool AssetDatabase::Save(const char* file)
+{
+	saved_time = (long long)time(nullptr);
+
+	std::string buffer;
+	uint magic = ASSET_DATABASE_MAGIC;
+	uint version = ASSET_DATABASE_VERSION;
+	uint count = records.size();
+	WriteBytes(buffer, &magic, sizeof(uint));
+	WriteBytes(buffer, &version, sizeof(uint));
+	WriteBytes(buffer, &saved_time, sizeof(long long));
+	WriteBytes(buffer, &count, sizeof(uint));
+
+	std::unordered_map<std::string, AssetRecord>::const_iterator item = records.cbegin();
+	for (; item != records.cend(); ++item) {
+		const AssetRecord& record = (*item).second;
+		int type = (int)record.type;
+		uint outputs = record.outputs.size();
+		uint dependencies = record.dependencies.size();
+
+		WriteString(buffer, record.path);
+		WriteBytes(buffer, &type, sizeof(int));
+		WriteBytes(buffer, &record.ID, sizeof(u64));
+		WriteString(buffer, record.name);
+		WriteString(buffer, record.library);
+		WriteBytes(buffer, &record.hash, sizeof(u64));
+		WriteBytes(buffer, &record.time, sizeof(long long));
+		WriteBytes(buffer, &record.size, sizeof(u64));
+		WriteBytes(buffer, &record.settings, sizeof(u64));
+		WriteBytes(buffer, &outputs, sizeof(uint));
+		for (uint i = 0; i < outputs; ++i) {
+			WriteString(buffer, record.outputs[i]);
+		}
+		WriteBytes(buffer, &dependencies, sizeof(uint));
+		for (uint i = 0; i < dependencies; ++i) {
+			WriteString(buffer, record.dependencies[i].name);
+			WriteBytes(buffer, &record.dependencies[i].ID, sizeof(u64));
+		}
+	}
+
+	return App->file_system->Save(file, buffer.data(), buffer.size()) == buffer.size();
+}
+
+void AssetDatabase::Clear()
+{
+	records.clear();
+	saved_time = 0;
+}
+
+AssetState AssetDatabase::Check(const char* path, ResourceType type, u64 settings, AssetRecord** record)
+{
+	*record = nullptr;
+
+	std::unordered_map<std::string, AssetRecord>::iterator found = records.find(path);
+	if (found == records.end()) {
+		++added;
+		return AssetState::ADDED;
+	}
+
+	AssetRecord* current = &(*found).second;
+	current->seen = true;
+	*record = current;
+
+	if (current->type != type || current->settings != settings) {
+		++changed;
+		return AssetState::CHANGED;
+	}
+
+	std::vector<std::string>::const_iterator output = current->outputs.cbegin();
+	for (; output != current->outputs.cend(); ++output) {
+		if (!App->file_system->Exists((*output).data())) {
+			++changed;
+			return AssetState::CHANGED;
+		}
+	}
+
+	long long time = 0;
+	u64 size = 0;
+	if (!GetFileInfo(path, &time, &size)) {
+		++changed;
+		return AssetState::CHANGED;
+	}
+	if (time == current->time && size == current->size && time < saved_time) {
+		++clean;
+		return AssetState::CLEAN;
+	}
+
+	// saved again, copied or too recent to trust its time, the content decides
+	if (size == current->size) {
+		u64 hash = 0;
+		++hashed;
+		if (HashFile(path, &hash) && hash == current->hash) {
+			current->time = time;
+			++touched;
+			++clean;
+			return AssetState::CLEAN;
+		}
+	}
+
+	++changed;
+	return AssetState::CHANGED;
+}
+
+bool AssetDatabase::DependenciesChanged(const AssetRecord& record) const
+{
+	std::vector<AssetDependency>::const_iterator item = record.dependencies.cbegin();
+	for (; item != record.dependencies.cend(); ++item) {
+		const ResourceTexture* texture = App->resources->GetTextureByName((*item).name.data());
+		u64 ID = (texture != nullptr) ? texture->GetID() : 0;
+		if (ID != (*item).ID)
+			return true;
+	}
+	return false;
+}
+
+AssetRecord* AssetDatabase::Store(const Resource* resource, u64 settings, const std::vector<std::string>& outputs, const std::vector<AssetDependency>& dependencies)
+{
+	AssetRecord* record = Store(resource->GetAssetsPath(), resource->GetType(), settings);
+	if (record != nullptr) {
+		record->ID = resource->GetID();
+		record->name = resource->GetName();
+		record->library = resource->GetLibraryPath();
+		record->outputs = outputs;
+		record->dependencies = dependencies;
+	}
+	return record;
+}
+
+AssetRecord* AssetDatabase::Store(const char* path, ResourceType type, u64 settings)
+{
+	long long time = 0;
+	u64 size = 0;
+	if (!GetFileInfo(path, &time, &size))
+		return nullptr;
+
+	AssetRecord& record = records[path];
+	bool same_file = !record.path.empty() && record.time == time && record.size == size;
+	if (!same_file) {
+		++hashed;
+		if (!HashFile(path, &record.hash)) {
+			records.erase(path);
+			return nullptr;
+		}
+	}
+
+	record.path = path;
+	record.type = type;
+	record.time = time;
+	record.size = size;
+	record.settings = settings;
+	record.seen = true;
+
+	return &record;
+}
+
+void AssetDatabase::Restore(Resource* resource, const AssetRecord& record) const
+{
+	resource->ID = record.ID;
+	resource->path = record.path;
+	resource->name = record.name;
+	resource->meta_data_path = record.library;
+}
+
+uint AssetDatabase::DropUnseen()
+{
+	uint ret = 0;
+	std::unordered_map<std::string, AssetRecord>::iterator item = records.begin();
+	while (item != records.end()) {
+		if (!(*item).second.seen) {
+			item = records.erase(item);
+			++ret;
+		}
+		else {
+			++item;
+		}
+	}
+	removed += ret;
+	return ret;
+}
+
+const AssetRecord* AssetDatabase::Find(const char* path) const
+{
+	std::unordered_map<std::string, AssetRecord>::const_iterator found = records.find(path);
+	return (found != records.cend()) ? &(*found).second : nullptr;
+}
+
+uint AssetDatabase::GetCount() const
+{
+	return records.size();
+}
+
+void AssetDatabase::ResetCounters()
+{
+	clean = 0;
+	touched = 0;
+	changed = 0;
+	added = 0;
+	removed = 0;
+	hashed = 0;
+}
+
+u64 AssetDatabase::GetTextureSettings()
+{
+	return TEXTURE_COOKER_VERSION;
+}
+
+u64 AssetDatabase::GetModelSettings()
+{
+	u64 settings = ALIEN_MESH_VERSION;
+	settings = (settings << 1) | (App->importer->optimize_meshes ? 1 : 0);
+	settings = (settings << 1) | (App->importer->generate_lods ? 1 : 0);
+	return settings;
+}
+
+u64 AssetDatabase::HashBytes(const void* data, u64 size, u64 hash)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (u64 i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool AssetDatabase::HashFile(const char* path, u64* hash)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr)
+		return false;
+
+	unsigned char buffer[HASH_FILE_CHUNK];
+	u64 ret = HashBytes(nullptr, 0);
+	size_t read = 0;
+	while ((read = fread(buffer, 1, HASH_FILE_CHUNK, file)) > 0) {
+		ret = HashBytes(buffer, read, ret);
+	}
+	bool error = ferror(file) != 0;
+	fclose(file);
+
+	*hash = ret;
+	return !error;
+}
+
+bool AssetDatabase::GetFileInfo(const char* path, long long* time, u64* size)
+{
+	struct stat file;
+	if (stat(path, &file) != 0)
+		return false;
+
+	*time = (long long)file.st_mtime;
+	*size = (u64)file.st_size;
+	return true;
+}
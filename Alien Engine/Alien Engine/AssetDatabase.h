@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Resource_.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define ASSET_DATABASE_FILE "Library/assets.db"
+#define ASSET_DATABASE_MAGIC 0x31424441 // "ADB1"
+#define ASSET_DATABASE_VERSION 1
+
+enum class AssetState {
+	CLEAN, // same file and settings, and its library files are there
+	ADDED, // no record of it
+	CHANGED // its content, its settings or a dependency changed, or a library file is missing
+};
+
+// a texture a model asked for, by the name the importer searched and the ID it had then. 0 if it was missing
+struct AssetDependency {
+	std::string name;
+	u64 ID = 0;
+};
+
+struct AssetRecord {
+	std::string path;
+	ResourceType type = ResourceType::RESOURCE_NONE;
+	u64 ID = 0;
+	std::string name;
+	std::string library;
+	// FNV-1a of the file, checked only when the time or the size change
+	u64 hash = 0;
+	long long time = 0;
+	u64 size = 0;
+	// versions and import options the library files depend on
+	u64 settings = 0;
+	// every library file made from the asset. The models have the .alienModel first and then their meshes
+	std::vector<std::string> outputs;
+	std::vector<AssetDependency> dependencies;
+
+	// not saved, the records not checked in a scan are dropped
+	bool seen = false;
+};
+
+// Record of every asset and the library files made from it, saved in a single file of the library. In the startup
+// the assets whose time, size and settings didn't change are added from their record, without parsing their metas,
+// and only the changed ones and the models whose textures changed are imported again.
+class AssetDatabase {
+
+public:
+
+	AssetDatabase();
+	~AssetDatabase();
+
+	bool Load(const char* file);
+	bool Save(const char* file);
+	void Clear();
+
+	// compare the asset file with its record, the file is hashed only if its time or size changed. The record
+	// is set if there is one
+	AssetState Check(const char* path, ResourceType type, u64 settings, AssetRecord** record);
+	// true if a texture of the record is another one or appeared since the import
+	bool DependenciesChanged(const AssetRecord& record) const;
+	// create or update the record with the current file of the asset and the fields of the resource
+	AssetRecord* Store(const Resource* resource, u64 settings, const std::vector<std::string>& outputs, const std::vector<AssetDependency>& dependencies);
+	// create or update the record with the current file, it is hashed again if its time or size changed
+	AssetRecord* Store(const char* path, ResourceType type, u64 settings);
+	// the resource takes the ID, paths and name of the record. It is not added to the resources
+	void Restore(Resource* resource, const AssetRecord& record) const;
+	// forget the assets not checked since the last Load, they were removed. Returns how many
+	uint DropUnseen();
+
+	const AssetRecord* Find(const char* path) const;
+	uint GetCount() const;
+	void ResetCounters();
+
+	static u64 GetTextureSettings();
+	static u64 GetModelSettings();
+
+	static u64 HashBytes(const void* data, u64 size, u64 hash = 14695981039346656037ULL);
+	// false if the file can't be read
+	static bool HashFile(const char* path, u64* hash);
+
+private:
+
+	static bool GetFileInfo(const char* path, long long* time, u64* size);
+
+public:
+
+	// the last scan
+	uint clean = 0;
+	// the time changed and the content not
+	uint touched = 0;
+	uint changed = 0;
+	uint added = 0;
+	uint removed = 0;
+	uint hashed = 0;
+
+private:
+
+	std::unordered_map<std::string, AssetRecord> records;
+	// when the records were saved. A file with this time or a later one could have changed again in the same
+	// second after it was recorded, its time is not trusted and it is hashed
+	long long saved_time = 0;
+};
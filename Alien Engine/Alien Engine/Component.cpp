@@ -17,6 +17,7 @@ Component::Component(GameObject* attach)
 
 Component::~Component()
 {
+	App->objects->component_registry.Remove(this);
 }
 
 bool Component::IsEnabled()
@@ -1,9 +1,19 @@
 #pragma once
 
+#include <stddef.h>
+
 class GameObject;
+class ComponentTransform;
+class ComponentMesh;
+class ComponentMaterial;
+class ComponentLight;
+class ComponentCamera;
+class ComponentScript;
 
 typedef unsigned int uint;
 class JSONArraypack;
+class SceneWriter;
+class SceneReader;
 typedef unsigned long long u64;
 enum class ComponentType {
 	TRANSFORM = 0,
@@ -16,6 +26,16 @@ enum class ComponentType {
 	UNKNOWN
 };
 
+// ComponentType of each component class known at compile time, GameObject::GetComponent<Comp>() uses it to avoid dynamic_cast
+template <class Comp>
+struct ComponentTypeOf { static constexpr ComponentType value = ComponentType::UNKNOWN; };
+template <> struct ComponentTypeOf<ComponentTransform> { static constexpr ComponentType value = ComponentType::TRANSFORM; };
+template <> struct ComponentTypeOf<ComponentMesh> { static constexpr ComponentType value = ComponentType::MESH; };
+template <> struct ComponentTypeOf<ComponentMaterial> { static constexpr ComponentType value = ComponentType::MATERIAL; };
+template <> struct ComponentTypeOf<ComponentLight> { static constexpr ComponentType value = ComponentType::LIGHT; };
+template <> struct ComponentTypeOf<ComponentCamera> { static constexpr ComponentType value = ComponentType::CAMERA; };
+template <> struct ComponentTypeOf<ComponentScript> { static constexpr ComponentType value = ComponentType::SCRIPT; };
+
 class __declspec(dllexport) Component {
 	friend class ComponentCamera;
 	friend class ComponentLight;
@@ -31,10 +51,17 @@ class __declspec(dllexport) Component {
 	friend class PanelInspector;
 	friend class ModuleObjects;
 	friend class ModuleUI;
+	friend class ComponentRegistry;
+	friend class ModuleCamera3D;
+	friend class TestScene;
 public:
 	Component(GameObject* attach);
 	virtual ~Component();
 
+	// from the pools of the ObjectAllocator, the size of each component class has its own
+	static void* operator new(size_t size);
+	static void operator delete(void* block, size_t size);
+
 	bool IsEnabled();
 	void SetEnable(bool enable);
 
@@ -46,6 +73,9 @@ protected:
 
 	virtual void SaveComponent(JSONArraypack* to_save) {}
 	virtual void LoadComponent(JSONArraypack* to_load) {}
+	// the binary scenes, the type is written before and the fields in the same order as the JSON ones
+	virtual void SaveComponent(SceneWriter* to_save) {}
+	virtual void LoadComponent(SceneReader* to_load) {}
 
 	void ResetIDs();
 
@@ -67,5 +97,7 @@ protected:
 	u64 ID = 0;
 	GameObject* game_object_attached = nullptr;
 	bool not_destroy = true;
+	// position in the ComponentRegistry dense array, -1 if the component is not attached to a GameObject
+	int registry_index = -1;
 
 };
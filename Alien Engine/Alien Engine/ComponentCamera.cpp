@@ -1,6 +1,7 @@
 #include "Component.h"
 #include "Globals.h"
 #include "ComponentCamera.h"
+#include "SceneBinary.h"
 #include "MathGeoLib/include/MathGeoLib.h"
 #include "MathGeoLib/include/MathBuildConfig.h"
 #include "ComponentTransform.h"
@@ -460,6 +461,46 @@ void ComponentCamera::LoadComponent(JSONArraypack* to_load)
 		App->renderer3D->selected_game_camera = this;
 	}
 
+	FinishLoad();
+}
+
+void ComponentCamera::SaveComponent(SceneWriter* to_save)
+{
+	to_save->Write(vertical_fov);
+	to_save->Write(horizontal_fov);
+	to_save->Write(camera_color_background);
+	to_save->Write(far_plane);
+	to_save->Write(near_plane);
+	to_save->Write(is_fov_horizontal);
+	to_save->Write(ID);
+	to_save->Write(App->renderer3D->actual_game_camera == this);
+	to_save->Write(game_object_attached->IsSelected());
+	to_save->Write(print_icon);
+	to_save->Write(camera_icon_color);
+}
+
+void ComponentCamera::LoadComponent(SceneReader* to_load)
+{
+	vertical_fov = to_load->Read<float>();
+	horizontal_fov = to_load->Read<float>();
+	camera_color_background = to_load->Read<Color>();
+	far_plane = to_load->Read<float>();
+	near_plane = to_load->Read<float>();
+	is_fov_horizontal = to_load->Read<int>();
+	ID = to_load->Read<u64>();
+	if (to_load->Read<bool>()) {
+		App->renderer3D->actual_game_camera = this;
+	}
+	if (to_load->Read<bool>()) {
+		App->renderer3D->selected_game_camera = this;
+	}
+	print_icon = to_load->Read<bool>();
+	camera_icon_color = to_load->Read<Color>();
+	FinishLoad();
+}
+
+void ComponentCamera::FinishLoad()
+{
 	frustum.nearPlaneDistance = near_plane;
 	frustum.farPlaneDistance = far_plane;
 	frustum.verticalFov = vertical_fov * Maths::Deg2Rad();
@@ -5,6 +5,7 @@
 #include "MathGeoLib/include/MathGeoLib.h"
 #include "MathGeoLib/include/MathBuildConfig.h"
 #include "ComponentMesh.h"
+#include "RenderQueue.h"
 
 class __declspec(dllexport) ComponentCamera : public Component {
 	friend class GameObject;
@@ -17,7 +18,9 @@ class __declspec(dllexport) ComponentCamera : public Component {
 	friend class ModuleObjects;
 	friend class RayCreator;
 	friend class Octree;
-	friend class OctreeNode;
+	friend class DynamicTree;
+	friend class ComponentMesh;
+	friend class TestScene;
 public:
 
 	ComponentCamera(GameObject* attach);
@@ -54,6 +57,10 @@ private:
 
 	void SaveComponent(JSONArraypack* to_save);
 	void LoadComponent(JSONArraypack* to_load);
+	void SaveComponent(SceneWriter* to_save);
+	void LoadComponent(SceneReader* to_load);
+	// the fields made from the loaded ones, the same for the JSON and the binary scenes
+	void FinishLoad();
 
 	void Reset();
 	void SetComponent(Component* component);
@@ -74,6 +81,9 @@ private:
 
 	ComponentMesh* mesh_camera = nullptr;
 
+	// visible objects sorted, kept between frames to reuse the memory
+	RenderQueue render_queue;
+
 	bool print_icon = true;
 	Color camera_icon_color = { 0.85f,0.85f,0.85f, 1.0F };
 
@@ -1,4 +1,5 @@
 #include "ComponentLight.h"
+#include "SceneBinary.h"
 #include "glew/include/glew.h"
 #include "GameObject.h"
 #include "imgui/imgui.h"
@@ -155,6 +156,24 @@ void ComponentLight::LoadComponent(JSONArraypack* to_load)
 	print_icon = to_load->GetBoolean("PrintIcon");
 }
 
+void ComponentLight::SaveComponent(SceneWriter* to_save)
+{
+	to_save->Write(diffuse);
+	to_save->Write(ambient);
+	to_save->Write(enabled);
+	to_save->Write(ID);
+	to_save->Write(print_icon);
+}
+
+void ComponentLight::LoadComponent(SceneReader* to_load)
+{
+	diffuse = to_load->Read<Color>();
+	ambient = to_load->Read<Color>();
+	enabled = to_load->Read<bool>();
+	ID = to_load->Read<u64>();
+	print_icon = to_load->Read<bool>();
+}
+
 void ComponentLight::DrawIconLight()
 {
 	if (bulb != nullptr && print_icon)
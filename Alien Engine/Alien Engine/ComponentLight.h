@@ -7,6 +7,7 @@
 class __declspec(dllexport) ComponentLight : public Component {
 	friend class GameObject;
 	friend class ComponentMesh;
+	friend class ModuleObjects;
 public:
 	ComponentLight(GameObject* attach);
 	virtual ~ComponentLight();
@@ -24,6 +25,8 @@ private:
 
 	void SaveComponent(JSONArraypack* to_save);
 	void LoadComponent(JSONArraypack* to_load);
+	void SaveComponent(SceneWriter* to_save);
+	void LoadComponent(SceneReader* to_load);
 
 	void DrawIconLight();
 
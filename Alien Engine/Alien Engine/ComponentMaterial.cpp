@@ -1,4 +1,5 @@
 #include "ComponentMaterial.h"
+#include "SceneBinary.h"
 #include "glew/include/glew.h"
 #include "GameObject.h"
 #include "imgui/imgui.h"
@@ -26,6 +27,7 @@ void ComponentMaterial::BindTexture()
 		glEnable(GL_TEXTURE_2D);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 		glBindTexture(GL_TEXTURE_2D, texture->id);
+		++App->renderer3D->state_changes;
 	}
 	glColor4f(color.r, color.g, color.b, color.a);
 	
@@ -253,6 +255,30 @@ void ComponentMaterial::LoadComponent(JSONArraypack* to_load)
 	ID = std::stoull(to_load->GetString("ID"));
 }
 
+void ComponentMaterial::SaveComponent(SceneWriter* to_save)
+{
+	to_save->Write(color);
+	to_save->Write(texture_activated);
+	to_save->Write(ID);
+	// 0 without texture
+	to_save->Write((texture != nullptr) ? texture->GetID() : (u64)0);
+	to_save->Write(enabled);
+}
+
+void ComponentMaterial::LoadComponent(SceneReader* to_load)
+{
+	color = to_load->Read<Color>();
+	texture_activated = to_load->Read<bool>();
+	ID = to_load->Read<u64>();
+	u64 texture_ID = to_load->Read<u64>();
+	if (texture_ID != 0) {
+		texture = (ResourceTexture*)App->resources->GetResourceWithID(texture_ID);
+		if (texture != nullptr)
+			texture->IncreaseReferences();
+	}
+	enabled = to_load->Read<bool>();
+}
+
 void ComponentMaterial::Clone(Component* clone)
 {
 	clone->enabled = enabled;
@@ -12,6 +12,8 @@ class __declspec(dllexport) ComponentMaterial : public Component {
 	friend class GameObject;
 	friend class ModuleImporter;
 	friend class ResourceMesh;
+	friend class RenderQueue;
+	friend class RenderBatcher;
 public:
 	ComponentMaterial(GameObject* attach);
 	virtual ~ComponentMaterial();
@@ -25,6 +27,8 @@ private:
 
 	void SaveComponent(JSONArraypack* to_save);
 	void LoadComponent(JSONArraypack* to_load);
+	void SaveComponent(SceneWriter* to_save);
+	void LoadComponent(SceneReader* to_load);
 
 	void Clone(Component* clone);
 
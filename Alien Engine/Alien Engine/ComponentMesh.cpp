@@ -1,4 +1,5 @@
 #include "ComponentMesh.h"
+#include "SceneBinary.h"
 #include "glew/include/glew.h"
 #include "GameObject.h"
 #include "ComponentTransform.h"
@@ -8,10 +9,12 @@
 #include "Color.h"
 #include "ResourceMesh.h"
 #include "ReturnZ.h"
+#include "ComponentCamera.h"
 
 ComponentMesh::ComponentMesh(GameObject* attach) : Component(attach)
 {
 	type = ComponentType::MESH;
+	local_aabb.SetNegativeInfinity();
 }
 
 ComponentMesh::~ComponentMesh()
@@ -23,10 +26,18 @@ ComponentMesh::~ComponentMesh()
 	if (mesh != nullptr && mesh->is_custom) {
 		mesh->DecreaseReferences();
 	}
+	if (tree_proxy != -1) {
+		App->objects->dynamic_tree.Remove(tree_proxy);
+	}
 }
 
 void ComponentMesh::DrawPolygon()
 {
+	if (mesh != nullptr && mesh->loading) {
+		DrawPlaceholder();
+		return;
+	}
+
 	if (mesh == nullptr || mesh->id_index <= 0)
 		return;
 
@@ -42,7 +53,7 @@ void ComponentMesh::DrawPolygon()
 		glFrontFace(GL_CW);
 
 	glPushMatrix();
-	glMultMatrixf(transform->global_transformation.Transposed().ptr());
+	glMultMatrixf(transform->GetGlobalMatrix().Transposed().ptr());
 
 	glEnableClientState(GL_VERTEX_ARRAY);
 
@@ -50,22 +61,14 @@ void ComponentMesh::DrawPolygon()
 	glEnable(GL_POLYGON_OFFSET_FILL);
 	glPolygonOffset(1.0f, 0.1f);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->id_vertex);
-	glVertexPointer(3, GL_FLOAT, 0, 0);
-
-	if (mesh->uv_cords != nullptr) {
-		glBindBuffer(GL_ARRAY_BUFFER, mesh->id_uv);
-		glTexCoordPointer(3, GL_FLOAT, 0, NULL);
-	}
-
-	if (mesh->normals != nullptr) {
-		glEnableClientState(GL_NORMAL_ARRAY);
-		glBindBuffer(GL_ARRAY_BUFFER, mesh->id_normals);
-		glNormalPointer(GL_FLOAT, 0, 0);
-	}
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->id_index);
-	glDrawElements(GL_TRIANGLES, mesh->num_index * 3, GL_UNSIGNED_INT, 0);
+	mesh->BindBuffers(true, true);
+	mesh->DrawElements(lod);
+	mesh->UnbindBuffers();
+	++App->renderer3D->draw_calls;
+	App->renderer3D->triangles += mesh->GetIndexCount(lod) / 3;
+	App->renderer3D->triangles_full += mesh->num_index / 3;
+	// the mesh buffers and the texture unbind
+	App->renderer3D->state_changes += 2;
 
 	if (transform->IsScaleNegative())
 		glFrontFace(GL_CCW);
@@ -80,6 +83,24 @@ void ComponentMesh::DrawPolygon()
 	glPopMatrix();
 }
 
+void ComponentMesh::DrawPlaceholder()
+{
+	if (!obb.IsFinite())
+		return;
+
+	// the box of the mesh in the color of the material until the streamer uploads it
+	glDisable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBegin(GL_LINES);
+	for (int i = 0; i < 12; ++i) {
+		LineSegment edge = obb.Edge(i);
+		glVertex3f(edge.a.x, edge.a.y, edge.a.z);
+		glVertex3f(edge.b.x, edge.b.y, edge.b.z);
+	}
+	glEnd();
+	++App->renderer3D->draw_calls;
+}
+
 void ComponentMesh::DrawOutLine()
 {
 	if (mesh == nullptr || mesh->id_index <= 0)
@@ -107,15 +128,14 @@ void ComponentMesh::DrawOutLine()
 
 	glPushMatrix();
 	ComponentTransform* transform = (ComponentTransform*)game_object_attached->GetComponent(ComponentType::TRANSFORM);
-	glMultMatrixf(transform->global_transformation.Transposed().ptr());
+	glMultMatrixf(transform->GetGlobalMatrix().Transposed().ptr());
 
 	glEnableClientState(GL_VERTEX_ARRAY);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->id_vertex);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->id_index);
-	glVertexPointer(3, GL_FLOAT, 0, 0);
+	mesh->BindBuffers(false, false);
 
-	glDrawElements(GL_TRIANGLES, mesh->num_index * 3, GL_UNSIGNED_INT, 0);
+	mesh->DrawElements();
+	mesh->UnbindBuffers();
 
 	glDisable(GL_STENCIL_TEST);
 	glDisable(GL_POLYGON_OFFSET_FILL);
@@ -133,7 +153,7 @@ void ComponentMesh::DrawMesh()
 	ComponentTransform* transform = (ComponentTransform*)game_object_attached->GetComponent(ComponentType::TRANSFORM);
 
 	glPushMatrix();
-	glMultMatrixf(transform->global_transformation.Transposed().ptr());
+	glMultMatrixf(transform->GetGlobalMatrix().Transposed().ptr());
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -143,11 +163,10 @@ void ComponentMesh::DrawMesh()
 
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->id_vertex);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->id_index);
-	glVertexPointer(3, GL_FLOAT, 0, NULL);
+	mesh->BindBuffers(false, false);
 
-	glDrawElements(GL_TRIANGLES, mesh->num_index * 3, GL_UNSIGNED_INT, NULL);
+	mesh->DrawElements();
+	mesh->UnbindBuffers();
 
 	glLineWidth(1);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -165,7 +184,7 @@ void ComponentMesh::DrawVertexNormals()
 		ComponentTransform* transform = (ComponentTransform*)game_object_attached->GetComponent(ComponentType::TRANSFORM);
 
 		glPushMatrix();
-		glMultMatrixf(transform->global_transformation.Transposed().ptr());
+		glMultMatrixf(transform->GetGlobalMatrix().Transposed().ptr());
 
 		glColor3f(App->objects->vertex_n_color.r, App->objects->vertex_n_color.g, App->objects->vertex_n_color.b);
 		glLineWidth(App->objects->vertex_n_width);
@@ -191,7 +210,7 @@ void ComponentMesh::DrawFaceNormals()
 		ComponentTransform* transform = (ComponentTransform*)game_object_attached->GetComponent(ComponentType::TRANSFORM);
 
 		glPushMatrix();
-		glMultMatrixf(transform->global_transformation.Transposed().ptr());
+		glMultMatrixf(transform->GetGlobalMatrix().Transposed().ptr());
 
 		glColor3f(App->objects->face_n_color.r, App->objects->face_n_color.g, App->objects->face_n_color.b);
 		glLineWidth(App->objects->face_n_width);
@@ -446,16 +465,102 @@ AABB ComponentMesh::GenerateAABB()
 {
 	if (mesh != nullptr) {
 		local_aabb.SetNegativeInfinity();
-		local_aabb.Enclose((float3*)mesh->vertex, mesh->num_vertex);
+		if (mesh->vertex != nullptr) {
+			local_aabb.Enclose((float3*)mesh->vertex, mesh->num_vertex);
+		}
+		else {
+			// streamed meshes have the bounds before the vertices
+			local_aabb = mesh->local_aabb;
+		}
 	}
 	return local_aabb;
 }
 
+void ComponentMesh::SelectLOD(const ComponentCamera* camera)
+{
+	if (mesh == nullptr || camera == nullptr || !App->objects->use_lods || mesh->GetLODsCount() <= 1 || !global_aabb.IsFinite()) {
+		lod = 0;
+		return;
+	}
+
+	// part of the screen height the bounding sphere covers
+	float radius = global_aabb.HalfDiagonal().Length();
+	float coverage = 1.0F;
+	if (camera->frustum.type == FrustumType::OrthographicFrustum) {
+		coverage = (2.0F * radius) / camera->frustum.orthographicHeight;
+	}
+	else {
+		float distance = camera->frustum.pos.Distance(global_aabb.CenterPoint());
+		if (distance > radius) {
+			coverage = radius / (distance * Tan(camera->frustum.verticalFov * 0.5F));
+		}
+	}
+
+	uint frame = App->objects->lod_frame;
+	std::vector<CameraLOD>::iterator item = camera_lods.begin();
+	for (; item != camera_lods.end(); ++item) {
+		if ((*item).camera == camera->ID)
+			break;
+	}
+	uint previous = (item != camera_lods.end()) ? (*item).lod : 0;
+
+	// each level is drawn below half the size of the previous one. A level already drawn is kept until the mesh
+	// is a bit bigger than its threshold and a new one waits until it is a bit smaller
+	lod = 0;
+	float threshold = App->objects->lod_screen_size;
+	for (uint i = 1; i < mesh->GetLODsCount(); ++i) {
+		float limit = threshold * ((i <= previous) ? 1.0F + App->objects->lod_hysteresis : 1.0F - App->objects->lod_hysteresis);
+		if (coverage >= limit)
+			break;
+		lod = i;
+		threshold *= 0.5F;
+	}
+
+	if (item != camera_lods.end()) {
+		(*item).lod = lod;
+		(*item).frame = frame;
+	}
+	else {
+		// forget the cameras that didn't draw the mesh lately (deleted, disabled, looking away...), the others keep their level
+		for (uint i = 0; i < camera_lods.size();) {
+			if (frame - camera_lods[i].frame > MESH_LOD_STALE_FRAMES) {
+				camera_lods[i] = camera_lods.back();
+				camera_lods.pop_back();
+			}
+			else {
+				++i;
+			}
+		}
+		CameraLOD camera_lod;
+		camera_lod.camera = camera->ID;
+		camera_lod.lod = lod;
+		camera_lod.frame = frame;
+		camera_lods.push_back(camera_lod);
+	}
+}
+
 void ComponentMesh::RecalculateAABB_OBB()
 {
 	ComponentTransform* transform = (ComponentTransform*)game_object_attached->GetComponent(ComponentType::TRANSFORM);
 	obb = GenerateAABB();
-	obb.Transform(transform->global_transformation);
+	obb.Transform(transform->GetGlobalMatrix());
+
+	global_aabb.SetNegativeInfinity();
+	global_aabb.Enclose(obb);
+}
+
+void ComponentMesh::RecalculateGlobalAABB_OBB()
+{
+	if (mesh == nullptr)
+		return;
+
+	if (!local_aabb.IsFinite()) {
+		GenerateAABB();
+	}
+
+	ComponentTransform* transform = (ComponentTransform*)game_object_attached->GetComponent(ComponentType::TRANSFORM);
+	obb = local_aabb;
+	obb.Transform(transform->GetGlobalMatrix());
 
 	global_aabb.SetNegativeInfinity();
 	global_aabb.Enclose(obb);
@@ -471,6 +576,33 @@ const OBB ComponentMesh::GetOBB() const
 	return obb;
 }
 
+// the primitives are told by their name
+static PrimitiveType GetPrimitiveType(const ResourceMesh* mesh)
+{
+	if (App->StringCmp("Cube", mesh->GetName())) {
+		return PrimitiveType::CUBE;
+	}
+	else if (App->StringCmp("Sphere", mesh->GetName())) {
+		return PrimitiveType::SPHERE_ALIEN;
+	}
+	else if (App->StringCmp("Dodecahedron", mesh->GetName())) {
+		return PrimitiveType::DODECAHEDRON;
+	}
+	else if (App->StringCmp("Icosahedron", mesh->GetName())) {
+		return PrimitiveType::ICOSAHEDRON;
+	}
+	else if (App->StringCmp("Octahedron", mesh->GetName())) {
+		return PrimitiveType::OCTAHEDRON;
+	}
+	else if (App->StringCmp("Rock", mesh->GetName())) {
+		return PrimitiveType::ROCK;
+	}
+	else if (App->StringCmp("Torus", mesh->GetName())) {
+		return PrimitiveType::TORUS;
+	}
+	return PrimitiveType::UNKONWN;
+}
+
 void ComponentMesh::SaveComponent(JSONArraypack* to_save)
 {
 	to_save->SetNumber("Type", (int)type);
@@ -487,26 +619,9 @@ void ComponentMesh::SaveComponent(JSONArraypack* to_save)
 		if (!mesh->is_primitive)
 			to_save->SetString("MeshID", std::to_string(mesh->GetID()));
 		else {
-			if (App->StringCmp("Cube", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::CUBE);
-			}
-			else if (App->StringCmp("Sphere", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::SPHERE_ALIEN);
-			}
-			else if (App->StringCmp("Dodecahedron", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::DODECAHEDRON);
-			}
-			else if (App->StringCmp("Icosahedron", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::ICOSAHEDRON);
-			}
-			else if (App->StringCmp("Octahedron", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::OCTAHEDRON);
-			}
-			else if (App->StringCmp("Rock", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::ROCK);
-			}
-			else if (App->StringCmp("Torus", mesh->GetName())) {
-				to_save->SetNumber("PrimType", (int)PrimitiveType::TORUS);
+			PrimitiveType primitive = GetPrimitiveType(mesh);
+			if (primitive != PrimitiveType::UNKONWN) {
+				to_save->SetNumber("PrimType", (int)primitive);
 			}
 		}
 	}
@@ -559,3 +674,51 @@ void ComponentMesh::LoadComponent(JSONArraypack* to_load)
 	GenerateAABB();
 	RecalculateAABB_OBB();
 }
+
+void ComponentMesh::SaveComponent(SceneWriter* to_save)
+{
+	to_save->Write(view_mesh);
+	to_save->Write(wireframe);
+	to_save->Write(view_vertex_normals);
+	to_save->Write(view_face_normals);
+	to_save->Write(draw_AABB);
+	to_save->Write(draw_OBB);
+	to_save->Write(ID);
+	to_save->Write(mesh != nullptr);
+	if (mesh != nullptr) {
+		to_save->Write(mesh->is_primitive);
+		if (!mesh->is_primitive)
+			to_save->Write(mesh->GetID());
+		else
+			to_save->Write((int)GetPrimitiveType(mesh));
+	}
+	to_save->Write(enabled);
+}
+
+void ComponentMesh::LoadComponent(SceneReader* to_load)
+{
+	view_mesh = to_load->Read<bool>();
+	wireframe = to_load->Read<bool>();
+	view_vertex_normals = to_load->Read<bool>();
+	view_face_normals = to_load->Read<bool>();
+	draw_AABB = to_load->Read<bool>();
+	draw_OBB = to_load->Read<bool>();
+	ID = to_load->Read<u64>();
+	if (to_load->Read<bool>()) {
+		if (!to_load->Read<bool>()) {
+			u64 ID = to_load->Read<u64>();
+			mesh = (ResourceMesh*)App->resources->GetResourceWithID(ID);
+			if (mesh != nullptr)
+				mesh->IncreaseReferences();
+		}
+		else {
+			int primitive = to_load->Read<int>();
+			if (primitive >= 0 && primitive < (int)PrimitiveType::UNKONWN) {
+				mesh = App->resources->GetPrimitive((PrimitiveType)primitive);
+			}
+		}
+	}
+	enabled = to_load->Read<bool>();
+	GenerateAABB();
+	RecalculateAABB_OBB();
+}
@@ -5,8 +5,21 @@
 #include "MathGeoLib/include/Geometry/AABB.h"
 #include "MathGeoLib/include/Geometry/OBB.h"
 #include "Color.h"
+#include <vector>
 
 class ResourceMesh;
+class ComponentCamera;
+
+// frames without drawing the mesh after which the level selected for a camera is forgotten
+#define MESH_LOD_STALE_FRAMES 120
+
+struct CameraLOD {
+	// the ID of the camera, a deleted camera can't be mistaken for a new one at the same address
+	u64 camera = 0;
+	uint lod = 0;
+	// ModuleObjects::lod_frame of the last selection
+	uint frame = 0;
+};
 
 class __declspec(dllexport) ComponentMesh : public Component {
 	friend class ReturnZ;
@@ -21,9 +34,13 @@ class __declspec(dllexport) ComponentMesh : public Component {
 	friend class ModuleObjects;
 	friend class Gizmos;
 	friend class Octree;
-	friend class OctreeNode;
 	friend class PanelCreateObject;
 	friend class PanelRender;
+	friend class TransformHierarchy;
+	friend class DynamicTree;
+	friend class RenderQueue;
+	friend class RenderBatcher;
+	friend class TestScene;
 public:
 
 	ComponentMesh(GameObject* attach);
@@ -32,6 +49,8 @@ public:
 private:
 
 	void DrawPolygon();
+	// while the mesh is being streamed
+	void DrawPlaceholder();
 	void DrawOutLine();
 	void DrawMesh();
 	void DrawVertexNormals();
@@ -46,14 +65,22 @@ private:
 	void Clone(Component* clone);
 
 	void RecalculateAABB_OBB();
+	// same as RecalculateAABB_OBB but reusing the local AABB, the mesh vertices are not iterated again
+	void RecalculateGlobalAABB_OBB();
 	const AABB GetGlobalAABB() const;
 	const OBB GetOBB() const;
 
 	void SaveComponent(JSONArraypack* to_save);
 	void LoadComponent(JSONArraypack* to_load);
+	void SaveComponent(SceneWriter* to_save);
+	void LoadComponent(SceneReader* to_load);
 
 	AABB GenerateAABB();
 
+	// level of detail for the size of the mesh on the screen of the camera, with hysteresis so it doesn't
+	// flicker in the threshold
+	void SelectLOD(const ComponentCamera* camera);
+
 private:
 	
 	ResourceMesh* mesh = nullptr;
@@ -69,4 +96,12 @@ private:
 	AABB local_aabb;
 	OBB obb;
 	AABB global_aabb;
+
+	// leaf in the DynamicTree, -1 if the mesh is static or not in the tree
+	int tree_proxy = -1;
+
+	// level drawn, 0 is the full mesh
+	uint lod = 0;
+	// last level selected for each camera that drew the mesh lately
+	std::vector<CameraLOD> camera_lods;
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "ComponentRegistry.h"
+#include "GameObject.h"
+
+ComponentRegistry::ComponentRegistry()
+{
+}
+
+ComponentRegistry::~ComponentRegistry()
+{
+	Clear();
+}
+
+void ComponentRegistry::Add(Component* component)
+{
+	if (component == nullptr || component->type == ComponentType::UNKNOWN || component->registry_index != -1)
+		return;
+
+	std::vector<Component*>& components = dense[(uint)component->type];
+	component->registry_index = components.size();
+	components.push_back(component);
+}
+
+void ComponentRegistry::Remove(Component* component)
+{
+	if (component == nullptr || component->type == ComponentType::UNKNOWN || component->registry_index == -1)
+		return;
+
+	std::vector<Component*>& components = dense[(uint)component->type];
+	const int index = component->registry_index;
+
+	if (index < (int)components.size() && components[index] == component) {
+		components[index] = components.back();
+		components[index]->registry_index = index;
+		components.pop_back();
+	}
+	component->registry_index = -1;
+}
+
+void ComponentRegistry::Clear()
+{
+	for (uint i = 0; i < (uint)ComponentType::UNKNOWN; ++i) {
+		std::vector<Component*>::iterator item = dense[i].begin();
+		for (; item != dense[i].end(); ++item) {
+			if (*item != nullptr) {
+				(*item)->registry_index = -1;
+			}
+		}
+		dense[i].clear();
+	}
+}
+
+const std::vector<Component*>& ComponentRegistry::GetComponents(const ComponentType& type) const
+{
+	return dense[(uint)type];
+}
+
+uint ComponentRegistry::GetCount(const ComponentType& type) const
+{
+	return (type != ComponentType::UNKNOWN) ? dense[(uint)type].size() : 0;
+}
+
+bool ComponentRegistry::IsFirstOfType(const Component* component)
+{
+	const GameObject* object = component->game_object_attached;
+	return object != nullptr && object->GetComponent(component->type) == component;
+}
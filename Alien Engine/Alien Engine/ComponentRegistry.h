@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Component.h"
+#include <vector>
+
+// Dense array with every component of each type attached to a GameObject, systems iterate them instead of walking
+// the GameObject tree. Each component knows its position in the array, so adding and removing are O(1)
+// (the last component of the array is moved to the removed position).
+// The arrays hold pointers and not the components: they are polymorphic, owned by their GameObject and pointed to
+// from everywhere, so they can't be moved. An object with two components of a type has both in the array, the
+// systems only use the first like the GameObject tree did (IsFirstOfType).
+class ComponentRegistry {
+
+public:
+
+	ComponentRegistry();
+	~ComponentRegistry();
+
+	void Add(Component* component);
+	void Remove(Component* component);
+	void Clear();
+
+	const std::vector<Component*>& GetComponents(const ComponentType& type) const;
+	uint GetCount(const ComponentType& type) const;
+
+	// true if the component is the one GameObject::GetComponent gives for its type
+	static bool IsFirstOfType(const Component* component);
+
+private:
+
+	std::vector<Component*> dense[(uint)ComponentType::UNKNOWN];
+};
@@ -8,6 +8,7 @@
 #include "FileNode.h"
 #include "ResourcePrefab.h"
 #include "Prefab.h"
+#include "SceneBinary.h"
 
 ComponentScript::ComponentScript(GameObject* attach) : Component(attach)
 {
@@ -347,18 +348,7 @@ void ComponentScript::LoadComponent(JSONArraypack* to_load)
 							*value = inspector->GetNumber("bool");
 							break; }
 						case InspectorScriptData::PREFAB: {
-							Prefab* value = (Prefab*)inspector_variables[i].ptr;
-							value->prefabID = std::stoull(inspector->GetString("prefab"));
-							if (value->prefabID != 0) {
-								ResourcePrefab* prefab = (ResourcePrefab*)App->resources->GetResourceWithID(value->prefabID);
-								if (prefab != nullptr) {
-									value->prefab_name = prefab->name;
-									prefab->prefab_references.push_back(value);
-								}
-								else {
-									value->prefabID = 0;
-								}
-							}
+							LoadInspectorPrefab((Prefab*)inspector_variables[i].ptr, std::stoull(inspector->GetString("prefab")));
 							break; }
 						case InspectorScriptData::DataType::GAMEOBJECT: {
 							u64 id = std::stoull(inspector->GetString("gameobject"));
@@ -381,6 +371,138 @@ void ComponentScript::LoadComponent(JSONArraypack* to_load)
 	}
 }
 
+// an inspector variable of the binary scenes, its value is kept until the variables of the script are there
+struct SavedInspectorVariable {
+	std::string name;
+	int type = 0;
+	int int_value = 0;
+	float float_value = 0.0F;
+	bool bool_value = false;
+	u64 ID = 0;
+};
+
+void ComponentScript::SaveComponent(SceneWriter* to_save)
+{
+	to_save->Write(ID);
+	to_save->Write(resourceID);
+	to_save->WriteString(data_name.data());
+	to_save->Write((uint)inspector_variables.size());
+	for (uint i = 0; i < inspector_variables.size(); ++i) {
+		to_save->Write((int)inspector_variables[i].variable_type);
+		to_save->WriteString(inspector_variables[i].variable_name.data());
+		switch (inspector_variables[i].variable_type) {
+		case InspectorScriptData::DataType::INT: {
+			to_save->Write(*(int*)inspector_variables[i].ptr);
+			break; }
+		case InspectorScriptData::DataType::FLOAT: {
+			to_save->Write(*(float*)inspector_variables[i].ptr);
+			break; }
+		case InspectorScriptData::DataType::BOOL: {
+			to_save->Write(*(bool*)inspector_variables[i].ptr);
+			break; }
+		case InspectorScriptData::DataType::PREFAB: {
+			to_save->Write(((Prefab*)inspector_variables[i].ptr)->prefabID);
+			break; }
+		case InspectorScriptData::DataType::GAMEOBJECT: {
+			bool has_object = inspector_variables[i].obj != nullptr && *inspector_variables[i].obj != nullptr;
+			to_save->Write(has_object ? (*inspector_variables[i].obj)->ID : (u64)0);
+			break; }
+		default:
+			break;
+		}
+	}
+}
+
+void ComponentScript::LoadComponent(SceneReader* to_load)
+{
+	ID = to_load->Read<u64>();
+	resourceID = to_load->Read<u64>();
+	data_name = to_load->ReadString();
+
+	// read all of them first, the block of the component must be read even if the script is not there
+	std::vector<SavedInspectorVariable> saved_variables;
+	uint variables_count = to_load->Read<uint>();
+	for (uint i = 0; i < variables_count && !to_load->Failed(); ++i) {
+		saved_variables.push_back(SavedInspectorVariable());
+		SavedInspectorVariable& saved = saved_variables.back();
+		saved.type = to_load->Read<int>();
+		saved.name = to_load->ReadString();
+		switch (saved.type) {
+		case InspectorScriptData::DataType::INT: {
+			saved.int_value = to_load->Read<int>();
+			break; }
+		case InspectorScriptData::DataType::FLOAT: {
+			saved.float_value = to_load->Read<float>();
+			break; }
+		case InspectorScriptData::DataType::BOOL: {
+			saved.bool_value = to_load->Read<bool>();
+			break; }
+		case InspectorScriptData::DataType::PREFAB:
+		case InspectorScriptData::DataType::GAMEOBJECT: {
+			saved.ID = to_load->Read<u64>();
+			break; }
+		default:
+			break;
+		}
+	}
+
+	ResourceScript* script = dynamic_cast<ResourceScript*>(App->resources->GetResourceWithID(resourceID));
+	if (resourceID != 0 && script != nullptr) {
+		for (uint i = 0; i < script->data_structures.size(); ++i) {
+			if (App->StringCmp(data_name.data(), script->data_structures[i].first.data())) {
+				LoadData(data_name.data(), script->data_structures[i].second);
+				break;
+			}
+		}
+		for (uint i = 0; i < inspector_variables.size(); ++i) {
+			for (uint j = 0; j < saved_variables.size(); ++j) {
+				const SavedInspectorVariable& saved = saved_variables[j];
+				if (App->StringCmp(inspector_variables[i].variable_name.data(), saved.name.data()) && inspector_variables[i].variable_type == saved.type) {
+					switch (inspector_variables[i].variable_type) {
+					case InspectorScriptData::DataType::INT: {
+						*(int*)inspector_variables[i].ptr = saved.int_value;
+						break; }
+					case InspectorScriptData::DataType::FLOAT: {
+						*(float*)inspector_variables[i].ptr = saved.float_value;
+						break; }
+					case InspectorScriptData::DataType::BOOL: {
+						*(bool*)inspector_variables[i].ptr = saved.bool_value;
+						break; }
+					case InspectorScriptData::DataType::PREFAB: {
+						LoadInspectorPrefab((Prefab*)inspector_variables[i].ptr, saved.ID);
+						break; }
+					case InspectorScriptData::DataType::GAMEOBJECT: {
+						if (saved.ID != 0) {
+							App->objects->AddScriptObject(saved.ID, inspector_variables[i].obj);
+						}
+						break; }
+					default:
+						break;
+					}
+				}
+			}
+		}
+	}
+	else {
+		delete this;
+	}
+}
+
+void ComponentScript::LoadInspectorPrefab(Prefab* prefab, const u64& prefabID)
+{
+	prefab->prefabID = prefabID;
+	if (prefab->prefabID != 0) {
+		ResourcePrefab* resource = (ResourcePrefab*)App->resources->GetResourceWithID(prefab->prefabID);
+		if (resource != nullptr) {
+			prefab->prefab_name = resource->name;
+			resource->prefab_references.push_back(prefab);
+		}
+		else {
+			prefab->prefabID = 0;
+		}
+	}
+}
+
 void ComponentScript::Clone(Component* clone)
 {
 	clone->enabled = enabled;
@@ -72,6 +72,10 @@ private:
 
 	void SaveComponent(JSONArraypack* to_save);
 	void LoadComponent(JSONArraypack* to_load);
+	void SaveComponent(SceneWriter* to_save);
+	void LoadComponent(SceneReader* to_load);
+	// the prefab of an inspector variable, 0 or a missing prefab leave it empty
+	void LoadInspectorPrefab(Prefab* prefab, const u64& prefabID);
 
 	void Clone(Component* clone);
 
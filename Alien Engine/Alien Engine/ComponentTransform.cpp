@@ -1,4 +1,5 @@
 #include "ComponentTransform.h"
+#include "SceneBinary.h"
 #include "GameObject.h"
 #include "imgui/imgui.h"
 #include "ModuleObjects.h"
@@ -8,10 +9,12 @@
 #include "PanelScene.h"
 #include "ResourcePrefab.h"
 #include "PanelProject.h"
+#include <algorithm>
 
 ComponentTransform::ComponentTransform(GameObject* attach) : Component(attach)
 {
 	type = ComponentType::TRANSFORM;
+	App->objects->transform_hierarchy.Invalidate();
 }
 
 ComponentTransform::ComponentTransform(GameObject* attach, const float3& pos, const Quat& rot, const float3& scale) : Component(attach)
@@ -27,7 +30,7 @@ ComponentTransform::ComponentTransform(GameObject* attach, const float3& pos, co
 
 	if (game_object_attached->parent != nullptr) {
 		ComponentTransform* tr = (ComponentTransform*)game_object_attached->parent->GetComponent(ComponentType::TRANSFORM);
-		if (tr != nullptr) global_transformation = tr->global_transformation * local_transformation;
+		if (tr != nullptr) global_transformation = tr->GetGlobalMatrix() * local_transformation;
 		else global_transformation = local_transformation;
 	}
 	else
@@ -44,10 +47,12 @@ ComponentTransform::ComponentTransform(GameObject* attach, const float3& pos, co
 		 2 * (local_rotation.x * local_rotation.z + local_rotation.w * local_rotation.y) };
 
 	type = ComponentType::TRANSFORM;
+	App->objects->transform_hierarchy.Invalidate();
 }
 
 ComponentTransform::~ComponentTransform()
 {
+	App->objects->transform_hierarchy.Invalidate();
 }
 
 void ComponentTransform::SetLocalPosition(const float3& new_local_pos)
@@ -73,12 +78,8 @@ const float3 ComponentTransform::GetLocalPosition() const
 
 const float3 ComponentTransform::GetGlobalPosition() const
 {
-	float3 pos, scale;
-	Quat rot;
-
-	global_transformation.Decompose(pos, rot, scale);
-
-	return pos;
+	// same as the position of Decompose without computing rotation and scale
+	return GetGlobalMatrix().TranslatePart();
 }
 
 void ComponentTransform::SetLocalScale(const float3& new_local_scale)
@@ -124,7 +125,7 @@ const float3 ComponentTransform::GetGlobalScale() const
 	float3 pos, scale;
 	Quat rot;
 
-	global_transformation.Decompose(pos, rot, scale);
+	GetGlobalMatrix().Decompose(pos, rot, scale);
 
 	return scale;
 }
@@ -168,7 +169,7 @@ const Quat ComponentTransform::GetGlobalRotation() const
 	float3 pos, scale;
 	Quat rot;
 
-	global_transformation.Decompose(pos, rot, scale);
+	GetGlobalMatrix().Decompose(pos, rot, scale);
 
 	return rot;
 }
@@ -180,16 +181,6 @@ void ComponentTransform::RecalculateTransform()
 	if (game_object_attached == nullptr)
 		return;
 
-	if (game_object_attached->parent != nullptr) {
-		ComponentTransform* tr = (ComponentTransform*)game_object_attached->parent->GetComponent(ComponentType::TRANSFORM);
-		if (tr != nullptr)
-			global_transformation = tr->global_transformation * local_transformation;
-		else
-			global_transformation = local_transformation;
-	}
-	else {
-		global_transformation = local_transformation;
-	}
 	up = { 2 * (local_rotation.x * local_rotation.y - local_rotation.w * local_rotation.z),
 			1 - 2 * (local_rotation.x * local_rotation.x + local_rotation.z * local_rotation.z),
 			2 * (local_rotation.y * local_rotation.z + local_rotation.w * local_rotation.x) };
@@ -200,19 +191,38 @@ void ComponentTransform::RecalculateTransform()
 			 2 * (local_rotation.x * local_rotation.y + local_rotation.w * local_rotation.z),
 			 2 * (local_rotation.x * local_rotation.z + local_rotation.w * local_rotation.y) };
 
+	SetDirty();
+	App->objects->transform_hierarchy.MarkDirty(this);
+}
+
+void ComponentTransform::SetDirty()
+{
+	// if we are already dirty, all our children are dirty too
+	if (is_dirty)
+		return;
+
+	is_dirty = true;
+
 	std::vector<GameObject*>::iterator item = game_object_attached->children.begin();
 	for (; item != game_object_attached->children.end(); ++item) {
 		if (*item != nullptr) {
 			ComponentTransform* tr = (ComponentTransform*)(*item)->GetComponent(ComponentType::TRANSFORM);
-			if (tr != nullptr) tr->RecalculateTransform();
+			if (tr != nullptr) tr->SetDirty();
 		}
 	}
+}
 
-	ComponentMesh* mesh = (ComponentMesh*)game_object_attached->GetComponent(ComponentType::MESH);
-	if (mesh != nullptr)
-	{
-		mesh->RecalculateAABB_OBB();
+const float4x4& ComponentTransform::GetGlobalMatrix() const
+{
+	if (is_dirty) {
+		ComponentTransform* tr = nullptr;
+		if (game_object_attached != nullptr && game_object_attached->parent != nullptr) {
+			tr = (ComponentTransform*)game_object_attached->parent->GetComponent(ComponentType::TRANSFORM);
+		}
+		global_transformation = (tr != nullptr) ? tr->GetGlobalMatrix() * local_transformation : local_transformation;
+		is_dirty = false;
 	}
+	return global_transformation;
 }
 
 
@@ -225,7 +235,10 @@ bool ComponentTransform::DrawInspector()
 	ImGui::SameLine();
 
 	static char name[30];
-	memcpy(name, game_object_attached->GetName(), 30);
+	uint name_size = game_object_attached->name.size();
+	name_size = (name_size < 29) ? name_size : 29;
+	memcpy(name, game_object_attached->GetName(), name_size);
+	name[name_size] = '\0';
 
 	ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5F);
 
@@ -248,13 +261,12 @@ bool ComponentTransform::DrawInspector()
 	}
 	ImGui::Spacing();
 	ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.6F);
-	if (ImGui::BeginCombo("Tag", game_object_attached->tag))
+	if (ImGui::BeginCombo("Tag", game_object_attached->GetTag()))
 	{
-		std::vector<std::string>::iterator item = App->objects->tags.begin();
-		for (; item != App->objects->tags.end(); ++item) {
-			bool is_selected = App->StringCmp(game_object_attached->tag, (*item).data());
-			if (ImGui::Selectable((*item).data(), is_selected)) {
-				strcpy(game_object_attached->tag, (*item).data());
+		for (uint i = 0; i < App->objects->tags.size(); ++i) {
+			bool is_selected = game_object_attached->tag == i;
+			if (ImGui::Selectable(App->objects->tags[i].data(), is_selected)) {
+				game_object_attached->tag = i;
 			}
 		}
 		ImGui::EndCombo();
@@ -584,12 +596,16 @@ bool ComponentTransform::DrawInspector()
 			ImGui::PushStyleColor(ImGuiCol_::ImGuiCol_ButtonActive, { 0.7F,0,0,1 });
 			ImGui::PushStyleColor(ImGuiCol_::ImGuiCol_ButtonHovered, { 0.8F,0,0,1 });
 			if (ImGui::Button("Delete Selected")) {
+				// the objects keep the index of their tag, the last ones are removed first so the next indices are right
+				std::vector<uint> removed;
 				std::list<std::vector<std::string>::iterator>::iterator item = selected.begin();
-				uint i = 0;
 				for (; item != selected.end(); ++item) {
-					App->objects->GetRoot(true)->ReTag((*(*item)).data(), "UnTagged");
-					App->objects->tags.erase((*item) - i);
-					++i;
+					removed.push_back((*item) - App->objects->tags.begin());
+				}
+				std::sort(removed.begin(), removed.end(), std::greater<uint>());
+				for (uint i = 0; i < removed.size(); ++i) {
+					App->objects->GetRoot(true)->RemoveTag(removed[i]);
+					App->objects->tags.erase(App->objects->tags.begin() + removed[i]);
 				}
 				selected.clear();
 
@@ -808,7 +824,7 @@ void ComponentTransform::Clone(Component* clone)
 	ComponentTransform* transform = (ComponentTransform*)clone;
 	transform->euler_rotation = euler_rotation;
 	transform->forward = forward;
-	transform->global_transformation = global_transformation;
+	transform->global_transformation = GetGlobalMatrix();
 	transform->is_scale_negative = is_scale_negative;
 	transform->local_position = local_position;
 	transform->local_rotation = local_rotation;
@@ -835,6 +851,30 @@ void ComponentTransform::LoadComponent(JSONArraypack* to_load)
 	local_scale = to_load->GetFloat3("Scale");
 	is_scale_negative = to_load->GetBoolean("ScaleNegative");
 	ID = std::stoull(to_load->GetString("ID"));
+	FinishLoad();
+}
+
+void ComponentTransform::SaveComponent(SceneWriter* to_save)
+{
+	to_save->Write(local_position);
+	to_save->Write(local_rotation);
+	to_save->Write(local_scale);
+	to_save->Write(is_scale_negative);
+	to_save->Write(ID);
+}
+
+void ComponentTransform::LoadComponent(SceneReader* to_load)
+{
+	local_position = to_load->Read<float3>();
+	local_rotation = to_load->Read<Quat>();
+	local_scale = to_load->Read<float3>();
+	is_scale_negative = to_load->Read<bool>();
+	ID = to_load->Read<u64>();
+	FinishLoad();
+}
+
+void ComponentTransform::FinishLoad()
+{
 	euler_rotation = local_rotation.ToEulerXYZ();
 	euler_rotation.x = RadToDeg(euler_rotation.x);
 	euler_rotation.y = RadToDeg(euler_rotation.y);
@@ -844,11 +884,12 @@ void ComponentTransform::LoadComponent(JSONArraypack* to_load)
 
 	if (game_object_attached->parent != nullptr) {
 		ComponentTransform* tr = (ComponentTransform*)game_object_attached->parent->GetComponent(ComponentType::TRANSFORM);
-		if (tr != nullptr) global_transformation = tr->global_transformation * local_transformation;
+		if (tr != nullptr) global_transformation = tr->GetGlobalMatrix() * local_transformation;
 		else global_transformation = local_transformation;
 	}
 	else
 		global_transformation = local_transformation;
+	is_dirty = false;
 }
 
 void ComponentTransform::SetGlobalTransformation(const float4x4& global_transformation)
@@ -12,6 +12,9 @@ class __declspec(dllexport) ComponentTransform : public Component {
 	friend class ModuleObjects;
 	friend class ModuleUI;
 	friend class PanelInspector;
+	friend class TransformHierarchy;
+	friend class RenderBatcher;
+	friend class TestScene;
 public:
 
 	ComponentTransform(GameObject* attach);
@@ -36,10 +39,14 @@ public:
 	const Quat GetLocalRotation() const;
 	const Quat GetGlobalRotation() const;
 
+	const float4x4& GetGlobalMatrix() const;
+
 private:
 
 	void LookScale();
 	void RecalculateTransform();
+	// mark this transform and all its children as dirty, global matrix will be solved when needed or at the end of the frame
+	void SetDirty();
 
 	void Reparent(const float4x4& transform);
 
@@ -57,6 +64,10 @@ private:
 
 	void SaveComponent(JSONArraypack* to_save);
 	void LoadComponent(JSONArraypack* to_load);
+	void SaveComponent(SceneWriter* to_save);
+	void LoadComponent(SceneReader* to_load);
+	// the fields made from the loaded ones, the same for the JSON and the binary scenes
+	void FinishLoad();
 
 	void SetGlobalTransformation(const float4x4& global_transformation);
 	void SetGlobalRotation(const Quat& rotation);
@@ -73,8 +84,14 @@ public:
 
 private:
 
-	float4x4 global_transformation = float4x4::identity();
+	mutable float4x4 global_transformation = float4x4::identity();
 	float4x4 local_transformation = float4x4::identity();
+
+	// global_transformation is outdated
+	mutable bool is_dirty = false;
+	// global_transformation and bounding boxes are pending to be solved by the TransformHierarchy
+	bool needs_update = false;
+	int hierarchy_index = -1;
 	
 	// to know if flip poly or not
 	bool is_scale_negative = false;
@@ -0,0 +1,447 @@
+#include "DynamicTree.h"
+#include "Application.h"
+#include "ComponentCamera.h"
+#include "ComponentMesh.h"
+#include "GameObject.h"
+#include "ComponentRegistry.h"
+
+DynamicTree::DynamicTree()
+{
+}
+
+DynamicTree::~DynamicTree()
+{
+	Clear();
+}
+
+void DynamicTree::Update(const std::vector<Component*>& meshes)
+{
+	std::vector<Component*>::const_iterator item = meshes.cbegin();
+	for (; item != meshes.cend(); ++item) {
+		ComponentMesh* mesh = (ComponentMesh*)*item;
+		if (mesh == nullptr)
+			continue;
+
+		// only the first mesh of an object is drawn
+		bool dynamic = !mesh->game_object_attached->is_static && mesh->mesh != nullptr && mesh->global_aabb.IsFinite()
+			&& ComponentRegistry::IsFirstOfType(mesh);
+
+		if (!dynamic) {
+			if (mesh->tree_proxy != -1) {
+				Remove(mesh->tree_proxy);
+			}
+		}
+		else if (mesh->tree_proxy == -1) {
+			mesh->tree_proxy = Insert(mesh, mesh->global_aabb);
+		}
+		else {
+			Move(mesh->tree_proxy, mesh->global_aabb);
+		}
+	}
+}
+
+int DynamicTree::Insert(ComponentMesh* mesh, const AABB& aabb)
+{
+	int proxy = AllocateNode();
+	nodes[proxy].aabb = FattenAABB(aabb);
+	nodes[proxy].mesh = mesh;
+	nodes[proxy].height = 0;
+
+	InsertLeaf(proxy);
+	++leaves_count;
+
+	return proxy;
+}
+
+void DynamicTree::Remove(int proxy)
+{
+	if (proxy < 0 || proxy >= (int)nodes.size() || !nodes[proxy].IsLeaf() || nodes[proxy].height != 0)
+		return;
+
+	RemoveLeaf(proxy);
+	if (nodes[proxy].mesh != nullptr) {
+		nodes[proxy].mesh->tree_proxy = -1;
+	}
+	FreeNode(proxy);
+	--leaves_count;
+}
+
+bool DynamicTree::Move(int proxy, const AABB& aabb)
+{
+	if (nodes[proxy].aabb.Contains(aabb))
+		return false;
+
+	RemoveLeaf(proxy);
+	nodes[proxy].aabb = FattenAABB(aabb);
+	InsertLeaf(proxy);
+
+	return true;
+}
+
+void DynamicTree::Clear()
+{
+	std::vector<DynamicTreeNode>::iterator item = nodes.begin();
+	for (; item != nodes.end(); ++item) {
+		if ((*item).height == 0 && (*item).mesh != nullptr) {
+			(*item).mesh->tree_proxy = -1;
+		}
+	}
+	nodes.clear();
+	root = -1;
+	free_list = -1;
+	nodes_count = 0;
+	leaves_count = 0;
+}
+
+void DynamicTree::GetMeshesInFrustum(const FrustumCulling& frustum, std::vector<ComponentMesh*>* meshes) const
+{
+	if (root == -1)
+		return;
+
+	frustum_meshes.clear();
+	min_x.clear(); min_y.clear(); min_z.clear();
+	max_x.clear(); max_y.clear(); max_z.clear();
+
+	// each node keeps the planes its parent was not completely inside
+	frustum_stack.clear();
+	frustum_stack.push_back({ root, FRUSTUM_PLANES_MASK });
+
+	while (!frustum_stack.empty()) {
+		const DynamicTreeNode& node = nodes[frustum_stack.back().first];
+		uint plane_mask = frustum_stack.back().second;
+		frustum_stack.pop_back();
+
+		if (!frustum.IsInside(node.aabb, plane_mask))
+			continue;
+
+		if (node.IsLeaf()) {
+			// the real AABB is inside the one in the tree, if that one is inside all the planes so is the mesh
+			if (plane_mask == 0) {
+				meshes->push_back(node.mesh);
+			}
+			else {
+				const AABB& aabb = node.mesh->global_aabb;
+				frustum_meshes.push_back(node.mesh);
+				min_x.push_back(aabb.minPoint.x); min_y.push_back(aabb.minPoint.y); min_z.push_back(aabb.minPoint.z);
+				max_x.push_back(aabb.maxPoint.x); max_y.push_back(aabb.maxPoint.y); max_z.push_back(aabb.maxPoint.z);
+			}
+		}
+		else {
+			frustum_stack.push_back({ node.left, plane_mask });
+			frustum_stack.push_back({ node.right, plane_mask });
+		}
+	}
+
+	// the real AABBs of the leaves that touch a plane, the one in the tree is bigger
+	inside.resize(frustum_meshes.size());
+	if (!frustum_meshes.empty()) {
+		frustum.AreInside(min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data(), frustum_meshes.size(), inside.data());
+	}
+	for (uint i = 0; i < frustum_meshes.size(); ++i) {
+		if (inside[i] != 0) {
+			meshes->push_back(frustum_meshes[i]);
+		}
+	}
+}
+
+void DynamicTree::GetMeshesInRay(const LineSegment& ray, std::vector<std::pair<float, ComponentMesh*>>* meshes) const
+{
+	if (root == -1)
+		return;
+
+	float distance = 0.f;
+	float distance_out = 0.f;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		const DynamicTreeNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (!ray.Intersects(node.aabb, distance, distance_out))
+			continue;
+
+		if (node.IsLeaf()) {
+			if (ray.Intersects(node.mesh->GetGlobalAABB(), distance, distance_out)) {
+				meshes->push_back({ distance, node.mesh });
+			}
+		}
+		else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+}
+
+uint DynamicTree::GetLeavesCount() const
+{
+	return leaves_count;
+}
+
+uint DynamicTree::GetNodesCount() const
+{
+	return nodes_count;
+}
+
+int DynamicTree::GetHeight() const
+{
+	return (root == -1) ? 0 : nodes[root].height;
+}
+
+int DynamicTree::AllocateNode()
+{
+	int node = -1;
+	if (free_list != -1) {
+		node = free_list;
+		free_list = nodes[node].next_free;
+		nodes[node] = DynamicTreeNode();
+	}
+	else {
+		node = nodes.size();
+		nodes.push_back(DynamicTreeNode());
+	}
+	++nodes_count;
+	return node;
+}
+
+void DynamicTree::FreeNode(int node)
+{
+	nodes[node].mesh = nullptr;
+	nodes[node].height = -1;
+	nodes[node].next_free = free_list;
+	free_list = node;
+	--nodes_count;
+}
+
+void DynamicTree::InsertLeaf(int leaf)
+{
+	if (root == -1) {
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	// find the best sibling, the one that makes the tree grow less (surface area heuristic)
+	const AABB leaf_aabb = nodes[leaf].aabb;
+	int index = root;
+	while (!nodes[index].IsLeaf()) {
+		const DynamicTreeNode& node = nodes[index];
+
+		AABB combined = node.aabb;
+		combined.Enclose(leaf_aabb);
+		float combined_area = combined.SurfaceArea();
+
+		// cost of creating a new parent for this node and the leaf
+		float cost = 2.0F * combined_area;
+		// minimum cost of pushing the leaf further down the tree
+		float inheritance_cost = 2.0F * (combined_area - node.aabb.SurfaceArea());
+
+		float child_cost[2];
+		int child[2] = { node.left, node.right };
+		for (uint i = 0; i < 2; ++i) {
+			AABB aabb = nodes[child[i]].aabb;
+			aabb.Enclose(leaf_aabb);
+			if (nodes[child[i]].IsLeaf())
+				child_cost[i] = aabb.SurfaceArea() + inheritance_cost;
+			else
+				child_cost[i] = (aabb.SurfaceArea() - nodes[child[i]].aabb.SurfaceArea()) + inheritance_cost;
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+			break;
+
+		index = (child_cost[0] < child_cost[1]) ? child[0] : child[1];
+	}
+
+	int sibling = index;
+	int old_parent = nodes[sibling].parent;
+	int new_parent = AllocateNode();
+
+	nodes[new_parent].parent = old_parent;
+	nodes[new_parent].aabb = nodes[sibling].aabb;
+	nodes[new_parent].aabb.Enclose(leaf_aabb);
+	nodes[new_parent].height = nodes[sibling].height + 1;
+	nodes[new_parent].left = sibling;
+	nodes[new_parent].right = leaf;
+	nodes[sibling].parent = new_parent;
+	nodes[leaf].parent = new_parent;
+
+	if (old_parent != -1) {
+		if (nodes[old_parent].left == sibling)
+			nodes[old_parent].left = new_parent;
+		else
+			nodes[old_parent].right = new_parent;
+	}
+	else {
+		root = new_parent;
+	}
+
+	// walk back up fixing heights and AABBs
+	index = nodes[leaf].parent;
+	while (index != -1) {
+		index = Balance(index);
+
+		DynamicTreeNode& node = nodes[index];
+		node.height = 1 + Max(nodes[node.left].height, nodes[node.right].height);
+		node.aabb = nodes[node.left].aabb;
+		node.aabb.Enclose(nodes[node.right].aabb);
+
+		index = node.parent;
+	}
+}
+
+void DynamicTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root) {
+		root = -1;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grand_parent = nodes[parent].parent;
+	int sibling = (nodes[parent].left == leaf) ? nodes[parent].right : nodes[parent].left;
+
+	if (grand_parent != -1) {
+		// the sibling takes the place of the parent
+		if (nodes[grand_parent].left == parent)
+			nodes[grand_parent].left = sibling;
+		else
+			nodes[grand_parent].right = sibling;
+		nodes[sibling].parent = grand_parent;
+		FreeNode(parent);
+
+		int index = grand_parent;
+		while (index != -1) {
+			index = Balance(index);
+
+			DynamicTreeNode& node = nodes[index];
+			node.aabb = nodes[node.left].aabb;
+			node.aabb.Enclose(nodes[node.right].aabb);
+			node.height = 1 + Max(nodes[node.left].height, nodes[node.right].height);
+
+			index = node.parent;
+		}
+	}
+	else {
+		root = sibling;
+		nodes[sibling].parent = -1;
+		FreeNode(parent);
+	}
+	nodes[leaf].parent = -1;
+}
+
+int DynamicTree::Balance(int index_a)
+{
+	DynamicTreeNode& a = nodes[index_a];
+	if (a.IsLeaf() || a.height < 2)
+		return index_a;
+
+	int index_b = a.left;
+	int index_c = a.right;
+	DynamicTreeNode& b = nodes[index_b];
+	DynamicTreeNode& c = nodes[index_c];
+
+	int balance = c.height - b.height;
+
+	// rotate c up
+	if (balance > 1) {
+		int index_f = c.left;
+		int index_g = c.right;
+		DynamicTreeNode& f = nodes[index_f];
+		DynamicTreeNode& g = nodes[index_g];
+
+		c.left = index_a;
+		c.parent = a.parent;
+		a.parent = index_c;
+
+		if (c.parent != -1) {
+			if (nodes[c.parent].left == index_a)
+				nodes[c.parent].left = index_c;
+			else
+				nodes[c.parent].right = index_c;
+		}
+		else {
+			root = index_c;
+		}
+
+		if (f.height > g.height) {
+			c.right = index_f;
+			a.right = index_g;
+			g.parent = index_a;
+			a.aabb = b.aabb;
+			a.aabb.Enclose(g.aabb);
+			c.aabb = a.aabb;
+			c.aabb.Enclose(f.aabb);
+			a.height = 1 + Max(b.height, g.height);
+			c.height = 1 + Max(a.height, f.height);
+		}
+		else {
+			c.right = index_g;
+			a.right = index_f;
+			f.parent = index_a;
+			a.aabb = b.aabb;
+			a.aabb.Enclose(f.aabb);
+			c.aabb = a.aabb;
+			c.aabb.Enclose(g.aabb);
+			a.height = 1 + Max(b.height, f.height);
+			c.height = 1 + Max(a.height, g.height);
+		}
+		return index_c;
+	}
+
+	// rotate b up
+	if (balance < -1) {
+		int index_d = b.left;
+		int index_e = b.right;
+		DynamicTreeNode& d = nodes[index_d];
+		DynamicTreeNode& e = nodes[index_e];
+
+		b.left = index_a;
+		b.parent = a.parent;
+		a.parent = index_b;
+
+		if (b.parent != -1) {
+			if (nodes[b.parent].left == index_a)
+				nodes[b.parent].left = index_b;
+			else
+				nodes[b.parent].right = index_b;
+		}
+		else {
+			root = index_b;
+		}
+
+		if (d.height > e.height) {
+			b.right = index_d;
+			a.left = index_e;
+			e.parent = index_a;
+			a.aabb = c.aabb;
+			a.aabb.Enclose(e.aabb);
+			b.aabb = a.aabb;
+			b.aabb.Enclose(d.aabb);
+			a.height = 1 + Max(c.height, e.height);
+			b.height = 1 + Max(a.height, d.height);
+		}
+		else {
+			b.right = index_e;
+			a.left = index_d;
+			d.parent = index_a;
+			a.aabb = c.aabb;
+			a.aabb.Enclose(d.aabb);
+			b.aabb = a.aabb;
+			b.aabb.Enclose(e.aabb);
+			a.height = 1 + Max(c.height, d.height);
+			b.height = 1 + Max(a.height, e.height);
+		}
+		return index_b;
+	}
+
+	return index_a;
+}
+
+AABB DynamicTree::FattenAABB(const AABB& aabb) const
+{
+	// a margin relative to the size plus a small constant one for flat or tiny meshes
+	float3 margin = aabb.Size() * 0.1F + float3(0.1F, 0.1F, 0.1F);
+	return AABB(aabb.minPoint - margin, aabb.maxPoint + margin);
+}
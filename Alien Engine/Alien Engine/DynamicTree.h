@@ -0,0 +1,85 @@
+#pragma once
+
+#include "MathGeoLib/include/Geometry/AABB.h"
+#include "MathGeoLib/include/Geometry/LineSegment.h"
+#include "FrustumCulling.h"
+#include <vector>
+
+class Component;
+class ComponentMesh;
+class ComponentCamera;
+
+typedef unsigned int uint;
+
+struct DynamicTreeNode {
+
+	bool IsLeaf() const { return left == -1; }
+
+	// leaves store the mesh AABB enlarged, so small movements don't touch the tree
+	AABB aabb;
+	ComponentMesh* mesh = nullptr;
+
+	int parent = -1;
+	int left = -1;
+	int right = -1;
+	int next_free = -1;
+
+	// 0 leaf, -1 free node
+	int height = -1;
+};
+
+// Bounding volume hierarchy for the non static meshes, the octree only holds static objects.
+// A mesh that goes out of its enlarged AABB is removed and inserted again, and the tree is kept balanced with rotations.
+class DynamicTree {
+
+public:
+
+	DynamicTree();
+	~DynamicTree();
+
+	// insert, move or remove the meshes to match their current state
+	void Update(const std::vector<Component*>& meshes);
+
+	int Insert(ComponentMesh* mesh, const AABB& aabb);
+	void Remove(int proxy);
+	// returns true if the tree has changed
+	bool Move(int proxy, const AABB& aabb);
+	void Clear();
+
+	// the nodes are tested one by one removing the planes they are completely inside, and the meshes of the leaves that
+	// still touch a plane are tested together 4 by 4 with FrustumCulling::AreInside
+	void GetMeshesInFrustum(const FrustumCulling& frustum, std::vector<ComponentMesh*>* meshes) const;
+	void GetMeshesInRay(const LineSegment& ray, std::vector<std::pair<float, ComponentMesh*>>* meshes) const;
+
+	uint GetLeavesCount() const;
+	uint GetNodesCount() const;
+	int GetHeight() const;
+
+private:
+
+	int AllocateNode();
+	void FreeNode(int node);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+
+	AABB FattenAABB(const AABB& aabb) const;
+
+private:
+
+	std::vector<DynamicTreeNode> nodes;
+	int root = -1;
+	int free_list = -1;
+	uint nodes_count = 0;
+	uint leaves_count = 0;
+
+	// used by the queries to avoid the recursion
+	mutable std::vector<int> stack;
+	// node and plane mask
+	mutable std::vector<std::pair<int, uint>> frustum_stack;
+	// the meshes of the leaves that touch a plane and their AABBs as SoA, for AreInside
+	mutable std::vector<ComponentMesh*> frustum_meshes;
+	mutable std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+	mutable std::vector<unsigned char> inside;
+};
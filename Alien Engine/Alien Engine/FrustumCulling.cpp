@@ -0,0 +1,94 @@
+#include "FrustumCulling.h"
+#include "MathGeoLib/include/Geometry/Plane.h"
+#include <xmmintrin.h>
+
+FrustumCulling::FrustumCulling()
+{
+	for (uint i = 0; i < 6; ++i) {
+		normal_x[i] = normal_y[i] = normal_z[i] = d[i] = 0.0F;
+	}
+}
+
+FrustumCulling::FrustumCulling(const Frustum& frustum)
+{
+	Plane planes[6];
+	frustum.GetPlanes(planes);
+
+	for (uint i = 0; i < 6; ++i) {
+		normal_x[i] = planes[i].normal.x;
+		normal_y[i] = planes[i].normal.y;
+		normal_z[i] = planes[i].normal.z;
+		d[i] = planes[i].d;
+	}
+}
+
+bool FrustumCulling::IsInside(const AABB& aabb) const
+{
+	uint plane_mask = FRUSTUM_PLANES_MASK;
+	return IsInside(aabb, plane_mask);
+}
+
+bool FrustumCulling::IsInside(const AABB& aabb, uint& plane_mask) const
+{
+	for (uint i = 0; i < 6; ++i)
+	{
+		if ((plane_mask & (1 << i)) == 0)
+			continue;
+
+		// n-vertex: the corner with the lowest distance to the plane
+		float n_x = (normal_x[i] >= 0.0F) ? aabb.minPoint.x : aabb.maxPoint.x;
+		float n_y = (normal_y[i] >= 0.0F) ? aabb.minPoint.y : aabb.maxPoint.y;
+		float n_z = (normal_z[i] >= 0.0F) ? aabb.minPoint.z : aabb.maxPoint.z;
+
+		// same operations order than Plane::SignedDistance so the result is the same
+		if (normal_x[i] * n_x + normal_y[i] * n_y + normal_z[i] * n_z - d[i] >= 0.0F)
+			return false;
+
+		// p-vertex: the corner with the highest distance, if it is on the negative side the whole box is
+		float p_x = (normal_x[i] >= 0.0F) ? aabb.maxPoint.x : aabb.minPoint.x;
+		float p_y = (normal_y[i] >= 0.0F) ? aabb.maxPoint.y : aabb.minPoint.y;
+		float p_z = (normal_z[i] >= 0.0F) ? aabb.maxPoint.z : aabb.minPoint.z;
+
+		if (normal_x[i] * p_x + normal_y[i] * p_y + normal_z[i] * p_z - d[i] < 0.0F)
+			plane_mask &= ~(1 << i);
+	}
+
+	return true;
+}
+
+void FrustumCulling::AreInside(const float* min_x, const float* min_y, const float* min_z,
+	const float* max_x, const float* max_y, const float* max_z, uint count, unsigned char* inside) const
+{
+	uint i = 0;
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4) {
+		__m128 outside = _mm_setzero_ps();
+
+		for (uint p = 0; p < 6; ++p) {
+			// the n-vertex only depends on the plane normal, so it is the same array for the 4 boxes
+			__m128 n_x = _mm_loadu_ps((normal_x[p] >= 0.0F) ? min_x + i : max_x + i);
+			__m128 n_y = _mm_loadu_ps((normal_y[p] >= 0.0F) ? min_y + i : max_y + i);
+			__m128 n_z = _mm_loadu_ps((normal_z[p] >= 0.0F) ? min_z + i : max_z + i);
+
+			__m128 distance = _mm_mul_ps(_mm_set1_ps(normal_x[p]), n_x);
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(normal_y[p]), n_y));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(normal_z[p]), n_z));
+			distance = _mm_sub_ps(distance, _mm_set1_ps(d[p]));
+
+			outside = _mm_or_ps(outside, _mm_cmpge_ps(distance, zero));
+		}
+
+		int outside_mask = _mm_movemask_ps(outside);
+		inside[i] = (outside_mask & 1) ? 0 : 1;
+		inside[i + 1] = (outside_mask & 2) ? 0 : 1;
+		inside[i + 2] = (outside_mask & 4) ? 0 : 1;
+		inside[i + 3] = (outside_mask & 8) ? 0 : 1;
+	}
+
+	// remaining boxes
+	for (; i < count; ++i) {
+		AABB aabb(float3(min_x[i], min_y[i], min_z[i]), float3(max_x[i], max_y[i], max_z[i]));
+		inside[i] = IsInside(aabb) ? 1 : 0;
+	}
+}
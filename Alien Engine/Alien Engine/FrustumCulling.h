@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MathGeoLib/include/Geometry/AABB.h"
+#include "MathGeoLib/include/Geometry/Frustum.h"
+
+typedef unsigned int uint;
+
+// all the frustum planes, a box that touches none of them has this mask
+#define FRUSTUM_PLANES_MASK 0x3F
+
+// Frustum planes computed once and stored SoA, so testing lots of AABBs doesn't compute corners and planes every time.
+// An AABB is outside if all its corners are on the positive side of any plane, only the nearest corner to each
+// plane (n-vertex) is tested, which gives the same result as testing the 8 corners.
+class FrustumCulling {
+
+public:
+
+	// nothing is inside until it is built from a frustum
+	FrustumCulling();
+	FrustumCulling(const Frustum& frustum);
+
+	bool IsInside(const AABB& aabb) const;
+	// plane_mask has a bit for each plane that still must be tested, the planes the box is completely inside are removed.
+	// Boxes contained in this one (octree children, BVH children...) only need to test the planes left in the mask
+	bool IsInside(const AABB& aabb, uint& plane_mask) const;
+
+	// test count AABBs given as SoA min and max arrays 4 by 4 with SSE, inside[i] is 1 if the AABB is inside and 0 if not
+	void AreInside(const float* min_x, const float* min_y, const float* min_z,
+		const float* max_x, const float* max_y, const float* max_z, uint count, unsigned char* inside) const;
+
+private:
+
+	float normal_x[6];
+	float normal_y[6];
+	float normal_z[6];
+	float d[6];
+};
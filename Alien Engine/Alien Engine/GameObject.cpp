@@ -13,6 +13,8 @@
 #include "Prefab.h"
 #include "ResourcePrefab.h"
 #include "ReturnZ.h"
+#include "SceneBinary.h"
+#include "FrustumCulling.h"
 
 GameObject::GameObject(GameObject* parent)
 {
@@ -33,15 +35,27 @@ GameObject::~GameObject()
 	if (std::find(App->objects->GetSelectedObjects().begin(), App->objects->GetSelectedObjects().end(), this) != App->objects->GetSelectedObjects().end()) {
 		App->objects->DeselectObject(this);
 	}
-	App->objects->octree.Remove(this);
+	// the children remove themselves when they are deleted
+	if (octree_index != -1 || App->objects->octree.IsBulkInserting()) {
+		App->objects->octree.Remove(this, false);
+	}
+	if (pooled) {
+		App->objects->object_pool.Forget(this);
+	}
 
 	std::vector<Component*>::iterator item = components.begin();
 	for (; item != components.end(); ++item) {
 		if (*item != nullptr) {
+			// the next components destructors may look for this one
+			if ((*item)->GetType() != ComponentType::UNKNOWN && component_slots[(uint)(*item)->GetType()] == *item) {
+				component_slots[(uint)(*item)->GetType()] = nullptr;
+			}
 			delete* item;
 			*item = nullptr;
 		}
 	}
+	// the children destructors see no components in their parent
+	memset(component_slots, 0, sizeof(component_slots));
 
 	std::vector<GameObject*>::iterator child = children.begin();
 	for (; child != children.end(); ++child) {
@@ -418,7 +432,7 @@ GameObject* GameObject::GetChild(const char* child_name)
 {
 	auto item = children.begin();
 	for (; item != children.end(); ++item) {
-		if (*item != nullptr && App->StringCmp((*item)->name, child_name)) {
+		if (*item != nullptr && App->StringCmp((*item)->name.data(), child_name)) {
 			return (*item);
 		}
 	}
@@ -438,7 +452,7 @@ GameObject* GameObject::GetChildRecursive(const char* child_name)
 	auto item = children.begin();
 	for (; item != children.end(); ++item) {
 		if (*item != nullptr) {
-			if (App->StringCmp((*item)->name, child_name)) {
+			if (App->StringCmp((*item)->name.data(), child_name)) {
 				return (*item);
 			}
 			(*item)->GetChildRecursive(child_name);
@@ -481,6 +495,17 @@ void GameObject::DrawScene()
 			glColor3f(1, 1, 1);
 		if (!mesh->wireframe)
 			mesh->DrawPolygon();
+	}
+
+	DrawSceneDebug();
+}
+
+void GameObject::DrawSceneDebug()
+{
+	ComponentMesh* mesh = (ComponentMesh*)GetComponent(ComponentType::MESH);
+
+	if (mesh != nullptr && mesh->IsEnabled())
+	{
 		if ((selected || parent_selected) && App->objects->outline)
 			mesh->DrawOutLine();
 		if (mesh->view_mesh || mesh->wireframe)
@@ -516,13 +541,13 @@ void GameObject::DrawGame()
 	}
 }
 
-void GameObject::SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera)
+void GameObject::SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum)
 {
 	if (!is_static) {
 		ComponentMesh* mesh = (ComponentMesh*)GetComponent(ComponentType::MESH);
 
 		if (mesh != nullptr && mesh->mesh != nullptr) {
-			if (App->renderer3D->IsInsideFrustum(camera, mesh->GetGlobalAABB())) {
+			if (frustum.IsInside(mesh->GetGlobalAABB())) {
 				float3 obj_pos = static_cast<ComponentTransform*>(GetComponent(ComponentType::TRANSFORM))->GetGlobalPosition();
 				float distance = camera->frustum.pos.Distance(obj_pos);
 				to_draw->push_back({ distance, this });
@@ -562,7 +587,7 @@ void GameObject::SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw
 	std::vector<GameObject*>::iterator child = children.begin();
 	for (; child != children.end(); ++child) {
 		if (*child != nullptr && (*child)->IsEnabled()) {
-			(*child)->SetDrawList(to_draw, camera);
+			(*child)->SetDrawList(to_draw, camera, frustum);
 		}
 	}
 }
@@ -575,22 +600,16 @@ void GameObject::AddComponent(Component* component)
 		}
 	}
 	components.push_back(component);
+	App->objects->component_registry.Add(component);
+
+	if (component != nullptr && component->GetType() != ComponentType::UNKNOWN && component_slots[(uint)component->GetType()] == nullptr) {
+		component_slots[(uint)component->GetType()] = component;
+	}
 }
 
 bool GameObject::HasComponent(ComponentType component) const
 {
-	bool exists = false;
-
-	std::vector<Component*>::const_iterator item = components.cbegin();
-	for (; item != components.cend(); ++item) {
-		if (*item != nullptr && (*item)->GetType() == component)
-		{
-			exists = true;
-			break;
-		}
-	}
-
-	return exists;
+	return GetComponent(component) != nullptr;
 }
 
 void GameObject::GetComponentsChildren(const ComponentType& type, std::vector<Component*>* to_fill, bool recursive)
@@ -674,35 +693,45 @@ void GameObject::GetComponentsScriptChildren(const char* script_calss_name, std:
 void GameObject::AddChild(GameObject* child)
 {
 	children.push_back(child);
+	App->objects->transform_hierarchy.Invalidate();
 }
 
 void GameObject::SetName(const char* name)
 {
-	strcpy(this->name, name);
+	this->name = name;
 }
 
 const char* GameObject::GetName() const
 {
-	return name;
+	return name.data();
 }
 
 const char* GameObject::ToString()
 {
-	return name;
+	return name.data();
 }
 
 void GameObject::SetTag(const char* tag)
 {
-	strcpy(this->tag, tag);
+	int index = App->objects->GetTagIndex(tag);
+	if (index != -1) {
+		this->tag = (uint)index;
+	}
+	else {
+		LOG_ENGINE("The tag %s doesn't exist", tag);
+	}
 }
 
 const char* GameObject::GetTag() const
 {
-	return tag;
+	return (tag < App->objects->tags.size()) ? App->objects->tags[tag].data() : App->objects->tags.front().data();
 }
 
 Component* GameObject::GetComponent(const ComponentType& type)
 {
+	if (type != ComponentType::UNKNOWN)
+		return component_slots[(uint)type];
+
 	std::vector<Component*>::iterator item = components.begin();
 	for (; item != components.end(); ++item) {
 		if (*item != nullptr && (*item)->GetType() == type) {
@@ -714,6 +743,9 @@ Component* GameObject::GetComponent(const ComponentType& type)
 
 const Component* GameObject::GetComponent(const ComponentType& type) const
 {
+	if (type != ComponentType::UNKNOWN)
+		return component_slots[(uint)type];
+
 	std::vector<Component*>::const_iterator item = components.cbegin();
 	for (; item != components.cend(); ++item) {
 		if (*item != nullptr && (*item)->GetType() == type) {
@@ -753,11 +785,24 @@ void GameObject::RemoveComponent(Component* component)
 			delete* item;
 			(*item) = nullptr;
 			components.erase(item);
+			RebuildComponentSlots();
 			break;
 		}
 	}
 }
 
+void GameObject::RebuildComponentSlots()
+{
+	memset(component_slots, 0, sizeof(component_slots));
+
+	std::vector<Component*>::reverse_iterator item = components.rbegin();
+	for (; item != components.rend(); ++item) {
+		if (*item != nullptr && (*item)->GetType() != ComponentType::UNKNOWN) {
+			component_slots[(uint)(*item)->GetType()] = *item;
+		}
+	}
+}
+
 bool GameObject::IsSelected() const
 {
 	return selected;
@@ -881,10 +926,10 @@ void GameObject::SetNewParent(GameObject* new_parent)
 		ComponentTransform* transform = (ComponentTransform*)GetComponent(ComponentType::TRANSFORM);
 
 		if (parent_transform != nullptr) {
-			transform->Reparent(parent_transform->global_transformation.Inverted() * transform->global_transformation);
+			transform->Reparent(parent_transform->GetGlobalMatrix().Inverted() * transform->GetGlobalMatrix());
 		}
 		else {
-			transform->Reparent(transform->global_transformation);
+			transform->Reparent(transform->GetGlobalMatrix());
 		}
 	}
 	else {
@@ -962,13 +1007,17 @@ GameObject* GameObject::FindWithName(const char* name)
 
 GameObject* GameObject::FindWithTag(const char* tag_to_find)
 {
-	return App->objects->GetRoot(true)->FindTag(tag_to_find);
+	int index = App->objects->GetTagIndex(tag_to_find);
+	return (index != -1) ? App->objects->GetRoot(true)->FindTag((uint)index) : nullptr;
 }
 
 uint GameObject::FindGameObjectsWithTag(const char* tag_to_find, GameObject*** objects)
 {
 	std::vector<GameObject*> found;
-	App->objects->GetRoot(true)->FindTags(tag_to_find, &found);
+	int index = App->objects->GetTagIndex(tag_to_find);
+	if (index != -1) {
+		App->objects->GetRoot(true)->FindTags((uint)index, &found);
+	}
 
 	if (found.size() > 0) {
 		(*objects) = new GameObject*[found.size()];
@@ -1057,7 +1106,7 @@ void GameObject::ScaleNegative(const bool& is_negative)
 GameObject* GameObject::Find(const char* name)
 {
 	GameObject* ret = nullptr;
-	if (App->StringCmp(name, this->name)) {
+	if (App->StringCmp(name, this->name.data())) {
 		return this;
 	}
 	std::vector<GameObject*>::iterator item = children.begin();
@@ -1082,14 +1131,17 @@ void GameObject::SayChildrenParentIsSelected(const bool& selected)
 	}
 }
 
-void GameObject::ReTag(const char* from, const char* to)
+void GameObject::RemoveTag(uint removed)
 {
-	if (App->StringCmp(tag, from)) {
-		strcpy(tag, to);
+	if (tag == removed) {
+		tag = 0;
+	}
+	else if (tag > removed) {
+		--tag;
 	}
 	for (uint i = 0; i < children.size(); ++i) {
 		if (children[i] != nullptr) {
-			children[i]->ReTag(from, to);
+			children[i]->RemoveTag(removed);
 		}
 	}
 }
@@ -1111,13 +1163,13 @@ GameObject* GameObject::GetGameObjectByID(const u64 & id)
 	return ret;
 }
 
-GameObject* GameObject::FindTag(const char* tag_to_find)
+GameObject* GameObject::FindTag(uint tag_to_find)
 {
 	GameObject* ret = nullptr;
 	std::vector<GameObject*>::iterator item = children.begin();
 	for (; item != children.end(); ++item) {
 		if (*item != nullptr) {
-			if (App->StringCmp((*item)->tag, tag_to_find)) {
+			if ((*item)->tag == tag_to_find) {
 				return (*item);
 			}
 			ret = (*item)->FindTag(tag_to_find);
@@ -1128,12 +1180,12 @@ GameObject* GameObject::FindTag(const char* tag_to_find)
 	return ret;
 }
 
-void GameObject::FindTags(const char* tag_to_find, std::vector<GameObject*>* objects)
+void GameObject::FindTags(uint tag_to_find, std::vector<GameObject*>* objects)
 {
 	std::vector<GameObject*>::iterator item = children.begin();
 	for (; item != children.end(); ++item) {
 		if (*item != nullptr) {
-			if (App->StringCmp((*item)->tag, tag_to_find)) {
+			if ((*item)->tag == tag_to_find) {
 				objects->push_back((*item));
 			}
 			(*item)->FindTags(tag_to_find, objects);
@@ -1200,7 +1252,7 @@ AABB GameObject::GetBB() const
 			if (camera != nullptr) {
 				ComponentTransform* transform = (ComponentTransform*)GetComponent(ComponentType::TRANSFORM);
 				float4x4 matrix = float4x4::FromTRS(transform->GetGlobalPosition() - camera->frustum.front.Normalized() * 2, transform->GetGlobalRotation() * (Quat{ 0,0,1,0 } *Quat{ 0.7071,0,0.7071,0 }), { 0.1F,0.1F,0.1F });
-				float4x4 to_save = transform->global_transformation;
+				float4x4 to_save = transform->GetGlobalMatrix();
 				transform->global_transformation = matrix;
 				camera->mesh_camera->RecalculateAABB_OBB();
 				transform->global_transformation = to_save;
@@ -1210,7 +1262,7 @@ AABB GameObject::GetBB() const
 				ComponentTransform* transform = (ComponentTransform*)GetComponent(ComponentType::TRANSFORM);
 				float3 pos = transform->GetGlobalPosition();
 				float4x4 matrix = float4x4::FromTRS({ pos.x - 0.133f, pos.y, pos.z }, transform->GetGlobalRotation(), { 0.2f, 0.18f, 0.2f });
-				float4x4 to_save = transform->global_transformation;
+				float4x4 to_save = transform->GetGlobalMatrix();
 				light->bulb->RecalculateAABB_OBB();
 				transform->global_transformation = to_save;
 				return light->bulb->GetGlobalAABB();
@@ -1233,7 +1285,7 @@ OBB GameObject::GetGlobalOBB() const
 	if (HasChildren())
 	{
 		OBB parent_obb = GetBB();
-		parent_obb.Transform(transform->global_transformation);
+		parent_obb.Transform(transform->GetGlobalMatrix());
 		return parent_obb;
 	}
 
@@ -1267,7 +1319,7 @@ void GameObject::SaveObject(JSONArraypack* to_save, const uint& family_number)
 	to_save->SetBoolean("IsStatic", is_static);
 	to_save->SetBoolean("IsPrefab", IsPrefab());
 	to_save->SetBoolean("PrefabLocked", prefab_locked);
-	to_save->SetString("Tag", tag);
+	to_save->SetString("Tag", GetTag());
 	if (IsPrefab()) {
 		to_save->SetString("PrefabID", std::to_string(prefabID));
 	}
@@ -1286,7 +1338,7 @@ void GameObject::SaveObject(JSONArraypack* to_save, const uint& family_number)
 
 void GameObject::LoadObject(JSONArraypack* to_load, GameObject* parent, bool force_no_selected)
 {
-	strcpy(name, to_load->GetString("Name"));
+	name = to_load->GetString("Name");
 	ID = std::stoull(to_load->GetString("ID"));
 	enabled = to_load->GetBoolean("Enabled");
 	parent_enabled = to_load->GetBoolean("ParentEnabled");
@@ -1296,9 +1348,9 @@ void GameObject::LoadObject(JSONArraypack* to_load, GameObject* parent, bool for
 	prefab_locked = to_load->GetBoolean("PrefabLocked");
 	parent_selected = to_load->GetBoolean("ParentSelected");
 	is_static = to_load->GetBoolean("IsStatic");
-	std::string tag_ = to_load->GetString("Tag");
-	if (std::find(App->objects->tags.begin(), App->objects->tags.end(), tag_) != App->objects->tags.end()) {
-		strcpy(tag, tag_.data());
+	int tag_index = App->objects->GetTagIndex(to_load->GetString("Tag"));
+	if (tag_index != -1) {
+		tag = (uint)tag_index;
 	}
 	if (to_load->GetBoolean("IsPrefab")) {
 		u64 id = std::stoull(to_load->GetString("PrefabID"));
@@ -1315,43 +1367,15 @@ void GameObject::LoadObject(JSONArraypack* to_load, GameObject* parent, bool for
 
 	if (components_to_load != nullptr) {
 		for (uint i = 0; i < components_to_load->GetArraySize(); ++i) {
-			SDL_assert((uint)ComponentType::UNKNOWN == 4); // add new type to switch
-			switch ((int)components_to_load->GetNumber("Type")) {
-			case (int)ComponentType::TRANSFORM: {
-				ComponentTransform* transform = new ComponentTransform(this);
-				transform->LoadComponent(components_to_load);
-				AddComponent(transform);
-				break; }
-			case (int)ComponentType::LIGHT: {
-				ComponentLight* light = new ComponentLight(this);
-				light->LoadComponent(components_to_load);
-				AddComponent(light);
-				break; }
-			case (int)ComponentType::MATERIAL: {
-				ComponentMaterial* material = new ComponentMaterial(this);
-				material->LoadComponent(components_to_load);
-				AddComponent(material);
-				break; }
-			case (int)ComponentType::MESH: {
-				ComponentMesh* mesh = new ComponentMesh(this);
-				mesh->LoadComponent(components_to_load);
-				AddComponent(mesh);
-				break; }
-			case (int)ComponentType::CAMERA: {
-				ComponentCamera* camera = new ComponentCamera(this);
-				camera->LoadComponent(components_to_load);
-				AddComponent(camera);
-				break; }
-			case (int)ComponentType::SCRIPT: {
-				ComponentScript* script = new ComponentScript(this);
-				script->LoadComponent(components_to_load);
-				// dont need to addcomponent, load script does it
-				break; }
-			default:
-				LOG_ENGINE("Unknown component type while loading");
-				break;
+			ComponentType type = (ComponentType)(int)components_to_load->GetNumber("Type");
+			Component* component = CreateComponentToLoad(type);
+			if (component != nullptr) {
+				component->LoadComponent(components_to_load);
+				// dont need to addcomponent for scripts, load script does it
+				if (type != ComponentType::SCRIPT) {
+					AddComponent(component);
+				}
 			}
-
 			components_to_load->GetAnotherNode();
 		}
 	}
@@ -1362,6 +1386,110 @@ void GameObject::LoadObject(JSONArraypack* to_load, GameObject* parent, bool for
 
 }
 
+void GameObject::SaveObject(SceneWriter* to_save)
+{
+	uint flags = (uint)SceneObjectFlags::NONE;
+	if (enabled) flags |= (uint)SceneObjectFlags::ENABLED;
+	if (parent_enabled) flags |= (uint)SceneObjectFlags::PARENT_ENABLED;
+	if (selected) flags |= (uint)SceneObjectFlags::SELECTED;
+	if (parent_selected) flags |= (uint)SceneObjectFlags::PARENT_SELECTED;
+	if (is_static) flags |= (uint)SceneObjectFlags::IS_STATIC;
+	if (IsPrefab()) flags |= (uint)SceneObjectFlags::IS_PREFAB;
+	if (prefab_locked) flags |= (uint)SceneObjectFlags::PREFAB_LOCKED;
+
+	to_save->Write(ID);
+	to_save->WriteString(name.data());
+	to_save->WriteString(GetTag());
+	to_save->Write(flags);
+	to_save->Write(prefabID);
+
+	uint components_count = 0;
+	std::vector<Component*>::iterator item = components.begin();
+	for (; item != components.end(); ++item) {
+		if (*item != nullptr) {
+			++components_count;
+		}
+	}
+	to_save->Write(components_count);
+
+	for (item = components.begin(); item != components.end(); ++item) {
+		if (*item != nullptr) {
+			to_save->Write((int)(*item)->GetType());
+			uint block = to_save->BeginBlock();
+			(*item)->SaveComponent(to_save);
+			to_save->EndBlock(block);
+		}
+	}
+}
+
+void GameObject::LoadObject(SceneReader* to_load, GameObject* parent, bool force_no_selected)
+{
+	ID = to_load->Read<u64>();
+	name = to_load->ReadString();
+	int tag_index = App->objects->GetTagIndex(to_load->ReadString().data());
+	if (tag_index != -1) {
+		tag = (uint)tag_index;
+	}
+	uint flags = to_load->Read<uint>();
+	u64 id = to_load->Read<u64>();
+
+	enabled = (flags & (uint)SceneObjectFlags::ENABLED) != 0;
+	parent_enabled = (flags & (uint)SceneObjectFlags::PARENT_ENABLED) != 0;
+	if (!force_no_selected && (flags & (uint)SceneObjectFlags::SELECTED) != 0) {
+		App->objects->SetNewSelectedObject(this);
+	}
+	prefab_locked = (flags & (uint)SceneObjectFlags::PREFAB_LOCKED) != 0;
+	parent_selected = (flags & (uint)SceneObjectFlags::PARENT_SELECTED) != 0;
+	is_static = (flags & (uint)SceneObjectFlags::IS_STATIC) != 0;
+	if ((flags & (uint)SceneObjectFlags::IS_PREFAB) != 0 && App->resources->GetResourceWithID(id) != nullptr) {
+		prefabID = id;
+	}
+	if (parent != nullptr) {
+		this->parent = parent;
+		parent->AddChild(this);
+	}
+
+	uint components_count = to_load->Read<uint>();
+	for (uint i = 0; i < components_count && !to_load->Failed(); ++i) {
+		ComponentType type = (ComponentType)to_load->Read<int>();
+		const char* block_end = to_load->BeginBlock();
+		Component* component = CreateComponentToLoad(type);
+		if (component != nullptr) {
+			component->LoadComponent(to_load);
+			if (type != ComponentType::SCRIPT) {
+				AddComponent(component);
+			}
+		}
+		to_load->EndBlock(block_end);
+	}
+
+	if (is_static) {
+		App->objects->octree.Insert(this, false);
+	}
+}
+
+Component* GameObject::CreateComponentToLoad(const ComponentType& type)
+{
+	SDL_assert((uint)ComponentType::UNKNOWN == 6); // add new type to switch
+	switch (type) {
+	case ComponentType::TRANSFORM:
+		return new ComponentTransform(this);
+	case ComponentType::LIGHT:
+		return new ComponentLight(this);
+	case ComponentType::MATERIAL:
+		return new ComponentMaterial(this);
+	case ComponentType::MESH:
+		return new ComponentMesh(this);
+	case ComponentType::CAMERA:
+		return new ComponentCamera(this);
+	case ComponentType::SCRIPT:
+		return new ComponentScript(this);
+	default:
+		LOG_ENGINE("Unknown component type while loading");
+		return nullptr;
+	}
+}
+
 GameObject* GameObject::Clone(GameObject* parent)
 {
 	GameObject* clone = new GameObject((parent == nullptr) ? this->parent : parent);
@@ -1377,17 +1505,17 @@ void GameObject::CloningGameObject(GameObject* clone)
 
 	std::string name_ = name;
 	if (name_.back() != ')') {
-		strcpy(clone->name, std::string(name + std::string(" (1)")).data());
+		clone->name = name + std::string(" (1)");
 	}
 	else {
 		int num = std::stoi(&(name_.at(name_.size() - 2)));
 		int offset = std::to_string(num).size() + 2;
 		std::string nam(name_.begin(), name_.size() - offset + name_.begin());
 		nam += std::string("(" + std::to_string(num + 1) + std::string(")"));
-		strcpy(clone->name, nam.data());
+		clone->name = nam;
 	}
 	
-	strcpy(clone->tag, tag);
+	clone->tag = tag;
 	clone->enabled = enabled;
 	clone->parent_enabled = parent_enabled;
 	clone->prefab_locked = prefab_locked;
@@ -1662,7 +1790,7 @@ void GameObject::SearchToDelete()
 					delete* item_com;
 					*item_com = nullptr;
 					item_com = (*item)->components.erase(item_com);
-					
+					(*item)->RebuildComponentSlots();
 				}
 				else
 				{
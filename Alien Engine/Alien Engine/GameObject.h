@@ -12,6 +12,7 @@ enum class ResourceType;
 class Resource;
 class Prefab;
 class ComponentCamera;
+class FrustumCulling;
 
 class __declspec(dllexport) GameObject
 {
@@ -29,7 +30,6 @@ class __declspec(dllexport) GameObject
 	friend class ModuleCamera3D;
 	friend class Prefab;
 	friend class Octree;
-	friend class OctreeNode;
 	friend class FileNode;
 	friend class ModuleImporter;
 	friend class PanelHierarchy;
@@ -43,11 +43,20 @@ class __declspec(dllexport) GameObject
 	friend class ResourceTexture;
 	friend class ModuleObjects;
 	friend class ModuleUI;
+	friend class TransformHierarchy;
+	friend class DynamicTree;
+	friend class RenderBatcher;
+	friend class GameObjectPool;
+	friend class TestScene;
 public:
 	GameObject(GameObject* parent);
 	GameObject(); // just for loading objects, dont use it
 	virtual ~GameObject();
 
+	// from the pools of the ObjectAllocator
+	static void* operator new(size_t size);
+	static void operator delete(void* block, size_t size);
+
 public:
 
 	static void Destroy(GameObject* object);
@@ -133,13 +142,17 @@ private:
 
 	// here we call Component Mesh, Material & light
 	void DrawScene();
+	// outline, wireframe, normals and bounding boxes of the mesh
+	void DrawSceneDebug();
 	void DrawGame();
-	void SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera);
+	void SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum);
 
 	Component* GetComponentWithID(const u64& ID);
 	const Component* GetComponentWithID(const u64& ID) const;
 	void RemoveComponent(Component* component);
 	void AddComponent(Component* component);
+	// fill component_slots again, call it after changing the order of the components or removing any of them
+	void RebuildComponentSlots();
 
 	template <class Comp>
 	Comp* GetComponent();
@@ -190,6 +203,9 @@ private:
 	OBB GetGlobalOBB() const;
 	void SaveObject(JSONArraypack* to_save, const uint& family_number);
 	void LoadObject(JSONArraypack* to_save, GameObject* parent, bool force_no_selected = false);
+	// one record of a binary scene, the index of the parent is written before by ModuleObjects
+	void SaveObject(SceneWriter* to_save);
+	void LoadObject(SceneReader* to_load, GameObject* parent, bool force_no_selected = false);
 
 	GameObject* Clone(GameObject* parent = nullptr);
 	void CloningGameObject(GameObject* clone);
@@ -216,13 +232,17 @@ private:
 	// find
 	GameObject* Find(const char* name);
 	GameObject* GetGameObjectByID(const u64& id);
-	GameObject* FindTag(const char* tag_to_find);
-	void FindTags(const char* tag_to_find, std::vector<GameObject*>* objects);
+	GameObject* FindTag(uint tag_to_find);
+	void FindTags(uint tag_to_find, std::vector<GameObject*>* objects);
 
 	// parent selected
 	void SayChildrenParentIsSelected(const bool& selected);
 
-	void ReTag(const char* from, const char* to);
+	// the tag was removed from ModuleObjects::tags, the objects with it are untagged and the next tags move back
+	void RemoveTag(uint removed);
+
+	// a new component of the type for LoadObject, nullptr if the type is unknown
+	Component* CreateComponentToLoad(const ComponentType& type);
 
 public:
 
@@ -236,23 +256,34 @@ private:
 	bool selected = false;
 
 	std::vector<Component*> components;
+	// first component of each type in components, O(1) lookup for GetComponent
+	Component* component_slots[(uint)ComponentType::UNKNOWN] = { nullptr };
 	std::vector<GameObject*> children;
 
-	char name[MAX_PATH] = "UnNamed";
-	char tag[MAX_PATH] = "UnTagged";
+	// short names are kept inside the string without allocating
+	std::string name = "UnNamed";
+	// index in ModuleObjects::tags, 0 is UnTagged
+	uint tag = 0;
 
 	bool enabled = true;
 	bool is_static = false;
+	// position in the objects of the scene Octree, -1 if it is not in it
+	int octree_index = -1;
 	u64 ID = 0;
 	bool parent_enabled = true;
 	bool parent_selected = false;
 	bool open_node = false;
 	bool prefab_locked = false;
+	// instance of a GameObjectPool, it leaves the pool when it is deleted
+	bool pooled = false;
 };
 
 template<class Comp>
 inline Comp* GameObject::GetComponent()
 {
+	if (ComponentTypeOf<Comp>::value != ComponentType::UNKNOWN) {
+		return static_cast<Comp*>(component_slots[(uint)ComponentTypeOf<Comp>::value]);
+	}
 	for (uint i = 0; i < components.size(); ++i) {
 		Comp* component = dynamic_cast<Comp*>(components[i]);
 		if (component != nullptr) {
@@ -267,6 +298,12 @@ inline std::vector<Comp*> GameObject::GetComponents()
 {
 	std::vector<Comp*> comps;
 	for (uint i = 0; i < components.size(); ++i) {
+		if (ComponentTypeOf<Comp>::value != ComponentType::UNKNOWN) {
+			if (components[i] != nullptr && components[i]->type == ComponentTypeOf<Comp>::value) {
+				comps.push_back(static_cast<Comp*>(components[i]));
+			}
+			continue;
+		}
 		Comp* component = dynamic_cast<Comp*>(components[i]);
 		if (component != nullptr) {
 			comps.push_back(component);
@@ -278,6 +315,9 @@ inline std::vector<Comp*> GameObject::GetComponents()
 template<class Comp>
 inline const Comp* GameObject::GetComponent() const
 {
+	if (ComponentTypeOf<Comp>::value != ComponentType::UNKNOWN) {
+		return static_cast<const Comp*>(component_slots[(uint)ComponentTypeOf<Comp>::value]);
+	}
 	for (uint i = 0; i < components.size(); ++i) {
 		Comp* component = dynamic_cast<Comp*>(components[i]);
 		if (component != nullptr) {
@@ -292,6 +332,12 @@ inline const std::vector<Comp*> GameObject::GetComponents() const
 {
 	std::vector<Comp*> comps;
 	for (uint i = 0; i < components.size(); ++i) {
+		if (ComponentTypeOf<Comp>::value != ComponentType::UNKNOWN) {
+			if (components[i] != nullptr && components[i]->type == ComponentTypeOf<Comp>::value) {
+				comps.push_back(static_cast<Comp*>(components[i]));
+			}
+			continue;
+		}
 		Comp* component = dynamic_cast<Comp*>(components[i]);
 		if (component != nullptr) {
 			comps.push_back(component);
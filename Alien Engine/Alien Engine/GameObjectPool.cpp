@@ -0,0 +1,193 @@
+#include "GameObjectPool.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ResourcePrefab.h"
+#include "Prefab.h"
+#include "Time.h"
+#include <algorithm>
+
+GameObjectPool::GameObjectPool()
+{
+}
+
+GameObjectPool::~GameObjectPool()
+{
+}
+
+void GameObjectPool::Prewarm(ResourcePrefab* prefab, uint count, GameObject* parent)
+{
+	if (prefab == nullptr)
+		return;
+
+	if (parent == nullptr) {
+		parent = App->objects->GetRoot(true);
+	}
+
+	PrefabPool& pool = pools[prefab->GetID()];
+	pool.free.reserve(pool.free.size() + count);
+	for (uint i = 0; i < count; ++i) {
+		GameObject* instance = Create(prefab, parent);
+		if (instance == nullptr)
+			break;
+		// the scripts didn't start, they don't get OnDisable
+		SetActive(instance, false);
+		pool.free.push_back(instance);
+	}
+}
+
+GameObject* GameObjectPool::Spawn(ResourcePrefab* prefab, const float3& local_position, GameObject* parent)
+{
+	if (prefab == nullptr)
+		return nullptr;
+
+	if (parent == nullptr) {
+		parent = App->objects->GetRoot(true);
+	}
+
+	PrefabPool& pool = pools[prefab->GetID()];
+	GameObject* instance = nullptr;
+	if (!pool.free.empty()) {
+		instance = pool.free.back();
+		pool.free.pop_back();
+		++reused;
+		if (instance->parent != parent) {
+			std::vector<GameObject*>& children = instance->parent->children;
+			children.erase(std::find(children.begin(), children.end(), instance));
+			instance->parent = parent;
+			parent->AddChild(instance);
+		}
+	}
+	else {
+		instance = Create(prefab, parent);
+		if (instance == nullptr)
+			return nullptr;
+	}
+
+	ComponentTransform* transform = (ComponentTransform*)instance->GetComponent(ComponentType::TRANSFORM);
+	transform->SetLocalPosition(local_position.x, local_position.y, local_position.z);
+	transform->SetLocalRotation(pool.rotation);
+	transform->SetLocalScale(pool.scale.x, pool.scale.y, pool.scale.z);
+
+	PooledObject& pooled = objects[instance];
+	pooled.spawned = true;
+	++spawned_count;
+	SetActive(instance, true);
+
+	if (Time::IsInGameState()) {
+		if (!pooled.started) {
+			pooled.started = true;
+			Prefab::InitScripts(instance);
+		}
+		else {
+			instance->OnEnable();
+		}
+	}
+
+	return instance;
+}
+
+bool GameObjectPool::Despawn(GameObject* instance)
+{
+	if (instance == nullptr || !instance->pooled)
+		return false;
+
+	std::unordered_map<const GameObject*, PooledObject>::iterator found = objects.find(instance);
+	if (found == objects.end())
+		return false;
+
+	// despawned twice, it is already free
+	if (!(*found).second.spawned)
+		return true;
+
+	(*found).second.spawned = false;
+	--spawned_count;
+	if (Time::IsInGameState() && (*found).second.started) {
+		instance->OnDisable();
+	}
+	SetActive(instance, false);
+	pools[(*found).second.prefabID].free.push_back(instance);
+
+	return true;
+}
+
+void GameObjectPool::Forget(GameObject* instance)
+{
+	std::unordered_map<const GameObject*, PooledObject>::iterator found = objects.find(instance);
+	if (found == objects.end())
+		return;
+
+	if ((*found).second.spawned) {
+		--spawned_count;
+	}
+	else {
+		std::vector<GameObject*>& free = pools[(*found).second.prefabID].free;
+		std::vector<GameObject*>::iterator item = std::find(free.begin(), free.end(), instance);
+		if (item != free.end()) {
+			free.erase(item);
+		}
+	}
+	instance->pooled = false;
+	objects.erase(found);
+}
+
+void GameObjectPool::Clear()
+{
+	std::unordered_map<const GameObject*, PooledObject>::iterator item = objects.begin();
+	for (; item != objects.end(); ++item) {
+		const_cast<GameObject*>((*item).first)->pooled = false;
+	}
+	objects.clear();
+	pools.clear();
+	spawned_count = 0;
+}
+
+uint GameObjectPool::GetFreeCount() const
+{
+	return objects.size() - spawned_count;
+}
+
+uint GameObjectPool::GetSpawnedCount() const
+{
+	return spawned_count;
+}
+
+GameObject* GameObjectPool::Create(ResourcePrefab* prefab, GameObject* parent)
+{
+	uint children = parent->children.size();
+	prefab->ConvertToGameObjects(parent, -1, { 0,0,0 }, false);
+	if (parent->children.size() == children)
+		return nullptr;
+
+	GameObject* instance = parent->children.back();
+	instance->pooled = true;
+	PooledObject& pooled = objects[instance];
+	pooled.prefabID = prefab->GetID();
+	++created;
+
+	// the spawns reset the root to the transform of the prefab
+	ComponentTransform* transform = (ComponentTransform*)instance->GetComponent(ComponentType::TRANSFORM);
+	PrefabPool& pool = pools[pooled.prefabID];
+	pool.rotation = transform->GetLocalRotation();
+	pool.scale = transform->GetLocalScale();
+
+	return instance;
+}
+
+void GameObjectPool::SetActive(GameObject* object, bool active)
+{
+	object->enabled = active;
+	SetParentEnabled(object, active);
+}
+
+void GameObjectPool::SetParentEnabled(GameObject* object, bool enabled)
+{
+	std::vector<GameObject*>::iterator item = object->children.begin();
+	for (; item != object->children.end(); ++item) {
+		if (*item != nullptr) {
+			(*item)->parent_enabled = enabled;
+			SetParentEnabled(*item, enabled);
+		}
+	}
+}
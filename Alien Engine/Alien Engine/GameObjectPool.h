@@ -0,0 +1,69 @@
+#pragma once
+
+#include "MathGeoLib/include/Math/float3.h"
+#include "MathGeoLib/include/Math/Quat.h"
+#include <vector>
+#include <unordered_map>
+
+class GameObject;
+class ResourcePrefab;
+
+typedef unsigned int uint;
+typedef unsigned long long u64;
+
+// Instances of the prefabs kept disabled in the scene to be spawned again instead of loading and deleting them.
+// The first Spawn of an instance calls Awake and Start of its scripts, the next ones OnEnable, and Despawn
+// calls OnDisable. Only the transform of the root is reset when it is spawned.
+class GameObjectPool {
+
+	// each prefab has its free instances and the transform of its root to reset them
+	struct PrefabPool {
+		std::vector<GameObject*> free;
+		Quat rotation = Quat::identity();
+		float3 scale = { 1,1,1 };
+	};
+
+	struct PooledObject {
+		u64 prefabID = 0;
+		bool spawned = false;
+		bool started = false;
+	};
+
+public:
+
+	GameObjectPool();
+	~GameObjectPool();
+
+	// create count instances of the prefab, disabled, in the parent or the root
+	void Prewarm(ResourcePrefab* prefab, uint count, GameObject* parent = nullptr);
+	// a free instance enabled at the position, a new one if the pool is empty
+	GameObject* Spawn(ResourcePrefab* prefab, const float3& local_position, GameObject* parent = nullptr);
+	// false if the object is not from a pool, despawning it again does nothing
+	bool Despawn(GameObject* instance);
+
+	// the instance is being deleted
+	void Forget(GameObject* instance);
+	void Clear();
+
+	uint GetFreeCount() const;
+	uint GetSpawnedCount() const;
+
+private:
+
+	GameObject* Create(ResourcePrefab* prefab, GameObject* parent);
+	// enabled flags of the object and its children, the scripts are called apart
+	static void SetActive(GameObject* object, bool active);
+	static void SetParentEnabled(GameObject* object, bool enabled);
+
+public:
+
+	// instances created since the start and spawns served by a free one
+	uint created = 0;
+	uint reused = 0;
+
+private:
+
+	std::unordered_map<u64, PrefabPool> pools;
+	std::unordered_map<const GameObject*, PooledObject> objects;
+	uint spawned_count = 0;
+};
@@ -112,17 +112,9 @@ void Gizmos::DrawPoly(const ResourceMesh * mesh, const float4x4& matrix, const C
 	glEnable(GL_POLYGON_OFFSET_FILL);
 	glPolygonOffset(1.0f, 0.1f);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->id_vertex);
-	glVertexPointer(3, GL_FLOAT, 0, 0);
-
-	if (mesh->normals != nullptr) {
-		glEnableClientState(GL_NORMAL_ARRAY);
-		glBindBuffer(GL_ARRAY_BUFFER, mesh->id_normals);
-		glNormalPointer(GL_FLOAT, 0, 0);
-	}
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->id_index);
-	glDrawElements(GL_TRIANGLES, mesh->num_index * 3, GL_UNSIGNED_INT, 0);
+	mesh->BindBuffers(true, false);
+	mesh->DrawElements();
+	mesh->UnbindBuffers();
 
 	glDisable(GL_POLYGON_OFFSET_FILL);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -145,11 +137,10 @@ void Gizmos::DrawWire(const ResourceMesh * mesh, const float4x4& matrix, const C
 
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->id_vertex);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->id_index);
-	glVertexPointer(3, GL_FLOAT, 0, NULL);
+	mesh->BindBuffers(false, false);
 
-	glDrawElements(GL_TRIANGLES, mesh->num_index * 3, GL_UNSIGNED_INT, NULL);
+	mesh->DrawElements();
+	mesh->UnbindBuffers();
 
 	glLineWidth(1);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -0,0 +1,583 @@
+#include "MeshOptimizer.h"
+#include "MathGeoLib/include/Math/float3.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// Forsyth's scoring, the cache he models is bigger than the FIFO measured, it works for any real size
+#define FORSYTH_CACHE_SIZE 32
+#define FORSYTH_CACHE_DECAY_POWER 1.5F
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75F
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0F
+#define FORSYTH_VALENCE_BOOST_POWER 0.5F
+
+#define INVALID_INDEX 0xFFFFFFFF
+
+// a collapse is not done if it turns a triangle more than ~75 degrees
+#define SIMPLIFY_MIN_NORMAL_COS 0.25F
+
+// sum of the squared distances to a set of planes, ax + by + cz + d = 0
+struct Quadric {
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+	double b2 = 0.0, bc = 0.0, bd = 0.0;
+	double c2 = 0.0, cd = 0.0;
+	double d2 = 0.0;
+
+	void AddPlane(double a, double b, double c, double d)
+	{
+		a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+		b2 += b * b; bc += b * c; bd += b * d;
+		c2 += c * c; cd += c * d;
+		d2 += d * d;
+	}
+
+	void Add(const Quadric& other)
+	{
+		a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+		b2 += other.b2; bc += other.bc; bd += other.bd;
+		c2 += other.c2; cd += other.cd;
+		d2 += other.d2;
+	}
+
+	double Evaluate(const float* point) const
+	{
+		double x = point[0], y = point[1], z = point[2];
+		return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+			+ b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+			+ c2 * z * z + 2.0 * cd * z
+			+ d2;
+	}
+};
+
+struct Collapse {
+	double cost = 0.0;
+	uint from = 0;
+	uint to = 0;
+};
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint* indices, uint index_count, uint vertex_count, uint cache_size)
+{
+	VertexCacheStats stats;
+	stats.triangles = index_count / 3;
+
+	// a vertex is in the cache if less than cache_size misses happened since it was added
+	std::vector<uint> added_at(vertex_count, 0);
+	std::vector<bool> used(vertex_count, false);
+	uint time = cache_size + 1;
+
+	for (uint i = 0; i < stats.triangles * 3; ++i) {
+		uint vertex = indices[i];
+		if (vertex >= vertex_count)
+			continue;
+
+		if (!used[vertex]) {
+			used[vertex] = true;
+			++stats.vertices;
+		}
+		if (time - added_at[vertex] > cache_size) {
+			added_at[vertex] = time++;
+			++stats.transformed;
+		}
+	}
+	return stats;
+}
+
+uint MeshOptimizer::WeldVertices(const float* positions, const float* normals, const float* uvs, uint* indices, uint index_count, uint vertex_count)
+{
+	std::vector<uint> remap(vertex_count);
+	FindEqualVertices(positions, normals, uvs, vertex_count, remap.data());
+
+	uint unique = 0;
+	for (uint i = 0; i < vertex_count; ++i) {
+		if (remap[i] == i) {
+			++unique;
+		}
+	}
+
+	for (uint i = 0; i < index_count; ++i) {
+		if (indices[i] < vertex_count) {
+			indices[i] = remap[indices[i]];
+		}
+	}
+	return unique;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint* indices, uint index_count, uint vertex_count)
+{
+	uint triangles_count = index_count / 3;
+	if (triangles_count == 0)
+		return;
+
+	// triangles using each vertex, the ones still not emitted are at the start of its range
+	std::vector<uint> live(vertex_count, 0);
+	for (uint i = 0; i < triangles_count * 3; ++i) {
+		++live[indices[i]];
+	}
+	std::vector<uint> offsets(vertex_count + 1, 0);
+	for (uint i = 0; i < vertex_count; ++i) {
+		offsets[i + 1] = offsets[i] + live[i];
+	}
+	std::vector<uint> adjacency(triangles_count * 3);
+	std::vector<uint> filled(offsets.begin(), offsets.end() - 1);
+	for (uint i = 0; i < triangles_count * 3; ++i) {
+		adjacency[filled[indices[i]]++] = i / 3;
+	}
+
+	std::vector<int> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (uint i = 0; i < vertex_count; ++i) {
+		vertex_score[i] = VertexScore(-1, live[i]);
+	}
+
+	std::vector<float> triangle_score(triangles_count);
+	std::vector<bool> emitted(triangles_count, false);
+	int best = -1;
+	float best_score = -1.0F;
+	for (uint i = 0; i < triangles_count; ++i) {
+		triangle_score[i] = vertex_score[indices[i * 3]] + vertex_score[indices[i * 3 + 1]] + vertex_score[indices[i * 3 + 2]];
+		if (triangle_score[i] > best_score) {
+			best_score = triangle_score[i];
+			best = i;
+		}
+	}
+
+	std::vector<uint> output;
+	output.reserve(triangles_count * 3);
+	std::vector<uint> cache;
+	std::vector<uint> new_cache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	uint next_unemitted = 0;
+
+	while (output.size() < triangles_count * 3) {
+		// nothing in the cache can be used, start again from the next triangle in the old order
+		if (best < 0) {
+			while (emitted[next_unemitted]) {
+				++next_unemitted;
+			}
+			best = next_unemitted;
+		}
+
+		const uint* triangle = &indices[best * 3];
+		emitted[best] = true;
+		new_cache.clear();
+		for (uint i = 0; i < 3; ++i) {
+			uint vertex = triangle[i];
+			output.push_back(vertex);
+
+			uint* begin = &adjacency[offsets[vertex]];
+			uint* end = begin + live[vertex];
+			uint* found = std::find(begin, end, (uint)best);
+			if (found != end) {
+				*found = *(end - 1);
+				--live[vertex];
+			}
+			if (std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end()) {
+				new_cache.push_back(vertex);
+			}
+		}
+		std::vector<uint>::iterator item = cache.begin();
+		for (; item != cache.end(); ++item) {
+			if (std::find(new_cache.begin(), new_cache.end(), *item) == new_cache.end()) {
+				new_cache.push_back(*item);
+			}
+		}
+
+		// the vertices that fall out of the cache are scored too, their triangles lose the cache bonus
+		for (uint i = 0; i < new_cache.size(); ++i) {
+			uint vertex = new_cache[i];
+			cache_position[vertex] = (i < FORSYTH_CACHE_SIZE) ? (int)i : -1;
+			vertex_score[vertex] = VertexScore(cache_position[vertex], live[vertex]);
+		}
+
+		best = -1;
+		best_score = -1.0F;
+		for (uint i = 0; i < new_cache.size(); ++i) {
+			uint vertex = new_cache[i];
+			for (uint j = offsets[vertex]; j < offsets[vertex] + live[vertex]; ++j) {
+				uint candidate = adjacency[j];
+				const uint* candidate_indices = &indices[candidate * 3];
+				triangle_score[candidate] = vertex_score[candidate_indices[0]] + vertex_score[candidate_indices[1]] + vertex_score[candidate_indices[2]];
+				if (triangle_score[candidate] > best_score) {
+					best_score = triangle_score[candidate];
+					best = candidate;
+				}
+			}
+		}
+
+		if (new_cache.size() > FORSYTH_CACHE_SIZE) {
+			new_cache.resize(FORSYTH_CACHE_SIZE);
+		}
+		cache.swap(new_cache);
+	}
+
+	memcpy(indices, output.data(), sizeof(uint) * output.size());
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint* indices, uint index_count, const float* positions, uint vertex_count, float threshold)
+{
+	uint triangles_count = index_count / 3;
+	if (triangles_count == 0)
+		return;
+
+	VertexCacheStats before = AnalyzeVertexCache(indices, index_count, vertex_count, VERTEX_CACHE_SIZE);
+
+	// a group starts where the cache simulation misses the three vertices, moving the groups keeps the reuse inside them
+	std::vector<uint> clusters;
+	std::vector<uint> added_at(vertex_count, 0);
+	uint time = VERTEX_CACHE_SIZE + 1;
+	for (uint i = 0; i < triangles_count; ++i) {
+		uint misses = 0;
+		for (uint j = 0; j < 3; ++j) {
+			uint vertex = indices[i * 3 + j];
+			if (time - added_at[vertex] > VERTEX_CACHE_SIZE) {
+				added_at[vertex] = time++;
+				++misses;
+			}
+		}
+		if (i == 0 || misses == 3) {
+			clusters.push_back(i);
+		}
+	}
+	if (clusters.size() < 2)
+		return;
+
+	float3 mesh_center = float3::zero();
+	float mesh_area = 0.0F;
+	std::vector<float3> cluster_centers(clusters.size(), float3::zero());
+	std::vector<float3> cluster_normals(clusters.size(), float3::zero());
+	for (uint i = 0; i < clusters.size(); ++i) {
+		uint end = (i + 1 < clusters.size()) ? clusters[i + 1] : triangles_count;
+		float area = 0.0F;
+		for (uint j = clusters[i]; j < end; ++j) {
+			float3 a(&positions[indices[j * 3] * 3]);
+			float3 b(&positions[indices[j * 3 + 1] * 3]);
+			float3 c(&positions[indices[j * 3 + 2] * 3]);
+			float3 normal = (b - a).Cross(c - a);
+			float triangle_area = normal.Length();
+
+			cluster_centers[i] += (a + b + c) * (triangle_area / 3.0F);
+			cluster_normals[i] += normal;
+			area += triangle_area;
+		}
+		mesh_center += cluster_centers[i];
+		mesh_area += area;
+		if (area > 0.0F) {
+			cluster_centers[i] /= area;
+		}
+	}
+	if (mesh_area > 0.0F) {
+		mesh_center /= mesh_area;
+	}
+
+	// the groups far from the center looking out are drawn first
+	std::vector<std::pair<float, uint>> order(clusters.size());
+	for (uint i = 0; i < clusters.size(); ++i) {
+		float length = cluster_normals[i].Length();
+		float facing = (length > 0.0F) ? (cluster_centers[i] - mesh_center).Dot(cluster_normals[i] / length) : 0.0F;
+		order[i] = { -facing, i };
+	}
+	std::stable_sort(order.begin(), order.end(), [](const std::pair<float, uint>& a, const std::pair<float, uint>& b) { return a.first < b.first; });
+
+	std::vector<uint> output;
+	output.reserve(triangles_count * 3);
+	std::vector<std::pair<float, uint>>::iterator item = order.begin();
+	for (; item != order.end(); ++item) {
+		uint cluster = (*item).second;
+		uint end = (cluster + 1 < clusters.size()) ? clusters[cluster + 1] : triangles_count;
+		output.insert(output.end(), indices + clusters[cluster] * 3, indices + end * 3);
+	}
+
+	VertexCacheStats after = AnalyzeVertexCache(output.data(), output.size(), vertex_count, VERTEX_CACHE_SIZE);
+	if (after.transformed <= before.transformed * threshold) {
+		memcpy(indices, output.data(), sizeof(uint) * output.size());
+	}
+}
+
+uint MeshOptimizer::OptimizeVertexFetch(float* positions, float* normals, float* uvs, uint* indices, uint index_count, uint vertex_count)
+{
+	std::vector<uint> remap(vertex_count, INVALID_INDEX);
+	uint new_count = 0;
+	for (uint i = 0; i < index_count; ++i) {
+		if (remap[indices[i]] == INVALID_INDEX) {
+			remap[indices[i]] = new_count++;
+		}
+		indices[i] = remap[indices[i]];
+	}
+
+	// moved to copies, a vertex can go to a place another one still has to leave
+	float* arrays[3] = { positions, normals, uvs };
+	uint components[3] = { 3, 3, 2 };
+	for (uint i = 0; i < 3; ++i) {
+		if (arrays[i] == nullptr)
+			continue;
+
+		std::vector<float> copy(arrays[i], arrays[i] + vertex_count * components[i]);
+		for (uint j = 0; j < vertex_count; ++j) {
+			if (remap[j] != INVALID_INDEX) {
+				memcpy(&arrays[i][remap[j] * components[i]], &copy[j * components[i]], sizeof(float) * components[i]);
+			}
+		}
+	}
+	return new_count;
+}
+
+uint MeshOptimizer::SimplifyMesh(uint* destination, const uint* indices, uint index_count, const float* positions, uint vertex_count, uint target_index_count, float max_error)
+{
+	uint count = index_count / 3 * 3;
+	memcpy(destination, indices, sizeof(uint) * count);
+	if (count <= target_index_count || vertex_count == 0)
+		return count;
+
+	// the error is relative to the mesh size
+	float3 min_point(&positions[0]);
+	float3 max_point(&positions[0]);
+	for (uint i = 1; i < vertex_count; ++i) {
+		float3 point(&positions[i * 3]);
+		min_point = min_point.Min(point);
+		max_point = max_point.Max(point);
+	}
+	double max_distance = (double)max_error * (max_point - min_point).Length();
+	double max_cost = max_distance * max_distance;
+
+	// the vertices sharing a position with others are on a normal or uv seam, moving them would open the mesh
+	std::vector<uint> same_position(vertex_count);
+	FindEqualVertices(positions, nullptr, nullptr, vertex_count, same_position.data());
+	std::vector<uint> position_users(vertex_count, 0);
+	for (uint i = 0; i < vertex_count; ++i) {
+		++position_users[same_position[i]];
+	}
+	std::vector<bool> locked(vertex_count, false);
+	for (uint i = 0; i < vertex_count; ++i) {
+		locked[i] = position_users[same_position[i]] > 1;
+	}
+
+	// the edges of only one triangle are borders, collapsing them shrinks the holes and the outline
+	std::unordered_map<u64, uint> edges;
+	for (uint i = 0; i < count; i += 3) {
+		for (uint j = 0; j < 3; ++j) {
+			uint a = destination[i + j];
+			uint b = destination[i + (j + 1) % 3];
+			++edges[(a < b) ? ((u64)a << 32 | b) : ((u64)b << 32 | a)];
+		}
+	}
+	std::unordered_map<u64, uint>::iterator edge = edges.begin();
+	for (; edge != edges.end(); ++edge) {
+		if ((*edge).second == 1) {
+			locked[(uint)((*edge).first >> 32)] = true;
+			locked[(uint)((*edge).first & 0xFFFFFFFF)] = true;
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertex_count);
+	for (uint i = 0; i < count; i += 3) {
+		float3 a(&positions[destination[i] * 3]);
+		float3 b(&positions[destination[i + 1] * 3]);
+		float3 c(&positions[destination[i + 2] * 3]);
+		float3 normal = (b - a).Cross(c - a);
+		float length = normal.Length();
+		if (length <= 0.0F)
+			continue;
+		normal /= length;
+		double d = -normal.Dot(a);
+		for (uint j = 0; j < 3; ++j) {
+			quadrics[destination[i + j]].AddPlane(normal.x, normal.y, normal.z, d);
+		}
+	}
+
+	std::vector<uint> live(vertex_count);
+	std::vector<uint> offsets(vertex_count + 1);
+	std::vector<uint> adjacency;
+	std::vector<uint> filled;
+	std::vector<Collapse> collapses;
+	std::vector<bool> touched(vertex_count);
+	std::vector<uint> remap(vertex_count);
+
+	// every pass collapses the cheapest edges that don't share triangles, then the indices are remapped
+	while (count > target_index_count) {
+		std::fill(live.begin(), live.end(), 0);
+		for (uint i = 0; i < count; ++i) {
+			++live[destination[i]];
+		}
+		offsets[0] = 0;
+		for (uint i = 0; i < vertex_count; ++i) {
+			offsets[i + 1] = offsets[i] + live[i];
+		}
+		adjacency.resize(count);
+		filled.assign(offsets.begin(), offsets.end() - 1);
+		for (uint i = 0; i < count; ++i) {
+			adjacency[filled[destination[i]]++] = i / 3;
+		}
+
+		collapses.clear();
+		for (uint i = 0; i < count; i += 3) {
+			for (uint j = 0; j < 3; ++j) {
+				uint a = destination[i + j];
+				uint b = destination[i + (j + 1) % 3];
+				Quadric quadric = quadrics[a];
+				quadric.Add(quadrics[b]);
+				if (!locked[a]) {
+					Collapse collapse;
+					collapse.cost = quadric.Evaluate(&positions[b * 3]);
+					collapse.from = a;
+					collapse.to = b;
+					collapses.push_back(collapse);
+				}
+				if (!locked[b]) {
+					Collapse collapse;
+					collapse.cost = quadric.Evaluate(&positions[a * 3]);
+					collapse.from = b;
+					collapse.to = a;
+					collapses.push_back(collapse);
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		std::fill(touched.begin(), touched.end(), false);
+		for (uint i = 0; i < vertex_count; ++i) {
+			remap[i] = i;
+		}
+
+		uint removed = 0;
+		uint to_remove = (count - target_index_count) / 3;
+		std::vector<Collapse>::iterator item = collapses.begin();
+		for (; item != collapses.end() && removed < to_remove; ++item) {
+			if ((*item).cost > max_cost)
+				break;
+
+			uint from = (*item).from;
+			uint to = (*item).to;
+			if (touched[from] || touched[to])
+				continue;
+
+			// the triangles that stay can't flip or turn too much
+			bool valid = true;
+			uint degenerated = 0;
+			for (uint j = offsets[from]; valid && j < offsets[from] + live[from]; ++j) {
+				const uint* triangle = &destination[adjacency[j] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+					++degenerated;
+					continue;
+				}
+
+				float3 before[3];
+				float3 after[3];
+				for (uint k = 0; k < 3; ++k) {
+					before[k] = float3(&positions[triangle[k] * 3]);
+					after[k] = float3(&positions[((triangle[k] == from) ? to : triangle[k]) * 3]);
+				}
+				float3 normal_before = (before[1] - before[0]).Cross(before[2] - before[0]);
+				float3 normal_after = (after[1] - after[0]).Cross(after[2] - after[0]);
+				float lengths = normal_before.Length() * normal_after.Length();
+				if (normal_before.Length() > 0.0F && normal_before.Dot(normal_after) <= SIMPLIFY_MIN_NORMAL_COS * lengths) {
+					valid = false;
+				}
+			}
+			if (!valid || degenerated == 0)
+				continue;
+
+			remap[from] = to;
+			quadrics[to].Add(quadrics[from]);
+			removed += degenerated;
+
+			// the vertices of the triangles changed can't be used again in this pass, their triangles are not up to date
+			for (uint j = offsets[from]; j < offsets[from] + live[from]; ++j) {
+				const uint* triangle = &destination[adjacency[j] * 3];
+				touched[triangle[0]] = true;
+				touched[triangle[1]] = true;
+				touched[triangle[2]] = true;
+			}
+		}
+
+		if (removed == 0)
+			break;
+
+		uint new_count = 0;
+		for (uint i = 0; i < count; i += 3) {
+			uint a = remap[destination[i]];
+			uint b = remap[destination[i + 1]];
+			uint c = remap[destination[i + 2]];
+			if (a != b && b != c && a != c) {
+				destination[new_count++] = a;
+				destination[new_count++] = b;
+				destination[new_count++] = c;
+			}
+		}
+		count = new_count;
+	}
+
+	return count;
+}
+
+void MeshOptimizer::FindEqualVertices(const float* positions, const float* normals, const float* uvs, uint vertex_count, uint* remap)
+{
+	// open addressing, the table is at most half full
+	uint table_size = 1;
+	while (table_size < vertex_count * 2) {
+		table_size *= 2;
+	}
+	std::vector<uint> table(table_size, INVALID_INDEX);
+
+	for (uint i = 0; i < vertex_count; ++i) {
+		uint slot = VertexHash(positions, normals, uvs, i) & (table_size - 1);
+		while (table[slot] != INVALID_INDEX && !VertexEqual(positions, normals, uvs, table[slot], i)) {
+			slot = (slot + 1) & (table_size - 1);
+		}
+		if (table[slot] == INVALID_INDEX) {
+			table[slot] = i;
+		}
+		remap[i] = table[slot];
+	}
+}
+
+float MeshOptimizer::VertexScore(int cache_position, uint live_triangles)
+{
+	// nothing left to draw with it
+	if (live_triangles == 0)
+		return -1.0F;
+
+	float score = 0.0F;
+	if (cache_position >= 0) {
+		// the last triangle vertices get a fixed score, it avoids using them again in a strip like order
+		if (cache_position < 3) {
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		}
+		else {
+			float scaler = 1.0F / (FORSYTH_CACHE_SIZE - 3);
+			score = powf(1.0F - (cache_position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+
+	// the vertices with few triangles left are finished first
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)live_triangles, -FORSYTH_VALENCE_BOOST_POWER);
+	return score;
+}
+
+bool MeshOptimizer::VertexEqual(const float* positions, const float* normals, const float* uvs, uint a, uint b)
+{
+	return memcmp(&positions[a * 3], &positions[b * 3], sizeof(float) * 3) == 0
+		&& (normals == nullptr || memcmp(&normals[a * 3], &normals[b * 3], sizeof(float) * 3) == 0)
+		&& (uvs == nullptr || memcmp(&uvs[a * 2], &uvs[b * 2], sizeof(float) * 2) == 0);
+}
+
+uint MeshOptimizer::VertexHash(const float* positions, const float* normals, const float* uvs, uint vertex)
+{
+	// FNV-1a of the bytes compared by VertexEqual
+	const float* arrays[3] = { positions, normals, uvs };
+	uint components[3] = { 3, 3, 2 };
+	uint hash = 2166136261U;
+	for (uint i = 0; i < 3; ++i) {
+		if (arrays[i] == nullptr)
+			continue;
+
+		const unsigned char* bytes = (const unsigned char*)&arrays[i][vertex * components[i]];
+		for (uint j = 0; j < sizeof(float) * components[i]; ++j) {
+			hash ^= bytes[j];
+			hash *= 16777619U;
+		}
+	}
+	return hash;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+typedef unsigned int uint;
+typedef unsigned long long u64;
+
+// vertices in the FIFO cache when measuring the meshes
+#define VERTEX_CACHE_SIZE 16
+// the overdraw order is kept only if the vertices transformed don't grow more than this
+#define OVERDRAW_CACHE_THRESHOLD 1.05F
+// the simplification stops before moving the surface more than this part of the mesh size
+#define SIMPLIFY_MAX_ERROR 0.05F
+
+// vertices transformed simulating a FIFO post-transform cache
+struct VertexCacheStats {
+	uint transformed = 0;
+	uint triangles = 0;
+	uint vertices = 0;
+
+	// average cache miss ratio, transformed by triangle. 0.5 is the best possible, 3 no reuse at all
+	float GetACMR() const { return (triangles > 0) ? (float)transformed / (float)triangles : 0.0F; }
+	// average transform to vertex ratio, 1 is the best possible
+	float GetATVR() const { return (vertices > 0) ? (float)transformed / (float)vertices : 0.0F; }
+};
+
+// Reordering of the triangle lists of the meshes so the GPU transforms, shades and fetches less. They only work with
+// the arrays they are given, the meshes can be optimized from any thread.
+// positions and normals have 3 floats each vertex and uvs 2, normals and uvs can be nullptr
+class MeshOptimizer {
+
+public:
+
+	static VertexCacheStats AnalyzeVertexCache(const uint* indices, uint index_count, uint vertex_count, uint cache_size);
+
+	// point the indices to the first vertex with the same position, normal and uv. The vertices not used anymore are
+	// removed by OptimizeVertexFetch. Returns the different vertices
+	static uint WeldVertices(const float* positions, const float* normals, const float* uvs, uint* indices, uint index_count, uint vertex_count);
+	// Forsyth's linear speed vertex cache optimization, the triangles using vertices in the cache go first
+	static void OptimizeVertexCache(uint* indices, uint index_count, uint vertex_count);
+	// split the triangles where the cache starts again and draw first the groups facing out of the mesh, the ones that
+	// hide others. Undone if the cache gets worse than the threshold
+	static void OptimizeOverdraw(uint* indices, uint index_count, const float* positions, uint vertex_count, float threshold);
+	// number the vertices in the order the triangles use them and remove the unused ones. Returns the new vertex count
+	static uint OptimizeVertexFetch(float* positions, float* normals, float* uvs, uint* indices, uint index_count, uint vertex_count);
+	// collapse the edges that change the surface the least, measured with quadrics, until the triangles are
+	// target_index_count or the error would be bigger than max_error. The vertices are not moved, so the result
+	// uses the same vertices. The borders and the seams of the normals and uvs are kept.
+	// destination has space for index_count indices, returns the indices written
+	static uint SimplifyMesh(uint* destination, const uint* indices, uint index_count, const float* positions, uint vertex_count, uint target_index_count, float max_error);
+
+private:
+
+	// the first vertex with the same position, normal and uv of each vertex
+	static void FindEqualVertices(const float* positions, const float* normals, const float* uvs, uint vertex_count, uint* remap);
+
+	static float VertexScore(int cache_position, uint live_triangles);
+	static bool VertexEqual(const float* positions, const float* normals, const float* uvs, uint a, uint b);
+	static uint VertexHash(const float* positions, const float* normals, const float* uvs, uint vertex);
+};
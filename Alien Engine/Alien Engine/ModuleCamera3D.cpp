@@ -248,13 +248,19 @@ void ModuleCamera3D::CreateRay()
 	std::vector<std::pair<float, GameObject*>> hits;
 
 	// with octree to static objects
-	CreateObjectsHitMap(&hits, App->objects->octree.root, ray);
+	App->objects->octree.GetObjectsInRay(ray, &hits);
 	
-	// without octree for the dynamics
-	std::vector<GameObject*>::iterator item = App->objects->GetRoot(true)->children.begin();
-	for (; item != App->objects->GetRoot(true)->children.end(); ++item) {
-		if (*item != nullptr && (*item)->IsEnabled()) {
-			CreateObjectsHitMap(&hits, (*item), ray);
+	if (App->objects->use_dynamic_tree) {
+		// with the dynamic tree for the dynamics
+		CreateObjectsHitMap(&hits, &App->objects->dynamic_tree, ray);
+	}
+	else {
+		// without octree for the dynamics
+		std::vector<GameObject*>::iterator item = App->objects->GetRoot(true)->children.begin();
+		for (; item != App->objects->GetRoot(true)->children.end(); ++item) {
+			if (*item != nullptr && (*item)->IsEnabled()) {
+				CreateObjectsHitMap(&hits, (*item), ray);
+			}
 		}
 	}
 	// sort by pos
@@ -297,34 +303,40 @@ void ModuleCamera3D::CreateObjectsHitMap(std::vector<std::pair<float, GameObject
 	}
 }
 
-void ModuleCamera3D::CreateObjectsHitMap(std::vector<std::pair<float, GameObject*>>* hits, OctreeNode* node, const LineSegment& ray)
+void ModuleCamera3D::CreateObjectsHitMap(std::vector<std::pair<float, GameObject*>>* hits, const DynamicTree* tree, const LineSegment& ray)
 {
-	if (node != nullptr) {
+	App->objects->transform_hierarchy.UpdateActive(App->objects->GetRoot(true));
+
+	std::vector<std::pair<float, ComponentMesh*>> meshes;
+	tree->GetMeshesInRay(ray, &meshes);
+
+	// the box of an object without children is the one of its mesh, so the distance is the same as without the tree
+	std::vector<std::pair<float, ComponentMesh*>>::iterator item = meshes.begin();
+	for (; item != meshes.end(); ++item) {
+		GameObject* go = (*item).second->game_object_attached;
+		ComponentTransform* transform = (ComponentTransform*)go->GetComponent(ComponentType::TRANSFORM);
+		if (go->children.empty() && transform != nullptr && App->objects->transform_hierarchy.IsActive(transform)) {
+			hits->push_back({ (*item).first, go });
+		}
+	}
 
-		float distance_out = 0.f;
-		float distance = 0.f;
+	// the other dynamic objects like without the tree: the ones with children, with the box of all of them, and the
+	// ones without mesh (lights, cameras, empty objects...)
+	float distance_out = 0.f;
+	float distance = 0.f;
 
-		if (ray.Intersects(node->section, distance, distance_out))
-		{
-			if (!node->game_objects.empty()) {
-				std::vector<GameObject*>::iterator item = node->game_objects.begin();
-				for (; item != node->game_objects.end(); ++item) {
-					if (*item != nullptr && (*item)->IsEnabled()) {
-						if (ray.Intersects((*item)->GetBB(), distance, distance_out)) {
-							hits->push_back({ distance, (*item) });
-						}
-					}
-				}
-			}
+	const std::vector<Component*>& transforms = App->objects->component_registry.GetComponents(ComponentType::TRANSFORM);
+	for (uint i = 0; i < transforms.size(); ++i) {
+		GameObject* go = transforms[i]->game_object_attached;
+		if (go->is_static)
+			continue;
 
-			if (!node->children.empty()) {
-				std::vector<OctreeNode*>::iterator item = node->children.begin();
-				for (; item != node->children.end(); ++item) {
-					if (*item != nullptr) {
-						CreateObjectsHitMap(hits, (*item), ray);
-					}
-				}
-			}
+		ComponentMesh* mesh = (ComponentMesh*)go->GetComponent(ComponentType::MESH);
+		if (go->children.empty() && mesh != nullptr && mesh->tree_proxy != -1)
+			continue;
+
+		if (App->objects->transform_hierarchy.IsActive((ComponentTransform*)transforms[i]) && ray.Intersects(go->GetBB(), distance, distance_out)) {
+			hits->push_back({ distance, go });
 		}
 	}
 }
@@ -334,7 +346,14 @@ bool ModuleCamera3D::TestTrianglesIntersections(GameObject* object, const LineSe
 	bool ret = false;
 	ComponentMesh* mesh = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
 
-	if (mesh != nullptr && mesh->mesh != nullptr)
+	if (mesh != nullptr && mesh->mesh != nullptr && mesh->mesh->id_index != 0 && (mesh->mesh->index == nullptr || mesh->mesh->vertex == nullptr))
+	{
+		// a mesh without its arrays in memory, the box that the ray hit is enough
+		object->parent->open_node = true;
+		App->objects->SetNewSelectedObject(object);
+		ret = true;
+	}
+	else if (mesh != nullptr && mesh->mesh != nullptr)
 	{
 		ComponentTransform* transform = (ComponentTransform*)object->GetComponent(ComponentType::TRANSFORM);
 		for (uint i = 0; i < mesh->mesh->num_index; i += 3)
@@ -351,7 +370,7 @@ bool ModuleCamera3D::TestTrianglesIntersections(GameObject* object, const LineSe
 			float3 point_c(&mesh->mesh->vertex[index_c]);
 
 			Triangle triangle_to_check(point_a, point_b, point_c);
-			triangle_to_check.Transform(transform->global_transformation);
+			triangle_to_check.Transform(transform->GetGlobalMatrix());
 			if (ray.Intersects(triangle_to_check, nullptr, nullptr))
 			{
 				object->parent->open_node = true;
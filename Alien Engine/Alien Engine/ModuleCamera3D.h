@@ -4,7 +4,7 @@
 #include "ImGuizmos/ImGuizmo.h"
 
 class ComponentCamera;
-class OctreeNode;
+class DynamicTree;
 
 class ModuleCamera3D : public Module
 {
@@ -25,7 +25,7 @@ public:
 	void CreateRay();
 
 	void CreateObjectsHitMap(std::vector<std::pair<float, GameObject*>>* hits, GameObject* go, const LineSegment &ray);
-	void CreateObjectsHitMap(std::vector<std::pair<float, GameObject*>>* hits, OctreeNode* node, const LineSegment &ray);
+	void CreateObjectsHitMap(std::vector<std::pair<float, GameObject*>>* hits, const DynamicTree* tree, const LineSegment &ray);
 	bool TestTrianglesIntersections(GameObject* object, const LineSegment& ray);
 	static bool SortByDistance(const std::pair<float, GameObject*> pair1, const std::pair<float, GameObject*> pair2);
 
@@ -6,6 +6,8 @@
 #include "Assimp/include/assimp/types.h"
 #include "Resource_.h"
 #include "FileNode.h"
+#include "AssetDatabase.h"
+#include <algorithm>
 
 #pragma comment( lib, "PhysFS/libx86/physfs.lib" )
 
@@ -66,6 +68,13 @@ ModuleFileSystem::ModuleFileSystem(const char* game_path) : Module()
 	// Generate IO interfaces
 	CreateAssimpIO();
 	CreateBassIO();
+
+#ifdef GAME_VERSION
+	// the builds pack the library in a single file
+	if (archive.Open(LIBRARY_ARCHIVE_FILE)) {
+		LOG_ENGINE("Library archive %s with %u files", LIBRARY_ARCHIVE_FILE, archive.GetEntriesCount());
+	}
+#endif
 }
 
 // Destructor
@@ -147,7 +156,7 @@ bool ModuleFileSystem::AddPath(const char* path_or_zip)
 // Check if a file exists
 bool ModuleFileSystem::Exists(const char* file) const
 {
-	return PHYSFS_exists(file) != 0;
+	return archive.Find(file) != nullptr || PHYSFS_exists(file) != 0;
 }
 
 bool ModuleFileSystem::ExistsInFolderRecursive(const char* folder, const char* file_name)
@@ -214,6 +223,58 @@ void ModuleFileSystem::DiscoverFiles(const char* directory, vector<string>& file
 	}
 
 	PHYSFS_freeList(rc);
+
+	if (archive.IsOpen()) {
+		std::vector<std::string> packed_files;
+		std::vector<std::string> packed_directories;
+		archive.GetFiles(directory, packed_files, packed_directories, false);
+
+		for (uint j = 0; j < packed_files.size(); ++j) {
+			std::string ext;
+			SplitFilePath(packed_files[j].data(), nullptr, nullptr, &ext);
+			if (!App->StringCmp(ext.data(), "alien")) {
+				file_list.push_back(files_hole_path ? std::string(directory + packed_files[j]) : packed_files[j]);
+			}
+		}
+		// the game creates the library folders empty
+		for (uint j = 0; j < packed_directories.size(); ++j) {
+			if (std::find(dir_list.begin(), dir_list.end(), packed_directories[j]) == dir_list.end()) {
+				dir_list.push_back(packed_directories[j]);
+			}
+		}
+	}
+}
+
+void ModuleFileSystem::DiscoverAllFiles(const char* directory, vector<string>& file_list) const
+{
+	char** rc = PHYSFS_enumerateFiles(directory);
+
+	string dir(directory);
+	if (!dir.empty() && dir.back() != '/')
+		dir += '/';
+
+	for (char** i = rc; *i != nullptr; i++)
+	{
+		if (PHYSFS_isDirectory((dir + *i).c_str()))
+			DiscoverAllFiles((dir + *i).c_str(), file_list);
+		else
+			file_list.push_back(dir + *i);
+	}
+
+	PHYSFS_freeList(rc);
+}
+
+void ModuleFileSystem::GetFilesToPack(vector<string>& file_list) const
+{
+	vector<string> files;
+	DiscoverAllFiles(LIBRARY_FOLDER, files);
+
+	vector<string>::iterator item = files.begin();
+	for (; item != files.end(); ++item) {
+		if (!App->StringCmp((*item).data(), ASSET_DATABASE_FILE)) {
+			file_list.push_back(*item);
+		}
+	}
 }
 
 void ModuleFileSystem::DiscoverEverythig(FileNode* node)
@@ -425,6 +486,15 @@ uint ModuleFileSystem::Load(const char* file, char** buffer) const
 {
 	uint ret = 0;
 
+	// the packed files of a game build
+	if (archive.IsOpen()) {
+		char* packed = archive.Extract(file, &ret);
+		if (packed != nullptr) {
+			*buffer = packed;
+			return ret;
+		}
+	}
+
 	PHYSFS_file* fs_file = PHYSFS_openRead(file);
 
 	if (fs_file != nullptr)
@@ -453,6 +523,82 @@ uint ModuleFileSystem::Load(const char* file, char** buffer) const
 	return ret;
 }
 
+bool ModuleFileSystem::Map(const char* file, FileMapping* file_mapping) const
+{
+	// the compressed entries can't be mapped, Load decompresses them
+	if (archive.Find(file) != nullptr)
+		return archive.Map(file, file_mapping);
+
+	const char* real_dir = PHYSFS_getRealDir(file);
+	if (real_dir == nullptr)
+		return false;
+
+	// the files inside an archive can't be mapped
+	DWORD attributes = GetFileAttributesA(real_dir);
+	if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+		return false;
+
+	std::string path = std::string(real_dir) + "/" + file;
+
+	HANDLE file_handle = CreateFileA(path.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD size = GetFileSize(file_handle, nullptr);
+	if (size == 0 || size == INVALID_FILE_SIZE) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	// copy on write, the pages that are modified become private and the file is not changed
+	HANDLE mapping = CreateFileMappingA(file_handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	char* data = (char*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	file_mapping->file = file_handle;
+	file_mapping->mapping = mapping;
+	file_mapping->data = data;
+	file_mapping->size = size;
+
+	return true;
+}
+
+void ModuleFileSystem::Unmap(FileMapping* file_mapping) const
+{
+	if (file_mapping->view != nullptr)
+		UnmapViewOfFile(file_mapping->view);
+	else if (file_mapping->data != nullptr)
+		UnmapViewOfFile(file_mapping->data);
+	if (file_mapping->mapping != nullptr)
+		CloseHandle(file_mapping->mapping);
+	if (file_mapping->file != nullptr)
+		CloseHandle(file_mapping->file);
+
+	*file_mapping = FileMapping();
+}
+
+JSON_Value* ModuleFileSystem::LoadJSON(const char* file) const
+{
+	uint size = 0;
+	char* packed = archive.Extract(file, &size);
+	if (packed == nullptr)
+		return json_parse_file(file);
+
+	// Extract ends the buffer with a 0
+	JSON_Value* value = json_parse_string(packed);
+	delete[] packed;
+	return value;
+}
+
 // Read a whole file and put it in a new buffer
 SDL_RWops* ModuleFileSystem::Load(const char* file) const
 {
@@ -8,6 +8,8 @@ int close_sdl_rwops(SDL_RWops* rw);
 
 struct aiFileIO;
 #include "Bass/include/bass.h"
+#include "AssetArchive.h"
+#include "Parson/parson.h"
 //struct BASS_FILEPROCS;
 
 // -------Foldres Paths--------
@@ -54,6 +56,16 @@ struct aiFileIO;
 class ResourceTexture;
 class FileNode;
 
+// file mapped in memory, the pages are read by the OS when they are accessed
+struct FileMapping {
+	void* file = nullptr;
+	void* mapping = nullptr;
+	// start of the view, the data of an entry of the archive is after it
+	char* view = nullptr;
+	char* data = nullptr;
+	uint size = 0;
+};
+
 enum class FileDropType {
 	MODEL3D,
 	TEXTURE,
@@ -88,6 +100,10 @@ public:
 	bool IsDirectory(const char* file) const;
 	void CreateDirectory(const char* directory);
 	void DiscoverFiles(const char* directory, std::vector<std::string>& file_list, std::vector<std::string>& dir_list, bool files_hole_path = false) const;
+	// every file of the folder and its subfolders with its whole path, without filtering the extensions
+	void DiscoverAllFiles(const char* directory, std::vector<std::string>& file_list) const;
+	// the library files a build needs, the ones only the editor uses are left out
+	void GetFilesToPack(std::vector<std::string>& file_list) const;
 	void DiscoverEverythig(FileNode* node);
 	void DiscoverFolders(FileNode* node);
 	bool CopyFromOutsideFS(const char* full_path, const char* destination);
@@ -103,6 +119,11 @@ public:
 	unsigned int Load(const char* file, char** buffer) const;
 	SDL_RWops* Load(const char* file) const;
 	void* BassLoad(const char* file) const;
+	// map the file copy on write, false if it can't be mapped, for example if it is inside a zip
+	bool Map(const char* file, FileMapping* file_mapping) const;
+	void Unmap(FileMapping* file_mapping) const;
+	// parse a JSON file, from the archive if it is packed
+	JSON_Value* LoadJSON(const char* file) const;
 
 	// IO interfaces for other libs to handle files via PHYSfs
 	aiFileIO* GetAssimpIO();
@@ -126,6 +147,7 @@ public:
 	std::string GetCurrentHolePathFolder(const std::string& path);
 	void GetPreviousNames(std::string& previous, FileNode* node);
 	std::string GetPathWithoutExtension(const std::string& path);
+
 private:
 
 	void CreateAssimpIO();
@@ -137,5 +159,11 @@ private:
 	BASS_FILEPROCS* BassIO = nullptr;
 
 	time_t last_mod_dll = 0;
+
+public:
+
+	// the library of a game build, the loads look for the files in it before the loose ones
+	AssetArchive archive;
+
 };
 
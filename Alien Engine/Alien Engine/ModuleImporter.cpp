@@ -16,6 +16,9 @@
 #include "ResourceModel.h"
 #include "ResourceTexture.h"
 #include "ReturnZ.h"
+#include "ParallelFor.h"
+#include <atomic>
+#include <algorithm>
 #include "mmgr/mmgr.h"
 
 ModuleImporter::ModuleImporter(bool start_enabled) : Module(start_enabled)
@@ -59,6 +62,7 @@ bool ModuleImporter::LoadModelFile(const char* path)
 	bool ret = true;
 
 	LOG_ENGINE("Loading %s", path);
+	j1PerfTimer timer;
 
 	// if this file has been already imported just load the .alienModel
 	Resource* model = nullptr;
@@ -83,6 +87,9 @@ bool ModuleImporter::LoadModelFile(const char* path)
 	else {
 		App->resources->CreateNewModelInstanceOf(model->GetLibraryPath());
 	}
+
+	App->resources->last_import_ms = timer.ReadMs();
+	App->resources->last_import_resources = App->resources->resources.size();
 	
 	return ret;
 }
@@ -97,6 +104,7 @@ void ModuleImporter::InitScene(const char* path, const aiScene* scene)
 	for (uint i = 0; i < scene->mRootNode->mNumChildren; ++i) {
 		LoadSceneNode(scene->mRootNode->mChildren[i], scene, nullptr, 1);
 	}
+	ProcessMeshes();
 
 	// create the meta data files like .alien
 	if (model->CreateMetaData()) {
@@ -181,87 +189,125 @@ ResourceMesh* ModuleImporter::LoadNodeMesh(const aiScene * scene, const aiNode*
 	if (parent != nullptr)
 		ret->parent_name = parent->name;
 
+	// set the material
+	aiMaterial* ai_material = scene->mMaterials[ai_mesh->mMaterialIndex];
+	aiString path;
+	ai_material->GetTexture(aiTextureType_DIFFUSE, 0, &path);
+	aiColor4D col;
+	if (AI_SUCCESS == aiGetMaterialColor(ai_material, AI_MATKEY_COLOR_DIFFUSE, &col)) {
+		ret->material_color.r = col.r;
+		ret->material_color.g = col.g;
+		ret->material_color.b = col.b;
+		ret->material_color.a = col.a;
+	}
+	std::string normal_path = path.C_Str();
+	App->file_system->NormalizePath(normal_path);
+	ret->texture = App->resources->GetTextureByName(normal_path.data());
+	// the asset database imports the model again if the texture appears or is another one
+	if (model != nullptr && !normal_path.empty() && std::find(model->textures_asked.begin(), model->textures_asked.end(), normal_path) == model->textures_asked.end()) {
+		model->textures_asked.push_back(normal_path);
+	}
+	ret->name = std::string(node->mName.C_Str());
+
+	meshes_to_convert.push_back({ ret, ai_mesh });
+
+	return ret;
+}
+
+void ModuleImporter::ProcessMeshes()
+{
+	last_import_meshes = meshes_to_convert.size();
+
+	j1PerfTimer timer;
+	std::atomic<uint> bad_faces(0);
+	std::vector<std::pair<VertexCacheStats, VertexCacheStats>> cache_stats(meshes_to_convert.size());
+	ParallelFor(meshes_to_convert.size(), import_threads, [this, &bad_faces, &cache_stats](uint i) {
+		bad_faces += ConvertMesh(meshes_to_convert[i].first, meshes_to_convert[i].second, optimize_meshes, generate_lods, &cache_stats[i].first, &cache_stats[i].second);
+	});
+	last_convert_ms = timer.ReadMs();
+
+	if (bad_faces > 0) {
+		LOG_ENGINE("WARNING, %u geometry faces with != 3 indices!", (uint)bad_faces);
+	}
+	if (optimize_meshes) {
+		for (uint i = 0; i < meshes_to_convert.size(); ++i) {
+			const VertexCacheStats& before = cache_stats[i].first;
+			const VertexCacheStats& after = cache_stats[i].second;
+			LOG_ENGINE("Mesh %s optimized: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %u -> %u vertices", meshes_to_convert[i].first->name.data(),
+				before.GetACMR(), after.GetACMR(), before.GetATVR(), after.GetATVR(), meshes_to_convert[i].second->mNumVertices, meshes_to_convert[i].first->num_vertex);
+		}
+	}
+
+	// GL only in the main thread
+	timer.Start();
+	std::vector<std::pair<ResourceMesh*, const aiMesh*>>::iterator item = meshes_to_convert.begin();
+	for (; item != meshes_to_convert.end(); ++item) {
+		ResourceMesh* mesh = (*item).first;
+		if (mesh->num_lods > 0) {
+			std::string triangles = std::to_string(mesh->num_index / 3);
+			for (uint i = 1; i < mesh->GetLODsCount(); ++i) {
+				triangles += ", " + std::to_string(mesh->GetIndexCount(i) / 3);
+			}
+			LOG_ENGINE("Mesh %s LODs triangles: %s", mesh->name.data(), triangles.data());
+		}
+		mesh->InitBuffers();
+		LOG_ENGINE("Mesh %s uses %u bytes in the GPU, %u bytes saved by the compact vertex format", mesh->name.data(), mesh->GetBuffersSize(), mesh->GetUncompressedBuffersSize() - mesh->GetBuffersSize());
+	}
+	last_upload_ms = timer.ReadMs();
+
+	meshes_to_convert.clear();
+}
+
+uint ModuleImporter::ConvertMesh(ResourceMesh* mesh, const aiMesh* ai_mesh, bool optimize, bool lods, VertexCacheStats* before, VertexCacheStats* after)
+{
+	uint bad_faces = 0;
+
 	// get vertex
-	ret->vertex = new float[ai_mesh->mNumVertices * 3];
-	memcpy(ret->vertex, ai_mesh->mVertices, sizeof(float) * ai_mesh->mNumVertices * 3);
-	ret->num_vertex = ai_mesh->mNumVertices;
+	mesh->vertex = new float[ai_mesh->mNumVertices * 3];
+	memcpy(mesh->vertex, ai_mesh->mVertices, sizeof(float) * ai_mesh->mNumVertices * 3);
+	mesh->num_vertex = ai_mesh->mNumVertices;
 
 	// get index
 	if (ai_mesh->HasFaces())
 	{
-		ret->num_index = ai_mesh->mNumFaces * 3;
-		ret->index = new uint[ret->num_index]; // assume each face is a triangle
+		mesh->num_index = ai_mesh->mNumFaces * 3;
+		mesh->index = new uint[mesh->num_index]; // assume each face is a triangle
 		for (uint i = 0; i < ai_mesh->mNumFaces; ++i)
 		{
 			if (ai_mesh->mFaces[i].mNumIndices != 3) {
 				uint non[3] = { 0,0,0 };
-				memcpy(&ret->index[i * 3], non, 3 * sizeof(uint));
-				LOG_ENGINE("WARNING, geometry face with != 3 indices!");
+				memcpy(&mesh->index[i * 3], non, 3 * sizeof(uint));
+				++bad_faces;
 			}
 			else {
-				memcpy(&ret->index[i * 3], ai_mesh->mFaces[i].mIndices, 3 * sizeof(uint));
+				memcpy(&mesh->index[i * 3], ai_mesh->mFaces[i].mIndices, 3 * sizeof(uint));
 			}
 		}
 	}
 	// get normals
 	if (ai_mesh->HasNormals())
 	{
-		ret->normals = new float[ai_mesh->mNumVertices * 3];
-		memcpy(ret->normals, ai_mesh->mNormals, sizeof(float) * ai_mesh->mNumVertices * 3);
-
-		ret->center_point_normal = new float[ai_mesh->mNumFaces * 3];
-		ret->center_point = new float[ai_mesh->mNumFaces * 3];
-		ret->num_faces = ai_mesh->mNumFaces;
-		for (uint i = 0; i < ret->num_index; i+=3)
-		{
-			uint index1 = ret->index[i] * 3;
-			uint index2 = ret->index[i + 1] * 3;
-			uint index3 = ret->index[i + 2] * 3;
-
-			float3 x0(ret->vertex[index1], ret->vertex[index1 + 1], ret->vertex[index1 + 2]);
-			float3 x1(ret->vertex[index2], ret->vertex[index2 + 1], ret->vertex[index2 + 2]);
-			float3 x2(ret->vertex[index3], ret->vertex[index3 + 1], ret->vertex[index3 + 2]);
-
-			float3 v0 = x0 - x2;
-			float3 v1 = x1 - x2;
-			float3 n = v0.Cross(v1);
-
-			float3 normalized = n.Normalized();
-
-			ret->center_point[i] = (x0.x + x1.x + x2.x) / 3;
-			ret->center_point[i + 1] = (x0.y + x1.y + x2.y) / 3;
-			ret->center_point[i + 2] = (x0.z + x1.z + x2.z) / 3;
-
-			ret->center_point_normal[i] = normalized.x;
-			ret->center_point_normal[i + 1] = normalized.y;
-			ret->center_point_normal[i + 2] = normalized.z;
-		}
+		mesh->normals = new float[ai_mesh->mNumVertices * 3];
+		memcpy(mesh->normals, ai_mesh->mNormals, sizeof(float) * ai_mesh->mNumVertices * 3);
 	}
 	// get UV
 	if (ai_mesh->HasTextureCoords(0)) {
-		ret->uv_cords = new float[ai_mesh->mNumVertices * 3];
-		memcpy(ret->uv_cords, (float*)ai_mesh->mTextureCoords[0], sizeof(float) * ai_mesh->mNumVertices * 3);
+		mesh->uv_cords = new float[ai_mesh->mNumVertices * 2];
+		for (uint i = 0; i < ai_mesh->mNumVertices; ++i) {
+			mesh->uv_cords[i * 2] = ai_mesh->mTextureCoords[0][i].x;
+			mesh->uv_cords[i * 2 + 1] = ai_mesh->mTextureCoords[0][i].y;
+		}
 	}
 
-	ret->InitBuffers();
-	
-	// set the material
-	aiMaterial* ai_material = scene->mMaterials[ai_mesh->mMaterialIndex];
-	aiString path;
-	ai_material->GetTexture(aiTextureType_DIFFUSE, 0, &path);
-	aiColor4D col;
-	if (AI_SUCCESS == aiGetMaterialColor(ai_material, AI_MATKEY_COLOR_DIFFUSE, &col)) {
-		ret->material_color.r = col.r;
-		ret->material_color.g = col.g;
-		ret->material_color.b = col.b;
-		ret->material_color.a = col.a;
+	if (optimize) {
+		mesh->Optimize(before, after);
 	}
-	std::string normal_path = path.C_Str();
-	App->file_system->NormalizePath(normal_path);
-	ret->texture = App->resources->GetTextureByName(normal_path.data());
-	ret->name = std::string(node->mName.C_Str());
+	if (lods) {
+		mesh->GenerateLODs();
+	}
+	mesh->GenerateFacesNormals();
 
-	return ret;
+	return bad_faces;
 }
 
 ResourceTexture* ModuleImporter::LoadTextureFile(const char* path, bool has_been_dropped, bool is_custom)
@@ -305,24 +351,15 @@ ResourceTexture* ModuleImporter::LoadEngineTexture(const char* path)
 {
 	ResourceTexture* texture = nullptr;
 
-	ILuint new_image_id = 0;
-	ilGenImages(1, &new_image_id);
-	ilBindImage(new_image_id);
-
-	ilutRenderer(ILUT_OPENGL);
+	uint width = 0;
+	uint height = 0;
+	unsigned char* pixels = ReadTexturePixels(path, &width, &height);
 
-	if (ilLoadImage(path)) {
-		iluFlipImage();
-		texture = new ResourceTexture(path, ilutGLBindTexImage(), ilGetInteger(IL_IMAGE_WIDTH), ilGetInteger(IL_IMAGE_HEIGHT));
+	if (pixels != nullptr) {
+		texture = new ResourceTexture(path);
+		UploadTexturePixels(texture, pixels, width, height);
 		texture->is_custom = false;
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glBindTexture(GL_TEXTURE_2D, texture->id);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
+		delete[] pixels;
 
 		App->resources->AddResource(texture);
 
@@ -330,47 +367,140 @@ ResourceTexture* ModuleImporter::LoadEngineTexture(const char* path)
 	}
 	else {
 		LOG_ENGINE("Error while loading image in %s", path);
-		LOG_ENGINE("Error: %s", ilGetString(ilGetError()));
 	}
 
-	ilDeleteImages(1, &new_image_id);
-
 	return texture;
 }
 
-void ModuleImporter::LoadTextureToResource(const char* path, ResourceTexture* texture)
+unsigned char* ModuleImporter::ReadTexturePixels(const char* path, uint* width, uint* height)
 {
+	unsigned char* pixels = nullptr;
+
+	std::lock_guard<std::mutex> lock(devil_mutex);
+
 	ILuint new_image_id = 0;
 	ilGenImages(1, &new_image_id);
 	ilBindImage(new_image_id);
 
-	ilutRenderer(ILUT_OPENGL);
-
-	if (ilLoadImage(path)) {
+	if (ilLoadImage(path) && ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE)) {
 		iluFlipImage();
 
-		texture->id = ilutGLBindTexImage();
-		texture->is_custom = true;
-		texture->width = ilGetInteger(IL_IMAGE_WIDTH);
-		texture->height = ilGetInteger(IL_IMAGE_HEIGHT);
+		*width = ilGetInteger(IL_IMAGE_WIDTH);
+		*height = ilGetInteger(IL_IMAGE_HEIGHT);
 
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glBindTexture(GL_TEXTURE_2D, texture->id);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		uint size = (*width) * (*height) * 4;
+		pixels = new unsigned char[size];
+		memcpy(pixels, ilGetData(), size);
+	}
 
-		glBindTexture(GL_TEXTURE_2D, 0);
+	ilDeleteImages(1, &new_image_id);
 
-		LOG_ENGINE("Texture successfully loaded: %s", path);
+	return pixels;
+}
+
+void ModuleImporter::UploadTexturePixels(ResourceTexture* texture, const unsigned char* pixels, uint width, uint height)
+{
+	// a texture read again gets a new one, the levels and the parameters of the old one don't stay
+	if (texture->id != 0) {
+		glDeleteTextures(1, &texture->id);
+		texture->id = 0;
 	}
-	else {
-		LOG_ENGINE("Error while loading image in %s", path);
-		LOG_ENGINE("Error: %s", ilGetString(ilGetError()));
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glGenTextures(1, &texture->id);
+	glBindTexture(GL_TEXTURE_2D, texture->id);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	// each level filtered from the previous one, like the cooked textures
+	uint mips_count = TextureCooker::GetMipsCount(width, height);
+	std::vector<unsigned char> level;
+	std::vector<unsigned char> next_level;
+	const unsigned char* source = pixels;
+	uint level_width = width;
+	uint level_height = height;
+	for (uint i = 1; i < mips_count; ++i) {
+		next_level.resize(std::max(level_width / 2, 1U) * std::max(level_height / 2, 1U) * 4);
+		TextureCooker::GenerateMip(source, level_width, level_height, next_level.data());
+		level.swap(next_level);
+		source = level.data();
+		level_width = std::max(level_width / 2, 1U);
+		level_height = std::max(level_height / 2, 1U);
+		glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level_width, level_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, source);
 	}
 
-	ilDeleteImages(1, &new_image_id);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mips_count - 1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	texture->is_custom = true;
+	texture->width = width;
+	texture->height = height;
+}
+
+uint ModuleImporter::CookTextures(const std::vector<ResourceTexture*>& textures)
+{
+	j1PerfTimer timer;
+
+	std::vector<ResourceTexture*> to_cook;
+	std::vector<bool> added;
+	std::vector<ResourceTexture*>::const_iterator item = textures.cbegin();
+	for (; item != textures.cend(); ++item) {
+		ResourceTexture* texture = *item;
+		bool is_added = texture->GetID() != 0 && App->resources->GetResourceWithID(texture->GetID()) == texture;
+
+		// the file is written again, the GL texture, the mapping and the pixels of the old one are dropped. Loaded, being
+		// loaded or cached, it is loaded again from the new file
+		App->resources->residency.Forget(texture);
+		texture->FreeMemory();
+
+		if (texture->PrepareMetaData(texture->GetID())) {
+			to_cook.push_back(texture);
+			added.push_back(is_added);
+		}
+		else {
+			LOG_ENGINE("Error while loading image in %s", texture->GetAssetsPath());
+			if (!is_added)
+				delete texture;
+		}
+	}
+
+	// decoding uses DevIL one texture at a time, the mips and the compression go in parallel
+	std::vector<std::pair<char*, uint>> files(to_cook.size(), { nullptr, 0 });
+	std::vector<TextureFormat> formats(to_cook.size(), TextureFormat::BC1);
+	ParallelFor(to_cook.size(), import_threads, [&to_cook, &files, &formats](uint i) {
+		files[i].first = to_cook[i]->CookMetaData(&files[i].second, &formats[i]);
+	});
+	last_cook_ms = timer.ReadMs();
+
+	// saving logs, the files are written here
+	timer.Start();
+	uint cooked = 0;
+	for (uint i = 0; i < to_cook.size(); ++i) {
+		ResourceTexture* texture = to_cook[i];
+		if (files[i].first == nullptr) {
+			LOG_ENGINE("Error while loading image in %s", texture->GetAssetsPath());
+			LOG_ENGINE("Error: %s", ilGetString(ilGetError()));
+			if (!added[i])
+				delete texture;
+			continue;
+		}
+
+		App->file_system->Save(texture->GetLibraryPath(), files[i].first, files[i].second);
+		delete[] files[i].first;
+		LOG_ENGINE("Cooked texture %s to %s (%s)", texture->GetAssetsPath(), texture->GetLibraryPath(), TextureCooker::GetFormatName(formats[i]));
+
+		App->resources->AddResource(texture);
+		if (texture->references > 0) {
+			texture->LoadMemory();
+		}
+		++cooked;
+	}
+	last_cook_save_ms = timer.ReadMs();
+	last_cook_textures = cooked;
+
+	return cooked;
 }
 
 void ModuleImporter::ApplyTextureToSelectedObject(ResourceTexture* texture)
@@ -411,49 +541,26 @@ void ModuleImporter::LoadParShapesMesh(par_shapes_mesh* shape, ResourceMesh* mes
 	mesh->num_index = shape->ntriangles * 3;
 
 	mesh->vertex = new float[mesh->num_vertex * 3];
-	mesh->index = new uint[mesh->num_index * 3];
+	mesh->index = new uint[mesh->num_index];
 
 	memcpy(mesh->vertex, shape->points, sizeof(float) * mesh->num_vertex * 3);
 	memcpy(mesh->index, shape->triangles, sizeof(PAR_SHAPES_T) * mesh->num_index);
 	
 	if (shape->tcoords != nullptr) {
-		mesh->uv_cords = new float[mesh->num_vertex * 3];
-		memcpy(mesh->uv_cords, shape->tcoords, sizeof(float) * mesh->num_vertex * 3);
+		mesh->uv_cords = new float[mesh->num_vertex * 2];
+		memcpy(mesh->uv_cords, shape->tcoords, sizeof(float) * mesh->num_vertex * 2);
 	}
 
 	if (shape->normals != nullptr) {
 		mesh->normals = new float[mesh->num_vertex * 3];
-
 		memcpy(mesh->normals, shape->normals, sizeof(float) * mesh->num_vertex * 3);
+	}
 
-		mesh->center_point_normal = new float[shape->ntriangles * 3];
-		mesh->center_point = new float[shape->ntriangles * 3];
-		mesh->num_faces = shape->ntriangles;
-		for (uint i = 0; i < mesh->num_index; i += 3)
-		{
-			uint index1 = mesh->index[i] * 3;
-			uint index2 = mesh->index[i + 1] * 3;
-			uint index3 = mesh->index[i + 2] * 3;
-
-			float3 x0(mesh->vertex[index1], mesh->vertex[index1 + 1], mesh->vertex[index1 + 2]);
-			float3 x1(mesh->vertex[index2], mesh->vertex[index2 + 1], mesh->vertex[index2 + 2]);
-			float3 x2(mesh->vertex[index3], mesh->vertex[index3 + 1], mesh->vertex[index3 + 2]);
-
-			float3 v0 = x0 - x2;
-			float3 v1 = x1 - x2;
-			float3 n = v0.Cross(v1);
-
-			float3 normalized = n.Normalized();
-
-			mesh->center_point[i] = (x0.x + x1.x + x2.x) / 3;
-			mesh->center_point[i + 1] = (x0.y + x1.y + x2.y) / 3;
-			mesh->center_point[i + 2] = (x0.z + x1.z + x2.z) / 3;
-
-			mesh->center_point_normal[i] = normalized.x;
-			mesh->center_point_normal[i + 1] = normalized.y;
-			mesh->center_point_normal[i + 2] = normalized.z;
-		}
+	// par_shapes_unweld leaves every triangle with its own vertices
+	if (optimize_meshes) {
+		mesh->Optimize();
 	}
+	mesh->GenerateFacesNormals();
 	mesh->InitBuffers();
 }
 
@@ -465,6 +572,7 @@ ResourceMesh* ModuleImporter::LoadEngineModels(const char* path)
 		aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_GenBoundingBoxes);
 
 	r_mesh = LoadNodeMesh(scene, scene->mRootNode, scene->mMeshes[0], nullptr);
+	ProcessMeshes();
 
 
 	aiReleaseImport(scene);
@@ -484,11 +592,13 @@ bool ModuleImporter::ReImportModel(ResourceModel* model)
 	if (scene != nullptr) {
 		model->name = App->file_system->GetBaseFileName(model->GetAssetsPath());
 		this->model = model;
+		model->textures_asked.clear();
 		// start recursive function to all nodes
 
 		for (uint i = 0; i < scene->mRootNode->mNumChildren; ++i) {
 			LoadSceneNode(scene->mRootNode->mChildren[i], scene, nullptr, 1);
 		}
+		ProcessMeshes();
 
 		// create the meta data files like .alien
 		if (model->CreateMetaData(model->ID)) {
@@ -507,5 +617,3 @@ bool ModuleImporter::ReImportModel(ResourceModel* model)
 	return ret;
 }
 
-
-
@@ -16,10 +16,13 @@
 #pragma comment (lib, "Devil/libx86/ILUT.lib")
 
 #include <vector>
+#include <mutex>
 #include "glew/include/glew.h"
 #include "GameObject.h"
 #include "ComponentMesh.h"
 #include "Shapes.h"
+#include "MeshOptimizer.h"
+#include "TextureCooker.h"
 
 #include "Devil/include/il.h"
 #include "Devil/include/ilu.h"
@@ -44,13 +47,47 @@ public:
 	void LoadParShapesMesh(par_shapes_mesh* p_mesh, ResourceMesh* mesh);
 	ResourceMesh* LoadEngineModels(const char* path);
 	bool ReImportModel(ResourceModel* model); // when dropped
+	// copy the arrays of the assimp mesh, optimize them, simplify the levels and compute the faces normals, can be
+	// called from any thread. Returns the faces that are not triangles
+	static uint ConvertMesh(ResourceMesh* mesh, const aiMesh* ai_mesh, bool optimize, bool lods, VertexCacheStats* before = nullptr, VertexCacheStats* after = nullptr);
 	
 	// textures
 	ResourceTexture* LoadTextureFile(const char* path, bool has_been_dropped = false, bool is_custom = true); // when dropped
 	ResourceTexture* LoadEngineTexture(const char* path);
-	void LoadTextureToResource(const char* path, ResourceTexture* texture);
+	// decode the image to RGBA, can be called from any thread. The pixels are deleted with delete[]
+	unsigned char* ReadTexturePixels(const char* path, uint* width, uint* height);
+	// main thread, create the GL texture of the resource with its mips, for the icons and the .dds saved before the cooker.
+	// The texture it had is deleted
+	void UploadTexturePixels(ResourceTexture* texture, const unsigned char* pixels, uint width, uint height);
+	// cook the assets of the textures to block compressed .dds with all their mips in parallel and add them. The ones
+	// loaded are freed and loaded again, the new ones that can't be cooked are deleted. Returns the textures cooked
+	uint CookTextures(const std::vector<ResourceTexture*>& textures);
 	void ApplyTextureToSelectedObject(ResourceTexture* texture);
 
+public:
+
+	// DevIL has one state for the whole process, it can be used only by one thread at a time
+	std::mutex devil_mutex;
+
+	// threads converting and serializing the meshes of a model, 0 uses one for each core
+	uint import_threads = 0;
+	// weld and reorder the meshes for the vertex cache, the overdraw and the vertex fetch when they are imported
+	bool optimize_meshes = true;
+	// simplified levels of the meshes drawn when they are small on the screen
+	bool generate_lods = true;
+
+	// phases of the last model imported
+	uint last_import_meshes = 0;
+	double last_convert_ms = 0.0;
+	double last_upload_ms = 0.0;
+	double last_serialize_ms = 0.0;
+	double last_save_ms = 0.0;
+
+	// last textures cooked, the ms decoding and compressing them and the ms saving them
+	uint last_cook_textures = 0;
+	double last_cook_ms = 0.0;
+	double last_cook_save_ms = 0.0;
+
 private:
 	
 	// models
@@ -59,10 +96,14 @@ private:
 	// mesh
 	void LoadSceneNode(const aiNode* node, const aiScene* scene, ResourceMesh* parent, uint family_number);
 	ResourceMesh* LoadNodeMesh(const aiScene * scene, const aiNode* node, const aiMesh* mesh, ResourceMesh* parent);
+	// convert the meshes found in the nodes in parallel and create their buffers
+	void ProcessMeshes();
 
 private:
 
 	ResourceModel* model = nullptr;
+	// meshes created while walking the nodes, converted after it
+	std::vector<std::pair<ResourceMesh*, const aiMesh*>> meshes_to_convert;
 };
 
 
@@ -15,6 +15,7 @@
 #include "Prefab.h"
 #include "ResourcePrefab.h"
 #include "ModuleRenderer3D.h"
+#include "FrustumCulling.h"
 #include "ComponentScript.h"
 #include "PanelHierarchy.h"
 #include "Gizmos.h"
@@ -22,6 +23,9 @@
 #define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
 #include <experimental/filesystem>
 #include "ResourceScript.h"
+#include "SceneBinary.h"
+#include "PoolAllocator.h"
+#include <unordered_map>
 #include "mmgr/mmgr.h"
 
 ModuleObjects::ModuleObjects(bool start_enabled):Module(start_enabled)
@@ -138,6 +142,10 @@ update_status ModuleObjects::PreUpdate(float dt)
 	}
 
 	ScriptsPreUpdate();
+
+	// solve the transforms changed this frame before cameras and culling read them
+	transform_hierarchy.Update(base_game_object);
+	dynamic_tree.Update(component_registry.GetComponents(ComponentType::MESH));
 	return UPDATE_CONTINUE;
 }
 
@@ -150,6 +158,10 @@ update_status ModuleObjects::Update(float dt)
 update_status ModuleObjects::PostUpdate(float dt)
 {
 	ScriptsPostUpdate();
+	transform_hierarchy.Update(base_game_object);
+	dynamic_tree.Update(component_registry.GetComponents(ComponentType::MESH));
+
+	ClearRenderQueues();
 #ifndef GAME_VERSION
 	if (App->renderer3D->SetCameraToDraw(App->camera->fake_camera)) {
 		printing_scene = true;
@@ -174,8 +186,6 @@ update_status ModuleObjects::PostUpdate(float dt)
 			octree.Draw();
 
 		if (base_game_object->HasChildren()) {
-			std::vector<std::pair<float, GameObject*>> to_draw;
-
 			ComponentCamera* frustum_camera = nullptr;
 
 			if (!check_culling_in_scene)
@@ -190,14 +200,7 @@ update_status ModuleObjects::PostUpdate(float dt)
 				frustum_camera = App->camera->fake_camera;
 			}
 
-			octree.SetStaticDrawList(&to_draw, frustum_camera);
-
-			std::vector<GameObject*>::iterator item = base_game_object->children.begin();
-			for (; item != base_game_object->children.end(); ++item) {
-				if (*item != nullptr && (*item)->IsEnabled()) {
-					(*item)->SetDrawList(&to_draw, frustum_camera);
-				}
-			}
+			const RenderQueue* render_queue = GetRenderQueue(frustum_camera);
 			
 			if (prefab_scene) {
 				static float light_ambient[] = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -206,13 +209,7 @@ update_status ModuleObjects::PostUpdate(float dt)
 				glLightfv(GL_LIGHT0, GL_DIFFUSE, light_diffuse);
 				glEnable(GL_LIGHT0);
 			}
-			std::sort(to_draw.begin(), to_draw.end(), ModuleObjects::SortGameObjectToDraw);
-			std::vector<std::pair<float, GameObject*>>::iterator it = to_draw.begin();
-			for (; it != to_draw.end(); ++it) {
-				if ((*it).second != nullptr) {
-					(*it).second->DrawScene();
-				}
-			}
+			DrawRenderQueue(render_queue, App->camera->fake_camera, true);
 			OnDrawGizmos();
 		}
 
@@ -237,25 +234,10 @@ update_status ModuleObjects::PostUpdate(float dt)
 		if (base_game_object->HasChildren()) {
 
 			OnPreCull(App->renderer3D->actual_game_camera);
-			std::vector<std::pair<float, GameObject*>> to_draw;
-			octree.SetStaticDrawList(&to_draw, App->renderer3D->actual_game_camera);
-
-			std::vector<GameObject*>::iterator item = base_game_object->children.begin();
-			for (; item != base_game_object->children.end(); ++item) {
-				if (*item != nullptr && (*item)->IsEnabled()) {
-					(*item)->SetDrawList(&to_draw, App->renderer3D->actual_game_camera);
-				}
-			}
-
-			std::sort(to_draw.begin(), to_draw.end(), ModuleObjects::SortGameObjectToDraw);
+			const RenderQueue* render_queue = GetRenderQueue(App->renderer3D->actual_game_camera);
 
 			OnPreRender(App->renderer3D->actual_game_camera);
-			std::vector<std::pair<float, GameObject*>>::iterator it = to_draw.begin();
-			for (; it != to_draw.end(); ++it) {
-				if ((*it).second != nullptr) {
-					(*it).second->DrawGame();
-				}
-			}
+			DrawRenderQueue(render_queue, App->renderer3D->actual_game_camera, false);
 
 			OnPostRender(App->renderer3D->actual_game_camera);
 		}
@@ -279,24 +261,9 @@ update_status ModuleObjects::PostUpdate(float dt)
 			App->renderer3D->RenderGrid();
 
 		if (base_game_object->HasChildren()) {
-			std::vector<std::pair<float, GameObject*>> to_draw;
-
-			octree.SetStaticDrawList(&to_draw, App->renderer3D->selected_game_camera);
-
-			std::vector<GameObject*>::iterator item = base_game_object->children.begin();
-			for (; item != base_game_object->children.end(); ++item) {
-				if (*item != nullptr && (*item)->IsEnabled()) {
-					(*item)->SetDrawList(&to_draw, App->renderer3D->selected_game_camera);
-				}
-			}
+			const RenderQueue* render_queue = GetRenderQueue(App->renderer3D->selected_game_camera);
 
-			std::sort(to_draw.begin(), to_draw.end(), ModuleObjects::SortGameObjectToDraw);
-			std::vector<std::pair<float, GameObject*>>::iterator it = to_draw.begin();
-			for (; it != to_draw.end(); ++it) {
-				if ((*it).second != nullptr) {
-					(*it).second->DrawGame();
-				}
-			}
+			DrawRenderQueue(render_queue, App->renderer3D->selected_game_camera, false);
 		}
 
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
@@ -306,33 +273,225 @@ update_status ModuleObjects::PostUpdate(float dt)
 	if (base_game_object->HasChildren() && App->renderer3D->actual_game_camera != nullptr) {
 		
 		OnPreCull(App->renderer3D->actual_game_camera);
-		std::vector<std::pair<float, GameObject*>> to_draw;
-
-		octree.SetStaticDrawList(&to_draw, App->renderer3D->actual_game_camera);
 		if (allow_grid) {
 			App->renderer3D->RenderGrid();
 		}
-		std::vector<GameObject*>::iterator item = base_game_object->children.begin();
-		for (; item != base_game_object->children.end(); ++item) {
-			if (*item != nullptr && (*item)->IsEnabled()) {
-				(*item)->SetDrawList(&to_draw, App->renderer3D->actual_game_camera);
-			}
-		}
+		const RenderQueue* render_queue = GetRenderQueue(App->renderer3D->actual_game_camera);
 
-		std::sort(to_draw.begin(), to_draw.end(), ModuleObjects::SortGameObjectToDraw);
 		OnPreRender(App->renderer3D->actual_game_camera);
-		std::vector<std::pair<float, GameObject*>>::iterator it = to_draw.begin();
-		for (; it != to_draw.end(); ++it) {
-			if ((*it).second != nullptr) {
-				(*it).second->DrawGame();
-			}
-		}
+		DrawRenderQueue(render_queue, App->renderer3D->actual_game_camera, false);
 		OnPostRender(App->renderer3D->actual_game_camera);
 	}
 #endif
 	return UPDATE_CONTINUE;
 }
 
+void ModuleObjects::SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum)
+{
+	if (use_component_systems) {
+		SetDrawListSystems(to_draw, camera, frustum);
+		return;
+	}
+
+	std::vector<GameObject*>::iterator item = base_game_object->children.begin();
+	for (; item != base_game_object->children.end(); ++item) {
+		if (*item != nullptr && (*item)->IsEnabled()) {
+			(*item)->SetDrawList(to_draw, camera, frustum);
+		}
+	}
+}
+
+void ModuleObjects::SetDrawListSystems(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum)
+{
+	transform_hierarchy.UpdateActive(base_game_object);
+	j1PerfTimer timer;
+
+	// cameras
+	const std::vector<Component*>& cameras = component_registry.GetComponents(ComponentType::CAMERA);
+	for (uint i = 0; i < cameras.size(); ++i) {
+		ComponentCamera* camera_ = (ComponentCamera*)cameras[i];
+		ComponentTransform* transform = (ComponentTransform*)camera_->game_object_attached->GetComponent(ComponentType::TRANSFORM);
+		if (!camera_->IsEnabled() || !ComponentRegistry::IsFirstOfType(camera_) || transform == nullptr || !transform_hierarchy.IsActive(transform))
+			continue;
+
+		if (printing_scene && draw_frustum && camera_->game_object_attached->IsSelected()) {
+			camera_->DrawFrustum();
+		}
+		camera_->frustum.pos = transform->GetGlobalPosition();
+		camera_->frustum.front = transform->GetGlobalRotation().WorldZ();
+		camera_->frustum.up = transform->GetGlobalRotation().WorldY();
+
+		if (printing_scene) {
+			camera_->DrawIconCamera();
+		}
+	}
+	cameras_system_ms = timer.ReadMs();
+	timer.Start();
+
+	// lights
+	const std::vector<Component*>& lights = component_registry.GetComponents(ComponentType::LIGHT);
+	for (uint i = 0; i < lights.size(); ++i) {
+		ComponentLight* light = (ComponentLight*)lights[i];
+		ComponentTransform* transform = (ComponentTransform*)light->game_object_attached->GetComponent(ComponentType::TRANSFORM);
+		if (!light->IsEnabled() || !ComponentRegistry::IsFirstOfType(light) || transform == nullptr || !transform_hierarchy.IsActive(transform))
+			continue;
+
+		light->LightLogic();
+		if (printing_scene) {
+			light->DrawIconLight();
+		}
+	}
+	lights_system_ms = timer.ReadMs();
+	timer.Start();
+
+	// the culling is reused from another camera
+	if (to_draw == nullptr)
+		return;
+
+	// dynamic meshes, static ones come from the octree
+	if (use_dynamic_tree) {
+		static std::vector<ComponentMesh*> meshes;
+		meshes.clear();
+		dynamic_tree.GetMeshesInFrustum(frustum, &meshes);
+
+		for (uint i = 0; i < meshes.size(); ++i) {
+			ComponentTransform* transform = (ComponentTransform*)meshes[i]->game_object_attached->GetComponent(ComponentType::TRANSFORM);
+			if (transform != nullptr && transform_hierarchy.IsActive(transform)) {
+				float distance = camera->frustum.pos.Distance(transform->GetGlobalPosition());
+				to_draw->push_back({ distance, meshes[i]->game_object_attached });
+			}
+		}
+	}
+	else {
+		// gather the AABBs as SoA and test them 4 by 4
+		static std::vector<ComponentTransform*> transforms;
+		static std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+		static std::vector<unsigned char> inside;
+		transforms.clear();
+		min_x.clear(); min_y.clear(); min_z.clear();
+		max_x.clear(); max_y.clear(); max_z.clear();
+
+		const std::vector<Component*>& meshes = component_registry.GetComponents(ComponentType::MESH);
+		for (uint i = 0; i < meshes.size(); ++i) {
+			ComponentMesh* mesh = (ComponentMesh*)meshes[i];
+			GameObject* object = mesh->game_object_attached;
+			if (object->is_static || mesh->mesh == nullptr || !ComponentRegistry::IsFirstOfType(mesh))
+				continue;
+
+			ComponentTransform* transform = (ComponentTransform*)object->GetComponent(ComponentType::TRANSFORM);
+			if (transform == nullptr || !transform_hierarchy.IsActive(transform))
+				continue;
+
+			const AABB& aabb = mesh->global_aabb;
+			transforms.push_back(transform);
+			min_x.push_back(aabb.minPoint.x); min_y.push_back(aabb.minPoint.y); min_z.push_back(aabb.minPoint.z);
+			max_x.push_back(aabb.maxPoint.x); max_y.push_back(aabb.maxPoint.y); max_z.push_back(aabb.maxPoint.z);
+		}
+
+		inside.resize(transforms.size());
+		if (!transforms.empty()) {
+			frustum.AreInside(min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data(), transforms.size(), inside.data());
+		}
+
+		for (uint i = 0; i < transforms.size(); ++i) {
+			if (inside[i] != 0) {
+				float distance = camera->frustum.pos.Distance(transforms[i]->GetGlobalPosition());
+				to_draw->push_back({ distance, transforms[i]->game_object_attached });
+			}
+		}
+	}
+	meshes_system_ms = timer.ReadMs();
+}
+
+const RenderQueue* ModuleObjects::GetRenderQueue(ComponentCamera* camera)
+{
+	// the culling of a camera with the same frustum is reused, but cameras and lights must be updated for this one
+	if (use_component_systems) {
+		std::vector<ComponentCamera*>::iterator item = cameras_drawn.begin();
+		for (; item != cameras_drawn.end(); ++item) {
+			if ((*item)->render_queue.IsBuiltFor(camera->frustum)) {
+				SetDrawListSystems(nullptr, camera, (*item)->render_queue.GetCulling());
+				++render_queues_shared;
+				return &(*item)->render_queue;
+			}
+		}
+	}
+
+	j1PerfTimer timer;
+	RenderQueue* render_queue = &camera->render_queue;
+	std::vector<std::pair<float, GameObject*>>* to_draw = render_queue->Begin(camera->frustum);
+	octree.SetStaticDrawList(to_draw, camera, render_queue->GetCulling());
+	SetDrawList(to_draw, camera, render_queue->GetCulling());
+	render_queues_culling_ms += timer.ReadMs();
+	render_queue->Sort();
+
+	cameras_drawn.push_back(camera);
+	++render_queues_built;
+	render_queues_objects += render_queue->GetCount();
+	render_queues_sort_ms += render_queue->GetLastSortMs();
+
+	return render_queue;
+}
+
+void ModuleObjects::ClearRenderQueues()
+{
+	++lod_frame;
+	cameras_drawn.clear();
+	render_queues_built = 0;
+	render_queues_shared = 0;
+	render_queues_objects = 0;
+	render_queues_culling_ms = 0.0;
+	render_queues_sort_ms = 0.0;
+	render_batches = 0;
+	render_batched_objects = 0;
+}
+
+void ModuleObjects::DrawRenderQueue(const RenderQueue* render_queue, const ComponentCamera* camera, bool scene)
+{
+	std::vector<RenderQueueItem>::const_iterator lod_item = render_queue->GetItems().cbegin();
+	for (; lod_item != render_queue->GetItems().cend(); ++lod_item) {
+		if ((*lod_item).object != nullptr) {
+			ComponentMesh* mesh = (ComponentMesh*)(*lod_item).object->GetComponent(ComponentType::MESH);
+			if (mesh != nullptr)
+				mesh->SelectLOD(camera);
+		}
+	}
+
+	if (!use_render_batches) {
+		std::vector<RenderQueueItem>::const_iterator it = render_queue->GetItems().cbegin();
+		for (; it != render_queue->GetItems().cend(); ++it) {
+			if ((*it).object != nullptr) {
+				if (scene)
+					(*it).object->DrawScene();
+				else
+					(*it).object->DrawGame();
+			}
+		}
+		return;
+	}
+
+	render_batcher.Build(render_queue->GetItems(), scene);
+	render_batcher.Draw();
+	render_batches += render_batcher.GetBatchesCount();
+	render_batched_objects += render_batcher.GetBatchedObjects().size();
+
+	if (scene) {
+		std::vector<GameObject*>::const_iterator item = render_batcher.GetBatchedObjects().cbegin();
+		for (; item != render_batcher.GetBatchedObjects().cend(); ++item) {
+			(*item)->DrawSceneDebug();
+		}
+	}
+
+	// transparent and selected objects, still far first
+	std::vector<GameObject*>::const_iterator item = render_batcher.GetUnbatchedObjects().cbegin();
+	for (; item != render_batcher.GetUnbatchedObjects().cend(); ++item) {
+		if (scene)
+			(*item)->DrawScene();
+		else
+			(*item)->DrawGame();
+	}
+}
+
 void ModuleObjects::DrawRay()
 {
 	if (App->camera->ray.IsFinite()) {
@@ -358,13 +517,12 @@ bool ModuleObjects::CleanUp()
 
 	delete base_game_object;
 	base_game_object = nullptr;
+	transform_hierarchy.Clear();
 	
-	if (octree.root != nullptr) {
-		delete octree.root;
-		octree.root = nullptr;
-	}
+	octree.Clear();
 
 	DeleteReturns();
+	ObjectAllocator::ReleaseUnused();
 	
 	return true;
 }
@@ -879,6 +1037,7 @@ void ModuleObjects::MoveComponentDown(GameObject* object, Component* component,
 			}
 		}
 	}
+	object->RebuildComponentSlots();
 }
 
 void ModuleObjects::MoveComponentUp(GameObject* object, Component* component, bool top)
@@ -902,6 +1061,7 @@ void ModuleObjects::MoveComponentUp(GameObject* object, Component* component, bo
 			}
 		}
 	}
+	object->RebuildComponentSlots();
 }
 
 GameObject* ModuleObjects::GetGameObjectByID(const u64& id)
@@ -923,34 +1083,40 @@ void ModuleObjects::SaveScene(ResourceScene* to_load_scene, const char* force_wi
 		return;
 	}
 
-	std::string meta_path;
-	JSON_Value* value = json_value_init_object();
-	JSON_Object* object = json_value_get_object(value);
+	// the scenes of the editor, like the one of the play mode, are only loaded back by the engine
+	if (force_with_path != nullptr) {
+		SaveSceneBinary(force_with_path, "NONE");
+		return;
+	}
 
-	if (force_with_path == nullptr) {
-		// remove the last save and save the new
-		remove(to_load_scene->GetLibraryPath());
-		meta_path = to_load_scene->GetAssetsPath();
-		remove(meta_path.data());
+	// remove the last save and save the new. The assets keep the JSON to diff and merge it and the library the
+	// binary the engine loads, written after it so it is never older
+	remove(to_load_scene->GetLibraryPath());
+	remove(to_load_scene->GetAssetsPath());
+
+	if (SaveSceneJSON(to_load_scene->GetAssetsPath(), to_load_scene->GetName())) {
+		SaveSceneBinary(to_load_scene->GetLibraryPath(), to_load_scene->GetName());
+		current_scene = to_load_scene;
 	}
 	else {
-		meta_path = std::string(force_with_path);
+		LOG_ENGINE("Could not load scene, fail when creating the file");
 	}
-	
-	json_serialize_to_file_pretty(value, meta_path.data());
+}
+
+bool ModuleObjects::SaveSceneJSON(const char* path, const char* scene_name)
+{
+	JSON_Value* value = json_value_init_object();
+	JSON_Object* object = json_value_get_object(value);
+
+	json_serialize_to_file_pretty(value, path);
 
 	if (value != nullptr && object != nullptr)
 	{
-		JSONfilepack* scene = new JSONfilepack(meta_path.data(), object, value);
+		JSONfilepack* scene = new JSONfilepack(path, object, value);
 
 		scene->StartSave();
 
-		if (force_with_path == nullptr) {
-			scene->SetString("Scene.Name", to_load_scene->GetName());
-		}
-		else {
-			scene->SetString("Scene.Name", "NONE");
-		}
+		scene->SetString("Scene.Name", scene_name);
 
 		if (!base_game_object->children.empty()) { // if base game objects has children, save them
 			JSONArraypack* game_objects = scene->InitNewArray("Scene.GameObjects");
@@ -969,18 +1135,32 @@ void ModuleObjects::SaveScene(ResourceScene* to_load_scene, const char* force_wi
 
 		scene->FinishSave();
 		delete scene;
-		if (force_with_path == nullptr) {
-			current_scene = to_load_scene;
-			std::experimental::filesystem::copy(to_load_scene->GetAssetsPath(), to_load_scene->GetLibraryPath());
-		}
+		return true;
 	}
-	else {
-		LOG_ENGINE("Could not load scene, fail when creating the file");
+	return false;
+}
+
+bool ModuleObjects::SaveSceneBinary(const char* path, const char* scene_name)
+{
+	SceneWriter scene;
+	scene.WriteHeader(scene_name);
+
+	uint objects_count = 0;
+	std::vector<GameObject*>::iterator item = base_game_object->children.begin();
+	for (; item != base_game_object->children.end(); ++item) {
+		if (*item != nullptr) {
+			SaveGameObject(*item, &scene, -1, &objects_count);
+		}
 	}
+	scene.SetObjectsCount(objects_count);
+
+	return App->file_system->Save(path, scene.GetData(), scene.GetSize()) == scene.GetSize();
 }
 
 void ModuleObjects::LoadScene(const char * name, bool change_scene)
 {
+	j1PerfTimer timer;
+
 	ResourceScene* to_load = App->resources->GetSceneByName(name);
 	if (to_load != nullptr || !change_scene) {
 
@@ -992,116 +1172,312 @@ void ModuleObjects::LoadScene(const char * name, bool change_scene)
 			path = name;
 		}
 
-		JSON_Value* value = json_parse_file(path.data());
+		// the library has the binary scenes, the JSON ones are there until the scene is saved from the editor
+		char* data = nullptr;
+		uint size = App->file_system->Load(path.data(), &data);
+		SceneReader reader(data, size);
+		std::string scene_name;
+		uint objects_count = 0;
+		bool binary = reader.ReadHeader(&scene_name, &objects_count);
+
+		JSON_Value* value = (!binary) ? App->file_system->LoadJSON(path.data()) : nullptr;
 		JSON_Object* object = json_value_get_object(value);
 
-		if (value != nullptr && object != nullptr)
+		if (binary || (value != nullptr && object != nullptr))
 		{
-			octree.Clear();
-			Gizmos::ClearAllCurrentGizmos();
-			delete base_game_object;
-			game_objects_selected.clear();
-			base_game_object = new GameObject();
-			base_game_object->ID = 0;
-			base_game_object->is_static = true;
+			ClearScene();
 
 			if (Time::IsInGameState()) {
 				CleanUpScriptsOnStop();
 			}
 			current_scripts.clear();
 
-			JSONfilepack* scene = new JSONfilepack(path.data(), object, value);
+			// static objects are saved while loading and the octree is built once with all of them
+			octree.BeginBulkInsert();
 
-			JSONArraypack* game_objects = scene->GetArray("Scene.GameObjects");
-
-			if (game_objects != nullptr) {
-			// first is family number, second parentID, third is array index in the json file
-				std::vector<std::tuple<uint, u64, uint>> objects_to_create;
-
-				for (uint i = 0; i < game_objects->GetArraySize(); ++i) {
-					uint family_number = game_objects->GetNumber("FamilyNumber");
-					u64 parentID = std::stoull(game_objects->GetString("ParentID"));
-					objects_to_create.push_back({ family_number,parentID, i });
-					game_objects->GetAnotherNode();
-				}
-				std::sort(objects_to_create.begin(), objects_to_create.end(), ModuleObjects::SortByFamilyNumber);
-				game_objects->GetFirstNode();
-				std::vector<GameObject*> objects_created;
-
-				std::vector<std::tuple<uint, u64, uint>>::iterator item = objects_to_create.begin();
-				for (; item != objects_to_create.end(); ++item) {
-					game_objects->GetNode(std::get<2>(*item));
-					GameObject* obj = new GameObject();
-					if (std::get<0>(*item) == 1) { // family number == 1 so parent is the base game object
-						obj->LoadObject(game_objects, base_game_object);
-					}
-					else { // search parent
-						std::vector<GameObject*>::iterator objects = objects_created.begin();
-						for (; objects != objects_created.end(); ++objects) {
-							if ((*objects)->ID == std::get<1>(*item)) {
-								obj->LoadObject(game_objects, *objects);
-								break;
-							}
-						}
-					}
-					objects_created.push_back(obj);
+			if (binary) {
+				if (!LoadSceneBinary(&reader, objects_count)) {
+					LOG_ENGINE("Scene %s is broken, it was loaded until the error", path.data());
 				}
+			}
+			else {
+				JSONfilepack* scene = new JSONfilepack(path.data(), object, value);
+				LoadSceneJSON(scene);
 				delete scene;
+			}
 
-				if (change_scene) {
-					struct stat file;
-					stat(path.data(), &file);
-
-					// refresh prefabs if are not locked
-					std::vector<GameObject*> prefab_roots;
-					base_game_object->GetAllPrefabRoots(prefab_roots);
-
-					for (uint i = 0; i < prefab_roots.size(); ++i) {
-						if (prefab_roots[i] != nullptr && !prefab_roots[i]->prefab_locked) {
-							ResourcePrefab* prefab = (ResourcePrefab*)App->resources->GetResourceWithID(prefab_roots[i]->GetPrefabID());
-							if (prefab != nullptr && prefab->GetID() != 0) {
-								struct stat prefab_file;
-								// TODO: when passing to library change
-								if (stat(prefab->GetAssetsPath(), &prefab_file) == 0) {
-									if (prefab_file.st_mtime > file.st_mtime) {
-										auto find = prefab_roots[i]->parent->children.begin();
-										for (; find != prefab_roots[i]->parent->children.end(); ++find) {
-											if (*find == prefab_roots[i]) {
-												prefab->ConvertToGameObjects(prefab_roots[i]->parent, find - prefab_roots[i]->parent->children.begin(), (*find)->GetComponent<ComponentTransform>()->GetGlobalPosition());
-												prefab_roots[i]->ToDelete();
-												break;
-											}
+			if (change_scene) {
+				struct stat file;
+				stat(path.data(), &file);
+
+				// refresh prefabs if are not locked
+				std::vector<GameObject*> prefab_roots;
+				base_game_object->GetAllPrefabRoots(prefab_roots);
+
+				for (uint i = 0; i < prefab_roots.size(); ++i) {
+					if (prefab_roots[i] != nullptr && !prefab_roots[i]->prefab_locked) {
+						ResourcePrefab* prefab = (ResourcePrefab*)App->resources->GetResourceWithID(prefab_roots[i]->GetPrefabID());
+						if (prefab != nullptr && prefab->GetID() != 0) {
+							struct stat prefab_file;
+							// TODO: when passing to library change
+							if (stat(prefab->GetAssetsPath(), &prefab_file) == 0) {
+								if (prefab_file.st_mtime > file.st_mtime) {
+									auto find = prefab_roots[i]->parent->children.begin();
+									for (; find != prefab_roots[i]->parent->children.end(); ++find) {
+										if (*find == prefab_roots[i]) {
+											prefab->ConvertToGameObjects(prefab_roots[i]->parent, find - prefab_roots[i]->parent->children.begin(), (*find)->GetComponent<ComponentTransform>()->GetGlobalPosition());
+											prefab_roots[i]->ToDelete();
+											break;
 										}
 									}
 								}
 							}
 						}
 					}
-					DeleteReturns();
 				}
+				DeleteReturns();
+			}
+			octree.EndBulkInsert();
 
-				if (!to_add.empty()) {
-					auto item = to_add.begin();
-					for (; item != to_add.end(); ++item) {
-						GameObject* found = GetGameObjectByID((*item).first);
-						if (found != nullptr) {
-							*(*item).second = found;
-						}
-					}
-				}
+			ResolveScriptObjects();
 
-				if (!current_scripts.empty() && Time::IsInGameState()) {
-					InitScriptsOnPlay();
-				}
+			if (!current_scripts.empty() && Time::IsInGameState()) {
+				InitScriptsOnPlay();
 			}
 			current_scene = to_load;
+
+			App->resources->last_scene_load_ms = timer.ReadMs();
+			App->resources->last_scene_load_resources = App->resources->resources.size();
 		}
 		else {
 			LOG_ENGINE("Error loading scene %s", path.data());
 		}
+		delete[] data;
+	}
+}
+
+bool ModuleObjects::LoadSceneBinary(SceneReader* scene, uint objects_count)
+{
+	// the objects are after their parent, its index is always of an object created before
+	std::vector<GameObject*> objects_created;
+	objects_created.reserve(objects_count);
+
+	for (uint i = 0; i < objects_count; ++i) {
+		int parent_index = scene->Read<int>();
+		if (scene->Failed() || parent_index >= (int)i)
+			return false;
+
+		GameObject* obj = new GameObject();
+		obj->LoadObject(scene, (parent_index < 0) ? base_game_object : objects_created[parent_index]);
+		objects_created.push_back(obj);
+	}
+	return !scene->Failed();
+}
+
+void ModuleObjects::LoadSceneJSON(JSONfilepack* scene)
+{
+	JSONArraypack* game_objects = scene->GetArray("Scene.GameObjects");
+	if (game_objects == nullptr)
+		return;
+
+	// first is family number, second parentID, third is array index in the json file
+	std::vector<std::tuple<uint, u64, uint>> objects_to_create;
+
+	for (uint i = 0; i < game_objects->GetArraySize(); ++i) {
+		uint family_number = game_objects->GetNumber("FamilyNumber");
+		u64 parentID = std::stoull(game_objects->GetString("ParentID"));
+		objects_to_create.push_back({ family_number,parentID, i });
+		game_objects->GetAnotherNode();
+	}
+	// stable, the children keep their order
+	std::stable_sort(objects_to_create.begin(), objects_to_create.end(), ModuleObjects::SortByFamilyNumber);
+	game_objects->GetFirstNode();
+	std::unordered_map<u64, GameObject*> objects_created;
+	objects_created.reserve(objects_to_create.size());
+
+	std::vector<std::tuple<uint, u64, uint>>::iterator item = objects_to_create.begin();
+	for (; item != objects_to_create.end(); ++item) {
+		game_objects->GetNode(std::get<2>(*item));
+		GameObject* obj = new GameObject();
+		if (std::get<0>(*item) == 1) { // family number == 1 so parent is the base game object
+			obj->LoadObject(game_objects, base_game_object);
+		}
+		else { // search parent
+			std::unordered_map<u64, GameObject*>::iterator parent = objects_created.find(std::get<1>(*item));
+			if (parent == objects_created.end()) {
+				delete obj;
+				continue;
+			}
+			obj->LoadObject(game_objects, (*parent).second);
+		}
+		objects_created[obj->ID] = obj;
+	}
+}
+
+void ModuleObjects::ClearScene()
+{
+	octree.Clear();
+	Gizmos::ClearAllCurrentGizmos();
+	delete base_game_object;
+	game_objects_selected.clear();
+	base_game_object = new GameObject();
+	base_game_object->ID = 0;
+	base_game_object->is_static = true;
+	transform_hierarchy.Clear();
+}
+
+void ModuleObjects::ResolveScriptObjects()
+{
+	if (!to_add.empty()) {
+		auto item = to_add.begin();
+		for (; item != to_add.end(); ++item) {
+			GameObject* found = GetGameObjectByID((*item).first);
+			if (found != nullptr) {
+				*(*item).second = found;
+			}
+		}
+		// the scripts that asked for them are deleted with the next scene
+		to_add.clear();
+	}
+}
+
+void ModuleObjects::TakePlaySnapshot()
+{
+	play_snapshot.data.Clear();
+	play_snapshot.objects.clear();
+
+	std::vector<GameObject*>::iterator item = base_game_object->children.begin();
+	for (; item != base_game_object->children.end(); ++item) {
+		if (*item != nullptr) {
+			SnapshotGameObject(*item, -1, &play_snapshot);
+		}
+	}
+	play_snapshot.taken = true;
+	play_snapshot_bytes = play_snapshot.data.GetSize();
+}
+
+void ModuleObjects::SnapshotGameObject(GameObject* obj, int parent_index, SceneSnapshot* snapshot)
+{
+	int index = (int)snapshot->objects.size();
+
+	SnapshotObject object;
+	object.ID = obj->ID;
+	object.parent_index = parent_index;
+	object.begin = snapshot->data.GetSize();
+	obj->SaveObject(&snapshot->data);
+	object.end = snapshot->data.GetSize();
+	object.has_scripts = obj->GetComponent(ComponentType::SCRIPT) != nullptr;
+	snapshot->objects.push_back(object);
+
+	std::vector<GameObject*>::iterator item = obj->children.begin();
+	for (; item != obj->children.end(); ++item) {
+		if (*item != nullptr) {
+			SnapshotGameObject(*item, index, snapshot);
+		}
 	}
 }
 
+void ModuleObjects::RestorePlaySnapshot()
+{
+	play_objects_reused = 0;
+	play_objects_loaded = 0;
+	play_objects_removed = 0;
+
+	if (!play_snapshot.taken)
+		return;
+
+	// the objects by their ID, the ones created in the play mode are not in the snapshot
+	std::unordered_map<u64, GameObject*> live_objects;
+	std::vector<GameObject*> to_visit(base_game_object->children.begin(), base_game_object->children.end());
+	while (!to_visit.empty()) {
+		GameObject* obj = to_visit.back();
+		to_visit.pop_back();
+		if (obj != nullptr) {
+			live_objects[obj->ID] = obj;
+			to_visit.insert(to_visit.end(), obj->children.begin(), obj->children.end());
+		}
+	}
+
+	// an object is reused if it has the same parent as before, nothing to delete and the same record. The parents
+	// are before the children, a child of an object loaded again is loaded again too
+	std::vector<GameObject*> objects(play_snapshot.objects.size(), nullptr);
+	std::unordered_set<const GameObject*> reused;
+	SceneWriter record;
+	for (uint i = 0; i < play_snapshot.objects.size(); ++i) {
+		const SnapshotObject& saved = play_snapshot.objects[i];
+		std::unordered_map<u64, GameObject*>::iterator found = live_objects.find(saved.ID);
+		if (saved.has_scripts || found == live_objects.end())
+			continue;
+
+		GameObject* live = (*found).second;
+		GameObject* parent = (saved.parent_index < 0) ? base_game_object : objects[saved.parent_index];
+		if (live->parent != parent || live->to_delete)
+			continue;
+
+		bool components_deleted = false;
+		std::vector<Component*>::iterator item = live->components.begin();
+		for (; item != live->components.end(); ++item) {
+			if (*item != nullptr && !(*item)->not_destroy) {
+				components_deleted = true;
+				break;
+			}
+		}
+		if (components_deleted)
+			continue;
+
+		record.Clear();
+		live->SaveObject(&record);
+		if (record.GetSize() == saved.end - saved.begin && memcmp(record.GetData(), play_snapshot.data.GetData() + saved.begin, record.GetSize()) == 0) {
+			objects[i] = live;
+			reused.insert(live);
+		}
+	}
+	play_objects_reused = reused.size();
+	play_objects_removed = live_objects.size() - reused.size();
+
+	DetachForRestore(base_game_object, reused);
+	current_scripts.clear();
+
+	octree.BeginBulkInsert();
+	for (uint i = 0; i < play_snapshot.objects.size(); ++i) {
+		const SnapshotObject& saved = play_snapshot.objects[i];
+		GameObject* parent = (saved.parent_index < 0) ? base_game_object : objects[saved.parent_index];
+		if (objects[i] != nullptr) {
+			parent->AddChild(objects[i]);
+		}
+		else {
+			SceneReader reader(play_snapshot.data.GetData() + saved.begin, saved.end - saved.begin);
+			GameObject* obj = new GameObject();
+			obj->LoadObject(&reader, parent);
+			objects[i] = obj;
+			++play_objects_loaded;
+		}
+	}
+	octree.EndBulkInsert();
+	ResolveScriptObjects();
+
+	play_snapshot.data.Clear();
+	play_snapshot.objects.clear();
+	play_snapshot.taken = false;
+}
+
+void ModuleObjects::DetachForRestore(GameObject* obj, const std::unordered_set<const GameObject*>& reused)
+{
+	std::vector<GameObject*>::iterator item = obj->children.begin();
+	for (; item != obj->children.end(); ++item) {
+		if (*item != nullptr) {
+			if (reused.find(*item) != reused.end()) {
+				DetachForRestore(*item, reused);
+			}
+			else {
+				delete* item;
+				*item = nullptr;
+			}
+		}
+	}
+	obj->children.clear();
+}
+
 void ModuleObjects::CreateEmptyScene(ResourceScene* scene)
 {
 	if (scene != nullptr) {
@@ -1110,6 +1486,7 @@ void ModuleObjects::CreateEmptyScene(ResourceScene* scene)
 		base_game_object = new GameObject();
 		base_game_object->ID = 0;
 		base_game_object->is_static = true;
+		transform_hierarchy.Clear();
 
 		current_scene = scene;
 	}
@@ -1128,6 +1505,20 @@ void ModuleObjects::SaveGameObject(GameObject* obj, JSONArraypack* to_save, cons
 	}
 }
 
+void ModuleObjects::SaveGameObject(GameObject* obj, SceneWriter* to_save, int parent_index, uint* objects_count)
+{
+	int index = (int)(*objects_count)++;
+	to_save->Write(parent_index);
+	obj->SaveObject(to_save);
+
+	std::vector<GameObject*>::iterator item = obj->children.begin();
+	for (; item != obj->children.end(); ++item) {
+		if (*item != nullptr) {
+			SaveGameObject(*item, to_save, index, objects_count);
+		}
+	}
+}
+
 GameObject* ModuleObjects::GetRoot(bool ignore_prefab) 
 {
 	if (prefab_scene && !ignore_prefab) {
@@ -1147,6 +1538,7 @@ void ModuleObjects::CreateRoot()
 	base_game_object = new GameObject();
 	base_game_object->ID = 0;
 	base_game_object->is_static = true;
+	transform_hierarchy.Clear();
 }
 
 void ModuleObjects::SwapReturnZ(bool get_save, bool delete_current)
@@ -1240,14 +1632,19 @@ void ModuleObjects::HotReload()
 	}
 }
 
-bool ModuleObjects::SortGameObjectToDraw(std::pair<float, GameObject*> first, std::pair<float, GameObject*> last)
+void ModuleObjects::AddScriptObject(const u64& ID, GameObject** object)
 {
-	return first.first > last.first;
+	to_add.push_back({ ID, object });
 }
 
-void ModuleObjects::AddScriptObject(const u64& ID, GameObject** object)
+int ModuleObjects::GetTagIndex(const char* tag) const
 {
-	to_add.push_back({ ID, object });
+	for (uint i = 0; i < tags.size(); ++i) {
+		if (tags[i] == tag) {
+			return (int)i;
+		}
+	}
+	return -1;
 }
 
 void ModuleObjects::DuplicateObjects()
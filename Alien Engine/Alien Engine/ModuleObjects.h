@@ -8,9 +8,16 @@
 #include <map>
 #include <utility>
 #include "Octree.h"
+#include "TransformHierarchy.h"
+#include "ComponentRegistry.h"
+#include "DynamicTree.h"
 #include "ComponentCamera.h"
+#include "RenderBatcher.h"
+#include "SceneBinary.h"
+#include "GameObjectPool.h"
 #include <stack>
 #include <functional>
+#include <unordered_set>
 
 class ReturnZ;
 class ResourcePrefab;
@@ -120,8 +127,34 @@ public:
 	void LoadScene(const char * name, bool change_scene = true);
 	void CreateEmptyScene(ResourceScene* scene);
 
+	// the JSON of the assets, to diff and merge the scenes
+	bool SaveSceneJSON(const char* path, const char* scene_name);
+	// the binary of the library, the objects in the order of the hierarchy with the index of their parent
+	bool SaveSceneBinary(const char* path, const char* scene_name);
+	// delete every object and start an empty root
+	void ClearScene();
+	// the play mode keeps the scene in memory, and restores it loading only the objects that changed
+	void TakePlaySnapshot();
+	void RestorePlaySnapshot();
+	// the object and its children at the end of the snapshot, each one after its parent
+	void SnapshotGameObject(GameObject* obj, int parent_index, SceneSnapshot* snapshot);
+	// the objects the scripts loaded asked for by their ID
+	void ResolveScriptObjects();
+
+	// fill to_draw with the dynamic meshes inside the camera frustum and update cameras and lights. frustum holds the
+	// planes of the camera, built once for the frame
+	void SetDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum);
+	// cull and sort the objects the camera sees, a camera drawn before in this frame with the same frustum gives its queue
+	const RenderQueue* GetRenderQueue(ComponentCamera* camera);
+	// draw the queue objects with the LODs for the camera, batching the opaque ones if use_render_batches is true
+	void DrawRenderQueue(const RenderQueue* render_queue, const ComponentCamera* camera, bool scene);
+	// forget the render queues of this frame and their counters, a camera deleted after drawing must not be shared.
+	// Starts the next lod_frame
+	void ClearRenderQueues();
+
 	static bool SortByFamilyNumber(std::tuple<uint, u64, uint> pair1, std::tuple<uint, u64, uint> pair2);
 	void SaveGameObject(GameObject* obj, JSONArraypack* to_save, const uint& family_number);
+	void SaveGameObject(GameObject* obj, SceneWriter* to_save, int parent_index, uint* objects_count);
 
 	GameObject* GetRoot(bool ignore_prefab);
 	void CreateRoot();
@@ -130,9 +163,9 @@ public:
 	
 	void HotReload();
 
-	static bool SortGameObjectToDraw(std::pair<float, GameObject*> first, std::pair<float, GameObject*> last);
-
 	void AddScriptObject(const u64& ID, GameObject** object);
+	// index of the tag in tags, -1 if it is not one of them
+	int GetTagIndex(const char* tag) const;
 
 	void DuplicateObjects();
 
@@ -143,6 +176,15 @@ public:
 
 private:
 
+	// to_draw can be nullptr to only update cameras and lights
+	void SetDrawListSystems(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum);
+
+	// the scene is empty before them. False if the file ends before all the objects
+	bool LoadSceneBinary(SceneReader* scene, uint objects_count);
+	void LoadSceneJSON(JSONfilepack* scene);
+	// delete the children not reused and empty the children of the rest, the restore adds them again in order
+	void DetachForRestore(GameObject* obj, const std::unordered_set<const GameObject*>& reused);
+
 	void CreateJsonScript(GameObject* obj, JSONArraypack* to_save);
 	void ReAssignScripts(JSONArraypack* to_load);
 	void DeleteReturns();
@@ -220,6 +262,36 @@ public:
 	bool errors = false;
 
 	Octree octree;
+	TransformHierarchy transform_hierarchy;
+	// instances of the prefabs spawned and despawned by the scripts
+	GameObjectPool object_pool;
+	ComponentRegistry component_registry;
+	// non static meshes, used by culling and mouse picking
+	DynamicTree dynamic_tree;
+	bool use_dynamic_tree = true;
+	// iterate the ComponentRegistry arrays instead of the GameObject tree to build the draw lists
+	bool use_component_systems = true;
+	double cameras_system_ms = 0.0;
+	double lights_system_ms = 0.0;
+	double meshes_system_ms = 0.0;
+	// render queues of this frame
+	uint render_queues_built = 0;
+	uint render_queues_shared = 0;
+	uint render_queues_objects = 0;
+	double render_queues_culling_ms = 0.0;
+	double render_queues_sort_ms = 0.0;
+	// group the opaque meshes by texture and mesh to set the state once per batch
+	RenderBatcher render_batcher;
+	bool use_render_batches = true;
+	uint render_batches = 0;
+	uint render_batched_objects = 0;
+	// simplified meshes for the objects that are small on the screen. The first LOD is drawn when the mesh covers
+	// less than lod_screen_size of the screen height, and every next one at half of the previous size
+	bool use_lods = true;
+	float lod_screen_size = 0.5F;
+	float lod_hysteresis = 0.1F;
+	// frames drawn, the meshes forget the levels of the cameras that haven't drawn them for a while
+	uint lod_frame = 0;
 	std::stack<ReturnZ*> return_actions;
 	std::stack<ReturnZ*> fordward_actions;
 
@@ -234,6 +306,14 @@ public:
 
 	std::vector<std::string> tags;
 
+	// the last enter and exit of the play mode
+	double play_enter_ms = 0.0;
+	double play_exit_ms = 0.0;
+	uint play_snapshot_bytes = 0;
+	uint play_objects_reused = 0;
+	uint play_objects_loaded = 0;
+	uint play_objects_removed = 0;
+
 private:
 	// root
 	GameObject* base_game_object = nullptr;
@@ -245,6 +325,11 @@ private:
 
 	std::vector<std::pair<u64, GameObject**>> to_add;
 
+	// cameras with the render queue built this frame
+	std::vector<ComponentCamera*> cameras_drawn;
+
 	std::list<InvokeInfo*> invokes;
+
+	SceneSnapshot play_snapshot;
 };
 
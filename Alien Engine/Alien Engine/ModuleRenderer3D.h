@@ -32,10 +32,15 @@ public:
 	void UpdateCameraMatrix(ComponentCamera* camera);
 
 	bool SetCameraToDraw(const ComponentCamera* camera);
-
-	bool IsInsideFrustum(const ComponentCamera* camera, const AABB& aabb);
 public:
 
+	// mesh draws and texture or mesh binds of this frame
+	uint draw_calls = 0;
+	uint state_changes = 0;
+	// triangles drawn this frame and the ones the full meshes would have drawn without LODs
+	uint triangles = 0;
+	uint triangles_full = 0;
+
 	// buffers to draw scene
 	uint scene_frame_buffer = 0;
 	uint scene_render_texture = 0;
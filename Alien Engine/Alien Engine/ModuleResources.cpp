@@ -25,6 +25,8 @@ ModuleResources::~ModuleResources()
 
 bool ModuleResources::Start()
 {
+	streamer.Start();
+
 #ifndef GAME_VERSION
 	// Load Icons
 	icons.jpg_file = App->importer->LoadEngineTexture("Configuration/EngineTextures/icon_jpg.png");
@@ -80,11 +82,20 @@ bool ModuleResources::Start()
 
 update_status ModuleResources::Update(float dt)
 {
+	textures_uploaded_bytes = 0;
+	streamer.Update(upload_budget_ms);
+	// the uploads can go over the budgets
+	residency.Trim();
+
 	return UPDATE_CONTINUE;
 }
 
 bool ModuleResources::CleanUp()
 {
+	// no worker can be reading a resource while they are deleted
+	streamer.Stop();
+	residency.Clear();
+
 	try {
 		std::vector<Resource*>::iterator item = resources.begin();
 		for (; item != resources.end(); ++item) {
@@ -98,6 +109,7 @@ bool ModuleResources::CleanUp()
 	}
 	catch (...) {}
 	resources.clear();
+	registry.Clear();
 
 	delete cube;
 	delete sphere;
@@ -115,10 +127,22 @@ bool ModuleResources::CleanUp()
 
 void ModuleResources::AddResource(Resource* resource)
 {
-	if (resource != nullptr) {
-		if (std::find(resources.begin(), resources.end(), resource) == resources.end())
-			resources.push_back(resource);
+	// the registry knows if it is already in without searching the vector
+	if (registry.Add(resource)) {
+		resources.push_back(resource);
+	}
+}
+
+bool ModuleResources::RemoveResource(Resource* resource)
+{
+	registry.Remove(resource);
+
+	std::vector<Resource*>::iterator position = std::find(resources.begin(), resources.end(), resource);
+	if (position != resources.end()) {
+		resources.erase(position);
+		return true;
 	}
+	return false;
 }
 
 bool ModuleResources::CreateNewModelInstanceOf(const char* path)
@@ -158,24 +182,18 @@ u64 ModuleResources::GetIDFromAlienPath(const char* path)
 
 Resource* ModuleResources::GetResourceWithID(const u64& ID)
 {
-	std::vector<Resource*>::iterator item = resources.begin();
-	for (; item != resources.end(); ++item) {
-		if (*item != nullptr && (*item)->GetID() == ID)
-			return (*item);
-	}
-	LOG_ENGINE("No resource found with ID %i", ID);
-	return nullptr;
+	Resource* ret = registry.GetByID(ID);
+	if (ret == nullptr)
+		LOG_ENGINE("No resource found with ID %i", ID);
+	return ret;
 }
 
 const Resource* ModuleResources::GetResourceWithID(const u64& ID) const
 {
-	std::vector<Resource*>::const_iterator item = resources.cbegin();
-	for (; item != resources.cend(); ++item) {
-		if (*item != nullptr && (*item)->GetID() == ID)
-			return (*item);
-	}
-	LOG_ENGINE("No resource found with ID %i", ID);
-	return nullptr;
+	const Resource* ret = registry.GetByID(ID);
+	if (ret == nullptr)
+		LOG_ENGINE("No resource found with ID %i", ID);
+	return ret;
 }
 
 void ModuleResources::AddNewFileNode(const std::string& path, bool is_file)
@@ -207,30 +225,12 @@ u64 ModuleResources::GetRandomID()
 
 ResourceTexture * ModuleResources::GetTextureByName(const char * name)
 {
-	ResourceTexture* ret = nullptr;
-
-	std::vector<Resource*>::iterator item = resources.begin();
-	for (; item != resources.end(); ++item) {
-		if (*item != nullptr && (*item)->GetType() == ResourceType::RESOURCE_TEXTURE && App->StringCmp(App->file_system->GetBaseFileName((*item)->GetAssetsPath()).data(),App->file_system->GetBaseFileName(name).data())) {
-			return static_cast<ResourceTexture*>(*item);
-		}
-	}
-
-	return ret;
+	return static_cast<ResourceTexture*>(registry.GetByName(ResourceType::RESOURCE_TEXTURE, name));
 }
 
 const ResourceTexture* ModuleResources::GetTextureByName(const char* name) const
 {
-	ResourceTexture* ret = nullptr;
-
-	std::vector<Resource*>::const_iterator item = resources.cbegin();
-	for (; item != resources.cend(); ++item) {
-		if (*item != nullptr && (*item)->GetType() == ResourceType::RESOURCE_TEXTURE && App->StringCmp(App->file_system->GetBaseFileName((*item)->GetAssetsPath()).data(), App->file_system->GetBaseFileName(name).data())) {
-			return static_cast<ResourceTexture*>(*item);
-		}
-	}
-
-	return ret;
+	return static_cast<const ResourceTexture*>(registry.GetByName(ResourceType::RESOURCE_TEXTURE, name));
 }
 
 ResourceMesh* ModuleResources::GetPrimitive(const PrimitiveType& type)
@@ -318,19 +318,11 @@ const ResourceMesh* ModuleResources::GetPrimitive(const PrimitiveType& type) con
 
 bool ModuleResources::Exists(const char * path, Resource** resource) const
 {
-	bool exists = false;
+	Resource* found = registry.GetByPath(path);
+	if (found != nullptr && resource != nullptr)
+		*resource = found;
 
-	std::vector<Resource*>::const_iterator item = resources.cbegin();
-	for (; item != resources.cend(); ++item) {
-		if (*item != nullptr && App->StringCmp(path, (*item)->GetAssetsPath())) {
-			exists = true;
-			if (resource != nullptr)
-				*resource = (*item);
-			break;
-		}
-	}
-
-	return exists;
+	return found != nullptr;
 }
 
 void ModuleResources::CreatePrimitive(const PrimitiveType& type, ResourceMesh** ret)
@@ -479,6 +471,7 @@ void ModuleResources::ReloadScripts()
 			}
 			else {
 				remove((*item)->GetAssetsPath());
+				registry.Remove(*item);
 				delete* item;
 				(*item) = nullptr;
 				item = resources.erase(item);
@@ -493,15 +486,23 @@ void ModuleResources::ReloadScripts()
 
 ResourceScene* ModuleResources::GetSceneByName(const char* name)
 {
-	auto item = resources.begin();
+	return static_cast<ResourceScene*>(registry.GetByName(ResourceType::RESOURCE_SCENE, name));
+}
+
+uint ModuleResources::CookAllTextures()
+{
+	std::vector<ResourceTexture*> textures;
+	std::vector<Resource*>::iterator item = resources.begin();
 	for (; item != resources.end(); ++item) {
-		if (*item != nullptr && (*item)->GetType() == ResourceType::RESOURCE_SCENE) {
-			if (App->StringCmp((*item)->GetName(), name)) {
-				return dynamic_cast<ResourceScene*>(*item);
-			}
+		if (*item != nullptr && (*item)->GetType() == ResourceType::RESOURCE_TEXTURE) {
+			ResourceTexture* texture = static_cast<ResourceTexture*>(*item);
+			// the icons and the render textures have no asset
+			if (texture->is_custom && texture->IsReloadable())
+				textures.push_back(texture);
 		}
 	}
-	return nullptr;
+
+	return App->importer->CookTextures(textures);
 }
 
 FileNode* ModuleResources::GetFileNodeByPath(const std::string& path, FileNode* node)
@@ -527,10 +528,30 @@ void ModuleResources::ReadAllMetaData()
 	std::vector<std::string> directories;
 
 #ifndef GAME_VERSION
-	// Init Textures
+	j1PerfTimer timer;
+	asset_database.Load(ASSET_DATABASE_FILE);
+	asset_database.ResetCounters();
+
+	// Init Textures, before the models because they check their textures
 	App->file_system->DiscoverFiles(TEXTURES_FOLDER, files, directories);
 
-	ReadTextures(directories, files, TEXTURES_FOLDER);
+	std::vector<ResourceTexture*> to_cook;
+	ReadTextures(directories, files, TEXTURES_FOLDER, to_cook);
+	if (!to_cook.empty()) {
+		// the ones that fail are deleted, the cooked ones are found again by their path
+		std::vector<std::string> cooked_paths;
+		std::vector<ResourceTexture*>::iterator item = to_cook.begin();
+		for (; item != to_cook.end(); ++item) {
+			cooked_paths.push_back((*item)->GetAssetsPath());
+		}
+		App->importer->CookTextures(to_cook);
+		for (uint i = 0; i < cooked_paths.size(); ++i) {
+			Resource* texture = registry.GetByPath(cooked_paths[i].data());
+			if (texture != nullptr && texture->GetType() == ResourceType::RESOURCE_TEXTURE) {
+				StoreAsset(texture);
+			}
+		}
+	}
 
 	files.clear();
 	directories.clear();
@@ -560,6 +581,13 @@ void ModuleResources::ReadAllMetaData()
 
 	files.clear();
 	directories.clear();
+
+	// the records of the assets that were not found are from removed files
+	asset_database.DropUnseen();
+	asset_database.Save(ASSET_DATABASE_FILE);
+	assets_read_ms = timer.ReadMs();
+	LOG_ENGINE("Read the assets in %.3f ms: %u clean, %u changed, %u new and %u removed", assets_read_ms, asset_database.clean, asset_database.changed,
+		asset_database.added, asset_database.removed);
 #else
 
 	// textures
@@ -609,13 +637,24 @@ void ModuleResources::ReadAllMetaData()
 #endif
 }
 
-void ModuleResources::ReadTextures(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder)
+void ModuleResources::ReadTextures(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder, std::vector<ResourceTexture*>& to_cook)
 {
 	for (uint i = 0; i < files.size(); ++i) {
+		std::string path = current_folder + files[i];
+		AssetRecord* record = nullptr;
+		AssetState state = asset_database.Check(path.data(), ResourceType::RESOURCE_TEXTURE, AssetDatabase::GetTextureSettings(), &record);
+
 		ResourceTexture* texture = new ResourceTexture();
-		if (!texture->ReadBaseInfo(std::string(current_folder + files[i]).data())) {
-			u64 id = texture->GetID();
-			texture->CreateMetaData(id);
+		if (state == AssetState::CLEAN) {
+			asset_database.Restore(texture, *record);
+			AddResource(texture);
+		}
+		else if (!texture->ReadBaseInfo(path.data()) || state == AssetState::CHANGED) {
+			// keeps the ID of its meta if it has one
+			to_cook.push_back(texture);
+		}
+		else {
+			StoreAsset(texture);
 		}
 	}
 	if (!directories.empty()) {
@@ -624,8 +663,11 @@ void ModuleResources::ReadTextures(std::vector<std::string> directories, std::ve
 
 		for (uint i = 0; i < directories.size(); ++i) {
 			std::string dir = current_folder + directories[i] + "/";
+			// each folder with only its files, the asset database would see the ones of the previous folder in this one
+			new_files.clear();
+			new_directories.clear();
 			App->file_system->DiscoverFiles(dir.data(), new_files, new_directories);
-			ReadTextures(new_directories, new_files, dir);
+			ReadTextures(new_directories, new_files, dir, to_cook);
 		}
 	}
 }
@@ -633,10 +675,48 @@ void ModuleResources::ReadTextures(std::vector<std::string> directories, std::ve
 void ModuleResources::ReadModels(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder)
 {
 	for (uint i = 0; i < files.size(); ++i) {
+		std::string path = current_folder + files[i];
+		AssetRecord* record = nullptr;
+		AssetState state = asset_database.Check(path.data(), ResourceType::RESOURCE_MODEL, AssetDatabase::GetModelSettings(), &record);
+		if (state == AssetState::CLEAN && asset_database.DependenciesChanged(*record)) {
+			state = AssetState::CHANGED;
+			++asset_database.changed;
+			--asset_database.clean;
+		}
+
 		ResourceModel* model = new ResourceModel();
-		if (!model->ReadBaseInfo(std::string(current_folder + files[i]).data())) {
+		if (state == AssetState::CLEAN) {
+			// the meshes are read like ReadBaseInfo does, without its metas
+			asset_database.Restore(model, *record);
+			model->SetLibraryPath((App->file_system->GetPathWithoutExtension(path) + "_meta.alien").data());
+			for (uint j = 1; j < record->outputs.size(); ++j) {
+				ResourceMesh* r_mesh = new ResourceMesh();
+				if (r_mesh->ReadBaseInfo(record->outputs[j].data())) {
+					model->meshes_attached.push_back(r_mesh);
+				}
+				else {
+					LOG_ENGINE("Error loading %s", record->outputs[j].data());
+					delete r_mesh;
+				}
+			}
+			AddResource(model);
+			continue;
+		}
+
+		if (state == AssetState::CHANGED) {
+			// imported again with its ID and the IDs of its meshes
+			asset_database.Restore(model, *record);
+			model->SetLibraryPath((App->file_system->GetPathWithoutExtension(path) + "_meta.alien").data());
+			LOG_ENGINE("Importing again %s, it or its textures changed", path.data());
 			App->importer->ReImportModel(model);
 		}
+		else if (!model->ReadBaseInfo(path.data())) {
+			App->importer->ReImportModel(model);
+		}
+
+		if (GetResourceWithID(model->GetID()) == model) {
+			StoreAsset(model);
+		}
 	}
 	if (!directories.empty()) {
 		std::vector<std::string> new_files;
@@ -644,6 +724,9 @@ void ModuleResources::ReadModels(std::vector<std::string> directories, std::vect
 
 		for (uint i = 0; i < directories.size(); ++i) {
 			std::string dir = current_folder + directories[i] + "/";
+			// each folder with only its files, the asset database would see the ones of the previous folder in this one
+			new_files.clear();
+			new_directories.clear();
 			App->file_system->DiscoverFiles(dir.data(), new_files, new_directories);
 			ReadModels(new_directories, new_files, dir);
 		}
@@ -653,11 +736,27 @@ void ModuleResources::ReadModels(std::vector<std::string> directories, std::vect
 void ModuleResources::ReadPrefabs(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder)
 {
 	for (uint i = 0; i < files.size(); ++i) {
+		std::string path = current_folder + files[i];
+		AssetRecord* record = nullptr;
+		AssetState state = asset_database.Check(path.data(), ResourceType::RESOURCE_PREFAB, 0, &record);
+
 		ResourcePrefab* model = new ResourcePrefab();
-		if (!model->ReadBaseInfo(std::string(current_folder + files[i]).data())) {
+		if (state == AssetState::CLEAN) {
+			asset_database.Restore(model, *record);
+			AddResource(model);
+			continue;
+		}
+		// ReadBaseInfo copies it to the library again
+		if (state == AssetState::CHANGED) {
+			remove(record->library.data());
+		}
+		if (!model->ReadBaseInfo(path.data())) {
 			LOG_ENGINE("Error while loading %s because has not .alienPrefab", files[i]);
 			delete model;
 		}
+		else if (GetResourceWithID(model->GetID()) == model) {
+			StoreAsset(model);
+		}
 	}
 	if (!directories.empty()) {
 		std::vector<std::string> new_files;
@@ -665,6 +764,9 @@ void ModuleResources::ReadPrefabs(std::vector<std::string> directories, std::vec
 
 		for (uint i = 0; i < directories.size(); ++i) {
 			std::string dir = current_folder + directories[i] + "/";
+			// each folder with only its files, the asset database would see the ones of the previous folder in this one
+			new_files.clear();
+			new_directories.clear();
 			App->file_system->DiscoverFiles(dir.data(), new_files, new_directories);
 			ReadPrefabs(new_directories, new_files, dir);
 		}
@@ -675,11 +777,25 @@ void ModuleResources::ReadScenes(std::vector<std::string> directories, std::vect
 {
 	for (uint i = 0; i < files.size(); ++i) {
 		if (files[i].find("_meta.alien") == std::string::npos) {
+			std::string path = current_folder + files[i];
+			AssetRecord* record = nullptr;
+			AssetState state = asset_database.Check(path.data(), ResourceType::RESOURCE_SCENE, 0, &record);
+
 			ResourceScene* scene = new ResourceScene();
-			if (!scene->ReadBaseInfo(std::string(current_folder + files[i]).data())) {
+			if (state == AssetState::CLEAN) {
+				asset_database.Restore(scene, *record);
+				AddResource(scene);
+				continue;
+			}
+			// ReadBaseInfo copies it to the library again if it changed outside the engine, the binary the
+			// editor saved with it is newer
+			if (!scene->ReadBaseInfo(path.data())) {
 				LOG_ENGINE("Error loading %s", files[i].data());
 				delete scene;
 			}
+			else {
+				StoreAsset(scene);
+			}
 		}
 	}
 	if (!directories.empty()) {
@@ -688,12 +804,37 @@ void ModuleResources::ReadScenes(std::vector<std::string> directories, std::vect
 
 		for (uint i = 0; i < directories.size(); ++i) {
 			std::string dir = current_folder + directories[i] + "/";
+			// each folder with only its files, the asset database would see the ones of the previous folder in this one
+			new_files.clear();
+			new_directories.clear();
 			App->file_system->DiscoverFiles(dir.data(), new_files, new_directories);
-			ReadModels(new_directories, new_files, dir);
+			ReadScenes(new_directories, new_files, dir);
 		}
 	}
 }
 
+void ModuleResources::StoreAsset(Resource* resource)
+{
+	std::vector<std::string> outputs;
+	std::vector<AssetDependency> dependencies;
+
+	switch (resource->GetType())
+	{
+	case ResourceType::RESOURCE_TEXTURE:
+		outputs.push_back(resource->GetLibraryPath());
+		asset_database.Store(resource, AssetDatabase::GetTextureSettings(), outputs, dependencies);
+		break;
+	case ResourceType::RESOURCE_MODEL: {
+		ResourceModel* model = static_cast<ResourceModel*>(resource);
+		asset_database.Store(resource, AssetDatabase::GetModelSettings(), model->GetLibraryFiles(), model->GetTextureDependencies());
+		break; }
+	default:
+		outputs.push_back(resource->GetLibraryPath());
+		asset_database.Store(resource, 0, outputs, dependencies);
+		break;
+	}
+}
+
 void ModuleResources::ReadScripts()
 {
 #ifndef GAME_VERSION
@@ -2,6 +2,10 @@
 #include "Module.h"
 #include "Globals.h"
 #include "ModuleObjects.h"
+#include "ResourceStreamer.h"
+#include "ResourceRegistry.h"
+#include "ResourceResidency.h"
+#include "AssetDatabase.h"
 
 #define DROP_ID_HIERARCHY_NODES "hierarchy_node"
 #define DROP_ID_PROJECT_NODE "project_node"
@@ -42,7 +46,6 @@ struct Icons {
 	ResourceTexture* prefab_lock = nullptr;
 };
 
-
 class ModuleResources : public Module
 {
 public:
@@ -55,6 +58,8 @@ public:
 	bool CleanUp();
 
 	void AddResource(Resource* resource);
+	// take the resource out of the resources list and the registry, it is not deleted. False if it was not in
+	bool RemoveResource(Resource* resource);
 
 	// meta path
 	bool CreateNewModelInstanceOf(const char* path);
@@ -83,15 +88,21 @@ public:
 
 	ResourceScene* GetSceneByName(const char* name);
 
+	// cook again the textures of the assets, with the mips and compression of the current cooker
+	uint CookAllTextures();
+
 private:
 	FileNode* GetFileNodeByPath(const std::string& path, FileNode* node);
 
 	void ReadAllMetaData();
-	void ReadTextures(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder);
+	// the textures without a .dds are added to to_cook
+	void ReadTextures(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder, std::vector<ResourceTexture*>& to_cook);
 	void ReadModels(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder);
 	void ReadPrefabs(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder);
 	void ReadScenes(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder);
 	void ReadScripts();
+	// record the current files of the resource in the asset database
+	void StoreAsset(Resource* resource);
 
 	void GetAllScriptsPath(std::vector<std::string> directories, std::vector<std::string> files, std::string current_folder, std::vector<std::string>* scripts);
 
@@ -100,11 +111,49 @@ public:
 	Icons icons;
 
 	std::vector<Resource*> resources;
+	// indices of resources, AddResource and RemoveResource keep them in sync
+	ResourceRegistry registry;
 
 	ResourceMesh* camera_mesh = nullptr;
 	ResourceMesh* light_mesh = nullptr; 
 	FileNode* assets = nullptr;
 
+	// GPU memory of the loaded meshes and how much the compact vertex format saves
+	uint meshes_buffers_size = 0;
+	uint meshes_buffers_saved = 0;
+	// .alienMesh loads, the mapped ones don't copy the file to the heap
+	uint meshes_loaded = 0;
+	uint meshes_mapped = 0;
+	double meshes_load_ms = 0.0;
+	uint meshes_load_heap_bytes = 0;
+	// hash the whole .alienMesh against the header when it is loaded. It reads every page of the mapped file, so only
+	// to look for corrupted files, the sizes of the sections are always checked
+	bool check_meshes_checksum = false;
+
+	// time of the last model import and scene load and the resources there were
+	double last_import_ms = 0.0;
+	uint last_import_resources = 0;
+	double last_scene_load_ms = 0.0;
+	uint last_scene_load_resources = 0;
+
+	// what the startup read from the asset database and what it imported again
+	AssetDatabase asset_database;
+	double assets_read_ms = 0.0;
+	// the prefabs are compiled the first time they are instantiated and the next instances are made from the records
+	bool use_compiled_prefabs = true;
+
+	// budgets and LRU cache of the loaded resources
+	ResourceResidency residency;
+
+	// meshes and textures referenced by the scene are read in other threads and uploaded in Update
+	ResourceStreamer streamer;
+	bool async_loading = true;
+	// ms of each frame the uploads can use
+	float upload_budget_ms = 2.0F;
+	// the cooked textures are uploaded in pieces of this size, the streamer sends more of them while the budget lasts
+	int texture_upload_chunk_kb = 256;
+	uint textures_uploaded_bytes = 0;
+
 private:
 	ResourceMesh* cube = nullptr;
 	ResourceMesh* sphere = nullptr;
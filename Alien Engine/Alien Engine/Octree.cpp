@@ -4,443 +4,834 @@
 #include "Application.h"
 #include "ComponentTransform.h"
 #include "ComponentCamera.h"
+#include "j1PerfTimer.h"
+#include "ParallelFor.h"
+#include <algorithm>
 
-OctreeNode::OctreeNode(const float3& min, const float3& max)
+Octree::Octree()
 {
-	section.minPoint = min;
-	section.maxPoint = max;
 }
 
-OctreeNode::~OctreeNode()
+Octree::~Octree()
 {
-	if (!children.empty()) {
-		std::vector<OctreeNode*>::iterator item = children.begin();
-		for (; item != children.end(); ++item) {
-			if (*item != nullptr) {
-				delete* item;
-				*item = nullptr;
-			}
-		}
-		children.clear();
-	}
-	if (!game_objects.empty())
-		game_objects.clear();
+	Clear();
 }
 
-void OctreeNode::Insert(GameObject* object, const AABB& sect)
+void Octree::Insert(GameObject* object, bool add_children)
 {
-	if (section.Contains(sect)) {
-		if (children.empty()) {
-			if (game_objects.size() < App->objects->octree.GetBucket()) {
-				AddGameObject(object);
+	ComponentMesh* mesh_parent = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+
+	if (mesh_parent != nullptr && mesh_parent->mesh != nullptr) {
+		if (bulk_depth > 0) {
+			bulk_objects.push_back(object);
+		}
+		else {
+			const AABB aabb = mesh_parent->GetGlobalAABB();
+			if (root == -1) {
+				Init(aabb.minPoint, aabb.maxPoint);
 			}
-			else {
-				Subdivide();
-				if (!AddToChildren(object, sect)) { // after the subdivision test if gameobject fits in children, if not delete childrena and object belogns to parent
-					Regrup();
-					AddGameObject(object);
+			if (!Exists(object)) {
+				if (!nodes[root].section.Contains(aabb) && !GrowRoot(aabb)) {
+					// too far from the root, create it again with the new object
+					Recalculate(object);
+				}
+				else {
+					// go down to the deepest node that contains the object
+					int node = root;
+					uint depth = 0;
+					while (!nodes[node].IsLeaf()) {
+						int child = -1;
+						for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+							if (nodes[nodes[node].first_child + i].section.Contains(aabb)) {
+								child = nodes[node].first_child + i;
+								break;
+							}
+						}
+						if (child == -1)
+							break;
+						node = child;
+						++depth;
+					}
+
+					AddObject(node, object, aabb);
+					if (nodes[node].IsLeaf() && nodes[node].objects_count > bucket) {
+						Split(nodes, free_blocks, split_buffers, node, depth);
+						IndexObjects(node);
+					}
+					if (wasted_objects > objects_count) {
+						Compact();
+					}
 				}
 			}
 		}
-		else if (!children.empty()) {
-			if (!AddToChildren(object, sect)) {
-				AddGameObject(object);
+	}
+
+	if (add_children && !object->children.empty()) {
+		std::vector<GameObject*>::iterator item = object->children.begin();
+		for (; item != object->children.end(); ++item) {
+			if (*item != nullptr) {
+				Insert((*item), add_children);
 			}
 		}
 	}
-	else {
-		App->objects->octree.Recalculate(object);
-	}
 }
 
-void OctreeNode::Regrup()
+void Octree::Remove(GameObject* object, bool remove_children)
 {
-	std::vector<OctreeNode*>::iterator item = children.begin();
-	for (; item != children.end(); ++item) {
-		if (*item != nullptr) {
-			delete* item;
-			*item = nullptr;
-		}
+	// the octree is built again at the end of the bulk insert, but a deleted object can't be left in it until then
+	if (bulk_depth > 0) {
+		RemoveFromBulk(object, remove_children);
+	}
+
+	if (root == -1)
+		return;
+
+	RemoveRecursively(object, remove_children);
+
+	if (objects_count == 0) {
+		Clear();
+	}
+	else if (wasted_objects > objects_count) {
+		Compact();
 	}
-	children.clear();
 }
 
-bool OctreeNode::Remove(GameObject* object)
+void Octree::UpdateObject(GameObject* object)
 {
-	bool ret = false;
-	if (!game_objects.empty()) {
-		std::vector<GameObject*>::iterator item = game_objects.begin();
-		for (; item != game_objects.end(); ++item) {
-			if (*item != nullptr && *item == object) {
-				game_objects.erase(item);
-				ret = true;
-				return ret;
-			}
-		}
+	// the bulk build reads the AABBs at the end
+	if (bulk_depth > 0 || !Exists(object))
+		return;
+
+	ComponentMesh* mesh = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+	if (mesh == nullptr || mesh->mesh == nullptr) {
+		Remove(object, false);
+		return;
 	}
 
-	if (!children.empty()) {
-		std::vector<OctreeNode*>::iterator item = children.begin();
-		for (; item != children.end(); ++item) {
-			if (*item != nullptr) {
-				ret = (*item)->Remove(object);
-				if (ret)
-					break;
+	const AABB aabb = mesh->GetGlobalAABB();
+	uint index = object->octree_index;
+	// still inside its node, it may fit in a child now but the queries are right anyway
+	if (nodes[objects_node[index]].section.Contains(aabb)) {
+		objects_aabb[index] = aabb;
+		return;
+	}
+
+	RemoveObject(index);
+	// the only object starts a new root where it is now
+	if (objects_count == 0) {
+		Clear();
+	}
+	Insert(object, false);
+}
+
+void Octree::Clear()
+{
+	// the objects left are still alive, the ones deleted removed themselves
+	for (uint i = 0; i < nodes.size(); ++i) {
+		uint end = nodes[i].objects_offset + nodes[i].objects_count;
+		for (uint j = nodes[i].objects_offset; j < end; ++j) {
+			if (objects[j]->octree_index == (int)j) {
+				objects[j]->octree_index = -1;
 			}
 		}
 	}
-	return ret;
+
+	nodes.clear();
+	free_blocks.clear();
+	objects.clear();
+	objects_aabb.clear();
+	objects_node.clear();
+	objects_count = 0;
+	wasted_objects = 0;
+	root = -1;
 }
 
-void OctreeNode::DrawNode()
+void Octree::Draw()
 {
+	if (root == -1)
+		return;
+
 	glColor3f(App->objects->octree_line_color.r, App->objects->octree_line_color.g, App->objects->octree_line_color.b);
 	glLineWidth(App->objects->octree_line_width);
 	glBegin(GL_LINES);
 
-	glVertex3f(section.minPoint.x, section.minPoint.y, section.minPoint.z);
-	glVertex3f(section.maxPoint.x, section.minPoint.y, section.minPoint.z);
+	stack.clear();
+	stack.push_back({ root, 0 });
 
-	glVertex3f(section.minPoint.x, section.minPoint.y, section.minPoint.z);
-	glVertex3f(section.minPoint.x, section.minPoint.y, section.maxPoint.z);
+	while (!stack.empty()) {
+		const OctreeNode& node = nodes[stack.back().first];
+		stack.pop_back();
 
-	glVertex3f(section.minPoint.x, section.minPoint.y, section.minPoint.z);
-	glVertex3f(section.minPoint.x, section.maxPoint.y, section.minPoint.z);
+		const AABB& section = node.section;
 
-	glVertex3f(section.maxPoint.x, section.minPoint.y, section.minPoint.z);
-	glVertex3f(section.maxPoint.x, section.maxPoint.y, section.minPoint.z);
+		glVertex3f(section.minPoint.x, section.minPoint.y, section.minPoint.z);
+		glVertex3f(section.maxPoint.x, section.minPoint.y, section.minPoint.z);
 
-	glVertex3f(section.maxPoint.x, section.minPoint.y, section.minPoint.z);
-	glVertex3f(section.maxPoint.x, section.minPoint.y, section.maxPoint.z);
+		glVertex3f(section.minPoint.x, section.minPoint.y, section.minPoint.z);
+		glVertex3f(section.minPoint.x, section.minPoint.y, section.maxPoint.z);
 
-	glVertex3f(section.minPoint.x, section.maxPoint.y, section.minPoint.z);
-	glVertex3f(section.minPoint.x, section.maxPoint.y, section.maxPoint.z);
+		glVertex3f(section.minPoint.x, section.minPoint.y, section.minPoint.z);
+		glVertex3f(section.minPoint.x, section.maxPoint.y, section.minPoint.z);
 
-	glVertex3f(section.minPoint.x, section.maxPoint.y, section.minPoint.z);
-	glVertex3f(section.maxPoint.x, section.maxPoint.y, section.minPoint.z);
+		glVertex3f(section.maxPoint.x, section.minPoint.y, section.minPoint.z);
+		glVertex3f(section.maxPoint.x, section.maxPoint.y, section.minPoint.z);
 
-	glVertex3f(section.maxPoint.x, section.maxPoint.y, section.minPoint.z);
-	glVertex3f(section.maxPoint.x, section.maxPoint.y, section.maxPoint.z);
+		glVertex3f(section.maxPoint.x, section.minPoint.y, section.minPoint.z);
+		glVertex3f(section.maxPoint.x, section.minPoint.y, section.maxPoint.z);
 
-	glVertex3f(section.maxPoint.x, section.minPoint.y, section.maxPoint.z);
-	glVertex3f(section.maxPoint.x, section.maxPoint.y, section.maxPoint.z);
+		glVertex3f(section.minPoint.x, section.maxPoint.y, section.minPoint.z);
+		glVertex3f(section.minPoint.x, section.maxPoint.y, section.maxPoint.z);
 
-	glVertex3f(section.minPoint.x, section.minPoint.y, section.maxPoint.z);
-	glVertex3f(section.maxPoint.x, section.minPoint.y, section.maxPoint.z);
+		glVertex3f(section.minPoint.x, section.maxPoint.y, section.minPoint.z);
+		glVertex3f(section.maxPoint.x, section.maxPoint.y, section.minPoint.z);
 
-	glVertex3f(section.minPoint.x, section.minPoint.y, section.maxPoint.z);
-	glVertex3f(section.minPoint.x, section.maxPoint.y, section.maxPoint.z);
+		glVertex3f(section.maxPoint.x, section.maxPoint.y, section.minPoint.z);
+		glVertex3f(section.maxPoint.x, section.maxPoint.y, section.maxPoint.z);
 
-	glVertex3f(section.minPoint.x, section.maxPoint.y, section.maxPoint.z);
-	glVertex3f(section.maxPoint.x, section.maxPoint.y, section.maxPoint.z);
+		glVertex3f(section.maxPoint.x, section.minPoint.y, section.maxPoint.z);
+		glVertex3f(section.maxPoint.x, section.maxPoint.y, section.maxPoint.z);
 
-	glEnd();
+		glVertex3f(section.minPoint.x, section.minPoint.y, section.maxPoint.z);
+		glVertex3f(section.maxPoint.x, section.minPoint.y, section.maxPoint.z);
 
-	glLineWidth(1);
+		glVertex3f(section.minPoint.x, section.minPoint.y, section.maxPoint.z);
+		glVertex3f(section.minPoint.x, section.maxPoint.y, section.maxPoint.z);
 
-	if (!children.empty()) {
-		std::vector<OctreeNode*>::iterator item = children.begin();
-		for (; item != children.end(); ++item) {
-			if (*item != nullptr) {
-				(*item)->DrawNode();
+		glVertex3f(section.minPoint.x, section.maxPoint.y, section.maxPoint.z);
+		glVertex3f(section.maxPoint.x, section.maxPoint.y, section.maxPoint.z);
+
+		if (!node.IsLeaf()) {
+			for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+				stack.push_back({ node.first_child + i, 0 });
 			}
 		}
 	}
+
+	glEnd();
+
+	glLineWidth(1);
 }
 
-void OctreeNode::AddGameObject(GameObject* obj)
+const uint& Octree::GetBucket() const
 {
-	game_objects.push_back(obj);
+	return bucket;
 }
 
-void OctreeNode::AddNode(const float3& min, const float3& max)
+void Octree::SetBucket(const uint& bucket)
 {
-	OctreeNode* node = new OctreeNode(min, max);
-	node->parent = this;
-	children.push_back(node);
+	this->bucket = bucket;
 }
 
-void OctreeNode::SaveGameObjects(std::vector<GameObject*>* to_save, AABB* new_section)
+void Octree::Init(const float3& min, const float3& max)
 {
-	if (!game_objects.empty()) {
-		std::vector<GameObject*>::iterator item = game_objects.begin();
-		for (; item != game_objects.end(); ++item) {
-			if (*item != nullptr) {
-				ComponentMesh* mesh = (ComponentMesh*)(*item)->GetComponent(ComponentType::MESH);
-				AABB aabb = mesh->GetGlobalAABB();
-				new_section->minPoint = { min(new_section->minPoint.x, aabb.minPoint.x), min(new_section->minPoint.y, aabb.minPoint.y),min(new_section->minPoint.z, aabb.minPoint.z) };
-				new_section->maxPoint = { max(new_section->maxPoint.x, aabb.maxPoint.x), max(new_section->maxPoint.y, aabb.maxPoint.y),max(new_section->maxPoint.z, aabb.maxPoint.z) };
-				to_save->push_back((*item));
-			}
-		}
-	}
+	Clear();
 
-	if (!children.empty()) {
-		std::vector<OctreeNode*>::iterator item = children.begin();
-		for (; item != children.end(); ++item) {
-			if (*item != nullptr) {
-				(*item)->SaveGameObjects(to_save, new_section);
-			}
-		}
-	}
+	OctreeNode node;
+	node.section.minPoint = min;
+	node.section.maxPoint = max;
+	nodes.push_back(node);
+	root = 0;
 }
 
-bool OctreeNode::AddToChildren(GameObject * obj, const AABB& sect)
+bool Octree::Exists(GameObject* object)
 {
-	bool ret = false;
-	std::vector<OctreeNode*>::iterator item = children.begin();
-	uint intersections = 0;
-	for (; item != children.end(); ++item) {
-		if (*item != nullptr && (*item)->section.Contains(sect)) {
-			(*item)->Insert(obj, sect);
-			ret = true;
-			break;
-		}
+	return object->octree_index != -1 && (uint)object->octree_index < objects.size() && objects[object->octree_index] == object;
+}
+
+void Octree::Recalculate(GameObject* new_object)
+{
+	if (root == -1)
+		return;
+
+	// get all gameobjects in octree
+	std::vector<GameObject*> to_save;
+	GatherObjects(&to_save);
+
+	if (new_object != nullptr) {
+		to_save.push_back(new_object);
 	}
-	return ret;
+
+	// delete the old octree and create it again
+	Build(to_save);
 }
 
-void OctreeNode::SetStaticDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera)
+void Octree::Build(const std::vector<GameObject*>& to_build)
 {
-	if (App->renderer3D->IsInsideFrustum(camera, section)) {
-		if (!game_objects.empty()) {
-			std::vector<GameObject*>::iterator item = game_objects.begin();
-			for (; item != game_objects.end(); ++item) {
-				if (*item != nullptr && (*item)->IsParentEnabled()) {
-					ComponentMesh* mesh = (ComponentMesh*)(*item)->GetComponent(ComponentType::MESH);
-					if (mesh != nullptr && mesh->mesh != nullptr) {
-						if (App->renderer3D->IsInsideFrustum(camera, mesh->GetGlobalAABB())) {
-							float3 obj_pos = static_cast<ComponentTransform*>((*item)->GetComponent(ComponentType::TRANSFORM))->GetGlobalPosition();
-							float distance = camera->frustum.pos.Distance(obj_pos);
-							to_draw->push_back({ distance, *item });
-						}
-					}
-				}
-			}
+	j1PerfTimer timer;
+
+	std::vector<GameObject*> build_objects;
+	std::vector<AABB> build_aabbs;
+	build_objects.reserve(to_build.size());
+	build_aabbs.reserve(to_build.size());
+
+	AABB new_section;
+	new_section.SetNegativeInfinity();
+
+	std::vector<GameObject*>::const_iterator item = to_build.cbegin();
+	for (; item != to_build.cend(); ++item) {
+		if (*item == nullptr)
+			continue;
+		ComponentMesh* mesh = (ComponentMesh*)(*item)->GetComponent(ComponentType::MESH);
+		if (mesh != nullptr && mesh->mesh != nullptr) {
+			const AABB aabb = mesh->GetGlobalAABB();
+			new_section.Enclose(aabb);
+			build_objects.push_back(*item);
+			build_aabbs.push_back(aabb);
 		}
-		if (!children.empty()) {
-			std::vector<OctreeNode*>::iterator item = children.begin();
-			for (; item != children.end(); ++item) {
-				if (*item != nullptr) {
-					if (App->renderer3D->IsInsideFrustum(camera, (*item)->section)) {
-						(*item)->SetStaticDrawList(to_draw, camera);
-					}
-				}
-			}
+	}
+
+	if (build_objects.empty()) {
+		Clear();
+	}
+	else {
+		Init(new_section.minPoint, new_section.maxPoint);
+
+		objects.swap(build_objects);
+		objects_aabb.swap(build_aabbs);
+		objects_node.assign(objects.size(), root);
+		objects_count = objects.size();
+
+		// everything starts in the root and goes down
+		nodes[root].objects_offset = 0;
+		nodes[root].objects_count = objects_count;
+		nodes[root].objects_capacity = objects_count;
+		if (objects_count > bucket) {
+			Split(nodes, free_blocks, split_buffers, root, 0);
 		}
+		IndexObjects(root);
 	}
+
+	last_build_ms = timer.ReadMs();
+	last_build_count = objects_count;
 }
 
-void OctreeNode::Subdivide()
+void Octree::BeginBulkInsert()
 {
-	float3 mid_point = section.minPoint + (section.maxPoint - section.minPoint) * 0.5F;
+	if (bulk_depth++ > 0)
+		return;
 
-	AddNode(section.minPoint, mid_point); // 0
-	AddNode(mid_point, section.maxPoint); // 2
+	// the objects already in the octree are built again with the new ones
+	bulk_objects.clear();
+	GatherObjects(&bulk_objects);
+}
 
-	float3 point = { section.minPoint.x,section.maxPoint.y,section.minPoint.z };
+void Octree::EndBulkInsert()
+{
+	if (bulk_depth == 0 || --bulk_depth > 0)
+		return;
 
-	AddNode(float3{min(point.x,mid_point.x), min(point.y,mid_point.y), min(point.z,mid_point.z) },
-		float3{ max(point.x,mid_point.x), max(point.y,mid_point.y), max(point.z,mid_point.z) });
+	// an object can be inserted twice while loading
+	std::sort(bulk_objects.begin(), bulk_objects.end());
+	bulk_objects.erase(std::unique(bulk_objects.begin(), bulk_objects.end()), bulk_objects.end());
 
-	point = { section.maxPoint.x,section.minPoint.y,section.maxPoint.z };
+	Build(bulk_objects);
+	bulk_objects.clear();
+}
 
-	AddNode(float3{ min(point.x,mid_point.x), min(point.y,mid_point.y), min(point.z,mid_point.z) },
-		float3{ max(point.x,mid_point.x), max(point.y,mid_point.y), max(point.z,mid_point.z) });
+bool Octree::IsBulkInserting() const
+{
+	return bulk_depth > 0;
+}
 
-	point = { section.maxPoint.x,section.maxPoint.y,section.minPoint.z };
+void Octree::SetStaticDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum)
+{
+	if (root == -1) {
+		return;
+	}
+
+	j1PerfTimer timer;
+
+	stack.clear();
+	stack.push_back({ root, FRUSTUM_PLANES_MASK });
+
+	while (!stack.empty()) {
+		const OctreeNode& node = nodes[stack.back().first];
+		uint plane_mask = stack.back().second;
+		stack.pop_back();
+
+		// the children and the objects are inside this section, so the planes this node is completely inside are not tested again
+		if (!frustum.IsInside(node.section, plane_mask))
+			continue;
+
+		uint end = node.objects_offset + node.objects_count;
+		for (uint i = node.objects_offset; i < end; ++i) {
+			// the mask is reduced for each object, the node one is still needed by the children
+			uint object_mask = plane_mask;
+			if (!frustum.IsInside(objects_aabb[i], object_mask))
+				continue;
+
+			GameObject* object = objects[i];
+			if (object->IsParentEnabled()) {
+				ComponentMesh* mesh = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+				if (mesh != nullptr && mesh->mesh != nullptr) {
+					float3 obj_pos = static_cast<ComponentTransform*>(object->GetComponent(ComponentType::TRANSFORM))->GetGlobalPosition();
+					float distance = camera->frustum.pos.Distance(obj_pos);
+					to_draw->push_back({ distance, object });
+				}
+			}
+		}
+
+		if (!node.IsLeaf()) {
+			for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+				stack.push_back({ node.first_child + i, plane_mask });
+			}
+		}
+	}
 
-	AddNode(float3{ min(point.x,mid_point.x), min(point.y,mid_point.y), min(point.z,mid_point.z) },
-		float3{ max(point.x,mid_point.x), max(point.y,mid_point.y), max(point.z,mid_point.z) });
+	last_traversal_ms = timer.ReadMs();
+}
 
-	point = { section.maxPoint.x,section.minPoint.y,section.minPoint.z };
+void Octree::GetObjectsInRay(const LineSegment& ray, std::vector<std::pair<float, GameObject*>>* hits) const
+{
+	if (root == -1)
+		return;
 
-	AddNode(float3{ min(point.x,mid_point.x), min(point.y,mid_point.y), min(point.z,mid_point.z) },
-		float3{ max(point.x,mid_point.x), max(point.y,mid_point.y), max(point.z,mid_point.z) });
+	float distance_out = 0.f;
+	float distance = 0.f;
 
-	point = { section.minPoint.x,section.maxPoint.y,section.maxPoint.z };
+	stack.clear();
+	stack.push_back({ root, 0 });
 
-	AddNode(float3{ min(point.x,mid_point.x), min(point.y,mid_point.y), min(point.z,mid_point.z) },
-		float3{ max(point.x,mid_point.x), max(point.y,mid_point.y), max(point.z,mid_point.z) });
+	while (!stack.empty()) {
+		const OctreeNode& node = nodes[stack.back().first];
+		stack.pop_back();
 
-	point = { section.minPoint.x,section.minPoint.y,section.maxPoint.z };
-	
-	AddNode(float3{ min(point.x,mid_point.x), min(point.y,mid_point.y), min(point.z,mid_point.z) },
-		float3{ max(point.x,mid_point.x), max(point.y,mid_point.y), max(point.z,mid_point.z) });
+		if (!ray.Intersects(node.section, distance, distance_out))
+			continue;
 
-	// reorder the gameobjects to the new nodes if possible, if intersects parent keep them
-	std::vector<GameObject*>::iterator objs = game_objects.begin();
-	while (objs != game_objects.end()) {
-		bool to_delete = false;
-		if (*objs != nullptr) {
-			std::vector<OctreeNode*>::iterator item = children.begin();
-			uint intersections = 0;
-			for (; item != children.end(); ++item) {
-				ComponentMesh* mesh = (ComponentMesh*)(*objs)->GetComponent(ComponentType::MESH);
-				if (*item != nullptr && (*item)->section.Contains(mesh->GetGlobalAABB().minPoint) && (*item)->section.Contains(mesh->GetGlobalAABB().maxPoint)) {
-					(*item)->Insert(*objs, mesh->GetGlobalAABB());
-					to_delete = true;
-					break;
-				}
+		uint end = node.objects_offset + node.objects_count;
+		for (uint i = node.objects_offset; i < end; ++i) {
+			if (objects[i]->IsEnabled() && ray.Intersects(objects[i]->GetBB(), distance, distance_out)) {
+				hits->push_back({ distance, objects[i] });
 			}
 		}
-		if (to_delete) {
-			objs = game_objects.erase(objs);
-		}
-		else {
-			++objs;
+
+		if (!node.IsLeaf()) {
+			for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+				stack.push_back({ node.first_child + i, 0 });
+			}
 		}
 	}
 }
 
-Octree::Octree()
+double Octree::GetLastBuildMs() const
 {
+	return last_build_ms;
 }
 
-Octree::~Octree()
+uint Octree::GetLastBuildCount() const
 {
-	if (root != nullptr)
-		delete root;
+	return last_build_count;
 }
 
-void Octree::Insert(GameObject* object, bool add_children)
+double Octree::GetLastTraversalMs() const
 {
-	ComponentMesh* mesh_parent = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+	return last_traversal_ms;
+}
 
-	if (mesh_parent != nullptr && mesh_parent->mesh != nullptr) {
-		if (root == nullptr) {
-			Init(mesh_parent->GetGlobalAABB().minPoint, mesh_parent->GetGlobalAABB().maxPoint);
-		}
-		if (!Exists(object)) {
-			all_objects.push_back(object);
-			root->Insert(object, mesh_parent->GetGlobalAABB());
-		}
+uint Octree::GetNodesCount() const
+{
+	return nodes.size() - free_blocks.size() * OCTREE_CHILDREN;
+}
+
+uint Octree::GetObjectsCount() const
+{
+	return objects_count;
+}
+
+uint Octree::GetBytesUsed() const
+{
+	return nodes.capacity() * sizeof(OctreeNode) + free_blocks.capacity() * sizeof(int)
+		+ objects.capacity() * sizeof(GameObject*) + objects_aabb.capacity() * sizeof(AABB) + objects_node.capacity() * sizeof(int);
+}
+
+uint Octree::GetWastedObjects() const
+{
+	return wasted_objects;
+}
+
+int Octree::AllocateChildren(std::vector<OctreeNode>& pool, std::vector<int>& pool_free_blocks, int node)
+{
+	int first_child = -1;
+	if (!pool_free_blocks.empty()) {
+		first_child = pool_free_blocks.back();
+		pool_free_blocks.pop_back();
+	}
+	else {
+		first_child = pool.size();
+		pool.resize(pool.size() + OCTREE_CHILDREN);
 	}
 
-	if (add_children && !object->children.empty()) {
-		std::vector<GameObject*>::iterator item = object->children.begin();
-		for (; item != object->children.end(); ++item) {
-			if (*item != nullptr) {
-				Insert((*item), add_children);
-			}
-		}
+	const AABB section = pool[node].section;
+	float3 mid_point = section.minPoint + (section.maxPoint - section.minPoint) * 0.5F;
+
+	for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+		OctreeNode& child = pool[first_child + i];
+		child = OctreeNode();
+		child.parent = node;
+		child.section.minPoint = float3((i & 1) ? mid_point.x : section.minPoint.x, (i & 2) ? mid_point.y : section.minPoint.y, (i & 4) ? mid_point.z : section.minPoint.z);
+		child.section.maxPoint = float3((i & 1) ? section.maxPoint.x : mid_point.x, (i & 2) ? section.maxPoint.y : mid_point.y, (i & 4) ? section.maxPoint.z : mid_point.z);
+		// empty range at the end of the parent one
+		child.objects_offset = pool[node].objects_offset + pool[node].objects_count;
+	}
+
+	pool[node].first_child = first_child;
+	return first_child;
+}
+
+void Octree::FreeChildren(std::vector<OctreeNode>& pool, std::vector<int>& pool_free_blocks, int node)
+{
+	int first_child = pool[node].first_child;
+	for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+		pool[first_child + i] = OctreeNode();
 	}
+	pool_free_blocks.push_back(first_child);
+	pool[node].first_child = -1;
 }
 
-void Octree::Remove(GameObject* object)
+void Octree::Split(std::vector<OctreeNode>& pool, std::vector<int>& pool_free_blocks, OctreeSplitBuffers& buffers, int node, uint depth)
 {
-	if (root == nullptr)
+	if (depth >= OCTREE_MAX_BUILD_DEPTH)
 		return;
 
-	RemoveRecursively(object);
+	uint offset = pool[node].objects_offset;
+	uint count = pool[node].objects_count;
+	int first_child = AllocateChildren(pool, pool_free_blocks, node);
 
-	if (all_objects.empty()) {
-		Clear();
+	if (buffers.owners.size() < count) {
+		buffers.owners.resize(count);
+		buffers.objects.resize(count);
+		buffers.aabbs.resize(count);
 	}
-	else {
-		App->objects->octree.Recalculate(nullptr);
+
+	ClassifyObjects(pool, first_child, offset, count, buffers.owners.data());
+
+	uint objects_per_owner[OCTREE_CHILDREN + 1] = { 0 };
+	for (uint i = 0; i < count; ++i) {
+		++objects_per_owner[buffers.owners[i]];
+	}
+
+	// same as inserting, if nothing fits in the children they are not needed
+	if (objects_per_owner[OCTREE_CHILDREN] == count) {
+		FreeChildren(pool, pool_free_blocks, node);
+		return;
+	}
+
+	// the objects that stay in the node go first and then the ones of each child, the last one keeps the room left
+	uint next[OCTREE_CHILDREN + 1];
+	next[OCTREE_CHILDREN] = 0;
+	uint position = objects_per_owner[OCTREE_CHILDREN];
+	for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+		next[i] = position;
+		pool[first_child + i].objects_offset = offset + position;
+		pool[first_child + i].objects_count = objects_per_owner[i];
+		pool[first_child + i].objects_capacity = objects_per_owner[i];
+		position += objects_per_owner[i];
+	}
+	pool[first_child + OCTREE_CHILDREN - 1].objects_capacity += pool[node].objects_capacity - count;
+	pool[node].objects_count = objects_per_owner[OCTREE_CHILDREN];
+	pool[node].objects_capacity = objects_per_owner[OCTREE_CHILDREN];
+
+	for (uint i = 0; i < count; ++i) {
+		uint to = next[buffers.owners[i]]++;
+		buffers.objects[to] = objects[offset + i];
+		buffers.aabbs[to] = objects_aabb[offset + i];
+	}
+	for (uint i = 0; i < count; ++i) {
+		objects[offset + i] = buffers.objects[i];
+		objects_aabb[offset + i] = buffers.aabbs[i];
+	}
+
+	// the subtrees built in parallel split their nodes in their thread
+	if (parallel_build && &pool == &nodes && count >= OCTREE_PARALLEL_BUILD_OBJECTS) {
+		SplitChildrenInParallel(node, depth);
+		return;
+	}
+
+	for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+		if (pool[first_child + i].objects_count > bucket) {
+			Split(pool, pool_free_blocks, buffers, first_child + i, depth + 1);
+		}
 	}
 }
 
-void Octree::Clear()
+void Octree::SplitChildrenInParallel(int node, uint depth)
 {
-	if (root != nullptr) {
-		delete root;
-		root = nullptr;
+	int first_child = nodes[node].first_child;
+
+	OctreeSubtree subtrees[OCTREE_CHILDREN];
+	for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+		subtrees[i].nodes.push_back(nodes[first_child + i]);
+		subtrees[i].nodes[0].parent = -1;
+	}
+
+	// each subtree only changes its own pool and the range of objects of its child
+	ParallelFor(OCTREE_CHILDREN, 0, [this, &subtrees, depth](uint i) {
+		OctreeSubtree& subtree = subtrees[i];
+		if (subtree.nodes[0].objects_count > bucket) {
+			Split(subtree.nodes, subtree.free_blocks, subtree.buffers, 0, depth + 1);
+		}
+	});
+
+	// the rest of the nodes of each subtree go at the end of the octree pool
+	for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+		const OctreeSubtree& subtree = subtrees[i];
+		int child = first_child + i;
+		int base = (int)nodes.size() - 1;
+		auto to_pool = [child, base](int index) { return (index == -1) ? -1 : ((index == 0) ? child : base + index); };
+
+		nodes[child].first_child = to_pool(subtree.nodes[0].first_child);
+		nodes[child].objects_count = subtree.nodes[0].objects_count;
+		nodes[child].objects_capacity = subtree.nodes[0].objects_capacity;
+		for (uint j = 1; j < subtree.nodes.size(); ++j) {
+			OctreeNode subtree_node = subtree.nodes[j];
+			subtree_node.parent = to_pool(subtree_node.parent);
+			subtree_node.first_child = to_pool(subtree_node.first_child);
+			nodes.push_back(subtree_node);
+		}
+		std::vector<int>::const_iterator item = subtree.free_blocks.cbegin();
+		for (; item != subtree.free_blocks.cend(); ++item) {
+			free_blocks.push_back(to_pool(*item));
+		}
 	}
 }
 
-void Octree::Draw()
+void Octree::ClassifyObjects(const std::vector<OctreeNode>& pool, int first_child, uint offset, uint count, unsigned char* owners) const
 {
-	if (root != nullptr)
-		root->DrawNode();
+	if (!parallel_build || &pool != &nodes || count < OCTREE_PARALLEL_BUILD_OBJECTS) {
+		ClassifyRange(pool, first_child, offset, 0, count, owners);
+		return;
+	}
+
+	// each chunk only reads the children sections and writes its own part of owners
+	uint chunks = (count + OCTREE_PARALLEL_BUILD_OBJECTS - 1) / OCTREE_PARALLEL_BUILD_OBJECTS;
+	ParallelFor(chunks, 0, [this, &pool, first_child, offset, count, owners](uint chunk) {
+		uint begin = chunk * OCTREE_PARALLEL_BUILD_OBJECTS;
+		uint end = (begin + OCTREE_PARALLEL_BUILD_OBJECTS < count) ? begin + OCTREE_PARALLEL_BUILD_OBJECTS : count;
+		ClassifyRange(pool, first_child, offset, begin, end, owners);
+	});
 }
 
-const uint& Octree::GetBucket() const
+void Octree::ClassifyRange(const std::vector<OctreeNode>& pool, int first_child, uint offset, uint begin, uint end, unsigned char* owners) const
 {
-	return bucket;
+	for (uint i = begin; i < end; ++i) {
+		owners[i] = OCTREE_CHILDREN;
+		for (uint j = 0; j < OCTREE_CHILDREN; ++j) {
+			if (pool[first_child + j].section.Contains(objects_aabb[offset + i])) {
+				owners[i] = j;
+				break;
+			}
+		}
+	}
 }
 
-void Octree::SetBucket(const uint& bucket)
+void Octree::AddObject(int node, GameObject* object, const AABB& aabb)
 {
-	this->bucket = bucket;
+	OctreeNode& owner = nodes[node];
+	if (owner.objects_count == owner.objects_capacity) {
+		// the range can't grow without moving the next ones, it moves to the end with twice the room
+		uint capacity = (owner.objects_capacity * 2 > OCTREE_MIN_NODE_CAPACITY) ? owner.objects_capacity * 2 : OCTREE_MIN_NODE_CAPACITY;
+		uint offset = objects.size();
+		objects.resize(offset + capacity, nullptr);
+		objects_aabb.resize(offset + capacity);
+		objects_node.resize(offset + capacity, -1);
+
+		for (uint i = 0; i < owner.objects_count; ++i) {
+			uint from = owner.objects_offset + i;
+			objects[offset + i] = objects[from];
+			objects_aabb[offset + i] = objects_aabb[from];
+			objects_node[offset + i] = node;
+			objects[offset + i]->octree_index = offset + i;
+			objects[from] = nullptr;
+		}
+		wasted_objects += owner.objects_capacity;
+		owner.objects_offset = offset;
+		owner.objects_capacity = capacity;
+	}
+
+	uint index = owner.objects_offset + owner.objects_count++;
+	objects[index] = object;
+	objects_aabb[index] = aabb;
+	objects_node[index] = node;
+	object->octree_index = index;
+	++objects_count;
 }
 
-void Octree::Init(const float3& min, const float3& max)
+void Octree::RemoveObject(uint index)
 {
-	if (root != nullptr) {
-		delete root;
-		all_objects.clear();
+	int node = objects_node[index];
+	OctreeNode& owner = nodes[node];
+	uint last = owner.objects_offset + owner.objects_count - 1;
+
+	objects[index]->octree_index = -1;
+	if (index != last) {
+		objects[index] = objects[last];
+		objects_aabb[index] = objects_aabb[last];
+		objects[index]->octree_index = index;
+	}
+	objects[last] = nullptr;
+	--owner.objects_count;
+	--objects_count;
+
+	if (owner.objects_count == 0 && owner.IsLeaf()) {
+		CollapseEmptyChildren(owner.parent);
 	}
-	root = new OctreeNode(min, max);
 }
 
-void Octree::Recalculate(GameObject* new_object)
+void Octree::CollapseEmptyChildren(int node)
 {
-	if (root == nullptr)
-		return;
+	// go up while the children of the node are empty leaves
+	while (node != -1 && !nodes[node].IsLeaf()) {
+		int first_child = nodes[node].first_child;
+		for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+			if (!nodes[first_child + i].IsLeaf() || nodes[first_child + i].objects_count > 0)
+				return;
+		}
 
-	std::vector<GameObject*> to_save;
+		for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+			wasted_objects += nodes[first_child + i].objects_capacity;
+		}
+		FreeChildren(nodes, free_blocks, node);
 
-	AABB new_section;
-	new_section.SetNegativeInfinity();
+		if (nodes[node].objects_count > 0)
+			return;
+		node = nodes[node].parent;
+	}
+}
 
-	if (new_object != nullptr) {
-		ComponentMesh* mesh = (ComponentMesh*)new_object->GetComponent(ComponentType::MESH);
-		new_section = mesh->GetGlobalAABB();
+bool Octree::GrowRoot(const AABB& aabb)
+{
+	for (uint growth = 0; growth < OCTREE_MAX_ROOT_GROWTH; ++growth) {
+		const AABB section = nodes[root].section;
+		if (section.Contains(aabb))
+			return true;
+
+		// the new root doubles the old one towards the object, a flat root grows at least one unit
+		float3 size = section.Size().Max(float3::one());
+		AABB grown = section;
+		uint old_child = 0;
+		if (aabb.minPoint.x < section.minPoint.x) { grown.minPoint.x -= size.x; old_child |= 1; } else { grown.maxPoint.x += size.x; }
+		if (aabb.minPoint.y < section.minPoint.y) { grown.minPoint.y -= size.y; old_child |= 2; } else { grown.maxPoint.y += size.y; }
+		if (aabb.minPoint.z < section.minPoint.z) { grown.minPoint.z -= size.z; old_child |= 4; } else { grown.maxPoint.z += size.z; }
+
+		// the root keeps its index in the pool and the old one moves to one of its children
+		OctreeNode old_root = nodes[root];
+		nodes[root].section = grown;
+		nodes[root].first_child = -1;
+		nodes[root].objects_count = 0;
+		nodes[root].objects_capacity = 0;
+		int first_child = AllocateChildren(nodes, free_blocks, root);
+		int moved = first_child + old_child;
+
+		AABB moved_section = nodes[moved].section;
+		moved_section.Enclose(old_root.section);
+		old_root.section = moved_section;
+		old_root.parent = root;
+		nodes[moved] = old_root;
+
+		if (!old_root.IsLeaf()) {
+			for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+				nodes[old_root.first_child + i].parent = moved;
+			}
+		}
+		uint end = old_root.objects_offset + old_root.objects_count;
+		for (uint i = old_root.objects_offset; i < end; ++i) {
+			objects_node[i] = moved;
+		}
 	}
 
-	// get all gameobjects in octree and get the min & max points
-	root->SaveGameObjects(&to_save, &new_section);
+	return nodes[root].section.Contains(aabb);
+}
 
-	if (new_object != nullptr) {
-		to_save.push_back(new_object);
+void Octree::Compact()
+{
+	std::vector<GameObject*> compact_objects;
+	std::vector<AABB> compact_aabbs;
+	std::vector<int> compact_nodes;
+	compact_objects.reserve(objects_count);
+	compact_aabbs.reserve(objects_count);
+	compact_nodes.reserve(objects_count);
+
+	for (uint i = 0; i < nodes.size(); ++i) {
+		OctreeNode& node = nodes[i];
+		uint offset = compact_objects.size();
+		for (uint j = 0; j < node.objects_count; ++j) {
+			GameObject* object = objects[node.objects_offset + j];
+			object->octree_index = offset + j;
+			compact_objects.push_back(object);
+			compact_aabbs.push_back(objects_aabb[node.objects_offset + j]);
+			compact_nodes.push_back(i);
+		}
+		node.objects_offset = offset;
+		node.objects_capacity = node.objects_count;
 	}
 
-	// delete the old octree and create it again
-	Init(new_section.minPoint, new_section.maxPoint);
+	objects.swap(compact_objects);
+	objects_aabb.swap(compact_aabbs);
+	objects_node.swap(compact_nodes);
+	wasted_objects = 0;
+}
 
-	// insert all the game objects
-	std::vector<GameObject*>::iterator item = to_save.begin();
-	for (; item != to_save.end(); ++item) {
-		if (*item != nullptr) {
-			Insert((*item), false);
+void Octree::IndexObjects(int node)
+{
+	stack.clear();
+	stack.push_back({ node, 0 });
+
+	while (!stack.empty()) {
+		int index = stack.back().first;
+		const OctreeNode& current = nodes[index];
+		stack.pop_back();
+
+		uint end = current.objects_offset + current.objects_count;
+		for (uint i = current.objects_offset; i < end; ++i) {
+			objects_node[i] = index;
+			objects[i]->octree_index = i;
+		}
+
+		if (!current.IsLeaf()) {
+			for (uint i = 0; i < OCTREE_CHILDREN; ++i) {
+				stack.push_back({ current.first_child + i, 0 });
+			}
 		}
 	}
-	to_save.clear();
 }
 
-void Octree::SetStaticDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera)
+void Octree::GatherObjects(std::vector<GameObject*>* gathered) const
 {
-	if (root == nullptr) {
-		return;
+	gathered->reserve(gathered->size() + objects_count);
+	for (uint i = 0; i < nodes.size(); ++i) {
+		uint end = nodes[i].objects_offset + nodes[i].objects_count;
+		for (uint j = nodes[i].objects_offset; j < end; ++j) {
+			gathered->push_back(objects[j]);
+		}
 	}
-
-	root->SetStaticDrawList(to_draw, camera);
 }
 
-bool Octree::Exists(GameObject* object)
+void Octree::RemoveRecursively(GameObject* obj, bool remove_children)
 {
-	bool ret = false;
-	if (!all_objects.empty()) {
-		ret = std::find(all_objects.begin(), all_objects.end(), object) == all_objects.begin();
+	if (Exists(obj)) {
+		RemoveObject(obj->octree_index);
+	}
+
+	if (remove_children && !obj->children.empty()) {
+		std::vector<GameObject*>::iterator item = obj->children.begin();
+		for (; item != obj->children.end(); ++item) {
+			if (*item != nullptr) {
+				RemoveRecursively((*item), remove_children);
+			}
+		}
 	}
-	return ret;
 }
 
-void Octree::RemoveRecursively(GameObject* obj)
+void Octree::RemoveFromBulk(GameObject* obj, bool remove_children)
 {
-	ComponentMesh* mesh_parent = (ComponentMesh*)obj->GetComponent(ComponentType::MESH);
-	if (mesh_parent != nullptr && mesh_parent->mesh != nullptr) {
-		if (root->Remove(obj))
-			all_objects.remove(obj);
-	}
+	bulk_objects.erase(std::remove(bulk_objects.begin(), bulk_objects.end(), obj), bulk_objects.end());
 
-	if (!obj->children.empty()) {
+	if (remove_children) {
 		std::vector<GameObject*>::iterator item = obj->children.begin();
 		for (; item != obj->children.end(); ++item) {
 			if (*item != nullptr) {
-				RemoveRecursively((*item));
+				RemoveFromBulk(*item, remove_children);
 			}
 		}
 	}
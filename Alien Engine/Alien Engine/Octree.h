@@ -1,60 +1,74 @@
 #pragma once
 
 #include "MathGeoLib/include/Geometry/AABB.h"
+#include "MathGeoLib/include/Geometry/LineSegment.h"
 #include <vector>
 #include <list>
 #include <map>
 #include "GameObject.h"
+#include "FrustumCulling.h"
 
 class ComponentCamera;
 
-class OctreeNode {
+// nodes with more objects than this classify them in chunks of this size and build the subtrees of their children
+// at the same time in the ThreadPool
+#define OCTREE_PARALLEL_BUILD_OBJECTS 4096
+// objects with the same AABB would subdivide forever
+#define OCTREE_MAX_BUILD_DEPTH 16
+#define OCTREE_CHILDREN 8
+// room for objects a node gets when its range is full and it moves to the end of the objects
+#define OCTREE_MIN_NODE_CAPACITY 4
+// times the root can double its size to contain a new object before the octree is built again
+#define OCTREE_MAX_ROOT_GROWTH 16
 
-	friend class Octree;
+// nodes live in the octree pool, the 8 children of a node are always consecutive
+struct OctreeNode {
 
-public:
-
-	OctreeNode(const float3& min, const float3& max);
-	~OctreeNode();
-
-	// insert a gameobject
-	void Insert(GameObject* object, const AABB& sect);
-	
-	// remove a gameobject
-	bool Remove(GameObject* object);
-	// draw AABB
-	void DrawNode();
-
-private:
-
-	void AddGameObject(GameObject* obj);
-	void AddNode(const float3& min, const float3& max);
-	void Subdivide();
-	void Regrup();
-	void SaveGameObjects(std::vector<GameObject*>* to_save, AABB* new_section);
-	bool AddToChildren(GameObject* obj, const AABB& sect);
-	void SetStaticDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera);
-
-public:
+	bool IsLeaf() const { return first_child == -1; }
 
 	AABB section;
-	std::vector<GameObject*> game_objects;
-	OctreeNode* parent = nullptr;
-	std::vector<OctreeNode*> children;
+	int parent = -1;
+	// index of the first child in the pool, -1 if it is a leaf
+	int first_child = -1;
+
+	// the objects of this node are objects[objects_offset, objects_offset + objects_count) in the octree,
+	// and up to objects_capacity the node can add objects without moving the others
+	uint objects_offset = 0;
+	uint objects_count = 0;
+	uint objects_capacity = 0;
+};
+
+// the buffers Split uses to reorder the objects, each subtree built in parallel has its own
+struct OctreeSplitBuffers {
+	std::vector<unsigned char> owners;
+	std::vector<GameObject*> objects;
+	std::vector<AABB> aabbs;
+};
 
+// the nodes of a child of the octree split in parallel, the child is the node 0
+struct OctreeSubtree {
+	std::vector<OctreeNode> nodes;
+	std::vector<int> free_blocks;
+	OctreeSplitBuffers buffers;
 };
 
+// Octree for the static objects. Nodes are stored in a pool and each one owns a range of one contiguous array
+// of objects and their AABBs, so the traversals don't jump around the heap. Each object knows its position in the
+// array, removing swaps it with the last one of its node, and a node with a full range moves it to the end of the
+// array with room to grow. The ranges left behind are compacted when they are more than the objects.
 class Octree {
 
 public:
 
 	Octree();
 	~Octree();
-	
+
 	// insert a gameobject
 	void Insert(GameObject* object, bool add_children);
-	// remove a gameobject
-	void Remove(GameObject* object);
+	// remove a gameobject and its children
+	void Remove(GameObject* object, bool remove_children = true);
+	// the global AABB of a static object in the octree has changed
+	void UpdateObject(GameObject* object);
 	// remove the hole octree
 	void Clear();
 
@@ -69,18 +83,85 @@ public:
 	bool Exists(GameObject* object);
 	// create again the octree
 	void Recalculate(GameObject* new_object);
-
-	void SetStaticDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera);
+	// create the octree with all the objects at once, much faster than inserting them one by one
+	void Build(const std::vector<GameObject*>& objects);
+
+	// between begin and end Insert and Remove only keep a list, the octree is built once in EndBulkInsert. Can be nested
+	void BeginBulkInsert();
+	void EndBulkInsert();
+	bool IsBulkInserting() const;
+
+	// frustum holds the planes of the camera, built once for the frame
+	void SetStaticDrawList(std::vector<std::pair<float, GameObject*>>* to_draw, const ComponentCamera* camera, const FrustumCulling& frustum);
+	void GetObjectsInRay(const LineSegment& ray, std::vector<std::pair<float, GameObject*>>* hits) const;
+
+	double GetLastBuildMs() const;
+	uint GetLastBuildCount() const;
+	double GetLastTraversalMs() const;
+	uint GetNodesCount() const;
+	uint GetObjectsCount() const;
+	// memory reserved by the pool and the objects arrays
+	uint GetBytesUsed() const;
+	// objects of the pool that don't belong to any node
+	uint GetWastedObjects() const;
 
 	uint bucket = 2;
-	OctreeNode* root = nullptr;
-private:
+	// false builds everything in the calling thread
+	bool parallel_build = true;
 
+private:
 
-	void RemoveRecursively(GameObject* obj);
+	// pool is the octree nodes or the nodes of a subtree built in parallel
+	int AllocateChildren(std::vector<OctreeNode>& pool, std::vector<int>& pool_free_blocks, int node);
+	void FreeChildren(std::vector<OctreeNode>& pool, std::vector<int>& pool_free_blocks, int node);
+
+	// move down to new children the objects of the node that fit in them, and keep splitting the children with too many objects
+	void Split(std::vector<OctreeNode>& pool, std::vector<int>& pool_free_blocks, OctreeSplitBuffers& buffers, int node, uint depth);
+	// split the children of a node of the octree pool each one in its own pool in the ThreadPool, and add their nodes to the octree
+	void SplitChildrenInParallel(int node, uint depth);
+	// owners[i] is the child that contains the object offset + i or OCTREE_CHILDREN if it must stay in the node
+	void ClassifyObjects(const std::vector<OctreeNode>& pool, int first_child, uint offset, uint count, unsigned char* owners) const;
+	void ClassifyRange(const std::vector<OctreeNode>& pool, int first_child, uint offset, uint begin, uint end, unsigned char* owners) const;
+
+	// add the object at the end of the node range, the range moves to the end of the objects if it is full
+	void AddObject(int node, GameObject* object, const AABB& aabb);
+	// the last object of the node takes its place, and the children of the parents left empty are freed
+	void RemoveObject(uint index);
+	void CollapseEmptyChildren(int node);
+	// make the root bigger until it contains the AABB, the old root becomes one of its children
+	bool GrowRoot(const AABB& aabb);
+	// move the ranges of all the nodes together at the start of the objects
+	void Compact();
+	// set the node and the index of the objects in the subtree of the node
+	void IndexObjects(int node);
+	void GatherObjects(std::vector<GameObject*>* gathered) const;
+
+	void RemoveRecursively(GameObject* obj, bool remove_children);
+	void RemoveFromBulk(GameObject* obj, bool remove_children);
 
 private:
 
-	std::list<GameObject*> all_objects;
-
-};
\ No newline at end of file
+	std::vector<OctreeNode> nodes;
+	int root = -1;
+	// first node of the blocks of 8 children that are not used
+	std::vector<int> free_blocks;
+
+	std::vector<GameObject*> objects;
+	std::vector<AABB> objects_aabb;
+	// node of each object
+	std::vector<int> objects_node;
+	uint objects_count = 0;
+	uint wasted_objects = 0;
+
+	std::vector<GameObject*> bulk_objects;
+	uint bulk_depth = 0;
+
+	// used by the traversals to avoid the recursion
+	mutable std::vector<std::pair<int, uint>> stack;
+	// used by Split to reorder the objects
+	OctreeSplitBuffers split_buffers;
+
+	double last_build_ms = 0.0;
+	uint last_build_count = 0;
+	double last_traversal_ms = 0.0;
+};
@@ -24,7 +24,7 @@ void PanelBuild::PanelLogic()
 	}
 
 	ImGui::OpenPopup("Build Settings");
-	ImGui::SetNextWindowSize({ 300,400 });
+	ImGui::SetNextWindowSize({ 300,425 });
 	if (ImGui::BeginPopupModal("Build Settings", &enabled, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove))
 	{
 		ImGui::Text("Select the first scene for the build");
@@ -118,6 +118,13 @@ void PanelBuild::PanelLogic()
 		ImGui::Button((build_name.empty()) ? "NO BUILD FOLDER" : build_name.data(), { ImGui::GetWindowWidth() * 0.61F, 0 });
 		ImGui::PopStyleColor(3);
 
+		ImGui::Spacing();
+
+		ImGui::SetCursorPosX(10);
+		ImGui::Checkbox("Pack Library", &pack_library);
+		ImGui::SameLine();
+		ImGui::Checkbox("LZ4", &compress_library);
+
 		ImGui::Spacing();
 		ImGui::Spacing();
 
@@ -291,8 +298,27 @@ void PanelBuild::CreateBuild()
 	std::string dir(curr_dir);
 	App->file_system->NormalizePath(dir);
 
+	// the library goes in one archive, the game creates its folders empty for the files it writes
+	bool packed = false;
+	if (pack_library) {
+		std::vector<std::string> library_files;
+		App->file_system->GetFilesToPack(library_files);
+
+		ArchivePackStats stats;
+		std::string archive_path = folder_location + "/" + LIBRARY_ARCHIVE_FILE;
+		packed = AssetArchive::Pack(library_files, archive_path.data(), compress_library, &stats);
+		if (packed) {
+			LOG_ENGINE("Packed %u library files in %s, %u compressed, %.2f MB", stats.files, archive_path.data(), stats.compressed, stats.archive_bytes / (1024.0F * 1024.0F));
+		}
+		else {
+			LOG_ENGINE("Error packing the library in %s, the files are copied", archive_path.data());
+			remove(archive_path.data());
+		}
+	}
+
 	for (uint i = 0; i < directories.size(); ++i) {
-		if (strcmp(directories[i].data(), "AlienEngineScripts") != 0 && strcmp(directories[i].data(), "Assets") != 0 && strcmp(directories[i].data(), "Configuration") != 0) {
+		if (strcmp(directories[i].data(), "AlienEngineScripts") != 0 && strcmp(directories[i].data(), "Assets") != 0 && strcmp(directories[i].data(), "Configuration") != 0
+			&& (!packed || strcmp(directories[i].data(), "Library") != 0)) {
 			std::experimental::filesystem::copy(std::string(dir + "/" + directories[i]).data(), std::string(folder_location + "/" + directories[i]).data(), std::experimental::filesystem::copy_options::recursive);
 		}
 	}
@@ -34,4 +34,7 @@ private:
 	std::string folder_location;
 	char game_name[MAX_PATH] = "MyAwesomeGame";
 	char folder_name[MAX_PATH] = "MyAwesomeFolder";
+	// the library is packed in an archive instead of copying its files
+	bool pack_library = true;
+	bool compress_library = false;
 };
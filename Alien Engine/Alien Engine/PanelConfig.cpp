@@ -1,4 +1,5 @@
 #include "PanelConfig.h"
+#include "PoolAllocator.h"
 #include "ModuleWindow.h"
 #include "SDL/include/SDL.h"
 #include "imgui/imgui.h"
@@ -95,6 +96,10 @@ void PanelConfig::PanelLogic()
 		ImGui::Text("Accumulated Alloc Unit Count: %u", memory_stats.accumulatedAllocUnitCount);
 		ImGui::Text("Total Alloc Unit Count: %u", memory_stats.totalAllocUnitCount);
 		ImGui::Text("Peak Alloc Unit Count: %u", memory_stats.peakAllocUnitCount);
+		// the panel is drawn once per frame
+		static uint last_alloc_unit_count = memory_stats.accumulatedAllocUnitCount;
+		ImGui::Text("Allocations Per Frame: %u", memory_stats.accumulatedAllocUnitCount - last_alloc_unit_count);
+		last_alloc_unit_count = memory_stats.accumulatedAllocUnitCount;
 
 
 		ImGui::Spacing();
@@ -271,6 +276,117 @@ void PanelConfig::PanelLogic()
 
 		ImGui::Spacing();
 	}
+	if (ImGui::CollapsingHeader("Performance"))
+	{
+		ImGui::Spacing();
+		ImGui::Text("Transform Nodes: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->transform_hierarchy.GetNodesCount());
+		ImGui::Text("Transforms Updated: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->transform_hierarchy.GetLastUpdatedCount());
+		ImGui::Text("Transforms Update: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->transform_hierarchy.GetLastUpdateMs());
+		ImGui::Separator();
+		ImGui::Checkbox("Component Systems", &App->objects->use_component_systems);
+		ImGui::Text("Meshes: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->component_registry.GetCount(ComponentType::MESH));
+		ImGui::SameLine(); ImGui::Text("Lights: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->component_registry.GetCount(ComponentType::LIGHT));
+		ImGui::SameLine(); ImGui::Text("Cameras: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->component_registry.GetCount(ComponentType::CAMERA));
+		if (App->objects->use_component_systems) {
+			ImGui::Text("Cameras System: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->cameras_system_ms);
+			ImGui::Text("Lights System: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->lights_system_ms);
+			ImGui::Text("Meshes System: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->meshes_system_ms);
+		}
+		ImGui::Separator();
+		ImGui::Checkbox("Dynamic BVH", &App->objects->use_dynamic_tree);
+		ImGui::Text("BVH Leaves: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->dynamic_tree.GetLeavesCount());
+		ImGui::SameLine(); ImGui::Text("Nodes: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->dynamic_tree.GetNodesCount());
+		ImGui::SameLine(); ImGui::Text("Height: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%i", App->objects->dynamic_tree.GetHeight());
+		ImGui::Separator();
+		ImGui::Text("Octree Objects: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->octree.GetObjectsCount());
+		ImGui::SameLine(); ImGui::Text("Nodes: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->octree.GetNodesCount());
+		ImGui::SameLine(); ImGui::Text("Memory: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.2f KB", App->objects->octree.GetBytesUsed() / 1024.0F);
+		ImGui::Text("Octree Build: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms (%u objects)", (float)App->objects->octree.GetLastBuildMs(), App->objects->octree.GetLastBuildCount());
+		ImGui::Text("Octree Culling: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->octree.GetLastTraversalMs());
+		ImGui::Separator();
+		ImGui::Text("Render Queues: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->render_queues_built);
+		ImGui::SameLine(); ImGui::Text("Shared: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->render_queues_shared);
+		ImGui::SameLine(); ImGui::Text("Objects: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->render_queues_objects);
+		ImGui::Text("Queues Culling: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->render_queues_culling_ms);
+		ImGui::Text("Queues Sort: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->objects->render_queues_sort_ms);
+		ImGui::Separator();
+		ImGui::Text("Meshes GPU Memory: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.2f KB", App->resources->meshes_buffers_size / 1024.0F);
+		ImGui::SameLine(); ImGui::Text("Saved: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.2f KB", App->resources->meshes_buffers_saved / 1024.0F);
+		ImGui::Text("Meshes Loaded: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u (%u mapped)", App->resources->meshes_loaded, App->resources->meshes_mapped);
+		ImGui::SameLine(); ImGui::Text("Load: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->resources->meshes_load_ms);
+		ImGui::Text("Meshes Load Heap: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.2f KB", App->resources->meshes_load_heap_bytes / 1024.0F);
+		ImGui::Checkbox("Check Meshes Checksum", &App->resources->check_meshes_checksum);
+		ImGui::Separator();
+		ImGui::Text("Resources: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->registry.GetCount());
+		ImGui::Text("Last Import: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms (%u resources)", (float)App->resources->last_import_ms, App->resources->last_import_resources);
+		ImGui::Text("Import Phases: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u meshes, %.3f ms convert, %.3f ms upload, %.3f ms serialize, %.3f ms save", App->importer->last_import_meshes,
+			(float)App->importer->last_convert_ms, (float)App->importer->last_upload_ms, (float)App->importer->last_serialize_ms, (float)App->importer->last_save_ms);
+		int import_threads = App->importer->import_threads;
+		if (ImGui::SliderInt("Import Threads (0 all cores)", &import_threads, 0, 32)) {
+			App->importer->import_threads = import_threads;
+		}
+		if (ImGui::Button("Cook Textures")) {
+			App->resources->CookAllTextures();
+		}
+		if (App->importer->last_cook_textures > 0) {
+			ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u textures, %.3f ms cooking, %.3f ms saving", App->importer->last_cook_textures, (float)App->importer->last_cook_ms, (float)App->importer->last_cook_save_ms);
+		}
+		ImGui::Checkbox("Optimize Imported Meshes", &App->importer->optimize_meshes);
+		ImGui::SameLine(); ImGui::Checkbox("Generate LODs", &App->importer->generate_lods);
+		ImGui::Text("Last Scene Load: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms (%u resources)", (float)App->resources->last_scene_load_ms, App->resources->last_scene_load_resources);
+		ImGui::Checkbox("Object Pools", &ObjectAllocator::enabled);
+		ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u objects in %u chunks", ObjectAllocator::GetPooledCount(), ObjectAllocator::GetChunksCount());
+		ImGui::Text("Play Mode: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "enter %.3f ms, exit %.3f ms (%u reused, %u loaded, %u removed)", (float)App->objects->play_enter_ms, (float)App->objects->play_exit_ms,
+			App->objects->play_objects_reused, App->objects->play_objects_loaded, App->objects->play_objects_removed);
+		ImGui::Text("Assets Read: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms (%u clean, %u changed, %u new, %u removed)", (float)App->resources->assets_read_ms,
+			App->resources->asset_database.clean, App->resources->asset_database.changed, App->resources->asset_database.added, App->resources->asset_database.removed);
+		ImGui::Checkbox("Compiled Prefabs", &App->resources->use_compiled_prefabs);
+		ImGui::Text("Object Pool: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u spawned, %u free (%u created, %u reused)", App->objects->object_pool.GetSpawnedCount(),
+			App->objects->object_pool.GetFreeCount(), App->objects->object_pool.created, App->objects->object_pool.reused);
+		ImGui::Separator();
+		ImGui::Checkbox("Cache Unreferenced", &App->resources->residency.cache_unreferenced);
+		ImGui::SameLine(); ImGui::Checkbox("Drop CPU Copies", &App->resources->residency.drop_cpu_copies);
+		ImGui::SliderInt("CPU Budget (MB)", &App->resources->residency.cpu_budget_mb, 16, 4096);
+		ImGui::SliderInt("GPU Budget (MB)", &App->resources->residency.gpu_budget_mb, 16, 4096);
+		ImGui::Text("Resident CPU: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.2f MB", App->resources->residency.GetCPUUsed() / (1024.0F * 1024.0F));
+		ImGui::SameLine(); ImGui::Text("GPU: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.2f MB", App->resources->residency.GetGPUUsed() / (1024.0F * 1024.0F));
+		ImGui::SameLine(); ImGui::Text("Cached: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->residency.GetCachedCount());
+		ImGui::Text("Cache Hits: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->residency.GetHits());
+		ImGui::SameLine(); ImGui::Text("Misses: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->residency.GetMisses());
+		ImGui::SameLine(); ImGui::Text("Evictions: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->residency.GetEvictions());
+		if (ImGui::Button("Free Cache")) {
+			App->resources->residency.FreeCache();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Reset Counters")) {
+			App->resources->residency.ResetCounters();
+		}
+		ImGui::Separator();
+		ImGui::Checkbox("Async Loading", &App->resources->async_loading);
+		ImGui::SameLine(); ImGui::Text("Workers: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->streamer.GetWorkersCount());
+		ImGui::SliderFloat("Upload Budget (ms)", &App->resources->upload_budget_ms, 0.1F, 16.0F);
+		ImGui::SliderInt("Texture Upload Chunk (KB)", &App->resources->texture_upload_chunk_kb, 16, 4096);
+		ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u KB this frame", App->resources->textures_uploaded_bytes / 1024);
+		ImGui::Text("Streaming: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->streamer.GetPendingCount());
+		ImGui::SameLine(); ImGui::Text("Uploaded: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->resources->streamer.GetTotalUploaded());
+		ImGui::Text("Frame Upload: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms (%u resources)", (float)App->resources->streamer.GetLastUploadMs(), App->resources->streamer.GetLastUploadCount());
+		ImGui::SameLine(); ImGui::Text("Max: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%.3f ms", (float)App->resources->streamer.GetMaxUploadMs());
+		ImGui::Separator();
+		ImGui::Checkbox("Render Batches", &App->objects->use_render_batches);
+		ImGui::SameLine(); ImGui::Checkbox("LODs", &App->objects->use_lods);
+		ImGui::SliderFloat("LOD Screen Size", &App->objects->lod_screen_size, 0.05F, 1.0F);
+		ImGui::SliderFloat("LOD Hysteresis", &App->objects->lod_hysteresis, 0.0F, 0.5F);
+		ImGui::Text("Batches: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->render_batches);
+		ImGui::SameLine(); ImGui::Text("Batched Objects: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->objects->render_batched_objects);
+		ImGui::Text("Draw Calls: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->renderer3D->draw_calls);
+		ImGui::SameLine(); ImGui::Text("State Changes: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->renderer3D->state_changes);
+		ImGui::Text("Triangles: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->renderer3D->triangles);
+		ImGui::SameLine(); ImGui::Text("Without LODs: "); ImGui::SameLine(); ImGui::TextColored({ 255,216,0,100 }, "%u", App->renderer3D->triangles_full);
+		if (ImGui::Button("Rebuild Octree")) {
+			App->objects->octree.Recalculate(nullptr);
+		}
+		ImGui::Spacing();
+	}
 	ImGui::Spacing();
 	if (ImGui::Button("Save Configuration", { 150,30 })) {
 		App->SaveCustomConfig();
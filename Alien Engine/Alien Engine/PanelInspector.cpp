@@ -75,10 +75,10 @@ void PanelInspector::PanelLogic()
 						some_static = true;
 					}
 					if (trans.Equals(float4x4::zero())) {
-						trans = (*item)->GetComponent<ComponentTransform>()->global_transformation;
+						trans = (*item)->GetComponent<ComponentTransform>()->GetGlobalMatrix();
 					}
 					else {
-						trans = trans * (*item)->GetComponent<ComponentTransform>()->global_transformation;
+						trans = trans * (*item)->GetComponent<ComponentTransform>()->GetGlobalMatrix();
 					}
 					
 				}
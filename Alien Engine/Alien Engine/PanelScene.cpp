@@ -181,7 +181,7 @@ void PanelScene::GuizmosLogic()
 				if ((*item)->is_static) {
 					block_move = true;
 				}
-				trans += (*item)->GetComponent<ComponentTransform>()->global_transformation;
+				trans += (*item)->GetComponent<ComponentTransform>()->GetGlobalMatrix();
 			}
 		}
 
@@ -214,10 +214,10 @@ void PanelScene::GuizmosLogic()
 					if ((*item)->parent != root)
 					{
 						ComponentTransform* parent_transform = (ComponentTransform*)(*item)->parent->GetComponent(ComponentType::TRANSFORM);
-						(*item)->GetComponent<ComponentTransform>()->SetGlobalTransformation(parent_transform->global_transformation.Inverted() * delta_matrix.Transposed() * (*item)->GetComponent<ComponentTransform>()->global_transformation);
+						(*item)->GetComponent<ComponentTransform>()->SetGlobalTransformation(parent_transform->GetGlobalMatrix().Inverted() * delta_matrix.Transposed() * (*item)->GetComponent<ComponentTransform>()->GetGlobalMatrix());
 					}
 					else {
-						(*item)->GetComponent<ComponentTransform>()->SetGlobalTransformation(delta_matrix.Transposed() * (*item)->GetComponent<ComponentTransform>()->global_transformation);
+						(*item)->GetComponent<ComponentTransform>()->SetGlobalTransformation(delta_matrix.Transposed() * (*item)->GetComponent<ComponentTransform>()->GetGlobalMatrix());
 					}
 				}
 				if (guizmo_return && (*item) == selected.back()) {
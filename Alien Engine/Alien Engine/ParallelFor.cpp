@@ -0,0 +1,111 @@
+#include "ParallelFor.h"
+
+// the thread running jobs of the pool, a ParallelFor inside a job doesn't wait for the pool it is part of
+static thread_local bool running_jobs = false;
+
+uint GetParallelThreadsCount(uint threads_count)
+{
+	if (threads_count == 0) {
+		threads_count = std::thread::hardware_concurrency();
+	}
+	return (threads_count > 0) ? threads_count : 1;
+}
+
+void ParallelFor(uint count, uint threads_count, const std::function<void(uint)>& job)
+{
+	static ThreadPool pool;
+	pool.ParallelFor(count, threads_count, job);
+}
+
+ThreadPool::ThreadPool() : next(0)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake_up.notify_all();
+
+	std::vector<std::thread>::iterator item = threads.begin();
+	for (; item != threads.end(); ++item) {
+		(*item).join();
+	}
+}
+
+void ThreadPool::ParallelFor(uint count, uint threads_count, const std::function<void(uint)>& job)
+{
+	threads_count = GetParallelThreadsCount(threads_count);
+	if (threads_count > count) {
+		threads_count = count;
+	}
+
+	if (threads_count < 2 || running_jobs || !using_pool.try_lock()) {
+		for (uint i = 0; i < count; ++i) {
+			job(i);
+		}
+		return;
+	}
+
+	// the calling thread is one of them
+	uint workers_count = GetParallelThreadsCount(0) - 1;
+	while (threads.size() < workers_count) {
+		threads.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->count = count;
+		next = 0;
+		++batch;
+		workers_wanted = (threads_count - 1 < threads.size()) ? threads_count - 1 : threads.size();
+	}
+	wake_up.notify_all();
+
+	RunJobs();
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		// the workers that didn't wake up yet have nothing left to do
+		workers_wanted = 0;
+		finished.wait(lock, [this]() { return workers_running == 0; });
+		this->job = nullptr;
+	}
+	using_pool.unlock();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	uint last_batch = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake_up.wait(lock, [this, &last_batch]() { return quit || (batch != last_batch && workers_wanted > 0); });
+		if (quit)
+			return;
+
+		last_batch = batch;
+		--workers_wanted;
+		++workers_running;
+
+		lock.unlock();
+		RunJobs();
+		lock.lock();
+
+		if (--workers_running == 0) {
+			finished.notify_all();
+		}
+	}
+}
+
+void ThreadPool::RunJobs()
+{
+	running_jobs = true;
+	// the jobs are taken one by one, a big mesh doesn't leave the other threads waiting
+	for (uint i = next++; i < count; i = next++) {
+		(*job)(i);
+	}
+	running_jobs = false;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+typedef unsigned int uint;
+
+// threads_count 0 uses one thread for each core
+uint GetParallelThreadsCount(uint threads_count);
+
+// call job with every index from 0 to count, split between threads_count threads. The calling thread is one of them
+// and it returns when all the indices are done. The jobs can't log or use GL, only the main thread can
+void ParallelFor(uint count, uint threads_count, const std::function<void(uint)>& job);
+
+// Threads created the first time they are needed that wait for the jobs of ParallelFor, so each call doesn't
+// create and join its own threads. One ParallelFor runs in the pool at a time, a call from inside a job or from
+// another thread while the pool is busy runs its jobs in the calling thread
+class ThreadPool {
+
+public:
+
+	ThreadPool();
+	~ThreadPool();
+
+	void ParallelFor(uint count, uint threads_count, const std::function<void(uint)>& job);
+
+private:
+
+	void WorkerLoop();
+	void RunJobs();
+
+private:
+
+	std::vector<std::thread> threads;
+
+	// held by the thread that is using the pool
+	std::mutex using_pool;
+
+	std::mutex mutex;
+	std::condition_variable wake_up;
+	std::condition_variable finished;
+
+	const std::function<void(uint)>* job = nullptr;
+	uint count = 0;
+	std::atomic<uint> next;
+	// each ParallelFor is a new batch, the workers that wake up join it until it has all the threads it wants
+	uint batch = 0;
+	uint workers_wanted = 0;
+	uint workers_running = 0;
+	bool quit = false;
+};
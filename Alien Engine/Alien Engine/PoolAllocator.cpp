@@ -0,0 +1,220 @@
+#include "PoolAllocator.h"
+#include "GameObject.h"
+#include "Component.h"
+#include <new>
+#include <algorithm>
+// without mmgr.h, its new and delete macros break the operator definitions. The chunks are still counted by its
+// global operator new
+
+bool ObjectAllocator::enabled = true;
+PoolAllocator* ObjectAllocator::pools[POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT] = { nullptr };
+
+PoolAllocator::PoolAllocator(uint block_size, uint blocks_per_chunk) : block_size(block_size), blocks_per_chunk(blocks_per_chunk)
+{
+}
+
+PoolAllocator::~PoolAllocator()
+{
+	std::vector<Chunk>::iterator item = chunks.begin();
+	for (; item != chunks.end(); ++item) {
+		::operator delete((*item).data);
+	}
+	chunks.clear();
+	free_blocks = nullptr;
+}
+
+void* PoolAllocator::Allocate()
+{
+	if (free_blocks == nullptr) {
+		AddChunk();
+	}
+
+	FreeBlock* block = free_blocks;
+	free_blocks = block->next;
+	++chunks[FindChunk(block)].used;
+	++used;
+	return block;
+}
+
+void PoolAllocator::Free(void* block)
+{
+	--chunks[FindChunk(block)].used;
+	--used;
+	FreeBlock* free_block = (FreeBlock*)block;
+	free_block->next = free_blocks;
+	free_blocks = free_block;
+}
+
+bool PoolAllocator::Owns(const void* block) const
+{
+	return FindChunk(block) != -1;
+}
+
+uint PoolAllocator::ReleaseUnused()
+{
+	uint empty = 0;
+	std::vector<Chunk>::const_iterator item = chunks.cbegin();
+	for (; item != chunks.cend(); ++item) {
+		if ((*item).used == 0) {
+			++empty;
+		}
+	}
+	if (empty == 0)
+		return 0;
+
+	// the free blocks of the empty chunks leave the list before their chunks are freed
+	FreeBlock* kept = nullptr;
+	FreeBlock* block = free_blocks;
+	while (block != nullptr) {
+		FreeBlock* next = block->next;
+		if (chunks[FindChunk(block)].used != 0) {
+			block->next = kept;
+			kept = block;
+		}
+		block = next;
+	}
+	free_blocks = kept;
+
+	std::vector<Chunk>::iterator chunk = chunks.begin();
+	while (chunk != chunks.end()) {
+		if ((*chunk).used == 0) {
+			::operator delete((*chunk).data);
+			chunk = chunks.erase(chunk);
+		}
+		else {
+			++chunk;
+		}
+	}
+
+	return empty;
+}
+
+uint PoolAllocator::GetBlockSize() const
+{
+	return block_size;
+}
+
+uint PoolAllocator::GetChunksCount() const
+{
+	return chunks.size();
+}
+
+uint PoolAllocator::GetUsedCount() const
+{
+	return used;
+}
+
+void PoolAllocator::AddChunk()
+{
+	Chunk chunk;
+	chunk.data = (char*)::operator new(block_size * blocks_per_chunk);
+
+	// linked from the end so the first blocks are allocated first
+	for (uint i = blocks_per_chunk; i > 0; --i) {
+		FreeBlock* block = (FreeBlock*)(chunk.data + (i - 1) * block_size);
+		block->next = free_blocks;
+		free_blocks = block;
+	}
+
+	std::vector<Chunk>::iterator position = std::upper_bound(chunks.begin(), chunks.end(), chunk,
+		[](const Chunk& chunk1, const Chunk& chunk2) { return chunk1.data < chunk2.data; });
+	chunks.insert(position, chunk);
+}
+
+int PoolAllocator::FindChunk(const void* block) const
+{
+	const char* address = (const char*)block;
+	std::vector<Chunk>::const_iterator item = std::upper_bound(chunks.cbegin(), chunks.cend(), address,
+		[](const char* address, const Chunk& chunk) { return address < chunk.data; });
+	if (item == chunks.cbegin())
+		return -1;
+
+	--item;
+	if (address >= (*item).data + block_size * blocks_per_chunk)
+		return -1;
+
+	return item - chunks.cbegin();
+}
+
+void* ObjectAllocator::Allocate(size_t size)
+{
+	uint index = (uint)((size + POOL_ALLOCATOR_ALIGNMENT - 1) / POOL_ALLOCATOR_ALIGNMENT);
+	if (!enabled || size == 0 || index > POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT)
+		return ::operator new(size);
+
+	PoolAllocator*& pool = pools[index - 1];
+	if (pool == nullptr) {
+		uint block_size = index * POOL_ALLOCATOR_ALIGNMENT;
+		pool = new PoolAllocator(block_size, std::max(POOL_ALLOCATOR_CHUNK_SIZE / block_size, 16U));
+	}
+	return pool->Allocate();
+}
+
+void ObjectAllocator::Free(void* block, size_t size)
+{
+	if (block == nullptr)
+		return;
+
+	uint index = (uint)((size + POOL_ALLOCATOR_ALIGNMENT - 1) / POOL_ALLOCATOR_ALIGNMENT);
+	if (size != 0 && index <= POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT) {
+		PoolAllocator* pool = pools[index - 1];
+		if (pool != nullptr && pool->Owns(block)) {
+			pool->Free(block);
+			return;
+		}
+	}
+	::operator delete(block);
+}
+
+uint ObjectAllocator::ReleaseUnused()
+{
+	uint ret = 0;
+	for (uint i = 0; i < POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT; ++i) {
+		if (pools[i] != nullptr) {
+			ret += pools[i]->ReleaseUnused();
+		}
+	}
+	return ret;
+}
+
+uint ObjectAllocator::GetChunksCount()
+{
+	uint ret = 0;
+	for (uint i = 0; i < POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT; ++i) {
+		if (pools[i] != nullptr) {
+			ret += pools[i]->GetChunksCount();
+		}
+	}
+	return ret;
+}
+
+uint ObjectAllocator::GetPooledCount()
+{
+	uint ret = 0;
+	for (uint i = 0; i < POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT; ++i) {
+		if (pools[i] != nullptr) {
+			ret += pools[i]->GetUsedCount();
+		}
+	}
+	return ret;
+}
+
+void* GameObject::operator new(size_t size)
+{
+	return ObjectAllocator::Allocate(size);
+}
+
+void GameObject::operator delete(void* block, size_t size)
+{
+	ObjectAllocator::Free(block, size);
+}
+
+void* Component::operator new(size_t size)
+{
+	return ObjectAllocator::Allocate(size);
+}
+
+void Component::operator delete(void* block, size_t size)
+{
+	ObjectAllocator::Free(block, size);
+}
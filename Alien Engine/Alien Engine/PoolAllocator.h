@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// the objects of each size class are taken from chunks of about this size
+#define POOL_ALLOCATOR_CHUNK_SIZE 16384
+#define POOL_ALLOCATOR_ALIGNMENT 16
+// bigger objects go to the heap
+#define POOL_ALLOCATOR_MAX_SIZE 2048
+
+// Blocks of one size carved from big chunks. The free blocks are linked through their first bytes and the chunks
+// count their used blocks so the empty ones can be released. Not thread safe, the objects are created and deleted
+// in the main thread.
+class PoolAllocator {
+
+	struct Chunk {
+		char* data = nullptr;
+		uint used = 0;
+	};
+
+	struct FreeBlock {
+		FreeBlock* next = nullptr;
+	};
+
+public:
+
+	PoolAllocator(uint block_size, uint blocks_per_chunk);
+	~PoolAllocator();
+
+	void* Allocate();
+	void Free(void* block);
+	bool Owns(const void* block) const;
+	// free the chunks without any used block, returns how many
+	uint ReleaseUnused();
+
+	uint GetBlockSize() const;
+	uint GetChunksCount() const;
+	uint GetUsedCount() const;
+
+private:
+
+	void AddChunk();
+	// index of the chunk of the block in chunks, -1 if it is not in any
+	int FindChunk(const void* block) const;
+
+private:
+
+	uint block_size = 0;
+	uint blocks_per_chunk = 0;
+	uint used = 0;
+	// sorted by address to find the chunk of a block
+	std::vector<Chunk> chunks;
+	FreeBlock* free_blocks = nullptr;
+};
+
+// The operator new and delete of GameObject and the components. Each size class has its PoolAllocator, so every
+// class ends in its own pool unless two have the same size.
+class ObjectAllocator {
+
+public:
+
+	static void* Allocate(size_t size);
+	static void Free(void* block, size_t size);
+	// free the empty chunks of every pool
+	static uint ReleaseUnused();
+
+	static uint GetChunksCount();
+	static uint GetPooledCount();
+
+public:
+
+	// the objects allocated while it is false go to the heap, the ones from the pools go back to them anyway
+	static bool enabled;
+
+private:
+
+	static PoolAllocator* pools[POOL_ALLOCATOR_MAX_SIZE / POOL_ALLOCATOR_ALIGNMENT];
+};
@@ -39,6 +39,33 @@ GameObject* Prefab::ConvertToGameObject(float3 local_position, GameObject* paren
 	return created;
 }
 
+void Prefab::Prewarm(unsigned int count, GameObject* parent)
+{
+	ResourcePrefab* prefab = (prefabID != 0) ? (ResourcePrefab*)App->resources->GetResourceWithID(prefabID) : nullptr;
+	if (prefab == nullptr) {
+		LOG_ENGINE("Prefab is NULL or might not exist");
+		return;
+	}
+	App->objects->object_pool.Prewarm(prefab, count, parent);
+}
+
+GameObject* Prefab::Spawn(float3 local_position, GameObject* parent)
+{
+	ResourcePrefab* prefab = (prefabID != 0) ? (ResourcePrefab*)App->resources->GetResourceWithID(prefabID) : nullptr;
+	if (prefab == nullptr) {
+		LOG_ENGINE("Prefab is NULL or might not exist");
+		return nullptr;
+	}
+	return App->objects->object_pool.Spawn(prefab, local_position, parent);
+}
+
+void Prefab::Despawn(GameObject* object)
+{
+	if (object != nullptr && !App->objects->object_pool.Despawn(object)) {
+		object->ToDelete();
+	}
+}
+
 void Prefab::InitScripts(GameObject* obj)
 {
 	if (!obj->components.empty()) {
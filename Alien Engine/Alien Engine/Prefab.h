@@ -12,6 +12,7 @@ class __declspec(dllexport) Prefab {
 	friend class ModuleObjects;
 	friend class GameObject;
 	friend class PanelScene;
+	friend class GameObjectPool;
 public:
 
 	Prefab();
@@ -20,6 +21,13 @@ public:
 	// parent = nullptr set the root
 	GameObject* ConvertToGameObject(float3 local_position, GameObject * parent = nullptr);
 
+	// object pool: keep count instances disabled to spawn them without loading nor deleting objects
+	void Prewarm(unsigned int count, GameObject* parent = nullptr);
+	// a disabled instance of the pool at the position, a new one if there are no more
+	GameObject* Spawn(float3 local_position, GameObject* parent = nullptr);
+	// back to the pool of its prefab, the objects not spawned from a pool are destroyed
+	static void Despawn(GameObject* object);
+
 private:
 
 	static void InitScripts(GameObject* obj);
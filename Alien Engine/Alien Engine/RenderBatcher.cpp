@@ -0,0 +1,371 @@
+#include "RenderBatcher.h"
+#include "glew/include/glew.h"
+#include "Application.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "ComponentMaterial.h"
+#include "ResourceMesh.h"
+#include "ResourceTexture.h"
+#include <algorithm>
+
+// generic attributes the conventional ones of the program don't alias, the matrix takes 4
+#define RENDER_BATCHER_TRANSFORM_ATTRIBUTE 10
+#define RENDER_BATCHER_COLOR_ATTRIBUTE 14
+#define RENDER_BATCHER_MAX_LIGHTS 8
+
+// the fixed pipeline with GL_COLOR_MATERIAL and the texture modulated, without the specular the engine doesn't use
+static const char* instances_vertex_shader =
+	"#version 120\n"
+	"attribute mat4 instance_transform;\n"
+	"attribute vec4 instance_color;\n"
+	"uniform bool lighting;\n"
+	"uniform bool lights[8];\n"
+	"varying vec4 color;\n"
+	"varying vec2 uv;\n"
+	"void main()\n"
+	"{\n"
+	"	mat4 model_view = gl_ModelViewMatrix * instance_transform;\n"
+	"	vec4 position = model_view * gl_Vertex;\n"
+	"	gl_Position = gl_ProjectionMatrix * position;\n"
+	"	uv = (gl_TextureMatrix[0] * gl_MultiTexCoord0).xy;\n"
+	"	color = instance_color;\n"
+	"	if (lighting) {\n"
+	"		vec3 normal = normalize(mat3(model_view) * gl_Normal);\n"
+	"		vec3 lit = gl_LightModel.ambient.rgb * instance_color.rgb;\n"
+	"		for (int i = 0; i < 8; ++i) {\n"
+	"			if (lights[i]) {\n"
+	"				vec3 direction = gl_LightSource[i].position.xyz;\n"
+	"				float attenuation = 1.0;\n"
+	"				if (gl_LightSource[i].position.w != 0.0) {\n"
+	"					direction -= position.xyz;\n"
+	"					float light_distance = length(direction);\n"
+	"					attenuation = 1.0 / (gl_LightSource[i].constantAttenuation + gl_LightSource[i].linearAttenuation * light_distance\n"
+	"						+ gl_LightSource[i].quadraticAttenuation * light_distance * light_distance);\n"
+	"				}\n"
+	"				float diffuse = max(dot(normal, normalize(direction)), 0.0);\n"
+	"				lit += attenuation * (gl_LightSource[i].ambient.rgb + diffuse * gl_LightSource[i].diffuse.rgb) * instance_color.rgb;\n"
+	"			}\n"
+	"		}\n"
+	"		color.rgb = clamp(lit, 0.0, 1.0);\n"
+	"	}\n"
+	"}\n";
+
+static const char* instances_fragment_shader =
+	"#version 120\n"
+	"uniform bool textured;\n"
+	"uniform sampler2D diffuse_texture;\n"
+	"varying vec4 color;\n"
+	"varying vec2 uv;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = textured ? texture2D(diffuse_texture, uv) * color : color;\n"
+	"}\n";
+
+RenderBatcher::RenderBatcher()
+{
+}
+
+RenderBatcher::~RenderBatcher()
+{
+	if (program != 0)
+		glDeleteProgram(program);
+	if (instances_buffer != 0)
+		glDeleteBuffers(1, &instances_buffer);
+}
+
+void RenderBatcher::Build(const std::vector<RenderQueueItem>& items, bool scene)
+{
+	batches.clear();
+	keys.clear();
+	transforms.clear();
+	colors.clear();
+	negative_scale.clear();
+	meshes.clear();
+	lods.clear();
+	batched.clear();
+	unbatched.clear();
+
+	std::vector<RenderQueueItem>::const_iterator item = items.cbegin();
+	for (; item != items.cend(); ++item) {
+		if ((*item).object != nullptr && !AddInstance((*item).object, scene)) {
+			unbatched.push_back((*item).object);
+		}
+	}
+
+	if (keys.empty())
+		return;
+
+	std::sort(keys.begin(), keys.end());
+
+	sorted_transforms.resize(transforms.size());
+	sorted_colors.resize(colors.size());
+	sorted_negative_scale.resize(negative_scale.size());
+
+	for (uint i = 0; i < keys.size(); ++i) {
+		uint instance = keys[i].second;
+		memcpy(&sorted_transforms[i * 16], &transforms[instance * 16], sizeof(float) * 16);
+		memcpy(&sorted_colors[i * 4], &colors[instance * 4], sizeof(float) * 4);
+		sorted_negative_scale[i] = negative_scale[instance];
+
+		if (batches.empty() || keys[i].first != keys[i - 1].first) {
+			RenderBatch batch;
+			batch.mesh = meshes[instance];
+			batch.lod = lods[instance];
+			batch.texture = (uint)(keys[i].first >> 32);
+			batch.negative_scale = sorted_negative_scale[i] != 0;
+			batch.first_instance = i;
+			batches.push_back(batch);
+		}
+		++batches.back().instances_count;
+	}
+}
+
+void RenderBatcher::Draw()
+{
+	if (batches.empty())
+		return;
+
+	bool instanced = CreateProgram();
+	if (instanced) {
+		// every batch reads its range of the buffer
+		glBindBuffer(GL_ARRAY_BUFFER, instances_buffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * (sorted_transforms.size() + sorted_colors.size()), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * sorted_transforms.size(), sorted_transforms.data());
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(float) * sorted_transforms.size(), sizeof(float) * sorted_colors.size(), sorted_colors.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		glUseProgram(program);
+		glUniform1i(lighting_location, glIsEnabled(GL_LIGHTING) ? 1 : 0);
+		int lights[RENDER_BATCHER_MAX_LIGHTS];
+		for (uint i = 0; i < RENDER_BATCHER_MAX_LIGHTS; ++i) {
+			lights[i] = glIsEnabled(GL_LIGHT0 + i) ? 1 : 0;
+		}
+		glUniform1iv(lights_location, RENDER_BATCHER_MAX_LIGHTS, lights);
+		glUniform1i(textured_location, 0);
+		for (uint i = 0; i < 4; ++i) {
+			glEnableVertexAttribArray(RENDER_BATCHER_TRANSFORM_ATTRIBUTE + i);
+			glVertexAttribDivisorARB(RENDER_BATCHER_TRANSFORM_ATTRIBUTE + i, 1);
+		}
+		glEnableVertexAttribArray(RENDER_BATCHER_COLOR_ATTRIBUTE);
+		glVertexAttribDivisorARB(RENDER_BATCHER_COLOR_ATTRIBUTE, 1);
+	}
+
+	// the state every batch shares is set only once
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(1.0f, 0.1f);
+	glEnableClientState(GL_VERTEX_ARRAY);
+
+	uint bound_texture = 0;
+	const ResourceMesh* bound_mesh = nullptr;
+
+	std::vector<RenderBatch>::const_iterator batch = batches.cbegin();
+	for (; batch != batches.cend(); ++batch) {
+		if ((*batch).texture != bound_texture) {
+			if ((*batch).texture != 0) {
+				glEnable(GL_TEXTURE_2D);
+				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			}
+			else {
+				glDisable(GL_TEXTURE_2D);
+				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			}
+			glBindTexture(GL_TEXTURE_2D, (*batch).texture);
+			if (instanced)
+				glUniform1i(textured_location, ((*batch).texture != 0) ? 1 : 0);
+			bound_texture = (*batch).texture;
+			++App->renderer3D->state_changes;
+		}
+
+		if ((*batch).mesh != bound_mesh) {
+			(*batch).mesh->BindBuffers(true, true);
+			bound_mesh = (*batch).mesh;
+			++App->renderer3D->state_changes;
+		}
+
+		if ((*batch).negative_scale)
+			glFrontFace(GL_CW);
+
+		if (instanced) {
+			DrawInstances(*batch);
+		}
+		else {
+			// only the transform and the color change between the instances of a batch
+			uint end = (*batch).first_instance + (*batch).instances_count;
+			for (uint i = (*batch).first_instance; i < end; ++i) {
+				glColor4fv(&sorted_colors[i * 4]);
+				glPushMatrix();
+				glMultMatrixf(&sorted_transforms[i * 16]);
+				bound_mesh->DrawElements((*batch).lod);
+				glPopMatrix();
+				++App->renderer3D->draw_calls;
+			}
+		}
+
+		if ((*batch).negative_scale)
+			glFrontFace(GL_CCW);
+
+		App->renderer3D->triangles += (*batch).instances_count * (bound_mesh->GetIndexCount((*batch).lod) / 3);
+		App->renderer3D->triangles_full += (*batch).instances_count * (bound_mesh->num_index / 3);
+	}
+
+	if (instanced) {
+		for (uint i = 0; i < 4; ++i) {
+			glVertexAttribDivisorARB(RENDER_BATCHER_TRANSFORM_ATTRIBUTE + i, 0);
+			glDisableVertexAttribArray(RENDER_BATCHER_TRANSFORM_ATTRIBUTE + i);
+		}
+		glVertexAttribDivisorARB(RENDER_BATCHER_COLOR_ATTRIBUTE, 0);
+		glDisableVertexAttribArray(RENDER_BATCHER_COLOR_ATTRIBUTE);
+		glUseProgram(0);
+	}
+
+	if (bound_mesh != nullptr)
+		bound_mesh->UnbindBuffers();
+
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+const std::vector<GameObject*>& RenderBatcher::GetBatchedObjects() const
+{
+	return batched;
+}
+
+const std::vector<GameObject*>& RenderBatcher::GetUnbatchedObjects() const
+{
+	return unbatched;
+}
+
+uint RenderBatcher::GetBatchesCount() const
+{
+	return batches.size();
+}
+
+bool RenderBatcher::CreateProgram()
+{
+	if (program != 0)
+		return true;
+	if (program_failed || !GLEW_ARB_instanced_arrays) {
+		program_failed = true;
+		return false;
+	}
+
+	const char* sources[] = { instances_vertex_shader, instances_fragment_shader };
+	const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	GLuint shaders[2] = { 0, 0 };
+	GLint compiled = GL_TRUE;
+	for (uint i = 0; i < 2 && compiled == GL_TRUE; ++i) {
+		shaders[i] = glCreateShader(types[i]);
+		glShaderSource(shaders[i], 1, &sources[i], nullptr);
+		glCompileShader(shaders[i]);
+		glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compiled);
+		if (compiled != GL_TRUE) {
+			char log[512];
+			glGetShaderInfoLog(shaders[i], sizeof(log), nullptr, log);
+			LOG_ENGINE("The instanced batches shader could not be compiled, the instances are drawn one by one: %s", log);
+		}
+	}
+
+	GLint linked = GL_FALSE;
+	if (compiled == GL_TRUE) {
+		program = glCreateProgram();
+		glAttachShader(program, shaders[0]);
+		glAttachShader(program, shaders[1]);
+		glBindAttribLocation(program, RENDER_BATCHER_TRANSFORM_ATTRIBUTE, "instance_transform");
+		glBindAttribLocation(program, RENDER_BATCHER_COLOR_ATTRIBUTE, "instance_color");
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (linked != GL_TRUE) {
+			char log[512];
+			glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+			LOG_ENGINE("The instanced batches shader could not be linked, the instances are drawn one by one: %s", log);
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+	for (uint i = 0; i < 2; ++i) {
+		if (shaders[i] != 0)
+			glDeleteShader(shaders[i]);
+	}
+
+	if (program == 0) {
+		program_failed = true;
+		return false;
+	}
+
+	lighting_location = glGetUniformLocation(program, "lighting");
+	lights_location = glGetUniformLocation(program, "lights");
+	textured_location = glGetUniformLocation(program, "textured");
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "diffuse_texture"), 0);
+	glUseProgram(0);
+	glGenBuffers(1, &instances_buffer);
+
+	return true;
+}
+
+void RenderBatcher::DrawInstances(const RenderBatch& batch)
+{
+	// GL 3.1 has no base instance, the attributes start at the first instance of the batch
+	glBindBuffer(GL_ARRAY_BUFFER, instances_buffer);
+	for (uint i = 0; i < 4; ++i) {
+		glVertexAttribPointer(RENDER_BATCHER_TRANSFORM_ATTRIBUTE + i, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 16,
+			(void*)(sizeof(float) * (batch.first_instance * 16 + i * 4)));
+	}
+	glVertexAttribPointer(RENDER_BATCHER_COLOR_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 4,
+		(void*)(sizeof(float) * (sorted_transforms.size() + batch.first_instance * 4)));
+	// the vertex pointers of the mesh keep the buffer they were set with
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	batch.mesh->DrawElements(batch.lod, batch.instances_count);
+	++App->renderer3D->draw_calls;
+}
+
+bool RenderBatcher::AddInstance(GameObject* object, bool scene)
+{
+	ComponentMesh* mesh = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+	if (mesh == nullptr || !mesh->IsEnabled() || mesh->mesh == nullptr || mesh->mesh->id_index <= 0)
+		return false;
+
+	// the selected objects write the stencil for the outline and the wireframe ones don't draw the polygons
+	if (object->IsSelected() || object->IsParentSelected() || (scene && mesh->wireframe))
+		return false;
+
+	Color color(1.0F, 1.0F, 1.0F, 1.0F);
+	uint texture = 0;
+
+	ComponentMaterial* material = (ComponentMaterial*)object->GetComponent(ComponentType::MATERIAL);
+	if (material != nullptr && material->IsEnabled()) {
+		color = material->color;
+		if (material->texture != nullptr && material->texture->id > 0 && material->texture_activated) {
+			texture = material->texture->id;
+		}
+	}
+
+	// the transparent objects have to be drawn back to front after the opaque ones
+	if (color.a < 1.0F)
+		return false;
+
+	ComponentTransform* transform = (ComponentTransform*)object->GetComponent(ComponentType::TRANSFORM);
+	float4x4 matrix = transform->GetGlobalMatrix().Transposed();
+
+	uint instance = meshes.size();
+	bool negative = transform->IsScaleNegative();
+	keys.push_back({ ((u64)texture << 32) | (((u64)mesh->mesh->id_vertex * (MESH_MAX_LODS + 1) + mesh->lod) << 1 | (negative ? 1 : 0)), instance });
+	transforms.insert(transforms.end(), matrix.ptr(), matrix.ptr() + 16);
+	colors.push_back(color.r);
+	colors.push_back(color.g);
+	colors.push_back(color.b);
+	colors.push_back(color.a);
+	negative_scale.push_back(negative ? 1 : 0);
+	meshes.push_back(mesh->mesh);
+	lods.push_back(mesh->lod);
+	batched.push_back(object);
+
+	return true;
+}
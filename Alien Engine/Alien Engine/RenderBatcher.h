@@ -0,0 +1,80 @@
+#pragma once
+
+#include "RenderQueue.h"
+#include <vector>
+
+class GameObject;
+class ResourceMesh;
+
+// instances with the same mesh, texture and winding, drawn with the state set once
+struct RenderBatch {
+	const ResourceMesh* mesh = nullptr;
+	uint lod = 0;
+	// 0 if the batch is not textured
+	uint texture = 0;
+	// the instances have a negative scale, their triangles are clockwise
+	bool negative_scale = false;
+	// the instances are [first_instance, first_instance + instances_count) of the batcher buffers
+	uint first_instance = 0;
+	uint instances_count = 0;
+};
+
+// Groups the opaque meshes of a render queue by texture and mesh and draws each group with one instanced draw call,
+// the matrices and the colors of the instances are vertex attributes. Without ARB_instanced_arrays the instances of
+// a batch are drawn one by one with the state still set once. The objects that need their own state (selected,
+// wireframe, transparent) are kept in the queue order to be drawn one by one after the batches.
+class RenderBatcher {
+
+public:
+
+	RenderBatcher();
+	~RenderBatcher();
+
+	// scene is true when the objects are drawn in the editor scene, there the wireframe meshes can't be batched
+	void Build(const std::vector<RenderQueueItem>& items, bool scene);
+	void Draw();
+
+	// objects drawn by the batches, the scene still has to draw their debug lines
+	const std::vector<GameObject*>& GetBatchedObjects() const;
+	// objects that must be drawn one by one, far first
+	const std::vector<GameObject*>& GetUnbatchedObjects() const;
+	uint GetBatchesCount() const;
+
+private:
+
+	bool AddInstance(GameObject* object, bool scene);
+	// the program that lights the instances like the fixed pipeline, false if instancing can't be used
+	bool CreateProgram();
+	void DrawInstances(const RenderBatch& batch);
+
+private:
+
+	std::vector<RenderBatch> batches;
+
+	// texture << 32 | mesh vertex buffer, LOD and winding, and the instance. Sorting them groups the instances of
+	// each batch
+	std::vector<std::pair<u64, uint>> keys;
+
+	// per instance data, 16 floats of the transposed global matrix and 4 of the color
+	std::vector<float> transforms;
+	std::vector<float> colors;
+	std::vector<unsigned char> negative_scale;
+	std::vector<const ResourceMesh*> meshes;
+	std::vector<uint> lods;
+
+	// per instance data in the batches order
+	std::vector<float> sorted_transforms;
+	std::vector<float> sorted_colors;
+	std::vector<unsigned char> sorted_negative_scale;
+
+	std::vector<GameObject*> batched;
+	std::vector<GameObject*> unbatched;
+
+	// the sorted matrices followed by the sorted colors, uploaded once per Draw
+	uint instances_buffer = 0;
+	uint program = 0;
+	bool program_failed = false;
+	int lighting_location = -1;
+	int lights_location = -1;
+	int textured_location = -1;
+};
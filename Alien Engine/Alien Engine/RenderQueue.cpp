@@ -0,0 +1,141 @@
+#include "RenderQueue.h"
+#include "GameObject.h"
+#include "ComponentMesh.h"
+#include "ComponentMaterial.h"
+#include "ResourceMesh.h"
+#include "ResourceTexture.h"
+#include "j1PerfTimer.h"
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+std::vector<std::pair<float, GameObject*>>* RenderQueue::Begin(const Frustum& frustum)
+{
+	this->frustum = frustum;
+	culling = FrustumCulling(frustum);
+	built = false;
+	visible.clear();
+	items.clear();
+	return &visible;
+}
+
+const FrustumCulling& RenderQueue::GetCulling() const
+{
+	return culling;
+}
+
+void RenderQueue::Sort()
+{
+	j1PerfTimer timer;
+
+	float far_plane = (frustum.farPlaneDistance > 0.0F) ? frustum.farPlaneDistance : 1.0F;
+	const u64 max_depth = (1ULL << RENDER_QUEUE_DEPTH_BITS) - 1;
+
+	items.resize(visible.size());
+	for (uint i = 0; i < visible.size(); ++i) {
+		GameObject* object = visible[i].second;
+
+		u64 depth = max_depth;
+		if (visible[i].first < far_plane) {
+			depth = (visible[i].first > 0.0F) ? (u64)(visible[i].first / far_plane * max_depth) : 0;
+		}
+
+		u64 texture = 0;
+		ComponentMaterial* material = (ComponentMaterial*)object->GetComponent(ComponentType::MATERIAL);
+		if (material != nullptr && material->texture_activated && material->texture != nullptr) {
+			texture = material->texture->id;
+		}
+
+		u64 mesh = 0;
+		ComponentMesh* mesh_component = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+		if (mesh_component != nullptr && mesh_component->mesh != nullptr) {
+			mesh = mesh_component->mesh->id_vertex;
+		}
+
+		// the depth is inverted so the far objects go first like before
+		items[i].key = ((max_depth - depth) << (RENDER_QUEUE_TEXTURE_BITS + RENDER_QUEUE_MESH_BITS))
+			| ((texture & ((1ULL << RENDER_QUEUE_TEXTURE_BITS) - 1)) << RENDER_QUEUE_MESH_BITS)
+			| (mesh & ((1ULL << RENDER_QUEUE_MESH_BITS) - 1));
+		items[i].object = object;
+	}
+
+	RadixSort();
+
+	built = true;
+	last_sort_ms = timer.ReadMs();
+}
+
+bool RenderQueue::IsBuiltFor(const Frustum& frustum) const
+{
+	return built && this->frustum.type == frustum.type && this->frustum.pos.Equals(frustum.pos, 0.0F)
+		&& this->frustum.front.Equals(frustum.front, 0.0F) && this->frustum.up.Equals(frustum.up, 0.0F)
+		&& this->frustum.nearPlaneDistance == frustum.nearPlaneDistance && this->frustum.farPlaneDistance == frustum.farPlaneDistance
+		&& this->frustum.horizontalFov == frustum.horizontalFov && this->frustum.verticalFov == frustum.verticalFov;
+}
+
+void RenderQueue::Invalidate()
+{
+	built = false;
+}
+
+const std::vector<RenderQueueItem>& RenderQueue::GetItems() const
+{
+	return items;
+}
+
+uint RenderQueue::GetCount() const
+{
+	return items.size();
+}
+
+double RenderQueue::GetLastSortMs() const
+{
+	return last_sort_ms;
+}
+
+void RenderQueue::RadixSort()
+{
+	uint size = items.size();
+	if (size < 2)
+		return;
+
+	sort_buffer.resize(size);
+	RenderQueueItem* from = items.data();
+	RenderQueueItem* to = sort_buffer.data();
+
+	// LSD radix sort, one byte of the key each pass
+	for (uint shift = 0; shift < 64; shift += 8) {
+		uint count[256] = { 0 };
+		for (uint i = 0; i < size; ++i) {
+			++count[(from[i].key >> shift) & 0xFF];
+		}
+
+		// all the keys have the same byte, nothing to do in this pass
+		if (count[(from[0].key >> shift) & 0xFF] == size)
+			continue;
+
+		uint offset = 0;
+		for (uint i = 0; i < 256; ++i) {
+			uint bucket_size = count[i];
+			count[i] = offset;
+			offset += bucket_size;
+		}
+
+		for (uint i = 0; i < size; ++i) {
+			to[count[(from[i].key >> shift) & 0xFF]++] = from[i];
+		}
+
+		RenderQueueItem* swap = from;
+		from = to;
+		to = swap;
+	}
+
+	if (from != items.data()) {
+		items.swap(sort_buffer);
+	}
+}
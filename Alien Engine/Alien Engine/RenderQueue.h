@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MathGeoLib/include/Geometry/Frustum.h"
+#include "FrustumCulling.h"
+#include <vector>
+
+class GameObject;
+
+typedef unsigned int uint;
+typedef unsigned long long u64;
+
+// bits of each part of the sort key, from the most significant to the least
+#define RENDER_QUEUE_DEPTH_BITS 16
+#define RENDER_QUEUE_TEXTURE_BITS 24
+#define RENDER_QUEUE_MESH_BITS 24
+
+struct RenderQueueItem {
+	// depth bucket (far first) | texture | mesh, sorting by it keeps the back to front order and groups the same state
+	u64 key = 0;
+	GameObject* object = nullptr;
+};
+
+// Visible objects of a camera in draw order. Each camera keeps its queue, so the memory is reused every frame.
+class RenderQueue {
+
+public:
+
+	RenderQueue();
+	~RenderQueue();
+
+	// empty the queue keeping the memory and return the list the culling fills with distance and object
+	std::vector<std::pair<float, GameObject*>>* Begin(const Frustum& frustum);
+	// the planes of the frustum of the last Begin, built once for all the boxes the camera tests in the frame
+	const FrustumCulling& GetCulling() const;
+	// create the keys of the visible objects and radix sort them
+	void Sort();
+
+	// true if the queue has been built for the same frustum, so the culling can be reused
+	bool IsBuiltFor(const Frustum& frustum) const;
+	void Invalidate();
+
+	const std::vector<RenderQueueItem>& GetItems() const;
+	uint GetCount() const;
+	double GetLastSortMs() const;
+
+private:
+
+	void RadixSort();
+
+private:
+
+	std::vector<std::pair<float, GameObject*>> visible;
+	std::vector<RenderQueueItem> items;
+	std::vector<RenderQueueItem> sort_buffer;
+
+	Frustum frustum;
+	FrustumCulling culling;
+	bool built = false;
+
+	double last_sort_ms = 0.0;
+};
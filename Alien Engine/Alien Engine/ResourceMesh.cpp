@@ -4,10 +4,13 @@
 #include "ComponentMaterial.h"
 #include "ComponentTransform.h"
 #include "ResourceTexture.h"
+#include "MathGeoLib/include/Math/MathFunc.h"
+#include "j1PerfTimer.h"
 
 ResourceMesh::ResourceMesh() : Resource()
 {
 	type = ResourceType::RESOURCE_MESH;
+	local_aabb.SetNegativeInfinity();
 }
 
 ResourceMesh::~ResourceMesh()
@@ -15,7 +18,111 @@ ResourceMesh::~ResourceMesh()
 	FreeMemory();
 }
 
+static uint AlignSize(uint size)
+{
+	return (size + ALIEN_MESH_ALIGNMENT - 1) & ~(ALIEN_MESH_ALIGNMENT - 1);
+}
+
+static uint MeshChecksum(const char* data, uint size)
+{
+	// FNV-1a
+	uint hash = 2166136261U;
+	for (uint i = 0; i < size; ++i) {
+		hash ^= (unsigned char)data[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+static bool CheckSectionSize(const MeshSectionRange& section, u64 size, bool optional)
+{
+	// the optional sections are empty when the mesh doesn't have the array
+	return (optional && section.size == 0) || section.size >= size;
+}
+
+static bool CheckSectionsSizes(const AlienMeshHeader* header)
+{
+	const MeshSectionRange* sections = header->sections;
+	u64 num_vertex = header->num_vertex;
+	u64 num_index = header->num_index;
+	u64 num_faces = header->num_faces;
+
+	if (num_vertex > 0) {
+		if (header->vertex_stride < sizeof(float) * 3 || !CheckSectionSize(sections[(uint)MeshSection::POSITIONS], sizeof(float) * 3 * num_vertex, false)
+			|| !CheckSectionSize(sections[(uint)MeshSection::GPU_VERTICES], header->vertex_stride * num_vertex, false))
+			return false;
+	}
+	if (sections[(uint)MeshSection::NORMALS].size > 0 && (u64)header->normals_offset + sizeof(uint) > header->vertex_stride)
+		return false;
+	if (sections[(uint)MeshSection::UVS].size > 0 && (u64)header->uv_offset + sizeof(short) * 2 > header->vertex_stride)
+		return false;
+	if (!CheckSectionSize(sections[(uint)MeshSection::NORMALS], sizeof(float) * 3 * num_vertex, true)
+		|| !CheckSectionSize(sections[(uint)MeshSection::UVS], sizeof(float) * 2 * num_vertex, true)
+		|| !CheckSectionSize(sections[(uint)MeshSection::FACE_CENTERS], sizeof(float) * 3 * num_faces, true)
+		|| !CheckSectionSize(sections[(uint)MeshSection::FACE_NORMALS], sizeof(float) * 3 * num_faces, true))
+		return false;
+
+	// the index buffer comes from GPU_INDICES with 16 bits and from INDICES with 32
+	if (header->index_type != GL_UNSIGNED_SHORT && header->index_type != GL_UNSIGNED_INT)
+		return false;
+	if (num_index > 0) {
+		if (!CheckSectionSize(sections[(uint)MeshSection::INDICES], sizeof(uint) * num_index, false))
+			return false;
+		if (header->index_type == GL_UNSIGNED_SHORT && (num_vertex > 65536 || !CheckSectionSize(sections[(uint)MeshSection::GPU_INDICES], sizeof(unsigned short) * num_index, false)))
+			return false;
+	}
+
+	if (header->header_size >= sizeof(AlienMeshHeader) && header->num_lods > 0 && header->index_type == GL_UNSIGNED_SHORT) {
+		u64 lods_index_count = header->lod_indices.size / sizeof(uint);
+		if (!CheckSectionSize(header->lod_gpu_indices, sizeof(unsigned short) * lods_index_count, false))
+			return false;
+	}
+
+	return true;
+}
+
+template <typename T>
+static bool CheckIndices(const T* indices, u64 count, u64 num_vertex)
+{
+	for (u64 i = 0; i < count; ++i) {
+		if (indices[i] >= num_vertex)
+			return false;
+	}
+	return true;
+}
+
+static bool CheckIndicesRanges(const AlienMeshHeader* header, const char* data)
+{
+	// the GPU and the picking would read past the vertices, the sizes are already checked
+	const MeshSectionRange* sections = header->sections;
+	bool short_indices = header->index_type == GL_UNSIGNED_SHORT;
+	if (!CheckIndices((const uint*)(data + sections[(uint)MeshSection::INDICES].offset), header->num_index, header->num_vertex)
+		|| (short_indices && !CheckIndices((const unsigned short*)(data + sections[(uint)MeshSection::GPU_INDICES].offset), header->num_index, header->num_vertex)))
+		return false;
+
+	if (header->header_size >= sizeof(AlienMeshHeader) && header->num_lods > 0) {
+		u64 lods_index_count = header->lod_indices.size / sizeof(uint);
+		if (!CheckIndices((const uint*)(data + header->lod_indices.offset), lods_index_count, header->num_vertex)
+			|| (short_indices && !CheckIndices((const unsigned short*)(data + header->lod_gpu_indices.offset), lods_index_count, header->num_vertex)))
+			return false;
+	}
+
+	return true;
+}
+
 bool ResourceMesh::CreateMetaData(const u64& force_id)
+{
+	PrepareMetaData(force_id);
+
+	uint size = 0;
+	char* data = SerializeMetaData(&size);
+	App->file_system->Save(meta_data_path.data(), data, size);
+	delete[] data;
+
+	return true;
+}
+
+void ResourceMesh::PrepareMetaData(const u64& force_id)
 {
 	if (parent_name.empty()) {
 		parent_name.assign("null");
@@ -28,220 +135,321 @@ bool ResourceMesh::CreateMetaData(const u64& force_id)
 	}
 
 	meta_data_path = std::string(LIBRARY_MESHES_FOLDER + std::to_string(ID) + ".alienMesh");
+	// the importer adds the meshes before they have an ID
+	App->resources->registry.Refresh(this);
+
+	// a mapped file can't be overwritten
+	DetachFromFile();
+	Resource* previous = App->resources->GetResourceWithID(ID);
+	if (previous != nullptr && previous != this && previous->GetType() == ResourceType::RESOURCE_MESH) {
+		static_cast<ResourceMesh*>(previous)->DetachFromFile();
+	}
+}
 
-	uint ranges[9] = { num_index, num_vertex, num_faces, family_number, (normals != nullptr) ? true : false, 
-		(uv_cords != nullptr) ? true : false,  (texture != nullptr) ? true : false, parent_name.size(), name.size() };
+char* ResourceMesh::SerializeMetaData(uint* file_size)
+{
+	SetVertexLayout();
+
+	AlienMeshHeader header;
+	header.num_index = num_index;
+	header.num_vertex = num_vertex;
+	header.num_faces = num_faces;
+	header.family_number = family_number;
+	header.texture_id = (texture != nullptr) ? texture->GetID() : 0;
+	header.parent_name_size = parent_name.size();
+	header.name_size = name.size();
+	memcpy(header.material_color, &material_color, sizeof(float) * 4);
+	memcpy(header.pos, pos.ptr(), sizeof(float) * 3);
+	memcpy(header.rot, rot.ptr(), sizeof(float) * 4);
+	memcpy(header.scale, scale.ptr(), sizeof(float) * 3);
+	header.vertex_stride = vertex_stride;
+	header.normals_offset = normals_offset;
+	header.uv_offset = uv_offset;
+	header.index_type = (num_vertex <= 65536) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	memcpy(header.uv_bias, uv_bias, sizeof(float) * 2);
+	memcpy(header.uv_scale, uv_scale, sizeof(float) * 2);
+
+	local_aabb.SetNegativeInfinity();
+	if (vertex != nullptr) {
+		local_aabb.Enclose((float3*)vertex, num_vertex);
+	}
+	memcpy(header.aabb_min, local_aabb.minPoint.ptr(), sizeof(float) * 3);
+	memcpy(header.aabb_max, local_aabb.maxPoint.ptr(), sizeof(float) * 3);
 
-	uint texture_size = (texture != nullptr) ? sizeof(u64) : 0;
-	uint uv_size = (uv_cords != nullptr) ? sizeof(float) * num_vertex * 3 : 0;
-	uint normals_size = (normals != nullptr) ? sizeof(float) * num_vertex * 3 + sizeof(float) * num_faces * 3 +
-		sizeof(float) * num_faces * 3 : 0;
-	uint vertex_size = sizeof(float) * num_vertex * 3;
-	uint index_size = sizeof(uint) * num_index;
+	header.num_lods = (lod_index != nullptr) ? num_lods : 0;
+	for (uint i = 0; i < MESH_MAX_LODS; ++i) {
+		header.lod_num_index[i] = (i < header.num_lods) ? lod_num_index[i] : 0;
+	}
+	uint lods_index_count = (header.num_lods > 0) ? GetLODsIndexCount() : 0;
+
+	uint sizes[(uint)MeshSection::MAX] = {
+		parent_name.size() + name.size(),
+		(vertex != nullptr) ? sizeof(float) * num_vertex * 3 : 0,
+		(index != nullptr) ? sizeof(uint) * num_index : 0,
+		(normals != nullptr) ? sizeof(float) * num_vertex * 3 : 0,
+		(center_point != nullptr) ? sizeof(float) * num_faces * 3 : 0,
+		(center_point_normal != nullptr) ? sizeof(float) * num_faces * 3 : 0,
+		(uv_cords != nullptr) ? sizeof(float) * num_vertex * 2 : 0,
+		vertex_stride * num_vertex,
+		(header.index_type == GL_UNSIGNED_SHORT && index != nullptr) ? sizeof(unsigned short) * num_index : 0
+	};
+
+	uint size = AlignSize(sizeof(AlienMeshHeader));
+	for (uint i = 0; i < (uint)MeshSection::MAX; ++i) {
+		header.sections[i].offset = size;
+		header.sections[i].size = sizes[i];
+		size += AlignSize(sizes[i]);
+	}
+	header.lod_indices.offset = size;
+	header.lod_indices.size = sizeof(uint) * lods_index_count;
+	size += AlignSize(header.lod_indices.size);
+	header.lod_gpu_indices.offset = size;
+	header.lod_gpu_indices.size = (header.index_type == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) * lods_index_count : 0;
+	size += AlignSize(header.lod_gpu_indices.size);
+
+	char* data = new char[size];
+	memset(data, 0, size);
+
+	char* names = data + header.sections[(uint)MeshSection::NAMES].offset;
+	memcpy(names, parent_name.data(), parent_name.size());
+	memcpy(names + parent_name.size(), name.data(), name.size());
+
+	const void* arrays[(uint)MeshSection::GPU_VERTICES] = { nullptr, vertex, index, normals, center_point, center_point_normal, uv_cords };
+	for (uint i = (uint)MeshSection::POSITIONS; i < (uint)MeshSection::GPU_VERTICES; ++i) {
+		if (header.sections[i].size > 0) {
+			memcpy(data + header.sections[i].offset, arrays[i], header.sections[i].size);
+		}
+	}
 
-	uint size = sizeof(ranges) + parent_name.size() + name.size() + texture_size +
-		sizeof(float) * 4 + sizeof(float) * 3 + sizeof(float) * 4 + sizeof(float) * 3 + vertex_size +
-		index_size + normals_size + uv_size;
+	// the file always has the normals in 10:10:10:2, they are repacked when loading if the driver doesn't accept them
+	if (num_vertex > 0) {
+		FillVertexBuffer(data + header.sections[(uint)MeshSection::GPU_VERTICES].offset, GL_INT_2_10_10_10_REV);
+	}
 
-	char* data = new char[size]; 
-	char* cursor = data;
+	if (header.sections[(uint)MeshSection::GPU_INDICES].size > 0) {
+		unsigned short* gpu_indices = (unsigned short*)(data + header.sections[(uint)MeshSection::GPU_INDICES].offset);
+		for (uint i = 0; i < num_index; ++i) {
+			gpu_indices[i] = (unsigned short)index[i];
+		}
+	}
 
-	uint bytes = sizeof(ranges); 
-	memcpy(cursor, ranges, bytes);
-	cursor += bytes; 
-	bytes_moved += bytes;
+	if (lods_index_count > 0) {
+		memcpy(data + header.lod_indices.offset, lod_index, header.lod_indices.size);
+		if (header.lod_gpu_indices.size > 0) {
+			unsigned short* gpu_indices = (unsigned short*)(data + header.lod_gpu_indices.offset);
+			for (uint i = 0; i < lods_index_count; ++i) {
+				gpu_indices[i] = (unsigned short)lod_index[i];
+			}
+		}
+	}
 
-	bytes = parent_name.size();
-	memcpy(cursor, parent_name.c_str(), bytes);
-	cursor += bytes;
-	bytes_moved += bytes;
+	header.checksum = MeshChecksum(data + header.header_size, size - header.header_size);
+	memcpy(data, &header, sizeof(AlienMeshHeader));
 
-	bytes = name.size();
-	memcpy(cursor, name.c_str(), bytes);
-	cursor += bytes;
-	bytes_moved += bytes;
+	*file_size = size;
+	return data;
+}
 
-	if (texture != nullptr) {
-		bytes = sizeof(u64);
-		memcpy(cursor, &texture->GetID(), bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
+char* ResourceMesh::SerializeLegacyMetaData(uint* file_size) const
+{
+	uint ranges[9] = { num_index, num_vertex, num_faces, family_number, (normals != nullptr) ? 1U : 0U, (uv_cords != nullptr) ? 2U : 0U,
+		(texture != nullptr) ? 1U : 0U, parent_name.size(), name.size() };
+
+	uint size = sizeof(ranges) + ranges[7] + ranges[8] + ((ranges[6]) ? sizeof(u64) : 0) + sizeof(float) * 14
+		+ sizeof(float) * num_vertex * 3 + sizeof(uint) * num_index;
+	if (ranges[4]) {
+		size += sizeof(float) * num_vertex * 3 + sizeof(float) * num_faces * 6;
+	}
+	if (ranges[5]) {
+		size += sizeof(float) * num_vertex * 2;
 	}
 
-	bytes = sizeof(float) * 4;
-	memcpy(cursor, &material_color, bytes);
-	cursor += bytes;
-	bytes_moved += bytes;
+	char* data = new char[size];
+	memset(data, 0, size);
+	char* cursor = data;
 
-	bytes = sizeof(float) * 3;
-	memcpy(cursor, pos.ptr(), bytes);
-	cursor += bytes;
-	bytes_moved += bytes;
+	memcpy(cursor, ranges, sizeof(ranges));
+	cursor += sizeof(ranges);
+	memcpy(cursor, parent_name.data(), ranges[7]);
+	cursor += ranges[7];
+	memcpy(cursor, name.data(), ranges[8]);
+	cursor += ranges[8];
+	if (ranges[6]) {
+		u64 id = texture->GetID();
+		memcpy(cursor, &id, sizeof(u64));
+		cursor += sizeof(u64);
+	}
+	memcpy(cursor, &material_color, sizeof(float) * 4);
+	cursor += sizeof(float) * 4;
+	memcpy(cursor, pos.ptr(), sizeof(float) * 3);
+	cursor += sizeof(float) * 3;
+	memcpy(cursor, rot.ptr(), sizeof(float) * 4);
+	cursor += sizeof(float) * 4;
+	memcpy(cursor, scale.ptr(), sizeof(float) * 3);
+	cursor += sizeof(float) * 3;
+
+	const void* arrays[] = { vertex, index, normals, center_point, center_point_normal, uv_cords };
+	uint sizes[] = { sizeof(float) * num_vertex * 3, sizeof(uint) * num_index, (ranges[4]) ? sizeof(float) * num_vertex * 3 : 0,
+		(ranges[4]) ? sizeof(float) * num_faces * 3 : 0, (ranges[4]) ? sizeof(float) * num_faces * 3 : 0, (ranges[5]) ? sizeof(float) * num_vertex * 2 : 0 };
+	for (uint i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		// the faces arrays are zeros if the mesh doesn't have them
+		if (arrays[i] != nullptr) {
+			memcpy(cursor, arrays[i], sizes[i]);
+		}
+		cursor += sizes[i];
+	}
 
-	bytes = sizeof(float) * 4;
-	memcpy(cursor, rot.ptr(), bytes);
-	cursor += bytes;
-	bytes_moved += bytes;
+	*file_size = size;
+	return data;
+}
 
-	bytes = sizeof(float) * 3;
-	memcpy(cursor, scale.ptr(), bytes);
-	cursor += bytes;
-	bytes_moved += bytes;
+bool ResourceMesh::ReadBaseInfo(const char* meta_file_path)
+{
+	meta_data_path = std::string(meta_file_path);
+	ID = std::stoull(App->file_system->GetBaseFileName(meta_file_path));
 
-	if (num_vertex > 0) {
-		bytes = sizeof(float) * num_vertex * 3;
-		memcpy(cursor, vertex, bytes);
-		cursor += bytes;
+	// mapping the file only reads the pages of the header and the names
+	FileMapping mapping;
+	char* data = nullptr;
+	uint size = 0;
+	if (App->file_system->Map(meta_data_path.data(), &mapping)) {
+		data = mapping.data;
+		size = mapping.size;
 	}
-
-	if (num_index > 0) {
-		bytes = sizeof(uint) * num_index;
-		memcpy(cursor, index, bytes);
-		cursor += bytes;
+	else {
+		size = App->file_system->Load(meta_data_path.data(), &data);
 	}
 
-	if (normals != nullptr) {
-		bytes = sizeof(float) * num_vertex * 3;
-		memcpy(cursor, normals, bytes);
-		cursor += bytes;
+	bool ret = false;
+	const AlienMeshHeader* header = (const AlienMeshHeader*)data;
 
-		bytes = sizeof(float) * num_faces * 3;
-		memcpy(cursor, center_point, bytes);
-		cursor += bytes;
-
-		bytes = sizeof(float) * num_faces * 3;
-		memcpy(cursor, center_point_normal, bytes);
-		cursor += bytes;
+	if (size >= ALIEN_MESH_HEADER_V1_SIZE && header->magic == ALIEN_MESH_MAGIC) {
+		const MeshSectionRange& names = header->sections[(uint)MeshSection::NAMES];
+		if (header->version > ALIEN_MESH_VERSION || (u64)names.offset + names.size > size || (u64)header->parent_name_size + header->name_size != names.size) {
+			LOG_ENGINE("Mesh %s has an unknown version or is corrupted", meta_data_path.data());
+		}
+		else {
+			family_number = header->family_number;
+			texture_id = header->texture_id;
+			parent_name.assign(data + names.offset, header->parent_name_size);
+			name.assign(data + names.offset + header->parent_name_size, header->name_size);
+			memcpy(&material_color, header->material_color, sizeof(float) * 4);
+			memcpy(pos.ptr(), header->pos, sizeof(float) * 3);
+			memcpy(rot.ptr(), header->rot, sizeof(float) * 4);
+			memcpy(scale.ptr(), header->scale, sizeof(float) * 3);
+			if (header->header_size >= ALIEN_MESH_HEADER_V2_SIZE && header->num_vertex > 0) {
+				local_aabb.minPoint = float3(header->aabb_min);
+				local_aabb.maxPoint = float3(header->aabb_max);
+			}
+			ret = true;
+		}
 	}
-
-	if (uv_cords != nullptr) {
-		bytes = sizeof(float) * num_vertex * 3;
-		memcpy(cursor, uv_cords, bytes);
+	else if (size > 0) {
+		ret = ReadLegacyBaseInfo(data, size);
 	}
 
-	App->file_system->Save(meta_data_path.data(), data, size);
+	if (mapping.data != nullptr) {
+		App->file_system->Unmap(&mapping);
+	}
+	else if (data != nullptr) {
+		delete[] data;
+	}
 
-	delete[] data;
+	if (ret) {
+		App->resources->AddResource(this);
+	}
 
-	return true;
+	return ret;
 }
 
-bool ResourceMesh::ReadBaseInfo(const char* meta_file_path)
+bool ResourceMesh::ReadLegacyBaseInfo(const char* data, uint size)
 {
-	meta_data_path = std::string(meta_file_path);
-	ID = std::stoull(App->file_system->GetBaseFileName(meta_file_path));
+	const char* cursor = data;
 
-	char* data = nullptr;
-	uint size = App->file_system->Load(meta_data_path.data(), &data);
+	uint ranges[9];
+	uint bytes = sizeof(ranges);
+	if (size < bytes)
+		return false;
+	memcpy(ranges, cursor, bytes);
+	cursor += bytes;
 
-	if (size > 0) {
-		char* cursor = data;
-		bytes_moved = 0;
+	// the names, the texture, the color and the TRS must be inside the file
+	u64 base_size = (u64)bytes + ranges[7] + ranges[8] + ((ranges[6]) ? sizeof(u64) : 0) + sizeof(float) * 14;
+	if (base_size > size)
+		return false;
 
-		uint ranges[9];
-		uint bytes = sizeof(ranges);
-		memcpy(ranges, cursor, bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
+	family_number = ranges[3];
 
-		family_number = ranges[3];
+	parent_name.assign(cursor, ranges[7]);
+	cursor += ranges[7];
 
-		char* p_name = new char[ranges[7] + 1];
-		bytes = sizeof(char) * ranges[7];
-		memcpy(p_name, cursor, bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
-		p_name[ranges[7]] = '\0';
-		parent_name = std::string(p_name);
-		delete[] p_name;
-
-		char* m_name = new char[ranges[8] + 1];
-		bytes = sizeof(char) * ranges[8];
-		memcpy(m_name, cursor, bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
-		m_name[ranges[8]] = '\0';
-		name = std::string(m_name);
-		delete[] m_name;
-
-		// texture
-		if (ranges[6]) {
-			bytes = sizeof(u64);
-			memcpy(&texture_id, cursor, bytes);
-			cursor += bytes;
-			bytes_moved += bytes;
-		}
+	name.assign(cursor, ranges[8]);
+	cursor += ranges[8];
 
-		bytes = sizeof(float) * 4;
-		memcpy(&material_color, cursor, bytes);
+	// texture
+	if (ranges[6]) {
+		bytes = sizeof(u64);
+		memcpy(&texture_id, cursor, bytes);
 		cursor += bytes;
-		bytes_moved += bytes;
+	}
 
-		bytes = sizeof(float) * 3;
-		memcpy(&pos, cursor, bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
+	bytes = sizeof(float) * 4;
+	memcpy(&material_color, cursor, bytes);
+	cursor += bytes;
 
-		bytes = sizeof(float) * 4;
-		memcpy(&rot, cursor, bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
+	bytes = sizeof(float) * 3;
+	memcpy(&pos, cursor, bytes);
+	cursor += bytes;
 
-		bytes = sizeof(float) * 3;
-		memcpy(&scale, cursor, bytes);
-		cursor += bytes;
-		bytes_moved += bytes;
+	bytes = sizeof(float) * 4;
+	memcpy(&rot, cursor, bytes);
+	cursor += bytes;
 
-		App->resources->AddResource(this);
-		delete[] data;
-	}
-	else {
-		return false;
-	}
+	bytes = sizeof(float) * 3;
+	memcpy(&scale, cursor, bytes);
+
+	return true;
 }
 
 void ResourceMesh::FreeMemory()
 {
-	if (id_vertex != 0)
+	// the file read by a worker is released below
+	CancelLoading();
+
+	if (id_vertex != 0) {
+		App->resources->meshes_buffers_size -= GetBuffersSize();
+		App->resources->meshes_buffers_saved -= GetUncompressedBuffersSize() - GetBuffersSize();
 		glDeleteBuffers(1, &id_vertex);
+	}
 	if (id_index != 0)
 		glDeleteBuffers(1, &id_index);
-	if (id_normals != 0)
-		glDeleteBuffers(1, &id_normals);
-	if (id_uv != 0)
-		glDeleteBuffers(1, &id_uv);
 
-	if (index != nullptr) {
+	// the arrays of a mapped file point to it
+	if (file_mapping.data == nullptr && file_buffer == nullptr) {
 		delete[] index;
-		index = nullptr;
-	}
-	if (vertex != nullptr) {
 		delete[] vertex;
-		vertex = nullptr;
-	}
-	if (normals != nullptr) {
 		delete[] normals;
-		normals = nullptr;
-	}
-	if (uv_cords != nullptr) {
 		delete[] uv_cords;
-		uv_cords = nullptr;
-	}
-	if (center_point_normal != nullptr) {
 		delete[] center_point_normal;
-		center_point_normal = nullptr;
-	}
-	if (center_point != nullptr) {
 		delete[] center_point;
-		center_point = nullptr;
+		delete[] lod_index;
 	}
+	ReleaseFileData();
+
+	index = nullptr;
+	vertex = nullptr;
+	normals = nullptr;
+	uv_cords = nullptr;
+	center_point_normal = nullptr;
+	center_point = nullptr;
+	lod_index = nullptr;
+	num_lods = 0;
 
 	id_vertex = 0;
 	id_index = 0;
-	id_normals = 0;
-	id_uv = 0;
 
 	references = 0;
+	SetResidentMemory(0, 0);
 
 	num_vertex = 0;
 	num_index = 0;
@@ -254,85 +462,431 @@ bool ResourceMesh::LoadMemory()
 		return true;
 	}
 
+	if (!ReadMemory()) {
+		LOG_ENGINE("Mesh %s can't be read, it has an unknown version or is corrupted", meta_data_path.data());
+		return false;
+	}
+
+	return UploadMemory();
+}
+
+bool ResourceMesh::CanLoadAsync() const
+{
+	return local_aabb.IsFinite() && id_vertex == 0;
+}
+
+bool ResourceMesh::IsReloadable() const
+{
+	return !is_primitive && !meta_data_path.empty();
+}
+
+bool ResourceMesh::ReadMemory()
+{
+	j1PerfTimer timer;
+
+	// Load logs if the file is missing, the workers can't
+	if (!App->file_system->Exists(meta_data_path.data())) {
+		return false;
+	}
+
 	char* data = nullptr;
-	uint size = App->file_system->Load(meta_data_path.data(), &data);
+	uint size = 0;
+	if (App->file_system->Map(meta_data_path.data(), &file_mapping)) {
+		data = file_mapping.data;
+		size = file_mapping.size;
+	}
+	else {
+		// inside an archive, the buffer is kept and the arrays point to it like with the mapping
+		file_buffer_size = App->file_system->Load(meta_data_path.data(), &file_buffer);
+		data = file_buffer;
+		size = file_buffer_size;
+	}
+
+	if (size == 0) {
+		ReleaseFileData();
+		return false;
+	}
 
-	if (size > 0) {
-		char* cursor = data;
+	// the old format is checked when it is copied
+	const AlienMeshHeader* header = (const AlienMeshHeader*)data;
+	if (size >= ALIEN_MESH_HEADER_V1_SIZE && header->magic == ALIEN_MESH_MAGIC) {
+		bool valid = header->version <= ALIEN_MESH_VERSION && header->header_size >= ALIEN_MESH_HEADER_V1_SIZE && header->header_size <= size;
+		for (uint i = 0; valid && i < (uint)MeshSection::MAX; ++i) {
+			valid = (u64)header->sections[i].offset + header->sections[i].size <= size;
+		}
+		if (valid && header->header_size >= sizeof(AlienMeshHeader)) {
+			valid = header->num_lods <= MESH_MAX_LODS && (u64)header->lod_indices.offset + header->lod_indices.size <= size
+				&& (u64)header->lod_gpu_indices.offset + header->lod_gpu_indices.size <= size;
+			uint lods_index_count = 0;
+			for (uint i = 0; valid && i < header->num_lods; ++i) {
+				lods_index_count += header->lod_num_index[i];
+			}
+			valid = valid && header->lod_indices.size == sizeof(uint) * lods_index_count;
+		}
+		// hashing the whole file reads every page of the mapping, only when asked
+		if (valid && App->resources->check_meshes_checksum) {
+			valid = MeshChecksum(data + header->header_size, size - header->header_size) == header->checksum;
+		}
+		if (!valid) {
+			ReleaseFileData();
+			return false;
+		}
+	}
+
+	read_ms = timer.ReadMs();
 
-		uint ranges[9];
-		uint bytes = sizeof(ranges);
-		memcpy(ranges, cursor, bytes);
-		cursor += bytes_moved;
+	return true;
+}
 
-		num_index = ranges[0];
-		num_vertex = ranges[1];
-		num_faces = ranges[2];
+bool ResourceMesh::UploadMemory()
+{
+	j1PerfTimer timer;
 
-		bytes = sizeof(float) * num_vertex * 3;
-		if (num_vertex > 0) {
-			vertex = new float[num_vertex * 3];
-			memcpy(vertex, cursor, bytes);
+	char* data = (file_mapping.data != nullptr) ? file_mapping.data : file_buffer;
+	uint size = (file_mapping.data != nullptr) ? file_mapping.size : file_buffer_size;
+	if (data == nullptr) {
+		return false;
+	}
+
+	if (file_mapping.data != nullptr) {
+		++App->resources->meshes_mapped;
+	}
+	else {
+		App->resources->meshes_load_heap_bytes += size;
+	}
+
+	const AlienMeshHeader* header = (const AlienMeshHeader*)data;
+
+	if (size < ALIEN_MESH_HEADER_V1_SIZE || header->magic != ALIEN_MESH_MAGIC) {
+		// the old format is copied to new arrays, the file is not needed after it
+		bool ret = LoadLegacyMemory(data, size);
+		ReleaseFileData();
+		if (!ret) {
+			LOG_ENGINE("Mesh %s is corrupted, its arrays don't fit in the file or its indices are past its vertices", meta_data_path.data());
 		}
+		else {
+			if (App->resources->residency.drop_cpu_copies && id_vertex != 0) {
+				DropCPUCopies();
+			}
+			UpdateResidentMemory();
+			App->resources->meshes_load_heap_bytes += size;
+			++App->resources->meshes_loaded;
+			App->resources->meshes_load_ms += read_ms + timer.ReadMs();
+		}
+		return ret;
+	}
+
+	if (!CheckSectionsSizes(header)) {
+		LOG_ENGINE("Mesh %s is corrupted, its sections are smaller than its arrays", meta_data_path.data());
+		ReleaseFileData();
+		return false;
+	}
+	if (!CheckIndicesRanges(header, data)) {
+		LOG_ENGINE("Mesh %s is corrupted, it has indices past its vertices", meta_data_path.data());
+		ReleaseFileData();
+		return false;
+	}
+
+	num_index = header->num_index;
+	num_vertex = header->num_vertex;
+	num_faces = header->num_faces;
+
+	vertex_stride = header->vertex_stride;
+	normals_offset = header->normals_offset;
+	uv_offset = header->uv_offset;
+	index_type = header->index_type;
+	memcpy(uv_bias, header->uv_bias, sizeof(float) * 2);
+	memcpy(uv_scale, header->uv_scale, sizeof(float) * 2);
+
+	// the arrays point to the file, nothing is copied
+	char* sections[(uint)MeshSection::MAX];
+	for (uint i = 0; i < (uint)MeshSection::MAX; ++i) {
+		sections[i] = (header->sections[i].size > 0) ? data + header->sections[i].offset : nullptr;
+	}
+	vertex = (float*)sections[(uint)MeshSection::POSITIONS];
+	index = (uint*)sections[(uint)MeshSection::INDICES];
+	normals = (float*)sections[(uint)MeshSection::NORMALS];
+	center_point = (float*)sections[(uint)MeshSection::FACE_CENTERS];
+	center_point_normal = (float*)sections[(uint)MeshSection::FACE_NORMALS];
+	uv_cords = (float*)sections[(uint)MeshSection::UVS];
+
+	const void* gpu_lod_indices = nullptr;
+	if (header->header_size >= sizeof(AlienMeshHeader) && header->num_lods > 0) {
+		num_lods = header->num_lods;
+		memcpy(lod_num_index, header->lod_num_index, sizeof(uint) * MESH_MAX_LODS);
+		lod_index = (uint*)(data + header->lod_indices.offset);
+		gpu_lod_indices = (index_type == GL_UNSIGNED_SHORT) ? (const void*)(data + header->lod_gpu_indices.offset) : (const void*)lod_index;
+	}
+
+	if (texture_id != 0) {
+		texture = (ResourceTexture*)App->resources->GetResourceWithID(texture_id);
+	}
+
+	if (num_vertex != 0) {
+		const void* gpu_indices = (index_type == GL_UNSIGNED_SHORT) ? (const void*)sections[(uint)MeshSection::GPU_INDICES] : (const void*)index;
+		InitBuffers(sections[(uint)MeshSection::GPU_VERTICES], gpu_indices, gpu_lod_indices);
+	}
+	else {
+		--references;
+	}
+
+	if (App->resources->residency.drop_cpu_copies && id_vertex != 0) {
+		DropCPUCopies();
+	}
+	UpdateResidentMemory();
+
+	++App->resources->meshes_loaded;
+	App->resources->meshes_load_ms += read_ms + timer.ReadMs();
+
+	return true;
+}
+
+bool ResourceMesh::LoadLegacyMemory(const char* data, uint size)
+{
+	const char* cursor = data;
+
+	uint ranges[9];
+	uint bytes = sizeof(ranges);
+	if (size < bytes)
+		return false;
+	memcpy(ranges, cursor, bytes);
+
+	// every array the cursor goes through below must be inside the file
+	u64 base_size = (u64)bytes + ranges[7] + ranges[8] + ((ranges[6]) ? sizeof(u64) : 0) + sizeof(float) * 14;
+	u64 arrays_size = sizeof(float) * 3 * (u64)ranges[1] + sizeof(uint) * (u64)ranges[0];
+	if (ranges[4]) {
+		arrays_size += sizeof(float) * 3 * (u64)ranges[1] + sizeof(float) * 6 * (u64)ranges[2];
+	}
+	if (ranges[5]) {
+		arrays_size += sizeof(float) * ((ranges[5] == 2) ? 2 : 3) * (u64)ranges[1];
+	}
+	if (base_size + arrays_size > size)
+		return false;
+
+	// the indices after the positions must be of the vertices, checked before anything is copied
+	const char* file_index = data + base_size + sizeof(float) * 3 * (u64)ranges[1];
+	for (uint i = 0; i < ranges[0]; ++i) {
+		uint value = 0;
+		memcpy(&value, file_index + sizeof(uint) * i, sizeof(uint));
+		if (value >= ranges[1])
+			return false;
+	}
+
+	// skip the base info read in ReadBaseInfo
+	cursor += base_size;
+
+	num_index = ranges[0];
+	num_vertex = ranges[1];
+	num_faces = ranges[2];
+
+	bytes = sizeof(float) * num_vertex * 3;
+	if (num_vertex > 0) {
+		vertex = new float[num_vertex * 3];
+		memcpy(vertex, cursor, bytes);
+	}
+	cursor += bytes;
+
+	bytes = sizeof(uint) * num_index;
+	if (num_index > 0) {
+		index = new uint[num_index];
+		memcpy(index, cursor, bytes);
+	}
+	cursor += bytes;
+
+	// normals
+	if (ranges[4]) {
+		bytes = sizeof(float) * num_vertex * 3;
+		normals = new float[num_vertex * 3];
+		memcpy(normals, cursor, bytes);
 		cursor += bytes;
 
-		bytes = sizeof(uint) * num_index;
-		if (num_index > 0) {
-			index = new uint[num_index];
-			memcpy(index, cursor, bytes);
-		}
+		bytes = sizeof(float) * num_faces * 3;
+		center_point = new float[num_faces * 3];
+		memcpy(center_point, cursor, bytes);
 		cursor += bytes;
 
-		// normals
-		if (ranges[4]) {
-			bytes = sizeof(float) * num_vertex * 3;
-			normals = new float[num_vertex * 3];
-			memcpy(normals, cursor, bytes);
-			cursor += bytes;
-
-			bytes = sizeof(float) * num_faces * 3;
-			center_point = new float[num_faces * 3];
-			memcpy(center_point, cursor, bytes);
-			cursor += bytes;
-
-			bytes = sizeof(float) * num_faces * 3;
-			center_point_normal = new float[num_faces * 3];
-			memcpy(center_point_normal, cursor, bytes);
-			cursor += bytes;
-		}
+		bytes = sizeof(float) * num_faces * 3;
+		center_point_normal = new float[num_faces * 3];
+		memcpy(center_point_normal, cursor, bytes);
+		cursor += bytes;
+	}
 
-		// uv
-		if (ranges[5]) {
-			bytes = sizeof(float) * num_vertex * 3;
-			uv_cords = new float[num_vertex * 3];
-			memcpy(uv_cords, cursor, bytes);
+	// uv
+	if (ranges[5] == 2) {
+		bytes = sizeof(float) * num_vertex * 2;
+		uv_cords = new float[num_vertex * 2];
+		memcpy(uv_cords, cursor, bytes);
+	}
+	else if (ranges[5]) {
+		// first files with 3 floats each uv
+		uv_cords = new float[num_vertex * 2];
+		const float* uv = (const float*)cursor;
+		for (uint i = 0; i < num_vertex; ++i) {
+			uv_cords[i * 2] = uv[i * 3];
+			uv_cords[i * 2 + 1] = uv[i * 3 + 1];
 		}
+	}
 
-		if (texture_id != 0) {
-			texture = (ResourceTexture*)App->resources->GetResourceWithID(texture_id);
-		}
+	if (texture_id != 0) {
+		texture = (ResourceTexture*)App->resources->GetResourceWithID(texture_id);
+	}
+
+	if (num_vertex != 0) {
+		InitBuffers();
+	}
+	else {
+		--references;
+	}
 
-		if (num_vertex != 0) {
-			InitBuffers();
+	return true;
+}
+
+void ResourceMesh::DetachFromFile()
+{
+	// the arrays only point to the file once it is uploaded
+	if (loading) {
+		App->resources->streamer.Finish(this);
+	}
+
+	if (file_mapping.data == nullptr && file_buffer == nullptr)
+		return;
+
+	if (vertex != nullptr) {
+		float* copy = new float[num_vertex * 3];
+		memcpy(copy, vertex, sizeof(float) * num_vertex * 3);
+		vertex = copy;
+	}
+	if (index != nullptr) {
+		uint* copy = new uint[num_index];
+		memcpy(copy, index, sizeof(uint) * num_index);
+		index = copy;
+	}
+	if (normals != nullptr) {
+		float* copy = new float[num_vertex * 3];
+		memcpy(copy, normals, sizeof(float) * num_vertex * 3);
+		normals = copy;
+	}
+	if (uv_cords != nullptr) {
+		float* copy = new float[num_vertex * 2];
+		memcpy(copy, uv_cords, sizeof(float) * num_vertex * 2);
+		uv_cords = copy;
+	}
+	if (center_point != nullptr) {
+		float* copy = new float[num_faces * 3];
+		memcpy(copy, center_point, sizeof(float) * num_faces * 3);
+		center_point = copy;
+	}
+	if (center_point_normal != nullptr) {
+		float* copy = new float[num_faces * 3];
+		memcpy(copy, center_point_normal, sizeof(float) * num_faces * 3);
+		center_point_normal = copy;
+	}
+	if (lod_index != nullptr) {
+		uint* copy = new uint[GetLODsIndexCount()];
+		memcpy(copy, lod_index, sizeof(uint) * GetLODsIndexCount());
+		lod_index = copy;
+	}
+
+	ReleaseFileData();
+	UpdateResidentMemory();
+}
+
+void ResourceMesh::DropCPUCopies()
+{
+	if (!local_aabb.IsFinite() && vertex != nullptr) {
+		local_aabb.Enclose((float3*)vertex, num_vertex);
+	}
+
+	float* picking_vertex = nullptr;
+	uint* picking_index = nullptr;
+#ifndef GAME_VERSION
+	// the editor picks the objects with the triangles of their meshes, the positions and the indices stay
+	if (file_mapping.data != nullptr || file_buffer != nullptr) {
+		// they point to the file released below
+		if (vertex != nullptr) {
+			picking_vertex = new float[num_vertex * 3];
+			memcpy(picking_vertex, vertex, sizeof(float) * num_vertex * 3);
 		}
-		else {
-			--references;
+		if (index != nullptr) {
+			picking_index = new uint[num_index];
+			memcpy(picking_index, index, sizeof(uint) * num_index);
 		}
-
-		return true;
 	}
 	else {
-		return false;
+		picking_vertex = vertex;
+		picking_index = index;
+		vertex = nullptr;
+		index = nullptr;
+	}
+#endif
+
+	// the arrays of a mapped file point to it
+	if (file_mapping.data == nullptr && file_buffer == nullptr) {
+		delete[] index;
+		delete[] vertex;
+		delete[] normals;
+		delete[] uv_cords;
+		delete[] center_point_normal;
+		delete[] center_point;
+		delete[] lod_index;
 	}
+	ReleaseFileData();
+
+	index = picking_index;
+	vertex = picking_vertex;
+	normals = nullptr;
+	uv_cords = nullptr;
+	center_point_normal = nullptr;
+	center_point = nullptr;
+	lod_index = nullptr;
+
+	UpdateResidentMemory();
+}
+
+uint ResourceMesh::GetArraysSize() const
+{
+	uint size = 0;
+	size += (vertex != nullptr) ? sizeof(float) * num_vertex * 3 : 0;
+	size += (index != nullptr) ? sizeof(uint) * num_index : 0;
+	size += (normals != nullptr) ? sizeof(float) * num_vertex * 3 : 0;
+	size += (uv_cords != nullptr) ? sizeof(float) * num_vertex * 2 : 0;
+	size += (center_point != nullptr) ? sizeof(float) * num_faces * 3 : 0;
+	size += (center_point_normal != nullptr) ? sizeof(float) * num_faces * 3 : 0;
+	size += (lod_index != nullptr) ? sizeof(uint) * GetLODsIndexCount() : 0;
+	return size;
+}
+
+void ResourceMesh::UpdateResidentMemory()
+{
+	uint cpu = GetArraysSize();
+	if (file_mapping.data != nullptr) {
+		cpu = file_mapping.size;
+	}
+	else if (file_buffer != nullptr) {
+		cpu = file_buffer_size;
+	}
+	SetResidentMemory(cpu, (id_vertex != 0) ? GetBuffersSize() : 0);
+}
+
+void ResourceMesh::ReleaseFileData()
+{
+	if (file_mapping.data != nullptr) {
+		App->file_system->Unmap(&file_mapping);
+	}
+	if (file_buffer != nullptr) {
+		delete[] file_buffer;
+		file_buffer = nullptr;
+	}
+	file_buffer_size = 0;
 }
 
 bool ResourceMesh::DeleteMetaData()
 {
+	// a mapped file can't be removed
+	FreeMemory();
 	remove(meta_data_path.data());
 
-	std::vector<Resource*>::iterator position = std::find(App->resources->resources.begin(), App->resources->resources.end(), static_cast<Resource*>(this));
-	if (position != App->resources->resources.end())
-		App->resources->resources.erase(position);
+	App->resources->RemoveResource(this);
 
 	delete this;
 
@@ -368,7 +922,12 @@ void ResourceMesh::ConvertToGameObject(std::vector<std::pair<u64, GameObject*>>*
 
 	obj->AddComponent(new ComponentTransform(obj, pos, rot, scale));
 
-	if (num_vertex != 0) {
+	// a streamed mesh gets its vertices later, the component already uses the bounds of the file
+	if (num_vertex != 0 || loading) {
+
+		if (texture == nullptr && texture_id != 0) {
+			texture = (ResourceTexture*)App->resources->GetResourceWithID(texture_id);
+		}
 
 		ComponentMesh* mesh = new ComponentMesh(obj);
 
@@ -388,32 +947,327 @@ void ResourceMesh::ConvertToGameObject(std::vector<std::pair<u64, GameObject*>>*
 	}
 }
 
+void ResourceMesh::Optimize(VertexCacheStats* before, VertexCacheStats* after)
+{
+	if (vertex == nullptr || index == nullptr || num_index < 3)
+		return;
+
+	MeshOptimizer::WeldVertices(vertex, normals, uv_cords, index, num_index, num_vertex);
+	// measured welded, the copies of the vertices that assimp leaves would count as misses the reorder doesn't save
+	if (before != nullptr) {
+		*before = MeshOptimizer::AnalyzeVertexCache(index, num_index, num_vertex, VERTEX_CACHE_SIZE);
+	}
+	MeshOptimizer::OptimizeVertexCache(index, num_index, num_vertex);
+	MeshOptimizer::OptimizeOverdraw(index, num_index, vertex, num_vertex, OVERDRAW_CACHE_THRESHOLD);
+	// the arrays keep their size, only the first vertices are used
+	num_vertex = MeshOptimizer::OptimizeVertexFetch(vertex, normals, uv_cords, index, num_index, num_vertex);
+
+	if (after != nullptr) {
+		*after = MeshOptimizer::AnalyzeVertexCache(index, num_index, num_vertex, VERTEX_CACHE_SIZE);
+	}
+}
+
+void ResourceMesh::GenerateLODs()
+{
+	delete[] lod_index;
+	lod_index = nullptr;
+	num_lods = 0;
+
+	if (vertex == nullptr || index == nullptr || num_index < 3)
+		return;
+
+	// every level is simplified from the full mesh, the errors don't add up
+	std::vector<uint> lods;
+	uint* simplified = new uint[num_index];
+	uint previous_count = num_index;
+	for (uint i = 0; i < MESH_MAX_LODS; ++i) {
+		uint target = (uint)(previous_count / 3 * MESH_LOD_RATIO) * 3;
+		uint count = MeshOptimizer::SimplifyMesh(simplified, index, num_index, vertex, num_vertex, target, SIMPLIFY_MAX_ERROR);
+		if (count == 0 || count > previous_count * (1.0F - MESH_LOD_MIN_REDUCTION))
+			break;
+
+		MeshOptimizer::OptimizeVertexCache(simplified, count, num_vertex);
+		lods.insert(lods.end(), simplified, simplified + count);
+		lod_num_index[num_lods++] = count;
+		previous_count = count;
+	}
+	delete[] simplified;
+
+	if (num_lods > 0) {
+		lod_index = new uint[lods.size()];
+		memcpy(lod_index, lods.data(), sizeof(uint) * lods.size());
+	}
+}
+
+void ResourceMesh::GenerateFacesNormals()
+{
+	if (normals == nullptr || vertex == nullptr || index == nullptr)
+		return;
+
+	num_faces = num_index / 3;
+	center_point_normal = new float[num_faces * 3];
+	center_point = new float[num_faces * 3];
+	for (uint i = 0; i < num_faces * 3; i += 3)
+	{
+		uint index1 = index[i] * 3;
+		uint index2 = index[i + 1] * 3;
+		uint index3 = index[i + 2] * 3;
+
+		float3 x0(vertex[index1], vertex[index1 + 1], vertex[index1 + 2]);
+		float3 x1(vertex[index2], vertex[index2 + 1], vertex[index2 + 2]);
+		float3 x2(vertex[index3], vertex[index3 + 1], vertex[index3 + 2]);
+
+		float3 v0 = x0 - x2;
+		float3 v1 = x1 - x2;
+		float3 n = v0.Cross(v1);
+
+		float3 normalized = n.Normalized();
+
+		center_point[i] = (x0.x + x1.x + x2.x) / 3;
+		center_point[i + 1] = (x0.y + x1.y + x2.y) / 3;
+		center_point[i + 2] = (x0.z + x1.z + x2.z) / 3;
+
+		center_point_normal[i] = normalized.x;
+		center_point_normal[i + 1] = normalized.y;
+		center_point_normal[i + 2] = normalized.z;
+	}
+}
+
 void ResourceMesh::InitBuffers()
+{
+	SetVertexLayout();
+
+	// 10:10:10:2 when the driver accepts it for the normals, 4 bytes if not
+	normals_type = GLEW_ARB_vertex_type_2_10_10_10_rev ? GL_INT_2_10_10_10_REV : GL_BYTE;
+
+	char* data = new char[vertex_stride * num_vertex];
+	FillVertexBuffer(data, normals_type);
+
+	// 16 bits when all the vertices can be addressed with them, the levels go after the full mesh
+	uint lods_index_count = (lod_index != nullptr) ? GetLODsIndexCount() : 0;
+	unsigned short* short_index = nullptr;
+	if (num_vertex <= 65536) {
+		index_type = GL_UNSIGNED_SHORT;
+		short_index = new unsigned short[num_index + lods_index_count];
+		for (uint i = 0; i < num_index; ++i) {
+			short_index[i] = (unsigned short)index[i];
+		}
+		for (uint i = 0; i < lods_index_count; ++i) {
+			short_index[num_index + i] = (unsigned short)lod_index[i];
+		}
+		UploadBuffers(data, short_index, short_index + num_index);
+	}
+	else {
+		index_type = GL_UNSIGNED_INT;
+		UploadBuffers(data, index, lod_index);
+	}
+
+	delete[] data;
+	delete[] short_index;
+
+	UpdateResidentMemory();
+}
+
+void ResourceMesh::InitBuffers(const char* gpu_vertices, const void* gpu_indices, const void* gpu_lod_indices)
+{
+	normals_type = GL_INT_2_10_10_10_REV;
+
+	if (normals != nullptr && !GLEW_ARB_vertex_type_2_10_10_10_rev) {
+		normals_type = GL_BYTE;
+		char* data = new char[vertex_stride * num_vertex];
+		FillVertexBuffer(data, normals_type);
+		UploadBuffers(data, gpu_indices, gpu_lod_indices);
+		delete[] data;
+		App->resources->meshes_load_heap_bytes += vertex_stride * num_vertex;
+	}
+	else {
+		UploadBuffers(gpu_vertices, gpu_indices, gpu_lod_indices);
+	}
+}
+
+void ResourceMesh::SetVertexLayout()
+{
+	// position, packed normal and uv
+	vertex_stride = sizeof(float) * 3;
+	normals_offset = vertex_stride;
+	if (normals != nullptr)
+		vertex_stride += sizeof(uint);
+	uv_offset = vertex_stride;
+	if (uv_cords != nullptr)
+		vertex_stride += sizeof(short) * 2;
+
+	if (uv_cords != nullptr) {
+		float uv_min[2] = { FLOAT_INF, FLOAT_INF };
+		float uv_max[2] = { -FLOAT_INF, -FLOAT_INF };
+		for (uint i = 0; i < num_vertex * 2; ++i) {
+			uv_min[i % 2] = Min(uv_min[i % 2], uv_cords[i]);
+			uv_max[i % 2] = Max(uv_max[i % 2], uv_cords[i]);
+		}
+
+		for (uint j = 0; j < 2; ++j) {
+			float extent = uv_max[j] - uv_min[j];
+			float step = (extent > 0.0F) ? extent / 65535.0F : 1.0F;
+			uv_scale[j] = step;
+			uv_bias[j] = uv_min[j] + 32768.0F * step;
+		}
+	}
+}
+
+void ResourceMesh::FillVertexBuffer(char* data, uint packed_normals_type) const
+{
+	for (uint i = 0; i < num_vertex; ++i) {
+		memcpy(data + i * vertex_stride, &vertex[i * 3], sizeof(float) * 3);
+	}
+
+	if (normals != nullptr) {
+		for (uint i = 0; i < num_vertex; ++i) {
+			uint packed = 0;
+			if (packed_normals_type == GL_INT_2_10_10_10_REV) {
+				for (uint j = 0; j < 3; ++j) {
+					int value = (int)roundf(Clamp(normals[i * 3 + j], -1.0F, 1.0F) * 511.0F);
+					packed |= ((uint)value & 0x3FF) << (j * 10);
+				}
+			}
+			else {
+				for (uint j = 0; j < 3; ++j) {
+					int value = (int)roundf(Clamp(normals[i * 3 + j], -1.0F, 1.0F) * 127.0F);
+					packed |= ((uint)value & 0xFF) << (j * 8);
+				}
+			}
+			memcpy(data + i * vertex_stride + normals_offset, &packed, sizeof(uint));
+		}
+	}
+
+	if (uv_cords != nullptr) {
+		for (uint i = 0; i < num_vertex; ++i) {
+			short uv[2];
+			for (uint j = 0; j < 2; ++j) {
+				float value = roundf((uv_cords[i * 2 + j] - uv_bias[j]) / uv_scale[j]);
+				uv[j] = (short)Clamp(value, -32768.0F, 32767.0F);
+			}
+			memcpy(data + i * vertex_stride + uv_offset, uv, sizeof(short) * 2);
+		}
+	}
+}
+
+void ResourceMesh::UploadBuffers(const char* vertex_data, const void* index_data, const void* lod_index_data)
 {
 	glGenBuffers(1, &id_vertex);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_vertex);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(float) *num_vertex * 3,
-		vertex, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, id_vertex);
+	glBufferData(GL_ARRAY_BUFFER, vertex_stride * num_vertex, vertex_data, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	// index
+	// the levels can't come with the mesh, their indices go after the full mesh ones
+	if (lod_index_data == nullptr) {
+		num_lods = 0;
+	}
+	uint index_size = (index_type == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(uint);
 	glGenBuffers(1, &id_index);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_index);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint) * num_index,
-		index, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_size * (num_index + GetLODsIndexCount()), nullptr, GL_STATIC_DRAW);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, index_size * num_index, index_data);
+	if (num_lods > 0) {
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, index_size * num_index, index_size * GetLODsIndexCount(), lod_index_data);
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-	if (uv_cords != nullptr) {
-		// UV
-		glGenBuffers(1, &id_uv);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_uv);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(float) * num_vertex * 3,
-			uv_cords, GL_STATIC_DRAW);
+	App->resources->meshes_buffers_size += GetBuffersSize();
+	App->resources->meshes_buffers_saved += GetUncompressedBuffersSize() - GetBuffersSize();
+}
+
+void ResourceMesh::BindBuffers(bool use_normals, bool use_uv) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, id_vertex);
+	glVertexPointer(3, GL_FLOAT, vertex_stride, 0);
+
+	if (use_uv && HasUV()) {
+		glTexCoordPointer(2, GL_SHORT, vertex_stride, (void*)(size_t)uv_offset);
+		glMatrixMode(GL_TEXTURE);
+		glLoadIdentity();
+		glTranslatef(uv_bias[0], uv_bias[1], 0.0F);
+		glScalef(uv_scale[0], uv_scale[1], 1.0F);
+		glMatrixMode(GL_MODELVIEW);
 	}
 
-	if (normals != nullptr) {
-		// normals
-		glGenBuffers(1, &id_normals);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_normals);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(float) * num_vertex * 3,
-			normals, GL_STATIC_DRAW);
+	if (use_normals && HasNormals()) {
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(normals_type, vertex_stride, (void*)(size_t)normals_offset);
+	}
+	else {
+		glDisableClientState(GL_NORMAL_ARRAY);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_index);
+}
+
+void ResourceMesh::DrawElements(uint lod, uint instances) const
+{
+	uint count = num_index;
+	uint offset = 0;
+	if (lod > 0 && lod <= num_lods) {
+		count = lod_num_index[lod - 1];
+		offset = num_index;
+		for (uint i = 0; i < lod - 1; ++i) {
+			offset += lod_num_index[i];
+		}
+	}
+
+	uint index_size = (index_type == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(uint);
+	if (instances > 1)
+		glDrawElementsInstancedARB(GL_TRIANGLES, count, index_type, (void*)(size_t)(offset * index_size), instances);
+	else
+		glDrawElements(GL_TRIANGLES, count, index_type, (void*)(size_t)(offset * index_size));
+}
+
+void ResourceMesh::UnbindBuffers() const
+{
+	// the texture matrix could have been set by another mesh bound before
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+uint ResourceMesh::GetBuffersSize() const
+{
+	uint index_size = (index_type == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(uint);
+	return vertex_stride * num_vertex + index_size * (num_index + GetLODsIndexCount());
+}
+
+uint ResourceMesh::GetUncompressedBuffersSize() const
+{
+	// the old layout had a buffer of 3 floats for the positions, normals and uvs
+	uint attributes = 1 + (HasNormals() ? 1 : 0) + (HasUV() ? 1 : 0);
+	return sizeof(float) * 3 * attributes * num_vertex + sizeof(uint) * (num_index + GetLODsIndexCount());
+}
+
+bool ResourceMesh::HasNormals() const
+{
+	// the layout is known even if the arrays have been dropped
+	return uv_offset > normals_offset;
+}
+
+bool ResourceMesh::HasUV() const
+{
+	return vertex_stride > uv_offset;
+}
+
+uint ResourceMesh::GetLODsCount() const
+{
+	return num_lods + 1;
+}
+
+uint ResourceMesh::GetIndexCount(uint lod) const
+{
+	return (lod == 0 || lod > num_lods) ? num_index : lod_num_index[lod - 1];
+}
+
+uint ResourceMesh::GetLODsIndexCount() const
+{
+	uint count = 0;
+	for (uint i = 0; i < num_lods; ++i) {
+		count += lod_num_index[i];
 	}
+	return count;
 }
@@ -5,9 +5,90 @@
 #include "MathGeoLib/include/Math/Quat.h"
 #include "GameObject.h"
 #include "Color.h"
+#include "ModuleFileSystem.h"
+#include "MeshOptimizer.h"
 
 class ResourceTexture;
 
+// .alienMesh files start with this header. The sections are aligned so the arrays of the mesh can point
+// straight to the mapped file and the vertex buffer is uploaded from it without any copy.
+#define ALIEN_MESH_MAGIC 0x48534D41 // "AMSH"
+#define ALIEN_MESH_VERSION 3
+#define ALIEN_MESH_ALIGNMENT 16
+
+// simplified levels of each mesh, besides the full one
+#define MESH_MAX_LODS 3
+// each level is simplified to this part of the triangles of the previous one
+#define MESH_LOD_RATIO 0.5F
+// a level is dropped if it doesn't remove at least this part of the triangles of the previous one
+#define MESH_LOD_MIN_REDUCTION 0.2F
+
+enum class MeshSection {
+	NAMES,
+	POSITIONS,
+	INDICES,
+	NORMALS,
+	FACE_CENTERS,
+	FACE_NORMALS,
+	UVS,
+	// interleaved vertices with the normals in 10:10:10:2, ready for the vertex buffer
+	GPU_VERTICES,
+	// 16 bit indices, only if the mesh fits them. If not the index buffer uses INDICES
+	GPU_INDICES,
+
+	MAX
+};
+
+struct MeshSectionRange {
+	uint offset = 0;
+	uint size = 0;
+};
+
+struct AlienMeshHeader {
+	uint magic = ALIEN_MESH_MAGIC;
+	uint version = ALIEN_MESH_VERSION;
+	uint header_size = sizeof(AlienMeshHeader);
+	// FNV-1a of everything after the header
+	uint checksum = 0;
+
+	uint num_index = 0;
+	uint num_vertex = 0;
+	uint num_faces = 0;
+	uint family_number = 0;
+	u64 texture_id = 0;
+	uint parent_name_size = 0;
+	uint name_size = 0;
+
+	float material_color[4];
+	float pos[3];
+	float rot[4];
+	float scale[3];
+
+	uint vertex_stride = 0;
+	uint normals_offset = 0;
+	uint uv_offset = 0;
+	uint index_type = 0;
+	float uv_bias[2];
+	float uv_scale[2];
+
+	MeshSectionRange sections[(uint)MeshSection::MAX];
+
+	// version 2, the mesh bounds so the objects can be placed before the vertices are loaded
+	float aabb_min[3];
+	float aabb_max[3];
+
+	// version 3, the simplified levels. They use the same vertices and go after the full mesh in the index buffer
+	uint num_lods = 0;
+	uint lod_num_index[MESH_MAX_LODS];
+	MeshSectionRange lod_indices;
+	// 16 bit like GPU_INDICES if the mesh fits them
+	MeshSectionRange lod_gpu_indices;
+};
+
+// version 1 files end the header before the bounds and version 2 before the levels
+#define ALIEN_MESH_HEADER_V1_SIZE offsetof(AlienMeshHeader, aabb_min)
+#define ALIEN_MESH_HEADER_V2_SIZE offsetof(AlienMeshHeader, num_lods)
+
 class ResourceMesh : public Resource {
 
 	friend class ModuleImporter;
@@ -19,24 +100,76 @@ public:
 	virtual ~ResourceMesh();
 
 	bool CreateMetaData(const u64& force_id = 0);
+	// the ID, the path and the file detached, in the main thread
+	void PrepareMetaData(const u64& force_id = 0);
+	// the whole .alienMesh in a buffer deleted with delete[]. Only touches this mesh, different meshes can be serialized in parallel
+	char* SerializeMetaData(uint* file_size);
+	// the same in the format before the header, only to compare the loads of both in the tests
+	char* SerializeLegacyMetaData(uint* file_size) const;
 	bool ReadBaseInfo(const char* assets_file_path);
 
 	void FreeMemory();
 	bool LoadMemory();
 
+	// only the files with the bounds in the header, the objects need them while the mesh is being streamed
+	bool CanLoadAsync() const;
+	bool IsReloadable() const;
+	// map or read the file and check it, in a worker thread
+	bool ReadMemory();
+	// point the arrays to the file read and create the buffers
+	bool UploadMemory();
+
 	bool DeleteMetaData();
 
 	void ConvertToGameObject(std::vector<std::pair<u64, GameObject*>>* objects_created);
 
+	// weld the equal vertices and reorder the triangles and the vertices with MeshOptimizer, before the faces normals and
+	// the buffers are created. Only touches this mesh
+	void Optimize(VertexCacheStats* before = nullptr, VertexCacheStats* after = nullptr);
+	// center and normal of every face, only the meshes with normals have them
+	void GenerateFacesNormals();
+	// simplify the mesh to MESH_LOD_RATIO of the triangles again and again, before the buffers are created
+	void GenerateLODs();
+	// upload the mesh to an interleaved vertex buffer, with packed normals and quantized uvs
 	void InitBuffers();
+	// the vertex buffer data comes from the file, only copied if the normals have to be repacked
+	void InitBuffers(const char* gpu_vertices, const void* gpu_indices, const void* gpu_lod_indices);
+	// set the vertex pointers to the interleaved buffer and bind the index buffer
+	void BindBuffers(bool use_normals, bool use_uv) const;
+	// draw all the triangles of the bound buffers, or the ones of a simplified level. More than one instance is one
+	// instanced draw call, only with ARB_instanced_arrays
+	void DrawElements(uint lod = 0, uint instances = 1) const;
+	void UnbindBuffers() const;
+
+	// bytes of the vertex and index buffers in the GPU
+	uint GetBuffersSize() const;
+	// bytes the same buffers would use with floats and 32 bit indices
+	uint GetUncompressedBuffersSize() const;
+	// attributes of the vertex buffer
+	bool HasNormals() const;
+	bool HasUV() const;
+
+	// levels including the full mesh, 0 is the full one
+	uint GetLODsCount() const;
+	uint GetIndexCount(uint lod) const;
+	// indices of all the simplified levels
+	uint GetLODsIndexCount() const;
 
 public:
 
-	// buffers id
+	// buffers id, the vertex buffer has position, normal and uv interleaved
 	uint id_index = 0;
 	uint id_vertex = 0;
-	uint id_normals = 0;
-	uint id_uv = 0;
+	// layout of the vertex buffer
+	uint vertex_stride = 0;
+	uint normals_offset = 0;
+	uint uv_offset = 0;
+	uint normals_type = 0;
+	// GL_UNSIGNED_SHORT if the mesh has less than 65536 vertices
+	uint index_type = 0;
+	// the uvs are stored as shorts between the mesh uv bounds, the texture matrix maps them back
+	float uv_bias[2] = { 0.0F, 0.0F };
+	float uv_scale[2] = { 1.0F, 1.0F };
 	// buffers size
 	uint num_index = 0;
 	uint num_vertex = 0;
@@ -45,12 +178,20 @@ public:
 	uint* index = nullptr;
 	float* vertex = nullptr;
 	float* normals = nullptr;
+	// 2 floats each vertex
 	float* uv_cords = nullptr;
 	float* center_point_normal = nullptr;
 	float* center_point = nullptr;
+	// simplified levels, the indices of each one after the other
+	uint num_lods = 0;
+	uint lod_num_index[MESH_MAX_LODS] = { 0 };
+	uint* lod_index = nullptr;
 
 	bool is_primitive = false;
 	bool is_custom = true;
+
+	// bounds of the vertices, known before loading them if the file has them
+	AABB local_aabb;
 private:
 
 	std::string parent_name;
@@ -65,6 +206,32 @@ private:
 
 	Color material_color;
 
-	uint bytes_moved = 0;
+	// if the arrays point to the mapped .alienMesh or to the file read in a buffer they are not deleted
+	FileMapping file_mapping;
+	char* file_buffer = nullptr;
+	uint file_buffer_size = 0;
+	// time ReadMemory took, added to the load stats in the upload
+	double read_ms = 0.0;
+
+private:
+
+	// old files without header, they are copied to new arrays
+	bool ReadLegacyBaseInfo(const char* data, uint size);
+	bool LoadLegacyMemory(const char* data, uint size);
+	void ReleaseFileData();
+	// copy the arrays that point to the file to new ones, needed before the file is written or removed
+	void DetachFromFile();
+	// free the arrays once the buffers have them, the bounds are kept. The editor keeps the positions and the indices
+	// to pick the objects
+	void DropCPUCopies();
+	// bytes of the arrays allocated for this mesh
+	uint GetArraysSize() const;
+	void UpdateResidentMemory();
+
+	// vertex_stride, offsets and uv quantization
+	void SetVertexLayout();
+	// write vertex_stride * num_vertex bytes of interleaved vertices
+	void FillVertexBuffer(char* data, uint packed_normals_type) const;
+	void UploadBuffers(const char* vertex_data, const void* index_data, const void* lod_index_data);
 
 };
\ No newline at end of file
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include "ReturnZ.h"
 #include "ComponentTransform.h"
+#include "ParallelFor.h"
+#include "AssetDatabase.h"
+#include "ResourceTexture.h"
 
 ResourceModel::ResourceModel() : Resource()
 {
@@ -32,6 +35,7 @@ bool ResourceModel::CreateMetaData(const u64& force_id)
 		ID = force_id;
 
 	std::string* paths = nullptr;
+	uint num_paths = 0;
 
 	if (force_id != 0) {
 		JSON_Value* value = json_parse_file(meta_data_path.data());
@@ -41,6 +45,7 @@ bool ResourceModel::CreateMetaData(const u64& force_id)
 		{
 			JSONfilepack* meta = new JSONfilepack(meta_data_path.data(), object, value);
 			paths = meta->GetArrayString("Meta.PathMeshes");
+			num_paths = (uint)meta->GetNumber("Meta.NumMeshes");
 			delete meta;
 		}
 		remove(meta_data_path.data());
@@ -79,18 +84,39 @@ bool ResourceModel::CreateMetaData(const u64& force_id)
 			std::vector<ResourceMesh*>::iterator item = meshes_attached.begin();
 			for (; item != meshes_attached.end(); ++item) {
 				if ((*item) != nullptr) {
-					if (paths != nullptr) {
+					// the asset could have more meshes than when it was imported
+					if (paths != nullptr && (uint)(item - meshes_attached.begin()) < num_paths) {
 						std::string path_ = App->file_system->GetBaseFileName(paths[item - meshes_attached.begin()].data()); //std::stoull().data());
-						(*item)->CreateMetaData(std::stoull(path_));
+						(*item)->PrepareMetaData(std::stoull(path_));
 					}
 					else {
-						(*item)->CreateMetaData();
+						(*item)->PrepareMetaData();
 					}
+				}
+			}
+
+			// the buffers are built in parallel, the files are written here because saving logs
+			j1PerfTimer timer;
+			std::vector<std::pair<char*, uint>> files(meshes_attached.size(), { nullptr, 0 });
+			ParallelFor(meshes_attached.size(), App->importer->import_threads, [this, &files](uint i) {
+				if (meshes_attached[i] != nullptr) {
+					files[i].first = meshes_attached[i]->SerializeMetaData(&files[i].second);
+				}
+			});
+			App->importer->last_serialize_ms = timer.ReadMs();
+
+			timer.Start();
+			for (item = meshes_attached.begin(); item != meshes_attached.end(); ++item) {
+				if ((*item) != nullptr) {
+					std::pair<char*, uint>& file = files[item - meshes_attached.begin()];
+					App->file_system->Save((*item)->GetLibraryPath(), file.first, file.second);
+					delete[] file.first;
 
 					meshes_paths[item - meshes_attached.begin()] = (*item)->GetLibraryPath();
 					LOG_ENGINE("Created alienMesh file %s", (*item)->GetLibraryPath());
 				}
 			}
+			App->importer->last_save_ms = timer.ReadMs();
 			meta->SetArrayString("Model.PathMeshes", meshes_paths, meshes_attached.size());
 			alien->SetArrayString("Meta.PathMeshes", meshes_paths, meshes_attached.size());
 			if (paths != nullptr)
@@ -182,7 +208,7 @@ void ResourceModel::ReadLibrary(const char* meta_data)
 	meta_data_path = meta_data;
 	ID = std::stoull(App->file_system->GetBaseFileName(meta_data_path.data()));
 
-	JSON_Value* mesh_value = json_parse_file(meta_data_path.data());
+	JSON_Value* mesh_value = App->file_system->LoadJSON(meta_data_path.data());
 	JSON_Object* mesh_object = json_value_get_object(mesh_value);
 
 	if (mesh_value != nullptr && mesh_object != nullptr) {
@@ -235,9 +261,7 @@ bool ResourceModel::DeleteMetaData()
 	}
 	meshes_attached.clear();
 
-	std::vector<Resource*>::iterator position = std::find(App->resources->resources.begin(), App->resources->resources.end(), static_cast<Resource*>(this));
-	if (position != App->resources->resources.end()) 
-		App->resources->resources.erase(position);
+	App->resources->RemoveResource(this);
 
 	delete this;
 
@@ -288,6 +312,54 @@ void ResourceModel::ConvertToGameObjects()
 	App->camera->reference = App->objects->GetRoot(false)->children.back()->GetBB().CenterPoint();
 }
 
+std::vector<std::string> ResourceModel::GetLibraryFiles() const
+{
+	std::vector<std::string> files;
+	files.push_back(LIBRARY_MODELS_FOLDER + std::to_string(ID) + ".alienModel");
+
+	std::vector<ResourceMesh*>::const_iterator item = meshes_attached.cbegin();
+	for (; item != meshes_attached.cend(); ++item) {
+		if (*item != nullptr) {
+			files.push_back((*item)->GetLibraryPath());
+		}
+	}
+	return files;
+}
+
+std::vector<AssetDependency> ResourceModel::GetTextureDependencies() const
+{
+	std::vector<AssetDependency> dependencies;
+
+	if (!textures_asked.empty()) {
+		std::vector<std::string>::const_iterator item = textures_asked.cbegin();
+		for (; item != textures_asked.cend(); ++item) {
+			const ResourceTexture* texture = App->resources->GetTextureByName((*item).data());
+			AssetDependency dependency;
+			dependency.name = *item;
+			dependency.ID = (texture != nullptr) ? texture->GetID() : 0;
+			dependencies.push_back(dependency);
+		}
+		return dependencies;
+	}
+
+	std::vector<ResourceMesh*>::const_iterator item = meshes_attached.cbegin();
+	for (; item != meshes_attached.cend(); ++item) {
+		if (*item == nullptr)
+			continue;
+		const Resource* texture = (*item)->texture;
+		if (texture == nullptr && (*item)->texture_id != 0) {
+			texture = App->resources->GetResourceWithID((*item)->texture_id);
+		}
+		if (texture != nullptr) {
+			AssetDependency dependency;
+			dependency.name = texture->GetAssetsPath();
+			dependency.ID = texture->GetID();
+			dependencies.push_back(dependency);
+		}
+	}
+	return dependencies;
+}
+
 bool ResourceModel::SortByFamilyNumber(const ResourceMesh* mesh1, const ResourceMesh* mesh2)
 {
 	return mesh1->family_number < mesh2->family_number;
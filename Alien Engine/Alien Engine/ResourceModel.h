@@ -4,6 +4,7 @@
 #include <vector>
 
 class ResourceMesh;
+struct AssetDependency;
 
 class ResourceModel : public Resource {
 
@@ -24,6 +25,11 @@ public:
 	// create GameObjects
 	void ConvertToGameObjects();
 
+	// for the asset database, the .alienModel and the files of its meshes
+	std::vector<std::string> GetLibraryFiles() const;
+	// the textures the meshes asked for in the last import, or the ones they have if it was not imported now
+	std::vector<AssetDependency> GetTextureDependencies() const;
+
 private:
 
 	// sort
@@ -33,4 +39,9 @@ public:
 
 	std::vector<ResourceMesh*> meshes_attached;
 
+private:
+
+	// names the importer searched the textures with, the missing ones too
+	std::vector<std::string> textures_asked;
+
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "ComponentLight.h"
 #include "ComponentTransform.h"
 #include "PanelHierarchy.h"
+#include <unordered_map>
 
 ResourcePrefab::ResourcePrefab() : Resource()
 {
@@ -120,6 +121,7 @@ bool ResourcePrefab::ReadBaseInfo(const char* assets_file_path)
 			stat(path.data(), &assets_file);
 			stat(meta_data_path.data(), &meta_file);
 			if (assets_file.st_mtime != meta_file.st_mtime) {
+				InvalidateCompiled();
 				remove(meta_data_path.data());
 				App->file_system->Copy(path.data(), meta_data_path.data());
 			}
@@ -150,6 +152,7 @@ bool ResourcePrefab::DeleteMetaData()
 		App->objects->enable_instancies = true;
 		App->objects->SwapReturnZ(true, true);
 	}
+	InvalidateCompiled();
 	remove(meta_data_path.data());
 	App->objects->GetRoot(true)->UnpackAllPrefabsOf(ID);
 	return true;
@@ -157,6 +160,7 @@ bool ResourcePrefab::DeleteMetaData()
 
 void ResourcePrefab::Save(GameObject* prefab_root)
 {
+	InvalidateCompiled();
 	remove(meta_data_path.data());
 	remove(path.data());
 	JSON_Value* prefab_value = json_value_init_object();
@@ -231,64 +235,117 @@ void ResourcePrefab::OpenPrefabScene()
 
 void ResourcePrefab::ConvertToGameObjects(GameObject* parent, int list_num, float3 pos, bool set_selected)
 {
-	JSON_Value* value = json_parse_file(meta_data_path.data());
-	JSON_Object* object = json_value_get_object(value);
+	App->objects->octree.BeginBulkInsert();
+	bool created = (App->resources->use_compiled_prefabs && compiled.taken) ? InstantiateCompiled(parent, set_selected) : LoadFromLibrary(parent, set_selected);
+	if (!created) {
+		App->objects->octree.EndBulkInsert();
+		LOG_ENGINE("Error loading prefab %s", path.data());
+		return;
+	}
 
-	if (value != nullptr && object != nullptr)
-	{
-		JSONfilepack* prefab = new JSONfilepack(meta_data_path.data(), object, value);
+	GameObject* obj = parent->children.back();
+	if (list_num != -1) {
+		parent->children.pop_back();
+		parent->children.insert(parent->children.begin() + list_num, obj);
+	}
+	obj->ResetIDs();
+	obj->SetPrefab(ID);
+	ComponentTransform* transform = (ComponentTransform*)(obj)->GetComponent(ComponentType::TRANSFORM);
+	transform->SetLocalPosition(pos.x, pos.y, pos.z);
+	// the octree keeps the AABBs, they must be in the final position
+	if (obj->is_static || obj->HasChildrenStatic()) {
+		App->objects->transform_hierarchy.Update(App->objects->GetRoot(true));
+	}
+	App->objects->octree.EndBulkInsert();
+	if (set_selected) {
+		App->objects->SetNewSelectedObject(obj);
+		App->camera->fake_camera->Look(parent->children.back()->GetBB().CenterPoint());
+		App->camera->reference = parent->children.back()->GetBB().CenterPoint();
+	}
+}
 
-		JSONArraypack* game_objects = prefab->GetArray("Prefab.GameObjects");
+void ResourcePrefab::InvalidateCompiled()
+{
+	compiled.data.Clear();
+	compiled.objects.clear();
+	compiled.taken = false;
+}
 
-		// first is family number, second parentID, third is array index in the json file
-		std::vector<std::tuple<uint, u64, uint>> objects_to_create;
+bool ResourcePrefab::LoadFromLibrary(GameObject* parent, bool set_selected)
+{
+	JSON_Value* value = App->file_system->LoadJSON(meta_data_path.data());
+	JSON_Object* object = json_value_get_object(value);
 
-		for (uint i = 0; i < game_objects->GetArraySize(); ++i) {
-			uint family_number = game_objects->GetNumber("FamilyNumber");
-			u64 parentID = std::stoull(game_objects->GetString("ParentID"));
-			objects_to_create.push_back({ family_number,parentID, i });
-			game_objects->GetAnotherNode();
-		}
-		std::sort(objects_to_create.begin(), objects_to_create.end(), ModuleObjects::SortByFamilyNumber);
-		game_objects->GetFirstNode();
-		std::vector<GameObject*> objects_created;
-
-		std::vector<std::tuple<uint, u64, uint>>::iterator item = objects_to_create.begin();
-		for (; item != objects_to_create.end(); ++item) {
-			game_objects->GetNode(std::get<2>(*item));
-			GameObject* obj = new GameObject();
-			if (std::get<0>(*item) == 1) { 
-				obj->LoadObject(game_objects, parent, !set_selected);
-			}
-			else { // search parent
-				std::vector<GameObject*>::iterator objects = objects_created.begin();
-				for (; objects != objects_created.end(); ++objects) {
-					if ((*objects)->ID == std::get<1>(*item)) {
-						obj->LoadObject(game_objects, *objects, !set_selected);
-						break;
-					}
-				}
-			}
-			objects_created.push_back(obj);
+	if (value == nullptr || object == nullptr) {
+		if (value != nullptr) {
+			json_value_free(value);
 		}
-		GameObject* obj = parent->children.back();
-		if (list_num != -1) {
-			parent->children.pop_back();
-			parent->children.insert(parent->children.begin() + list_num, obj);
+		return false;
+	}
+
+	JSONfilepack* prefab = new JSONfilepack(meta_data_path.data(), object, value);
+
+	JSONArraypack* game_objects = prefab->GetArray("Prefab.GameObjects");
+
+	// first is family number, second parentID, third is array index in the json file
+	std::vector<std::tuple<uint, u64, uint>> objects_to_create;
+
+	for (uint i = 0; i < game_objects->GetArraySize(); ++i) {
+		uint family_number = game_objects->GetNumber("FamilyNumber");
+		u64 parentID = std::stoull(game_objects->GetString("ParentID"));
+		objects_to_create.push_back({ family_number,parentID, i });
+		game_objects->GetAnotherNode();
+	}
+	// stable so the children keep the order of the file
+	std::stable_sort(objects_to_create.begin(), objects_to_create.end(), ModuleObjects::SortByFamilyNumber);
+	game_objects->GetFirstNode();
+	std::unordered_map<u64, GameObject*> objects_created;
+
+	GameObject* root = nullptr;
+	std::vector<std::tuple<uint, u64, uint>>::iterator item = objects_to_create.begin();
+	for (; item != objects_to_create.end(); ++item) {
+		game_objects->GetNode(std::get<2>(*item));
+		GameObject* obj_parent = parent;
+		if (std::get<0>(*item) != 1) { // search parent
+			std::unordered_map<u64, GameObject*>::iterator found = objects_created.find(std::get<1>(*item));
+			if (found == objects_created.end())
+				continue;
+			obj_parent = (*found).second;
 		}
-		obj->ResetIDs();
-		obj->SetPrefab(ID);
-		ComponentTransform* transform = (ComponentTransform*)(obj)->GetComponent(ComponentType::TRANSFORM);
-		transform->SetLocalPosition(pos.x, pos.y, pos.z);
-		if (set_selected) {
-			App->objects->SetNewSelectedObject(obj);
-			App->camera->fake_camera->Look(parent->children.back()->GetBB().CenterPoint());
-			App->camera->reference = parent->children.back()->GetBB().CenterPoint();
+		GameObject* obj = new GameObject();
+		obj->LoadObject(game_objects, obj_parent, !set_selected);
+		if (std::get<0>(*item) == 1) {
+			root = obj;
 		}
+		objects_created[obj->ID] = obj;
+	}
+	delete prefab;
 
-		delete prefab;
+	if (root == nullptr)
+		return false;
+
+	// compiled before the IDs are reset and the position changes, the next instances start from the same objects
+	if (App->resources->use_compiled_prefabs) {
+		InvalidateCompiled();
+		App->objects->SnapshotGameObject(root, -1, &compiled);
+		compiled.taken = true;
 	}
-	else {
-		LOG_ENGINE("Error loading prefab %s", path.data());
+
+	return true;
+}
+
+bool ResourcePrefab::InstantiateCompiled(GameObject* parent, bool set_selected)
+{
+	std::vector<GameObject*> objects_created(compiled.objects.size(), nullptr);
+
+	for (uint i = 0; i < compiled.objects.size(); ++i) {
+		const SnapshotObject& record = compiled.objects[i];
+		GameObject* obj_parent = (record.parent_index == -1) ? parent : objects_created[record.parent_index];
+		SceneReader reader(compiled.data.GetData() + record.begin, record.end - record.begin);
+		GameObject* obj = new GameObject();
+		obj->LoadObject(&reader, obj_parent, !set_selected);
+		objects_created[i] = obj;
 	}
+
+	return !objects_created.empty();
 }
@@ -4,6 +4,7 @@
 #include <vector>
 #include "MathGeoLib/include/Math/float3.h"
 #include <list>
+#include "SceneBinary.h"
 
 class Prefab;
 class ResourceMesh;
@@ -30,8 +31,19 @@ public:
 
 	// create GameObjects
 	void ConvertToGameObjects(GameObject* parent, int list_num = -1, float3 pos = { 0,0,0 }, bool set_selected = true);
+	// the next instance reads the library file again and compiles it
+	void InvalidateCompiled();
+
+private:
+
+	// parse the library file, the first instance is compiled from the objects created
+	bool LoadFromLibrary(GameObject* parent, bool set_selected);
+	// the objects of the compiled records, without reading nor parsing files
+	bool InstantiateCompiled(GameObject* parent, bool set_selected);
 
 private:
 
 	std::list<Prefab*> prefab_references;
+	// the objects of the prefab in the records of the binary scenes, before the IDs are reset
+	SceneSnapshot compiled;
 };
\ No newline at end of file
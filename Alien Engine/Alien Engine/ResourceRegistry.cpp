@@ -0,0 +1,160 @@
+#include "ResourceRegistry.h"
+#include "Application.h"
+#include "ModuleFileSystem.h"
+#include <cctype>
+
+ResourceRegistry::ResourceRegistry()
+{
+}
+
+ResourceRegistry::~ResourceRegistry()
+{
+}
+
+bool ResourceRegistry::Add(Resource* resource)
+{
+	if (resource == nullptr)
+		return false;
+
+	bool ret = false;
+	std::unordered_map<Resource*, Entry>::iterator found = entries.find(resource);
+	if (found == entries.end()) {
+		found = entries.insert({ resource, Entry() }).first;
+		(*found).second.order = next_order++;
+		ret = true;
+	}
+	else {
+		// indexed again, its position doesn't change
+		EraseFrom(by_id, (*found).second.ID, resource);
+		EraseFrom(by_path, (*found).second.path, resource);
+		EraseFrom(by_name, (*found).second.name, resource);
+	}
+
+	Entry& entry = (*found).second;
+	entry.ID = resource->GetID();
+	entry.path = NormalizePath(resource->GetAssetsPath());
+	entry.name = GetNameKey(resource);
+
+	// resources without ID, path or name can't be searched by them
+	if (entry.ID != 0)
+		by_id.insert({ entry.ID, resource });
+	if (!entry.path.empty())
+		by_path.insert({ entry.path, resource });
+	if (!entry.name.empty())
+		by_name.insert({ entry.name, resource });
+
+	return ret;
+}
+
+void ResourceRegistry::Refresh(Resource* resource)
+{
+	if (entries.find(resource) != entries.end()) {
+		Add(resource);
+	}
+}
+
+void ResourceRegistry::Remove(Resource* resource)
+{
+	std::unordered_map<Resource*, Entry>::iterator found = entries.find(resource);
+	if (found == entries.end())
+		return;
+
+	EraseFrom(by_id, (*found).second.ID, resource);
+	EraseFrom(by_path, (*found).second.path, resource);
+	EraseFrom(by_name, (*found).second.name, resource);
+	entries.erase(found);
+}
+
+void ResourceRegistry::Clear()
+{
+	entries.clear();
+	by_id.clear();
+	by_path.clear();
+	by_name.clear();
+	next_order = 0;
+}
+
+Resource* ResourceRegistry::GetByID(const u64& ID) const
+{
+	return Find(by_id, ID);
+}
+
+Resource* ResourceRegistry::GetByPath(const char* path) const
+{
+	return Find(by_path, NormalizePath(path));
+}
+
+Resource* ResourceRegistry::GetByName(ResourceType type, const char* name) const
+{
+	if (type == ResourceType::RESOURCE_TEXTURE) {
+		return Find(by_name, NameKey(type, App->file_system->GetBaseFileName(name).data()));
+	}
+	return Find(by_name, NameKey(type, name));
+}
+
+uint ResourceRegistry::GetCount() const
+{
+	return entries.size();
+}
+
+std::string ResourceRegistry::NormalizePath(const char* path)
+{
+	std::string normalized(path);
+	for (uint i = 0; i < normalized.size(); ++i) {
+		normalized[i] = (normalized[i] == '\\') ? '/' : (char)std::tolower((unsigned char)normalized[i]);
+	}
+	return normalized;
+}
+
+std::string ResourceRegistry::NameKey(ResourceType type, const char* name)
+{
+	if (name == nullptr || name[0] == '\0')
+		return std::string();
+
+	std::string key = std::to_string((int)type) + ":" + name;
+	for (uint i = 0; i < key.size(); ++i) {
+		key[i] = (char)std::tolower((unsigned char)key[i]);
+	}
+	return key;
+}
+
+std::string ResourceRegistry::GetNameKey(const Resource* resource)
+{
+	switch (resource->GetType()) {
+	case ResourceType::RESOURCE_MESH:
+		return std::string();
+	case ResourceType::RESOURCE_TEXTURE:
+		return NameKey(resource->GetType(), App->file_system->GetBaseFileName(resource->GetAssetsPath()).data());
+	default:
+		return NameKey(resource->GetType(), resource->GetName());
+	}
+}
+
+template <typename KEY>
+void ResourceRegistry::EraseFrom(std::unordered_multimap<KEY, Resource*>& map, const KEY& key, Resource* resource)
+{
+	auto range = map.equal_range(key);
+	for (auto item = range.first; item != range.second; ++item) {
+		if ((*item).second == resource) {
+			map.erase(item);
+			return;
+		}
+	}
+}
+
+template <typename KEY>
+Resource* ResourceRegistry::Find(const std::unordered_multimap<KEY, Resource*>& map, const KEY& key) const
+{
+	Resource* ret = nullptr;
+	u64 order = 0;
+
+	auto range = map.equal_range(key);
+	for (auto item = range.first; item != range.second; ++item) {
+		u64 item_order = entries.at((*item).second).order;
+		if (ret == nullptr || item_order < order) {
+			ret = (*item).second;
+			order = item_order;
+		}
+	}
+	return ret;
+}
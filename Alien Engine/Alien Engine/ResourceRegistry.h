@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Resource_.h"
+#include <unordered_map>
+#include <string>
+
+// Hash indices over the resources of ModuleResources. They are found by ID, by assets path and by type and name
+// without iterating the resources vector. When several resources share a key the first one registered wins, like
+// the old linear searches did.
+class ResourceRegistry {
+
+	// keys a resource was indexed with, needed to remove it even if its fields changed
+	struct Entry {
+		u64 order = 0;
+		u64 ID = 0;
+		std::string path;
+		std::string name;
+	};
+
+public:
+
+	ResourceRegistry();
+	~ResourceRegistry();
+
+	// index the resource, or index it again with its current ID, path and name if it was already in.
+	// Returns true if it was not in the registry
+	bool Add(Resource* resource);
+	// index it again if it is in the registry, after its ID, path or name change
+	void Refresh(Resource* resource);
+	void Remove(Resource* resource);
+	void Clear();
+
+	Resource* GetByID(const u64& ID) const;
+	// the path is compared without case and with '\' as '/'
+	Resource* GetByPath(const char* path) const;
+	// textures are named by the base name of their assets path, the other types by their name. Meshes are not
+	// indexed by name, every model repeats them
+	Resource* GetByName(ResourceType type, const char* name) const;
+
+	uint GetCount() const;
+
+private:
+
+	static std::string NormalizePath(const char* path);
+	static std::string NameKey(ResourceType type, const char* name);
+	static std::string GetNameKey(const Resource* resource);
+
+	template <typename KEY>
+	static void EraseFrom(std::unordered_multimap<KEY, Resource*>& map, const KEY& key, Resource* resource);
+	// the match registered first
+	template <typename KEY>
+	Resource* Find(const std::unordered_multimap<KEY, Resource*>& map, const KEY& key) const;
+
+private:
+
+	std::unordered_map<Resource*, Entry> entries;
+	std::unordered_multimap<u64, Resource*> by_id;
+	std::unordered_multimap<std::string, Resource*> by_path;
+	std::unordered_multimap<std::string, Resource*> by_name;
+
+	u64 next_order = 0;
+};
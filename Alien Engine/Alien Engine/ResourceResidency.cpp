@@ -0,0 +1,141 @@
+#include "ResourceResidency.h"
+#include "Resource_.h"
+
+#define MB_TO_BYTES(mb) ((u64)(mb) * 1024ULL * 1024ULL)
+
+ResourceResidency::ResourceResidency()
+{
+}
+
+ResourceResidency::~ResourceResidency()
+{
+}
+
+void ResourceResidency::AddMemory(int cpu_bytes, int gpu_bytes)
+{
+	cpu_used += cpu_bytes;
+	gpu_used += gpu_bytes;
+}
+
+bool ResourceResidency::Reuse(Resource* resource)
+{
+	std::unordered_map<Resource*, std::list<Resource*>::iterator>::iterator found = cached.find(resource);
+	if (found == cached.end()) {
+		++misses;
+		return false;
+	}
+
+	lru.erase((*found).second);
+	cached.erase(found);
+	resource->in_cache = false;
+	++hits;
+	return true;
+}
+
+void ResourceResidency::Release(Resource* resource)
+{
+	// the ones in flight or without a file to load them again are freed like before
+	if (!cache_unreferenced || resource->loading || !resource->IsReloadable() || resource->GetCPUMemory() + resource->GetGPUMemory() == 0) {
+		resource->FreeMemory();
+		return;
+	}
+
+	std::unordered_map<Resource*, std::list<Resource*>::iterator>::iterator found = cached.find(resource);
+	if (found != cached.end()) {
+		lru.erase((*found).second);
+	}
+	lru.push_front(resource);
+	cached[resource] = lru.begin();
+	resource->in_cache = true;
+
+	Trim();
+}
+
+void ResourceResidency::Forget(Resource* resource)
+{
+	std::unordered_map<Resource*, std::list<Resource*>::iterator>::iterator found = cached.find(resource);
+	if (found != cached.end()) {
+		lru.erase((*found).second);
+		cached.erase(found);
+	}
+	resource->in_cache = false;
+}
+
+void ResourceResidency::Trim()
+{
+	while (!lru.empty() && (cpu_used > MB_TO_BYTES(cpu_budget_mb) || gpu_used > MB_TO_BYTES(gpu_budget_mb))) {
+		Resource* resource = lru.back();
+		lru.pop_back();
+		cached.erase(resource);
+		Evict(resource);
+	}
+}
+
+void ResourceResidency::FreeCache()
+{
+	while (!lru.empty()) {
+		Resource* resource = lru.back();
+		lru.pop_back();
+		cached.erase(resource);
+		Evict(resource);
+	}
+}
+
+void ResourceResidency::Clear()
+{
+	std::list<Resource*>::iterator item = lru.begin();
+	for (; item != lru.end(); ++item) {
+		(*item)->in_cache = false;
+	}
+	lru.clear();
+	cached.clear();
+}
+
+u64 ResourceResidency::GetCPUUsed() const
+{
+	return cpu_used;
+}
+
+u64 ResourceResidency::GetGPUUsed() const
+{
+	return gpu_used;
+}
+
+uint ResourceResidency::GetCachedCount() const
+{
+	return lru.size();
+}
+
+uint ResourceResidency::GetHits() const
+{
+	return hits;
+}
+
+uint ResourceResidency::GetMisses() const
+{
+	return misses;
+}
+
+uint ResourceResidency::GetEvictions() const
+{
+	return evictions;
+}
+
+void ResourceResidency::ResetCounters()
+{
+	hits = 0;
+	misses = 0;
+	evictions = 0;
+}
+
+void ResourceResidency::Evict(Resource* resource)
+{
+	resource->in_cache = false;
+
+	// something took a reference without IncreaseReferences, it can't be freed
+	if (resource->references > 0)
+		return;
+
+	resource->FreeMemory();
+	++evictions;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+class Resource;
+
+typedef unsigned int uint;
+typedef unsigned long long u64;
+
+// Memory of the loaded resources. The resources nobody references are kept in a LRU cache instead of being freed,
+// so using them again doesn't read the files, and the oldest ones are freed when the budgets are exceeded.
+class ResourceResidency {
+
+public:
+
+	ResourceResidency();
+	~ResourceResidency();
+
+	// the resources report how their memory changes
+	void AddMemory(int cpu_bytes, int gpu_bytes);
+
+	// the resource is referenced again, true if it was in the cache and doesn't need to be loaded
+	bool Reuse(Resource* resource);
+	// nobody references the resource, it is cached or freed
+	void Release(Resource* resource);
+	// the resource is being deleted
+	void Forget(Resource* resource);
+
+	// free the oldest cached resources until the memory fits the budgets
+	void Trim();
+	// free all the cached resources
+	void FreeCache();
+	void Clear();
+
+	u64 GetCPUUsed() const;
+	u64 GetGPUUsed() const;
+	uint GetCachedCount() const;
+	uint GetHits() const;
+	uint GetMisses() const;
+	uint GetEvictions() const;
+	void ResetCounters();
+
+public:
+
+	bool cache_unreferenced = true;
+	// the meshes free their arrays after the upload. In the editor the positions and the indices are kept for mouse picking
+	bool drop_cpu_copies = false;
+	int cpu_budget_mb = 256;
+	int gpu_budget_mb = 512;
+
+private:
+
+	void Evict(Resource* resource);
+
+private:
+
+	// the front is the last released
+	std::list<Resource*> lru;
+	std::unordered_map<Resource*, std::list<Resource*>::iterator> cached;
+
+	u64 cpu_used = 0;
+	u64 gpu_used = 0;
+
+	uint hits = 0;
+	uint misses = 0;
+	uint evictions = 0;
+};
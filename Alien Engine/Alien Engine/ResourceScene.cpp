@@ -1,5 +1,6 @@
 #include "ResourceScene.h"
 #include "Application.h"
+#include "SceneBinary.h"
 
 ResourceScene::ResourceScene() : Resource()
 {
@@ -63,11 +64,13 @@ bool ResourceScene::ReadBaseInfo(const char* assets_file_path)
 		}
 		else {
 			// TODO: look what to do when game mode
+			// the editor saves the binary of the library after the JSON of the assets, an older library is from
+			// an asset changed outside the engine and it is loaded from its JSON until it is saved again
 			struct stat meta_file;
 			struct stat assets_file;
 			stat(path.data(), &assets_file);
 			stat(meta_data_path.data(), &meta_file);
-			if (assets_file.st_mtime != meta_file.st_mtime) {
+			if (assets_file.st_mtime > meta_file.st_mtime) {
 				remove(meta_data_path.data());
 				App->file_system->Copy(path.data(), meta_data_path.data());
 			}
@@ -84,15 +87,22 @@ void ResourceScene::ReadLibrary(const char* meta_data)
 
 	ID = std::stoull(App->file_system->GetBaseFileName(meta_data_path.data()));
 
-	JSON_Value* value = json_parse_file(meta_data_path.data());
-	JSON_Object* object = json_value_get_object(value);
-
-	if (value != nullptr && object != nullptr)
-	{
-		JSONfilepack* meta = new JSONfilepack(meta_data_path, object, value);
-		name = meta->GetString("Scene.Name");
-		delete meta;
+	char* data = nullptr;
+	uint size = App->file_system->Load(meta_data_path.data(), &data);
+	SceneReader scene(data, size);
+	uint objects_count = 0;
+	if (!scene.ReadHeader(&name, &objects_count)) {
+		JSON_Value* value = App->file_system->LoadJSON(meta_data_path.data());
+		JSON_Object* object = json_value_get_object(value);
+
+		if (value != nullptr && object != nullptr)
+		{
+			JSONfilepack* meta = new JSONfilepack(meta_data_path, object, value);
+			name = meta->GetString("Scene.Name");
+			delete meta;
+		}
 	}
+	delete[] data;
 
 	App->resources->AddResource(this);
 }
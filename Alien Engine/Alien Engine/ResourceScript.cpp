@@ -158,7 +158,7 @@ void ResourceScript::ReadLibrary(const char* meta_data)
 {
 	meta_data_path = std::string(meta_data);
 
-	JSON_Value* value = json_parse_file(meta_data_path.data());
+	JSON_Value* value = App->file_system->LoadJSON(meta_data_path.data());
 	JSON_Object* object = json_value_get_object(value);
 
 	if (value != nullptr && object != nullptr)
@@ -0,0 +1,245 @@
+#include "ResourceStreamer.h"
+#include "Resource_.h"
+#include "Globals.h"
+#include "j1PerfTimer.h"
+#include <algorithm>
+
+ResourceStreamer::ResourceStreamer()
+{
+}
+
+ResourceStreamer::~ResourceStreamer()
+{
+	Stop();
+}
+
+void ResourceStreamer::Start()
+{
+	if (!workers.empty())
+		return;
+
+	stop = false;
+
+	uint threads_count = std::thread::hardware_concurrency();
+	threads_count = (threads_count > 1) ? threads_count - 1 : RESOURCE_STREAMER_MIN_WORKERS;
+	threads_count = std::min(std::max(threads_count, (uint)RESOURCE_STREAMER_MIN_WORKERS), (uint)RESOURCE_STREAMER_MAX_WORKERS);
+
+	for (uint i = 0; i < threads_count; ++i) {
+		workers.push_back(std::thread(&ResourceStreamer::WorkerLoop, this));
+	}
+}
+
+void ResourceStreamer::Stop()
+{
+	if (workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	work_condition.notify_all();
+
+	std::vector<std::thread>::iterator item = workers.begin();
+	for (; item != workers.end(); ++item) {
+		(*item).join();
+	}
+	workers.clear();
+
+	// the resources keep what they read, it is freed with their memory
+	std::list<Resource*>::iterator pending_item = pending.begin();
+	for (; pending_item != pending.end(); ++pending_item) {
+		(*pending_item)->loading = false;
+	}
+	std::list<std::pair<Resource*, bool>>::iterator read_item = read.begin();
+	for (; read_item != read.end(); ++read_item) {
+		(*read_item).first->loading = false;
+	}
+	pending.clear();
+	read.clear();
+}
+
+void ResourceStreamer::Load(Resource* resource)
+{
+	if (resource == nullptr || resource->loading)
+		return;
+
+	resource->loading = true;
+
+	if (workers.empty()) {
+		// nothing to read it, load it now
+		Upload(resource, resource->ReadMemory());
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.push_back(resource);
+	}
+	work_condition.notify_one();
+}
+
+void ResourceStreamer::Update(double budget_ms)
+{
+	j1PerfTimer timer;
+	uint count = 0;
+
+	while (true) {
+		std::pair<Resource*, bool> item;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (read.empty())
+				break;
+			item = read.front();
+			read.pop_front();
+		}
+
+		double start_ms = timer.ReadMs();
+		Upload(item.first, item.second);
+		max_resource_upload_ms = std::max(max_resource_upload_ms, timer.ReadMs() - start_ms);
+		++count;
+
+		if (timer.ReadMs() >= budget_ms)
+			break;
+	}
+
+	last_upload_count = count;
+	last_upload_ms = (count > 0) ? timer.ReadMs() : 0.0;
+	max_upload_ms = std::max(max_upload_ms, last_upload_ms);
+}
+
+void ResourceStreamer::Finish(Resource* resource)
+{
+	if (resource == nullptr || !resource->loading)
+		return;
+
+	bool read_ok = false;
+	if (!Take(resource, &read_ok)) {
+		read_ok = resource->ReadMemory();
+	}
+	Upload(resource, read_ok);
+
+	// the rest that Upload queued again
+	while (resource->loading) {
+		Take(resource, &read_ok);
+		Upload(resource, read_ok);
+	}
+}
+
+void ResourceStreamer::Cancel(Resource* resource)
+{
+	if (resource == nullptr || !resource->loading)
+		return;
+
+	bool read_ok = false;
+	Take(resource, &read_ok);
+	resource->loading = false;
+}
+
+bool ResourceStreamer::IsRunning() const
+{
+	return !workers.empty();
+}
+
+uint ResourceStreamer::GetWorkersCount() const
+{
+	return workers.size();
+}
+
+uint ResourceStreamer::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending.size() + reading.size() + read.size();
+}
+
+uint ResourceStreamer::GetLastUploadCount() const
+{
+	return last_upload_count;
+}
+
+double ResourceStreamer::GetLastUploadMs() const
+{
+	return last_upload_ms;
+}
+
+double ResourceStreamer::GetMaxUploadMs() const
+{
+	return max_upload_ms;
+}
+
+double ResourceStreamer::GetMaxResourceUploadMs() const
+{
+	return max_resource_upload_ms;
+}
+
+uint ResourceStreamer::GetTotalUploaded() const
+{
+	return total_uploaded;
+}
+
+void ResourceStreamer::WorkerLoop()
+{
+	while (true) {
+		Resource* resource = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_condition.wait(lock, [this] { return stop || !pending.empty(); });
+			if (stop)
+				return;
+			resource = pending.front();
+			pending.pop_front();
+			reading.push_back(resource);
+		}
+
+		bool read_ok = resource->ReadMemory();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			reading.erase(std::find(reading.begin(), reading.end(), resource));
+			read.push_back({ resource, read_ok });
+		}
+		read_condition.notify_all();
+	}
+}
+
+bool ResourceStreamer::Take(Resource* resource, bool* read_ok)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	std::list<Resource*>::iterator pending_item = std::find(pending.begin(), pending.end(), resource);
+	if (pending_item != pending.end()) {
+		pending.erase(pending_item);
+		return false;
+	}
+
+	read_condition.wait(lock, [this, resource] { return std::find(reading.begin(), reading.end(), resource) == reading.end(); });
+
+	std::list<std::pair<Resource*, bool>>::iterator read_item = read.begin();
+	for (; read_item != read.end(); ++read_item) {
+		if ((*read_item).first == resource) {
+			*read_ok = (*read_item).second;
+			read.erase(read_item);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ResourceStreamer::Upload(Resource* resource, bool read_ok)
+{
+	resource->loading = false;
+
+	if (read_ok && resource->UploadMemory()) {
+		if (resource->HasPendingUpload()) {
+			// the next piece waits behind the other resources
+			resource->loading = true;
+			std::lock_guard<std::mutex> lock(mutex);
+			read.push_back({ resource, true });
+			return;
+		}
+		++total_uploaded;
+	}
+	else {
+		LOG_ENGINE("Error while streaming %s", resource->GetLibraryPath());
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <list>
+
+class Resource;
+
+typedef unsigned int uint;
+
+// the workers are the hardware threads minus the main one, between these
+#define RESOURCE_STREAMER_MIN_WORKERS 1
+#define RESOURCE_STREAMER_MAX_WORKERS 4
+
+// Loads the resources in two steps so the frames don't stop. The workers read and decode the files (Resource::ReadMemory)
+// and the main thread creates the GPU data (Resource::UploadMemory) spending at most a budget of time every frame.
+class ResourceStreamer {
+
+public:
+
+	ResourceStreamer();
+	~ResourceStreamer();
+
+	void Start();
+	// join the workers, the resources not uploaded yet are dropped
+	void Stop();
+
+	// queue the resource, it is marked as loading until Update uploads it
+	void Load(Resource* resource);
+	// upload the resources already read until the budget is spent. At least one is uploaded each frame
+	void Update(double budget_ms);
+	// wait for the resource and upload all of it now, when its data is needed in this frame
+	void Finish(Resource* resource);
+	// take the resource out without uploading it, its read data is freed by the resource FreeMemory
+	void Cancel(Resource* resource);
+
+	bool IsRunning() const;
+	uint GetWorkersCount() const;
+	// queued or being read
+	uint GetPendingCount() const;
+	uint GetLastUploadCount() const;
+	double GetLastUploadMs() const;
+	double GetMaxUploadMs() const;
+	// the slowest single upload, the budget is checked after each one so a frame can pass it by this much
+	double GetMaxResourceUploadMs() const;
+	uint GetTotalUploaded() const;
+
+private:
+
+	void WorkerLoop();
+	// remove the resource from the queues, waiting if a worker is reading it. Returns false if it was not read
+	bool Take(Resource* resource, bool* read_ok);
+	void Upload(Resource* resource, bool read_ok);
+
+private:
+
+	std::vector<std::thread> workers;
+
+	mutable std::mutex mutex;
+	std::condition_variable work_condition;
+	std::condition_variable read_condition;
+	bool stop = false;
+
+	// waiting for a worker
+	std::list<Resource*> pending;
+	// being read by a worker
+	std::vector<Resource*> reading;
+	// read and the ReadMemory result, waiting for the upload or for the rest of it
+	std::list<std::pair<Resource*, bool>> read;
+
+	uint last_upload_count = 0;
+	double last_upload_ms = 0.0;
+	double max_upload_ms = 0.0;
+	double max_resource_upload_ms = 0.0;
+	uint total_uploaded = 0;
+};
@@ -1,6 +1,7 @@
 #include "ResourceTexture.h"
 #include "ModuleResources.h"
 #include "Application.h"
+#include <algorithm>
 
 ResourceTexture::ResourceTexture(const char* path, const uint& id, const uint& width, const uint& height) : Resource()
 {
@@ -21,93 +22,258 @@ ResourceTexture::ResourceTexture(const char* path)
 
 ResourceTexture::~ResourceTexture()
 {
+	CancelLoading();
+	RELEASE_ARRAY(pixels);
+	ReleaseFileData();
 	glDeleteTextures(1, &id);
 }
 
 bool ResourceTexture::CreateMetaData(const u64& force_id)
 {
-	bool ret = false;
-	if (ilLoadImage(path.data())) {
-		if (force_id == 0)
-			ID = App->resources->GetRandomID();
-		else
-			ID = force_id;
-
-		iluFlipImage();
-		std::string alien_path = std::string(App->file_system->GetPathWithoutExtension(path) + "_meta.alien").data();
-
-		JSON_Value* alien_value = json_value_init_object();
-		JSON_Object* alien_object = json_value_get_object(alien_value);
-		json_serialize_to_file_pretty(alien_value, alien_path.data());
-
-		if (alien_value != nullptr && alien_object != nullptr) {
-			JSONfilepack* alien = new JSONfilepack(alien_path, alien_object, alien_value);
-			alien->StartSave();
-			alien->SetString("Meta.ID", std::to_string(ID));
-			alien->FinishSave();
-			delete alien;
-		}
+	if (force_id != 0)
+		ID = force_id;
+
+	// cooked like the textures found when the engine starts, it is deleted if it can't be
+	std::vector<ResourceTexture*> textures(1, this);
+	return App->importer->CookTextures(textures) == 1;
+}
+
+bool ResourceTexture::PrepareMetaData(const u64& force_id)
+{
+	if (!App->file_system->Exists(path.data()))
+		return false;
+
+	if (force_id == 0)
+		ID = App->resources->GetRandomID();
+	else
+		ID = force_id;
+
+	std::string alien_path = std::string(App->file_system->GetPathWithoutExtension(path) + "_meta.alien").data();
+
+	JSON_Value* alien_value = json_value_init_object();
+	JSON_Object* alien_object = json_value_get_object(alien_value);
+	json_serialize_to_file_pretty(alien_value, alien_path.data());
+
+	if (alien_value != nullptr && alien_object != nullptr) {
+		JSONfilepack* alien = new JSONfilepack(alien_path, alien_object, alien_value);
+		alien->StartSave();
+		alien->SetString("Meta.ID", std::to_string(ID));
+		alien->FinishSave();
+		delete alien;
+	}
+
+	meta_data_path = std::string(LIBRARY_TEXTURES_FOLDER + std::to_string(ID) + ".dds");
+
+	return true;
+}
+
+char* ResourceTexture::CookMetaData(uint* size, TextureFormat* format)
+{
+	uint source_width = 0;
+	uint source_height = 0;
+	unsigned char* source = App->importer->ReadTexturePixels(path.data(), &source_width, &source_height);
+	if (source == nullptr)
+		return nullptr;
+
+	char* data = TextureCooker::Cook(source, source_width, source_height, size, format);
+	delete[] source;
+
+	return data;
+}
+
+bool ResourceTexture::LoadMemory()
+{
+	if (!ReadMemory()) {
+		LOG_ENGINE("Error while loading image in %s", meta_data_path.data());
+		return false;
+	}
+
+	// all the levels now, the texture is needed in this frame
+	bool ret = UploadMemory();
+	while (ret && HasPendingUpload()) {
+		ret = UploadMemory();
+	}
+
+	if (ret)
+		LOG_ENGINE("Texture successfully loaded: %s", meta_data_path.data());
+
+	return ret;
+}
+
+bool ResourceTexture::CanLoadAsync() const
+{
+	return id == 0;
+}
+
+bool ResourceTexture::IsReloadable() const
+{
+	return !meta_data_path.empty();
+}
+
+bool ResourceTexture::ReadMemory()
+{
+	// Load logs if the file is missing, the workers can't
+	if (!App->file_system->Exists(meta_data_path.data())) {
+		return false;
+	}
+
+	// read again, the file and the pixels of the last read can't be left behind
+	RELEASE_ARRAY(pixels);
+	ReleaseFileData();
+
+	char* data = nullptr;
+	uint size = 0;
+	if (App->file_system->Map(meta_data_path.data(), &file_mapping)) {
+		data = file_mapping.data;
+		size = file_mapping.size;
+	}
+	else {
+		file_buffer_size = App->file_system->Load(meta_data_path.data(), &file_buffer);
+		data = file_buffer;
+		size = file_buffer_size;
+	}
 
-		meta_data_path = std::string(LIBRARY_TEXTURES_FOLDER + std::to_string(ID) + ".dds");
-		std::string ext;
-		App->file_system->SplitFilePath(path.data(), nullptr, nullptr, &ext);
-		if (App->StringCmp(ext.data(), "dds")) {
-			App->file_system->Copy(path.data(), meta_data_path.data());
-			id = ilutGLBindTexImage();
-			is_custom = true;
-			width = ilGetInteger(IL_IMAGE_WIDTH);
-			height = ilGetInteger(IL_IMAGE_HEIGHT);
+	if (TextureCooker::ReadHeader(data, size, &format, &pixels_width, &pixels_height, &mips_count)) {
+		upload_level = (int)mips_count - 1;
+		upload_row = 0;
+		uploaded_bytes = 0;
+		return true;
+	}
+
+	// saved before the cooker, DevIL decodes it
+	ReleaseFileData();
+	pixels = App->importer->ReadTexturePixels(meta_data_path.data(), &pixels_width, &pixels_height);
+	return pixels != nullptr;
+}
+
+bool ResourceTexture::UploadMemory()
+{
+	if (pixels != nullptr) {
+		App->importer->UploadTexturePixels(this, pixels, pixels_width, pixels_height);
+		RELEASE_ARRAY(pixels);
+		// the mips are a third more
+		SetResidentMemory(0, width * height * 4 + width * height * 4 / 3);
+		return true;
+	}
+
+	char* data = (file_mapping.data != nullptr) ? file_mapping.data : file_buffer;
+	if (data == nullptr || upload_level < 0)
+		return false;
+
+	GLenum gl_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	if (format == TextureFormat::BC3)
+		gl_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	else if (format == TextureFormat::BC5)
+		gl_format = GL_COMPRESSED_RG_RGTC2;
+
+	// the first call after ReadMemory. A texture uploaded before is deleted, its size and levels are the ones of the
+	// file it was read from
+	if (uploaded_bytes == 0 && id != 0) {
+		glDeleteTextures(1, &id);
+		id = 0;
+	}
+
+	if (id == 0) {
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mips_count - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mips_count - 1);
+		width = pixels_width;
+		height = pixels_height;
+		is_custom = true;
+	}
+	else {
+		glBindTexture(GL_TEXTURE_2D, id);
+	}
+
+	// the smallest levels go first so the texture can be drawn blurry while the big ones arrive
+	uint budget = (uint)std::max(App->resources->texture_upload_chunk_kb, 1) * 1024;
+	uint uploaded = 0;
+	uint block_size = TextureCooker::GetBlockSize(format);
+	while (upload_level >= 0 && uploaded < budget) {
+		uint level_width = std::max(pixels_width >> upload_level, 1U);
+		uint level_height = std::max(pixels_height >> upload_level, 1U);
+		uint level_size = TextureCooker::GetLevelSize(format, level_width, level_height);
+		const char* level_data = data + TextureCooker::GetLevelOffset(format, pixels_width, pixels_height, upload_level);
+		uint row_size = ((level_width + 3) / 4) * block_size;
+		uint rows_count = (level_height + 3) / 4;
+
+		if (upload_row == 0 && level_size <= budget - uploaded) {
+			glCompressedTexImage2D(GL_TEXTURE_2D, upload_level, gl_format, level_width, level_height, 0, level_size, level_data);
+			uploaded += level_size;
+			upload_row = rows_count;
 		}
 		else {
-			iluFlipImage();
-			ILuint image_size;
-			ILubyte* image_data;
-			ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);
-			image_size = ilSaveL(IL_DDS, NULL, 0); 
-			if (image_size > 0) {
-				image_data = new ILubyte[image_size]; 
-				if (ilSaveL(IL_DDS, image_data, image_size) > 0) {
-					std::string output;
-					App->file_system->SaveUnique(output, image_data, image_size, LIBRARY_TEXTURES_FOLDER, std::to_string(ID).data(), ".dds");
-				}
-				iluFlipImage();
-				id = ilutGLBindTexImage();
-				is_custom = true;
-				width = ilGetInteger(IL_IMAGE_WIDTH);
-				height = ilGetInteger(IL_IMAGE_HEIGHT);
-				
-				RELEASE_ARRAY(image_data);
-			}
+			// the level doesn't fit, it is sent in strips of blocks over the next calls
+			if (upload_row == 0)
+				glCompressedTexImage2D(GL_TEXTURE_2D, upload_level, gl_format, level_width, level_height, 0, level_size, nullptr);
+
+			uint rows = std::min(std::max((budget - uploaded) / row_size, 1U), rows_count - upload_row);
+			uint y = upload_row * 4;
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, upload_level, 0, y, level_width, std::min(rows * 4, level_height - y), gl_format, rows * row_size, level_data + upload_row * row_size);
+			uploaded += rows * row_size;
+			upload_row += rows;
+		}
+
+		if (upload_row == rows_count) {
+			// the level is complete, it is the biggest one sampled now
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, upload_level);
+			--upload_level;
+			upload_row = 0;
 		}
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	uploaded_bytes += uploaded;
+	App->resources->textures_uploaded_bytes += uploaded;
 
-		ret = true;
-		glBindTexture(GL_TEXTURE_2D, 0);
-		App->resources->AddResource(this);
-		FreeMemory();
+	if (upload_level < 0) {
+		ReleaseFileData();
+		SetResidentMemory(0, uploaded_bytes);
 	}
 	else {
-		delete this;
-		ret = false;
+		SetResidentMemory((file_mapping.data != nullptr) ? file_mapping.size : file_buffer_size, uploaded_bytes);
 	}
 
-	return ret;
+	return true;
 }
 
-bool ResourceTexture::LoadMemory()
+bool ResourceTexture::HasPendingUpload() const
 {
-	bool ret = true;
-
-	App->importer->LoadTextureToResource(meta_data_path.data(), this);
-
-	return ret;
+	return upload_level >= 0 && (file_mapping.data != nullptr || file_buffer != nullptr);
 }
 
 void ResourceTexture::FreeMemory()
 {
+	// the pixels read by a worker are deleted below
+	CancelLoading();
+	RELEASE_ARRAY(pixels);
+	ReleaseFileData();
+	upload_level = -1;
+	upload_row = 0;
+	uploaded_bytes = 0;
+
 	glDeleteTextures(1, &id);
 	width = 0;
 	height = 0;
 	id = 0;
+	SetResidentMemory(0, 0);
+}
+
+void ResourceTexture::ReleaseFileData()
+{
+	if (file_mapping.data != nullptr) {
+		App->file_system->Unmap(&file_mapping);
+	}
+	if (file_buffer != nullptr) {
+		delete[] file_buffer;
+		file_buffer = nullptr;
+	}
+	file_buffer_size = 0;
 }
 
 bool ResourceTexture::ReadBaseInfo(const char* assets_path)
@@ -149,11 +315,11 @@ void ResourceTexture::ReadLibrary(const char* meta_data)
 
 bool ResourceTexture::DeleteMetaData()
 {
+	// a mapped file can't be removed
+	FreeMemory();
 	remove(meta_data_path.data());
 
-	std::vector<Resource*>::iterator position = std::find(App->resources->resources.begin(), App->resources->resources.end(), static_cast<Resource*>(this));
-	if (position != App->resources->resources.end())
-		App->resources->resources.erase(position);
+	App->resources->RemoveResource(this);
 
 	delete this;
 
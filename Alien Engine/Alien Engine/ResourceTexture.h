@@ -1,11 +1,15 @@
 #pragma once
 
 #include "Resource_.h"
+#include "ModuleFileSystem.h"
+#include "TextureCooker.h"
 #include <vector>
 
 
 class ResourceTexture : public Resource {
 
+	friend class ModuleImporter;
+
 public:
 
 	ResourceTexture() { type = ResourceType::RESOURCE_TEXTURE; }
@@ -16,10 +20,25 @@ public:
 	bool CreateMetaData(const u64& force_id = 0);
 	bool LoadMemory();
 	void FreeMemory();
+	bool CanLoadAsync() const;
+	bool IsReloadable() const;
+	// map the cooked .dds in a worker thread, the old ones are decoded to RGBA pixels
+	bool ReadMemory();
+	// upload the levels from the smallest one, at most App->resources->texture_upload_chunk_kb each call
+	bool UploadMemory();
+	bool HasPendingUpload() const;
 	bool ReadBaseInfo(const char* assets_path);
 	void ReadLibrary(const char* meta_data);
 	bool DeleteMetaData();
 
+private:
+
+	// main thread, the ID and the meta of the asset before it is cooked
+	bool PrepareMetaData(const u64& force_id);
+	// decode the asset and cook it to the .dds file data, can be called from any thread
+	char* CookMetaData(uint* size, TextureFormat* format);
+	void ReleaseFileData();
+
 public:
 
 	bool is_custom = true;
@@ -28,4 +47,21 @@ public:
 	uint width = 0;
 	uint id = 0;
 
+private:
+
+	// decoded by ReadMemory and waiting for UploadMemory
+	unsigned char* pixels = nullptr;
+	uint pixels_width = 0;
+	uint pixels_height = 0;
+
+	// cooked file read by ReadMemory, mapped or in a buffer inside an archive
+	FileMapping file_mapping;
+	char* file_buffer = nullptr;
+	uint file_buffer_size = 0;
+	TextureFormat format = TextureFormat::BC1;
+	uint mips_count = 0;
+	// level being uploaded and its next row of blocks, -1 when all of them are in the GPU
+	int upload_level = -1;
+	uint upload_row = 0;
+	uint uploaded_bytes = 0;
 };
\ No newline at end of file
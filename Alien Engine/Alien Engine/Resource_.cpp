@@ -1,5 +1,6 @@
 #include "Resource_.h"
 #include "ModuleObjects.h"
+#include "ModuleResources.h"
 #include "Application.h"
 
 Resource::Resource()
@@ -8,6 +9,11 @@ Resource::Resource()
 
 Resource::~Resource()
 {
+	// the derived resources should have freed it, but the totals must not keep deleted memory
+	if (cpu_memory != 0 || gpu_memory != 0 || in_cache) {
+		SetResidentMemory(0, 0);
+		App->resources->residency.Forget(this);
+	}
 }
 
 const char* const Resource::GetAssetsPath() const
@@ -23,6 +29,7 @@ const char* const Resource::GetLibraryPath() const
 void Resource::SetAssetsPath(const char* path)
 {
 	this->path = std::string(path);
+	App->resources->registry.Refresh(this);
 }
 
 void Resource::SetLibraryPath(const char* path)
@@ -38,6 +45,7 @@ const char* const Resource::GetName() const
 void Resource::SetName(const char* name)
 {
 	this->name = std::string(name);
+	App->resources->registry.Refresh(this);
 }
 
 const ResourceType Resource::GetType() const
@@ -57,8 +65,16 @@ const bool Resource::NeedToLoad() const
 
 void Resource::IncreaseReferences()
 {
-	if (references == 0) {
-		LoadMemory();
+	if (references == 0 && !loading) {
+		if (App->resources->residency.Reuse(this)) {
+			// still in memory from the last time it was used
+		}
+		else if (App->resources->async_loading && CanLoadAsync()) {
+			App->resources->streamer.Load(this);
+		}
+		else {
+			LoadMemory();
+		}
 	}
 	if (App->objects->enable_instancies) {
 		++references;
@@ -71,6 +87,33 @@ void Resource::DecreaseReferences()
 		--references;
 	}
 	if (references == 0) {
-		FreeMemory();
+		App->resources->residency.Release(this);
+	}
+}
+
+void Resource::CancelLoading()
+{
+	if (loading) {
+		App->resources->streamer.Cancel(this);
 	}
 }
+
+uint Resource::GetCPUMemory() const
+{
+	return cpu_memory;
+}
+
+uint Resource::GetGPUMemory() const
+{
+	return gpu_memory;
+}
+
+void Resource::SetResidentMemory(uint cpu_bytes, uint gpu_bytes)
+{
+	if (cpu_bytes == cpu_memory && gpu_bytes == gpu_memory)
+		return;
+
+	App->resources->residency.AddMemory((int)cpu_bytes - (int)cpu_memory, (int)gpu_bytes - (int)gpu_memory);
+	cpu_memory = cpu_bytes;
+	gpu_memory = gpu_bytes;
+}
@@ -20,6 +20,8 @@ enum class ResourceType {
 
 class Resource {
 
+	friend class AssetDatabase;
+
 public:
 
 	Resource();
@@ -47,8 +49,23 @@ public:
 	virtual bool LoadMemory() { return true; }
 	virtual void FreeMemory() {}
 
+	// resources that can be loaded by the ResourceStreamer in two steps
+	virtual bool CanLoadAsync() const { return false; }
+	// called in a worker thread, it only reads and decodes the files. No GL, no logs and no other resources
+	virtual bool ReadMemory() { return true; }
+	// called in the main thread after ReadMemory to create the GPU data
+	virtual bool UploadMemory() { return LoadMemory(); }
+	// true after UploadMemory if part of the GPU data is left, the streamer calls UploadMemory again in the next frames
+	virtual bool HasPendingUpload() const { return false; }
+
 	const u64& GetID() const;
 
+	// false if the resource has no file to be loaded from again, then it is not kept in the cache
+	virtual bool IsReloadable() const { return false; }
+	// bytes the loaded resource uses
+	uint GetCPUMemory() const;
+	uint GetGPUMemory() const;
+
 	const bool NeedToLoad() const;
 	void IncreaseReferences();
 	void DecreaseReferences();
@@ -56,6 +73,17 @@ public:
 public:
 
 	uint references = 0u;
+	// true while the ResourceStreamer has it, only changed in the main thread
+	bool loading = false;
+	// loaded and not referenced, in the LRU of the ResourceResidency
+	bool in_cache = false;
+
+protected:
+
+	// take the resource out of the ResourceStreamer without uploading it, before the memory is freed
+	void CancelLoading();
+	// report the memory of the resource to the ResourceResidency, 0 when it is freed
+	void SetResidentMemory(uint cpu_bytes, uint gpu_bytes);
 
 protected:
 
@@ -67,4 +95,6 @@ protected:
 
 	u64 ID = 0;
 
+	uint cpu_memory = 0;
+	uint gpu_memory = 0;
 };
\ No newline at end of file
@@ -213,7 +213,8 @@ bool ReturnZ::DoAction(ReturnZ* action, bool is_fordward)
 					ComponentTransform* transform = (ComponentTransform*)App->objects->GetGameObjectByID(comp->comp->objectID)->GetComponentWithID(comp->comp->compID);
 					CompZ::SetComponent(transform, comp->comp);
 					if (App->objects->octree.Exists(transform->game_object_attached)) {
-						App->objects->octree.Recalculate(nullptr);
+						// solving the transforms moves the static objects in the octree
+						App->objects->transform_hierarchy.Update(App->objects->GetRoot(true));
 					}
 					break; }
 				case ComponentType::MESH: {
@@ -278,6 +279,7 @@ bool ReturnZ::DoAction(ReturnZ* action, bool is_fordward)
 						delete component;
 						component = nullptr;
 						obj->components.erase(item);
+						obj->RebuildComponentSlots();
 						ret = true;
 						break;
 					}
@@ -0,0 +1,141 @@
+#include "SceneBinary.h"
+#include <string.h>
+
+// the count is after the magic and the version
+#define SCENE_BINARY_COUNT_OFFSET 8
+
+void SceneWriter::Write(const void* data, uint size)
+{
+	buffer.append((const char*)data, size);
+}
+
+void SceneWriter::WriteString(const char* string)
+{
+	uint size = (string != nullptr) ? (uint)strlen(string) : 0;
+	Write(size);
+	Write(string, size);
+}
+
+void SceneWriter::WriteHeader(const char* scene_name)
+{
+	Write((uint)SCENE_BINARY_MAGIC);
+	Write((uint)SCENE_BINARY_VERSION);
+	Write((uint)0);
+	WriteString(scene_name);
+}
+
+void SceneWriter::SetObjectsCount(uint count)
+{
+	if (buffer.size() >= SCENE_BINARY_COUNT_OFFSET + sizeof(uint)) {
+		memcpy(&buffer[SCENE_BINARY_COUNT_OFFSET], &count, sizeof(uint));
+	}
+}
+
+uint SceneWriter::BeginBlock()
+{
+	uint block = buffer.size();
+	Write((uint)0);
+	return block;
+}
+
+void SceneWriter::EndBlock(uint block)
+{
+	uint size = buffer.size() - block - sizeof(uint);
+	memcpy(&buffer[block], &size, sizeof(uint));
+}
+
+const char* SceneWriter::GetData() const
+{
+	return buffer.data();
+}
+
+uint SceneWriter::GetSize() const
+{
+	return buffer.size();
+}
+
+void SceneWriter::Clear()
+{
+	buffer.clear();
+}
+
+SceneReader::SceneReader(const char* data, uint size) : cursor(data), end(data + size)
+{
+	failed = data == nullptr;
+}
+
+bool SceneReader::Read(void* data, uint size)
+{
+	if (failed || (uint)(end - cursor) < size) {
+		memset(data, 0, size);
+		failed = true;
+		return false;
+	}
+	memcpy(data, cursor, size);
+	cursor += size;
+	return true;
+}
+
+std::string SceneReader::ReadString()
+{
+	uint size = Read<uint>();
+	if (failed || (uint)(end - cursor) < size) {
+		failed = true;
+		return std::string();
+	}
+	std::string ret(cursor, size);
+	cursor += size;
+	return ret;
+}
+
+void SceneReader::ReadString(char* destination, uint capacity)
+{
+	uint size = Read<uint>();
+	if (failed || (uint)(end - cursor) < size) {
+		failed = true;
+		destination[0] = '\0';
+		return;
+	}
+	uint copied = (size < capacity) ? size : capacity - 1;
+	memcpy(destination, cursor, copied);
+	destination[copied] = '\0';
+	cursor += size;
+}
+
+bool SceneReader::ReadHeader(std::string* scene_name, uint* objects_count)
+{
+	uint magic = 0;
+	uint version = 0;
+	if (!Read(&magic, sizeof(uint)) || magic != SCENE_BINARY_MAGIC || !Read(&version, sizeof(uint)) || version != SCENE_BINARY_VERSION)
+		return false;
+
+	*objects_count = Read<uint>();
+	*scene_name = ReadString();
+	return !failed;
+}
+
+const char* SceneReader::BeginBlock()
+{
+	uint size = Read<uint>();
+	if (failed || (uint)(end - cursor) < size) {
+		failed = true;
+		return end;
+	}
+	return cursor + size;
+}
+
+void SceneReader::EndBlock(const char* block_end)
+{
+	// a component that read more than its block broke the next ones
+	if (cursor > block_end) {
+		failed = true;
+	}
+	if (!failed) {
+		cursor = block_end;
+	}
+}
+
+bool SceneReader::Failed() const
+{
+	return failed;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+typedef unsigned long long u64;
+
+#define SCENE_BINARY_MAGIC 0x4E435341 // "ASCN"
+#define SCENE_BINARY_VERSION 1
+
+enum class SceneObjectFlags {
+	NONE = 0,
+	ENABLED = 1 << 0,
+	PARENT_ENABLED = 1 << 1,
+	SELECTED = 1 << 2,
+	PARENT_SELECTED = 1 << 3,
+	IS_STATIC = 1 << 4,
+	IS_PREFAB = 1 << 5,
+	PREFAB_LOCKED = 1 << 6
+};
+
+// Binary scenes of the library. After the header the objects are in the order of the hierarchy, each one after its
+// parent and with the index of its parent (-1 for the root), and every component is a block with its size so the
+// ones that can't be loaded are skipped. The numbers are in the memory layout of the engine.
+class SceneWriter {
+
+public:
+
+	void Write(const void* data, uint size);
+	template <class T>
+	void Write(const T& value) { Write((const void*)&value, sizeof(T)); }
+	void WriteString(const char* string);
+
+	void WriteHeader(const char* scene_name);
+	// the objects are counted while they are written, the header gets it at the end
+	void SetObjectsCount(uint count);
+
+	// reserve the size of a block, EndBlock writes it when the block is done
+	uint BeginBlock();
+	void EndBlock(uint block);
+
+	const char* GetData() const;
+	uint GetSize() const;
+	// empty, keeping the memory for the next writes
+	void Clear();
+
+private:
+
+	std::string buffer;
+};
+
+class SceneReader {
+
+public:
+
+	SceneReader(const char* data, uint size);
+
+	// zeros and false past the end, and every read after it fails too
+	bool Read(void* data, uint size);
+	template <class T>
+	T Read() { T value = T(); Read((void*)&value, sizeof(T)); return value; }
+	std::string ReadString();
+	// cut to the capacity with the 0 at the end
+	void ReadString(char* destination, uint capacity);
+
+	// false if the data is not a binary scene of this version
+	bool ReadHeader(std::string* scene_name, uint* objects_count);
+
+	// the end of the block, EndBlock moves there even if the block was not read at all
+	const char* BeginBlock();
+	void EndBlock(const char* block_end);
+
+	bool Failed() const;
+
+private:
+
+	const char* cursor = nullptr;
+	const char* end = nullptr;
+	bool failed = false;
+};
+
+// an object of a snapshot, its record is in [begin, end) of the data without the index of its parent
+struct SnapshotObject {
+	u64 ID = 0;
+	int parent_index = -1;
+	uint begin = 0;
+	uint end = 0;
+	// the scripts have state out of the record, their objects are always loaded again
+	bool has_scripts = false;
+};
+
+// the scene in memory when the play mode starts, in the records of the binary scenes
+struct SceneSnapshot {
+	SceneWriter data;
+	std::vector<SnapshotObject> objects;
+	bool taken = false;
+};
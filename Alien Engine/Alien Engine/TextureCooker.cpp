@@ -0,0 +1,363 @@
+#include "TextureCooker.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cmath>
+
+#define FOUR_CC(a, b, c, d) ((uint)(a) | ((uint)(b) << 8) | ((uint)(c) << 16) | ((uint)(d) << 24))
+
+#define DDS_MAGIC FOUR_CC('D', 'D', 'S', ' ')
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#define DDPF_FOURCC 0x4
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+
+TextureFormat TextureCooker::ChooseFormat(const unsigned char* pixels, uint width, uint height)
+{
+	const unsigned char* end = pixels + width * height * 4;
+	for (const unsigned char* pixel = pixels; pixel != end; pixel += 4) {
+		if (pixel[3] < 255)
+			return TextureFormat::BC3;
+	}
+
+	// the z of the normals is rebuilt from x and y when they are sampled, colors keep the three channels
+	if (IsNormalMap(pixels, width, height))
+		return TextureFormat::BC5;
+	return TextureFormat::BC1;
+}
+
+bool TextureCooker::IsNormalMap(const unsigned char* pixels, uint width, uint height)
+{
+	const unsigned char* end = pixels + width * height * 4;
+	for (const unsigned char* pixel = pixels; pixel != end; pixel += 4) {
+		// z is never below the surface
+		if (pixel[2] < 128)
+			return false;
+		float x = pixel[0] / 127.5F - 1.0F;
+		float y = pixel[1] / 127.5F - 1.0F;
+		float z = pixel[2] / 127.5F - 1.0F;
+		if (std::abs(x * x + y * y + z * z - 1.0F) > TEXTURE_COOKER_NORMAL_TOLERANCE)
+			return false;
+	}
+	return width > 0 && height > 0;
+}
+
+uint TextureCooker::GetMipsCount(uint width, uint height)
+{
+	uint count = 1;
+	while (width > 1 || height > 1) {
+		width = std::max(width / 2, 1U);
+		height = std::max(height / 2, 1U);
+		++count;
+	}
+	return count;
+}
+
+uint TextureCooker::GetBlockSize(TextureFormat format)
+{
+	return (format == TextureFormat::BC1) ? 8 : 16;
+}
+
+uint TextureCooker::GetLevelSize(TextureFormat format, uint width, uint height)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+const char* TextureCooker::GetFormatName(TextureFormat format)
+{
+	switch (format) {
+	case TextureFormat::BC1: return "BC1";
+	case TextureFormat::BC3: return "BC3";
+	case TextureFormat::BC5: return "BC5";
+	default: return "unknown";
+	}
+}
+
+uint TextureCooker::GetLevelOffset(TextureFormat format, uint width, uint height, uint level)
+{
+	uint offset = sizeof(DDSHeader);
+	for (uint i = 0; i < level; ++i) {
+		offset += GetLevelSize(format, width, height);
+		width = std::max(width / 2, 1U);
+		height = std::max(height / 2, 1U);
+	}
+	return offset;
+}
+
+void TextureCooker::GenerateMip(const unsigned char* source, uint width, uint height, unsigned char* destination)
+{
+	uint mip_width = std::max(width / 2, 1U);
+	uint mip_height = std::max(height / 2, 1U);
+
+	for (uint y = 0; y < mip_height; ++y) {
+		const unsigned char* row0 = source + std::min(y * 2, height - 1) * width * 4;
+		const unsigned char* row1 = source + std::min(y * 2 + 1, height - 1) * width * 4;
+		for (uint x = 0; x < mip_width; ++x) {
+			uint x0 = std::min(x * 2, width - 1) * 4;
+			uint x1 = std::min(x * 2 + 1, width - 1) * 4;
+			for (uint c = 0; c < 4; ++c) {
+				destination[c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+			destination += 4;
+		}
+	}
+}
+
+void TextureCooker::CompressLevel(TextureFormat format, const unsigned char* pixels, uint width, uint height, unsigned char* destination)
+{
+	unsigned char block[16 * 4];
+
+	for (uint y = 0; y < height; y += 4) {
+		for (uint x = 0; x < width; x += 4) {
+			FetchBlock(pixels, width, height, x, y, block);
+			switch (format) {
+			case TextureFormat::BC1:
+				CompressColorBlock(block, destination);
+				break;
+			case TextureFormat::BC3:
+				CompressChannelBlock(block, 3, destination);
+				CompressColorBlock(block, destination + 8);
+				break;
+			case TextureFormat::BC5:
+				CompressChannelBlock(block, 0, destination);
+				CompressChannelBlock(block, 1, destination + 8);
+				break;
+			default:
+				break;
+			}
+			destination += GetBlockSize(format);
+		}
+	}
+}
+
+char* TextureCooker::Cook(const unsigned char* pixels, uint width, uint height, uint* size, TextureFormat* chosen_format)
+{
+	TextureFormat format = ChooseFormat(pixels, width, height);
+	uint mips_count = GetMipsCount(width, height);
+
+	*size = GetLevelOffset(format, width, height, mips_count);
+	char* data = new char[*size];
+
+	DDSHeader header;
+	header.magic = DDS_MAGIC;
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.width = width;
+	header.height = height;
+	header.linear_size = GetLevelSize(format, width, height);
+	header.mips_count = mips_count;
+	header.reserved[0] = TEXTURE_COOKER_MAGIC;
+	header.reserved[1] = TEXTURE_COOKER_VERSION;
+	header.reserved[2] = (uint)format;
+	header.pixel_format.flags = DDPF_FOURCC;
+	switch (format) {
+	case TextureFormat::BC1: header.pixel_format.four_cc = FOUR_CC('D', 'X', 'T', '1'); break;
+	case TextureFormat::BC3: header.pixel_format.four_cc = FOUR_CC('D', 'X', 'T', '5'); break;
+	case TextureFormat::BC5: header.pixel_format.four_cc = FOUR_CC('A', 'T', 'I', '2'); break;
+	default: break;
+	}
+	header.caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	memcpy(data, &header, sizeof(DDSHeader));
+
+	// each level is filtered from the previous one
+	std::vector<unsigned char> level;
+	std::vector<unsigned char> next_level;
+	const unsigned char* source = pixels;
+	unsigned char* destination = (unsigned char*)data + sizeof(DDSHeader);
+
+	for (uint i = 0; i < mips_count; ++i) {
+		CompressLevel(format, source, width, height, destination);
+		destination += GetLevelSize(format, width, height);
+
+		if (i + 1 < mips_count) {
+			next_level.resize(std::max(width / 2, 1U) * std::max(height / 2, 1U) * 4);
+			GenerateMip(source, width, height, next_level.data());
+			level.swap(next_level);
+			source = level.data();
+			width = std::max(width / 2, 1U);
+			height = std::max(height / 2, 1U);
+		}
+	}
+
+	if (chosen_format != nullptr)
+		*chosen_format = format;
+
+	return data;
+}
+
+bool TextureCooker::ReadHeader(const char* data, uint size, TextureFormat* format, uint* width, uint* height, uint* mips_count)
+{
+	if (data == nullptr || size < sizeof(DDSHeader))
+		return false;
+
+	DDSHeader header;
+	memcpy(&header, data, sizeof(DDSHeader));
+
+	// the DDS files of other tools and the ones saved before the cooker are not read here
+	if (header.magic != DDS_MAGIC || header.reserved[0] != TEXTURE_COOKER_MAGIC || header.reserved[1] == 0 || header.reserved[1] > TEXTURE_COOKER_VERSION
+		|| header.reserved[2] >= (uint)TextureFormat::MAX || header.width == 0 || header.height == 0 || header.mips_count != GetMipsCount(header.width, header.height)) {
+		return false;
+	}
+
+	if (GetLevelOffset((TextureFormat)header.reserved[2], header.width, header.height, header.mips_count) > size)
+		return false;
+
+	*format = (TextureFormat)header.reserved[2];
+	*width = header.width;
+	*height = header.height;
+	*mips_count = header.mips_count;
+
+	return true;
+}
+
+void TextureCooker::CompressColorBlock(const unsigned char* block, unsigned char* destination)
+{
+	int min[3] = { 255, 255, 255 };
+	int max[3] = { 0, 0, 0 };
+	int sum[3] = { 0, 0, 0 };
+	for (uint i = 0; i < 16; ++i) {
+		for (uint c = 0; c < 3; ++c) {
+			min[c] = std::min(min[c], (int)block[i * 4 + c]);
+			max[c] = std::max(max[c], (int)block[i * 4 + c]);
+			sum[c] += block[i * 4 + c];
+		}
+	}
+
+	// the channel that changes the most leads, the ones going the other way are flipped so the ends of the line
+	// are the diagonal of the box the colors follow
+	int covariance[3][3] = { { 0 } };
+	for (uint i = 0; i < 16; ++i) {
+		int delta[3];
+		for (uint c = 0; c < 3; ++c) {
+			delta[c] = block[i * 4 + c] * 16 - sum[c];
+		}
+		for (uint c = 0; c < 3; ++c) {
+			for (uint k = 0; k < 3; ++k) {
+				covariance[c][k] += delta[c] * delta[k];
+			}
+		}
+	}
+	uint lead = 0;
+	for (uint c = 1; c < 3; ++c) {
+		if (covariance[c][c] > covariance[lead][lead])
+			lead = c;
+	}
+
+	int end0[3];
+	int end1[3];
+	for (uint c = 0; c < 3; ++c) {
+		// inset a bit, the extreme pixels are rare and the palette is better spent inside
+		int inset = (max[c] - min[c]) / 16;
+		end0[c] = max[c] - inset;
+		end1[c] = min[c] + inset;
+		if (c != lead && covariance[lead][c] < 0)
+			std::swap(end0[c], end1[c]);
+	}
+
+	uint color0 = ((end0[0] * 31 + 127) / 255) << 11 | ((end0[1] * 63 + 127) / 255) << 5 | ((end0[2] * 31 + 127) / 255);
+	uint color1 = ((end1[0] * 31 + 127) / 255) << 11 | ((end1[1] * 63 + 127) / 255) << 5 | ((end1[2] * 31 + 127) / 255);
+	// color0 > color1 is the 4 colors mode
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	uint indices = 0;
+	if (color0 != color1) {
+		int palette[4][3];
+		uint colors[2] = { color0, color1 };
+		for (uint i = 0; i < 2; ++i) {
+			uint r = (colors[i] >> 11) & 31;
+			uint g = (colors[i] >> 5) & 63;
+			uint b = colors[i] & 31;
+			palette[i][0] = (r << 3) | (r >> 2);
+			palette[i][1] = (g << 2) | (g >> 4);
+			palette[i][2] = (b << 3) | (b >> 2);
+		}
+		for (uint c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (uint i = 0; i < 16; ++i) {
+			uint best = 0;
+			int best_distance = INT_MAX;
+			for (uint p = 0; p < 4; ++p) {
+				int distance = 0;
+				for (uint c = 0; c < 3; ++c) {
+					int delta = (int)block[i * 4 + c] - palette[p][c];
+					distance += delta * delta;
+				}
+				if (distance < best_distance) {
+					best_distance = distance;
+					best = p;
+				}
+			}
+			indices |= best << (i * 2);
+		}
+	}
+
+	destination[0] = (unsigned char)(color0 & 0xFF);
+	destination[1] = (unsigned char)(color0 >> 8);
+	destination[2] = (unsigned char)(color1 & 0xFF);
+	destination[3] = (unsigned char)(color1 >> 8);
+	for (uint i = 0; i < 4; ++i) {
+		destination[4 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+void TextureCooker::CompressChannelBlock(const unsigned char* block, uint channel, unsigned char* destination)
+{
+	int min = 255;
+	int max = 0;
+	for (uint i = 0; i < 16; ++i) {
+		min = std::min(min, (int)block[i * 4 + channel]);
+		max = std::max(max, (int)block[i * 4 + channel]);
+	}
+
+	// max > min is the 8 values mode, the 6 between them interpolated
+	unsigned long long indices = 0;
+	if (max != min) {
+		int palette[8] = { max, min };
+		for (uint i = 1; i < 7; ++i) {
+			palette[i + 1] = ((7 - i) * max + i * min + 3) / 7;
+		}
+
+		for (uint i = 0; i < 16; ++i) {
+			int value = block[i * 4 + channel];
+			uint best = 0;
+			int best_distance = INT_MAX;
+			for (uint p = 0; p < 8; ++p) {
+				int distance = abs(value - palette[p]);
+				if (distance < best_distance) {
+					best_distance = distance;
+					best = p;
+				}
+			}
+			indices |= (unsigned long long)best << (i * 3);
+		}
+	}
+
+	destination[0] = (unsigned char)max;
+	destination[1] = (unsigned char)min;
+	for (uint i = 0; i < 6; ++i) {
+		destination[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+void TextureCooker::FetchBlock(const unsigned char* pixels, uint width, uint height, uint x, uint y, unsigned char* block)
+{
+	// the blocks over the border repeat the last row and column
+	for (uint j = 0; j < 4; ++j) {
+		uint row = std::min(y + j, height - 1);
+		for (uint i = 0; i < 4; ++i) {
+			uint column = std::min(x + i, width - 1);
+			memcpy(block + (j * 4 + i) * 4, pixels + (row * width + column) * 4, 4);
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+typedef unsigned int uint;
+
+#define TEXTURE_COOKER_MAGIC 0x4B4F4F43 // "COOK" in the reserved words of the DDS header
+#define TEXTURE_COOKER_VERSION 2
+// how far the squared length of the vectors of a normal map can be from 1, the 8 bit channels round them
+#define TEXTURE_COOKER_NORMAL_TOLERANCE 0.1F
+
+enum class TextureFormat {
+	BC1, // opaque colors, 8 bytes per block of 4x4 pixels
+	BC3, // colors and alpha, 16 bytes per block
+	BC5, // red and green of the normal maps, 16 bytes per block
+
+	MAX
+};
+
+struct DDSPixelFormat {
+	uint size = 32;
+	uint flags = 0;
+	uint four_cc = 0;
+	uint rgb_bit_count = 0;
+	uint r_bit_mask = 0;
+	uint g_bit_mask = 0;
+	uint b_bit_mask = 0;
+	uint a_bit_mask = 0;
+};
+
+// Header of the cooked textures. It is a DDS header so other tools can open them, with the levels after it from
+// the biggest to 1x1 and the rows in the GL order, each level can be uploaded straight from the mapped file
+struct DDSHeader {
+	uint magic = 0;
+	uint size = 124;
+	uint flags = 0;
+	uint height = 0;
+	uint width = 0;
+	uint linear_size = 0;
+	uint depth = 0;
+	uint mips_count = 0;
+	// 0 the cooker magic, 1 its version and 2 the TextureFormat
+	uint reserved[11] = { 0 };
+	DDSPixelFormat pixel_format;
+	uint caps = 0;
+	uint caps2 = 0;
+	uint caps3 = 0;
+	uint caps4 = 0;
+	uint reserved2 = 0;
+};
+
+// Offline steps of the textures, from RGBA pixels to the block compressed mip chain the GPU reads. Everything is
+// thread safe, nothing uses GL.
+class TextureCooker {
+
+public:
+
+	// BC3 if some pixel is not opaque, BC5 for the normal maps and BC1 for the rest
+	static TextureFormat ChooseFormat(const unsigned char* pixels, uint width, uint height);
+	// every pixel is a unit vector facing out of the surface, like the tangent space normal maps
+	static bool IsNormalMap(const unsigned char* pixels, uint width, uint height);
+	// levels from width x height to 1x1
+	static uint GetMipsCount(uint width, uint height);
+	static uint GetBlockSize(TextureFormat format);
+	static uint GetLevelSize(TextureFormat format, uint width, uint height);
+	static const char* GetFormatName(TextureFormat format);
+
+	// half the size of the RGBA level with a box filter, the odd rows and columns repeat the last one
+	static void GenerateMip(const unsigned char* source, uint width, uint height, unsigned char* destination);
+	static void CompressLevel(TextureFormat format, const unsigned char* pixels, uint width, uint height, unsigned char* destination);
+
+	// the whole cooked file of the RGBA pixels, delete it with delete[]
+	static char* Cook(const unsigned char* pixels, uint width, uint height, uint* size, TextureFormat* chosen_format = nullptr);
+	// false if the data is not a complete cooked file
+	static bool ReadHeader(const char* data, uint size, TextureFormat* format, uint* width, uint* height, uint* mips_count);
+	// offset of the level in the cooked file
+	static uint GetLevelOffset(TextureFormat format, uint width, uint height, uint level);
+
+private:
+
+	// 4x4 RGBA pixels to a BC1 block of 8 bytes, always in the 4 colors mode
+	static void CompressColorBlock(const unsigned char* block, unsigned char* destination);
+	// one channel of the 4x4 RGBA pixels to a BC4 block of 8 bytes, BC3 uses it for the alpha and BC5 twice
+	static void CompressChannelBlock(const unsigned char* block, uint channel, unsigned char* destination);
+	static void FetchBlock(const unsigned char* pixels, uint width, uint height, uint x, uint y, unsigned char* block);
+};
@@ -7,6 +7,7 @@
 #include "ResourceScene.h"
 #include "Resource_.h"
 #include "PanelScene.h"
+#include "j1PerfTimer.h"
 
 Time::GameState Time::state = Time::GameState::NONE;
 float Time::time_since_start = 0.0F;
@@ -35,9 +36,10 @@ void Time::Play()
 {
 	static std::string actual_scene_name;
 	if (state == GameState::NONE) {
+		j1PerfTimer timer;
 #ifndef GAME_VERSION
 		actual_scene_name = (App->objects->current_scene != nullptr) ? App->objects->current_scene->GetName() : std::string();
-		App->objects->SaveScene(nullptr, "Library/play_scene.alienScene");
+		App->objects->TakePlaySnapshot();
 		App->objects->ignore_cntrlZ = true;
 		if (App->ui->panel_console->clear_on_play) {
 			App->game_string_logs.clear();
@@ -52,18 +54,20 @@ void Time::Play()
 		App->objects->InitScriptsOnPlay();
 		game_time = 0.0F;
 		game_timer->Start();
+		App->objects->play_enter_ms = timer.ReadMs();
+		LOG_ENGINE("Entered the play mode in %.3f ms, snapshot of %u bytes", App->objects->play_enter_ms, App->objects->play_snapshot_bytes);
 	}
 	else if (state == GameState::PAUSE) {
 		state = GameState::PLAY;
 		game_timer->Resume();
 	}
 	else if (state == GameState::PLAY) {
+		j1PerfTimer timer;
 		App->objects->CleanUpScriptsOnStop();
 		state = GameState::NONE;
 		game_time = 0.0F;
-		App->objects->LoadScene("Library/play_scene.alienScene", false);
+		App->objects->RestorePlaySnapshot();
 		App->objects->ignore_cntrlZ = false;
-		remove("Library/play_scene.alienScene");
 #ifndef GAME_VERSION
 		App->objects->errors = false;
 		if (!actual_scene_name.empty()) {
@@ -75,6 +79,9 @@ void Time::Play()
 		App->ui->panel_console->game_console = false;
 		ImGui::SetWindowFocus(App->ui->panel_scene->GetPanelName().data());
 #endif
+		App->objects->play_exit_ms = timer.ReadMs();
+		LOG_ENGINE("Left the play mode in %.3f ms: %u objects reused, %u loaded again and %u removed", App->objects->play_exit_ms, App->objects->play_objects_reused,
+			App->objects->play_objects_loaded, App->objects->play_objects_removed);
 	}
 }
 
@@ -14,6 +14,8 @@ private:
 	friend class PanelScene;
 	friend class PanelInspector;
 	friend class ResourcePrefab;
+	friend class GameObjectPool;
+	friend class TestScene;
 
 	enum class GameState {
 		NONE,
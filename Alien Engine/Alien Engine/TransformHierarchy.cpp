@@ -0,0 +1,171 @@
+#include "TransformHierarchy.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "j1PerfTimer.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include <algorithm>
+
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+	Clear();
+}
+
+void TransformHierarchy::Update(GameObject* root)
+{
+	if (root == nullptr)
+		return;
+
+	if (need_rebuild) {
+		Rebuild(root);
+	}
+
+	if (!any_dirty) {
+		last_updated = 0;
+		return;
+	}
+
+	j1PerfTimer timer;
+	last_updated = 0;
+
+	for (uint i = 0; i < owners.size(); ++i) {
+		const int parent = parents[i];
+
+		// parents are always before their children, so a dirty parent has already marked us
+		if (dirty[i] == 0 && (parent == -1 || dirty[parent] == 0))
+			continue;
+
+		dirty[i] = 1;
+		ComponentTransform* transform = owners[i];
+
+		if (transform->is_dirty) {
+			transform->global_transformation = (parent == -1) ? transform->local_transformation : globals[parent] * transform->local_transformation;
+			transform->is_dirty = false;
+		}
+		globals[i] = transform->global_transformation;
+		transform->needs_update = false;
+
+		ComponentMesh* mesh = (ComponentMesh*)transform->game_object_attached->GetComponent(ComponentType::MESH);
+		if (mesh != nullptr) {
+			mesh->RecalculateGlobalAABB_OBB();
+			// the octree keeps a copy of the AABBs of the static objects
+			if (transform->game_object_attached->is_static) {
+				App->objects->octree.UpdateObject(transform->game_object_attached);
+			}
+		}
+		++last_updated;
+	}
+
+	std::fill(dirty.begin(), dirty.end(), 0);
+	any_dirty = false;
+
+	last_update_ms = timer.ReadMs();
+}
+
+void TransformHierarchy::UpdateActive(GameObject* root)
+{
+	if (root == nullptr)
+		return;
+
+	if (need_rebuild) {
+		Rebuild(root);
+	}
+
+	active.resize(owners.size());
+	for (uint i = 0; i < owners.size(); ++i) {
+		const int parent = parents[i];
+		active[i] = (owners[i]->game_object_attached->enabled && (parent == -1 || active[parent] != 0)) ? 1 : 0;
+	}
+}
+
+bool TransformHierarchy::IsActive(const ComponentTransform* transform) const
+{
+	const int index = transform->hierarchy_index;
+	if (!need_rebuild && index >= 0 && index < (int)active.size() && owners[index] == transform) {
+		return active[index] != 0;
+	}
+	return transform->game_object_attached->enabled && transform->game_object_attached->IsUpWardsEnabled();
+}
+
+void TransformHierarchy::Invalidate()
+{
+	need_rebuild = true;
+	any_dirty = true;
+}
+
+void TransformHierarchy::Clear()
+{
+	owners.clear();
+	parents.clear();
+	globals.clear();
+	dirty.clear();
+	active.clear();
+	need_rebuild = true;
+	any_dirty = false;
+}
+
+uint TransformHierarchy::GetNodesCount() const
+{
+	return owners.size();
+}
+
+uint TransformHierarchy::GetLastUpdatedCount() const
+{
+	return last_updated;
+}
+
+double TransformHierarchy::GetLastUpdateMs() const
+{
+	return last_update_ms;
+}
+
+void TransformHierarchy::Rebuild(GameObject* root)
+{
+	owners.clear();
+	parents.clear();
+	globals.clear();
+	dirty.clear();
+	active.clear();
+
+	AddNodes(root, -1);
+
+	need_rebuild = false;
+}
+
+void TransformHierarchy::AddNodes(GameObject* object, int parent_index)
+{
+	ComponentTransform* transform = (ComponentTransform*)object->GetComponent(ComponentType::TRANSFORM);
+
+	if (transform != nullptr) {
+		transform->hierarchy_index = owners.size();
+		owners.push_back(transform);
+		parents.push_back(parent_index);
+		globals.push_back(transform->global_transformation);
+		dirty.push_back(transform->needs_update ? 1 : 0);
+		if (transform->needs_update)
+			any_dirty = true;
+		parent_index = transform->hierarchy_index;
+	}
+
+	std::vector<GameObject*>::iterator item = object->children.begin();
+	for (; item != object->children.end(); ++item) {
+		if (*item != nullptr) {
+			AddNodes(*item, parent_index);
+		}
+	}
+}
+
+void TransformHierarchy::MarkDirty(ComponentTransform* transform)
+{
+	transform->needs_update = true;
+	any_dirty = true;
+
+	if (!need_rebuild && transform->hierarchy_index >= 0 && transform->hierarchy_index < (int)owners.size() && owners[transform->hierarchy_index] == transform) {
+		dirty[transform->hierarchy_index] = 1;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MathGeoLib/include/Math/float4x4.h"
+#include <vector>
+
+class GameObject;
+class ComponentTransform;
+
+typedef unsigned int uint;
+
+// Flat copy of the transform tree. Nodes are stored parent first (a parent index is always lower than
+// its children ones) so all the dirty global matrices and bounding boxes can be solved in one linear pass per frame.
+class TransformHierarchy {
+
+	friend class ComponentTransform;
+
+public:
+
+	TransformHierarchy();
+	~TransformHierarchy();
+
+	// solve every dirty transform and its mesh bounding boxes
+	void Update(GameObject* root);
+
+	// solve which objects are enabled and have all their parents enabled too
+	void UpdateActive(GameObject* root);
+	// only valid after UpdateActive
+	bool IsActive(const ComponentTransform* transform) const;
+
+	// the tree changed (new/deleted transform, reparent...) so the arrays must be built again
+	void Invalidate();
+	void Clear();
+
+	uint GetNodesCount() const;
+	uint GetLastUpdatedCount() const;
+	double GetLastUpdateMs() const;
+
+private:
+
+	void Rebuild(GameObject* root);
+	void AddNodes(GameObject* object, int parent_index);
+
+	void MarkDirty(ComponentTransform* transform);
+
+private:
+
+	bool need_rebuild = true;
+	bool any_dirty = false;
+
+	std::vector<ComponentTransform*> owners;
+	std::vector<int> parents;
+	std::vector<float4x4> globals;
+	std::vector<unsigned char> dirty;
+	std::vector<unsigned char> active;
+
+	uint last_updated = 0;
+	double last_update_ms = 0.0;
+};
@@ -87,6 +87,7 @@
 #include <time.h>
 #include <stdarg.h>
 #include <new>
+#include <mutex>
 
 #ifndef	_WIN32
 #include <unistd.h>
@@ -241,9 +242,9 @@ static		sAllocUnit	*reservoir;
 static		unsigned int	currentAllocationCount = 0;
 static		unsigned int	breakOnAllocationCount = 0;
 static		sMStats		stats;
-static	const	char		*sourceFile            = "??";
-static	const	char		*sourceFunc            = "??";
-static		unsigned int	sourceLine             = 0;
+static	thread_local	const	char	*sourceFile    = "??";
+static	thread_local	const	char	*sourceFunc    = "??";
+static	thread_local	unsigned int	sourceLine     = 0;
 static		bool		staticDeinitTime       = false;
 static		sAllocUnit	**reservoirBuffer      = NULL;
 static		unsigned int	reservoirBufferSize    = 0;
@@ -251,6 +252,35 @@ static const	char		*memoryLogFile         = "DLLs/memory.log";
 static const	char		*memoryLeakLogFile     = "DLLs/memleaks.log";
 static		void		doCleanupLogOnFirstRun();
 
+// ---------------------------------------------------------------------------------------------------------------------------------
+// The resource streaming threads allocate too, so the tracking tables are protected by a mutex and the threads waiting for it sleep.
+// It can be taken again by the same thread because the reallocator calls the allocator and the deallocator. The mutex is built in
+// static storage the first time it is needed and never destroyed, so it can be used while the static objects are being created and
+// destroyed.
+// ---------------------------------------------------------------------------------------------------------------------------------
+
+static	std::mutex	&allocationMutex()
+{
+	alignas(std::mutex) static	char		storage[sizeof(std::mutex)];
+	static	std::mutex	*mutex = ::new (storage) std::mutex();
+	return *mutex;
+}
+
+static	thread_local	unsigned int	allocationLockDepth    = 0;
+
+class	AllocationLock
+{
+public:
+	AllocationLock()
+	{
+		if (allocationLockDepth++ == 0) allocationMutex().lock();
+	}
+	~AllocationLock()
+	{
+		if (--allocationLockDepth == 0) allocationMutex().unlock();
+	}
+};
+
 // ---------------------------------------------------------------------------------------------------------------------------------
 // Local functions only
 // ---------------------------------------------------------------------------------------------------------------------------------
@@ -1040,6 +1070,8 @@ void	operator delete[](void *reportedAddress)
 
 void	*m_allocator(const char *sourceFile, const unsigned int sourceLine, const char *sourceFunc, const unsigned int allocationType, const size_t reportedSize)
 {
+	AllocationLock	lock;
+
 	try
 	{
 		#ifdef TEST_MEMORY_MANAGER
@@ -1219,6 +1251,8 @@ void	*m_allocator(const char *sourceFile, const unsigned int sourceLine, const c
 
 void	*m_reallocator(const char *sourceFile, const unsigned int sourceLine, const char *sourceFunc, const unsigned int reallocationType, const size_t reportedSize, void *reportedAddress)
 {
+	AllocationLock	lock;
+
 	try
 	{
 		#ifdef TEST_MEMORY_MANAGER
@@ -1418,6 +1452,8 @@ void	*m_reallocator(const char *sourceFile, const unsigned int sourceLine, const
 
 void	m_deallocator(const char *sourceFile, const unsigned int sourceLine, const char *sourceFunc, const unsigned int deallocationType, const void *reportedAddress)
 {
+	AllocationLock	lock;
+
 	try
 	{
 		#ifdef TEST_MEMORY_MANAGER
@@ -1581,6 +1617,8 @@ bool	m_validateAllocUnit(const sAllocUnit *allocUnit)
 
 bool	m_validateAllAllocUnits()
 {
+	AllocationLock	lock;
+
 	// Just go through each allocation unit in the hash table and count the ones that have errors
 
 	unsigned int	errors = 0;
@@ -1680,6 +1718,8 @@ void	m_dumpAllocUnit(const sAllocUnit *allocUnit, const char *prefix)
 
 void	m_dumpMemoryReport(const char *filename, const bool overwrite)
 {
+	AllocationLock	lock;
+
 	// Open the report file
 
 	FILE	*fp = NULL;
@@ -1750,6 +1790,17 @@ sMStats	m_getMemoryStatistics()
 	return stats;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------------------
+
+void	m_resetPeakStatistics()
+{
+	AllocationLock	lock;
+
+	stats.peakReportedMemory = stats.totalReportedMemory;
+	stats.peakActualMemory   = stats.totalActualMemory;
+	stats.peakAllocUnitCount = stats.totalAllocUnitCount;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------------------
 // mmgr.cpp - End of file
 // ---------------------------------------------------------------------------------------------------------------------------------
@@ -135,6 +135,8 @@ unsigned int countMemoryLeaks();
 void		m_dumpAllocUnit(const sAllocUnit *allocUnit, const char *prefix = "");
 void		m_dumpMemoryReport(const char *filename = "memreport.log", const bool overwrite = true);
 sMStats		m_getMemoryStatistics();
+// the peaks start again from the memory in use, to measure the peak of a part of the program
+void		m_resetPeakStatistics();
 
 // ---------------------------------------------------------------------------------------------------------------------------------
 // Variations of global operators new & delete
@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "Application.h"
+#include "Globals.h"
+#include "j1PerfTimer.h"
+#include "Tests.h"
+
+#include "SDL/include/SDL.h"
+#pragma comment( lib, "SDL/libx86/SDL2.lib" )
+#pragma comment( lib, "SDL/libx86/SDL2main.lib" )
+
+struct Test {
+	const char* name;
+	TestFunction function;
+};
+
+// the names are the arguments to run only some of them, all of them run without arguments
+static const Test tests[] = {
+	{ "transforms", TestTransforms },
+	{ "components", TestComponents },
+	{ "systems", TestSystems },
+	{ "dynamic_tree", TestDynamicTree },
+	{ "frustum", TestFrustum },
+	{ "octree_build", TestOctreeBuild },
+	{ "octree", TestOctree },
+	{ "render_queue", TestRenderQueue },
+	{ "batching", TestBatching },
+	{ "mesh_memory", TestMeshMemory },
+	{ "mesh_load", TestMeshLoad },
+	{ "streaming", TestStreaming },
+	{ "registry", TestRegistry },
+	{ "residency", TestResidency },
+	{ "import", TestImport },
+	{ "vertex_cache", TestVertexCache },
+	{ "lods", TestLODs },
+	{ "cook", TestCook },
+	{ "asset_database", TestAssetDatabase },
+	{ "archive", TestArchive },
+	{ "scenes", TestScenes },
+	{ "play_mode", TestPlayMode },
+	{ "prefabs", TestPrefabs },
+	{ "pool", TestPool },
+	{ "object_memory", TestObjectMemory },
+	{ "memory_threads", TestMemoryThreads },
+};
+
+Application* App = NULL;
+
+static bool IsSelected(const char* name, int argc, char** argv)
+{
+	if (argc < 2)
+		return true;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], name) == 0)
+			return true;
+	}
+	return false;
+}
+
+// The engine starts with a hidden window in the current folder, which must be the one of the engine project
+// with its configuration and assets, and the tests run one after the other in its scene
+int main(int argc, char ** argv)
+{
+	App = new Application();
+	if (!App->Init()) {
+		printf("Application Init exits with ERROR\n");
+		delete App;
+		return EXIT_FAILURE;
+	}
+	// the first frame of the editor
+	App->Update();
+
+	uint run = 0;
+	uint failed = 0;
+	for (uint i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		if (!IsSelected(tests[i].name, argc, argv))
+			continue;
+
+		printf("-------------- %s --------------\n", tests[i].name);
+		j1PerfTimer timer;
+		bool passed = tests[i].function();
+		printf("%s %s (%.3f ms)\n", passed ? "PASSED" : "FAILED", tests[i].name, timer.ReadMs());
+		++run;
+		if (!passed) {
+			++failed;
+		}
+	}
+
+	if (!App->CleanUp()) {
+		printf("Application CleanUp exits with ERROR\n");
+	}
+	delete App;
+
+	printf("%u of %u tests passed\n", run - failed, run);
+	return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleFileSystem.h"
+#include "AssetArchive.h"
+#include "PhysFS/include/physfs.h"
+#include "j1PerfTimer.h"
+#include <stdio.h>
+#include <string.h>
+
+// packed from the library by the test, removed after it
+#define ASSET_ARCHIVE_TEST_FILE "ArchiveTest.pack"
+
+struct ArchiveTimes {
+	// listing the library folders
+	double startup_ms = 0.0;
+	// reading every file
+	double load_ms = 0.0;
+	// parsing the scenes
+	double scenes_ms = 0.0;
+};
+
+struct ArchiveBenchmark {
+	ArchivePackStats pack;
+	double pack_ms = 0.0;
+	// [0] is the first pass after packing and [1] the second
+	ArchiveTimes loose[2];
+	ArchiveTimes packed[2];
+	// files extracted from the archive with other bytes than the loose ones
+	uint mismatches = 0;
+};
+
+// pack the library, then read it from the loose files and from the archive twice
+static void BenchmarkArchive(bool compress, ArchiveBenchmark* benchmark)
+{
+	*benchmark = ArchiveBenchmark();
+
+	std::vector<std::string> files;
+	App->file_system->GetFilesToPack(files);
+	if (files.empty())
+		return;
+
+	j1PerfTimer timer;
+	if (!AssetArchive::Pack(files, ASSET_ARCHIVE_TEST_FILE, compress, &benchmark->pack)) {
+		remove(ASSET_ARCHIVE_TEST_FILE);
+		return;
+	}
+	benchmark->pack_ms = timer.ReadMs();
+
+	const char* folders[] = { LIBRARY_TEXTURES_FOLDER, LIBRARY_MODELS_FOLDER, LIBRARY_MESHES_FOLDER, LIBRARY_SCENES_FOLDER, LIBRARY_PREFABS_FOLDER };
+	uint folders_count = sizeof(folders) / sizeof(const char*);
+	std::vector<std::string> scenes;
+	for (uint i = 0; i < files.size(); ++i) {
+		if (files[i].compare(0, strlen(LIBRARY_SCENES_FOLDER), LIBRARY_SCENES_FOLDER) == 0) {
+			scenes.push_back(files[i]);
+		}
+	}
+
+	// the first pass reads the archive for the first time, the OS can have the loose files cached already
+	for (uint pass = 0; pass < 2; ++pass) {
+		ArchiveTimes& loose = benchmark->loose[pass];
+		ArchiveTimes& packed = benchmark->packed[pass];
+
+		// startup, the folders the game lists
+		timer.Start();
+		for (uint i = 0; i < folders_count; ++i) {
+			std::vector<std::string> listed;
+			char** rc = PHYSFS_enumerateFiles(folders[i]);
+			for (char** name = rc; *name != nullptr; ++name) {
+				listed.push_back(std::string(folders[i]) + *name);
+			}
+			PHYSFS_freeList(rc);
+		}
+		loose.startup_ms = timer.ReadMs();
+
+		AssetArchive test_archive;
+		timer.Start();
+		test_archive.Open(ASSET_ARCHIVE_TEST_FILE);
+		for (uint i = 0; i < folders_count; ++i) {
+			std::vector<std::string> listed;
+			std::vector<std::string> directories;
+			test_archive.GetFiles(folders[i], listed, directories, true);
+		}
+		packed.startup_ms = timer.ReadMs();
+
+		// every file, like loading all the resources. The archive is not in the file system, it is read directly
+		timer.Start();
+		for (uint i = 0; i < files.size(); ++i) {
+			char* buffer = nullptr;
+			PHYSFS_file* fs_file = PHYSFS_openRead(files[i].data());
+			if (fs_file != nullptr) {
+				PHYSFS_sint64 size = PHYSFS_fileLength(fs_file);
+				if (size > 0) {
+					buffer = new char[(uint)size];
+					PHYSFS_read(fs_file, buffer, 1, (PHYSFS_uint32)size);
+				}
+				PHYSFS_close(fs_file);
+			}
+			delete[] buffer;
+		}
+		loose.load_ms = timer.ReadMs();
+
+		timer.Start();
+		for (uint i = 0; i < files.size(); ++i) {
+			uint size = 0;
+			delete[] test_archive.Extract(files[i].data(), &size);
+		}
+		packed.load_ms = timer.ReadMs();
+
+		// the scenes as LoadScene parses them
+		timer.Start();
+		for (uint i = 0; i < scenes.size(); ++i) {
+			json_value_free(json_parse_file(scenes[i].data()));
+		}
+		loose.scenes_ms = timer.ReadMs();
+
+		timer.Start();
+		for (uint i = 0; i < scenes.size(); ++i) {
+			uint size = 0;
+			char* scene = test_archive.Extract(scenes[i].data(), &size);
+			if (scene != nullptr) {
+				json_value_free(json_parse_string(scene));
+				delete[] scene;
+			}
+		}
+		packed.scenes_ms = timer.ReadMs();
+	}
+
+	// the same bytes from both, compressed or not
+	AssetArchive test_archive;
+	test_archive.Open(ASSET_ARCHIVE_TEST_FILE);
+	for (uint i = 0; i < files.size(); ++i) {
+		char* loose = nullptr;
+		uint loose_size = 0;
+		PHYSFS_file* fs_file = PHYSFS_openRead(files[i].data());
+		if (fs_file != nullptr) {
+			PHYSFS_sint64 size = PHYSFS_fileLength(fs_file);
+			if (size > 0) {
+				loose = new char[(uint)size];
+				loose_size = (uint)PHYSFS_read(fs_file, loose, 1, (PHYSFS_uint32)size);
+			}
+			PHYSFS_close(fs_file);
+		}
+		uint packed_size = 0;
+		char* packed = test_archive.Extract(files[i].data(), &packed_size);
+		if (packed_size != loose_size || (loose_size > 0 && (packed == nullptr || memcmp(loose, packed, loose_size) != 0))) {
+			++benchmark->mismatches;
+		}
+		delete[] loose;
+		delete[] packed;
+	}
+	test_archive.Close();
+
+	remove(ASSET_ARCHIVE_TEST_FILE);
+}
+
+// the library packed in one archive, stored and compressed, against the loose files when listing the
+// folders, reading every file and parsing the scenes
+bool TestArchive()
+{
+	for (uint compress = 0; compress < 2; ++compress) {
+		ArchiveBenchmark benchmark;
+		BenchmarkArchive(compress == 1, &benchmark);
+		TestReport("%s: %u files (%u compressed), %.2f MB loose, %.2f MB packed in %.3f ms", (compress == 1) ? "LZ4" : "Stored", benchmark.pack.files, benchmark.pack.compressed,
+			benchmark.pack.original_bytes / (1024.0F * 1024.0F), benchmark.pack.archive_bytes / (1024.0F * 1024.0F), benchmark.pack_ms);
+		for (uint pass = 0; pass < 2; ++pass) {
+			TestReport("%s: startup %8.3f / %8.3f ms, files %9.3f / %9.3f ms, scenes %8.3f / %8.3f ms (loose / packed)", (pass == 0) ? "Cold" : "Warm",
+				benchmark.loose[pass].startup_ms, benchmark.packed[pass].startup_ms, benchmark.loose[pass].load_ms, benchmark.packed[pass].load_ms,
+				benchmark.loose[pass].scenes_ms, benchmark.packed[pass].scenes_ms);
+		}
+
+		TEST_CHECK(benchmark.pack.files > 0);
+		TEST_CHECK(benchmark.mismatches == 0);
+		if (compress == 0) {
+			TEST_CHECK(benchmark.pack.compressed == 0);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,134 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleResources.h"
+#include "ModuleFileSystem.h"
+#include "AssetDatabase.h"
+#include "j1PerfTimer.h"
+#include "SDL/include/SDL_timer.h"
+#include <stdio.h>
+#include <string>
+
+// the synthetic assets of the test, removed after it
+#define ASSET_DATABASE_TEST_FOLDER "Library/AssetDatabaseTest/"
+
+struct AssetDatabaseBenchmark {
+	uint assets = 0;
+	// ms parsing a meta for each asset like before, and checking them with the database without records, with them and
+	// with 1% of the files changed
+	double metas_ms = 0.0;
+	double cold_ms = 0.0;
+	double warm_ms = 0.0;
+	double changed_ms = 0.0;
+	// assets found clean with the records and found changed after 1% of them were written again
+	uint warm_clean = 0;
+	uint changed = 0;
+};
+
+static void WriteFile(const std::string& path, const std::string& content)
+{
+	FILE* file = fopen(path.data(), "wb");
+	if (file != nullptr) {
+		fwrite(content.data(), 1, content.size(), file);
+		fclose(file);
+	}
+}
+
+// scan count synthetic assets parsing a meta for each like before, and with the asset database without
+// records, with them and with 1% of the files changed
+static void BenchmarkAssetDatabase(uint count, AssetDatabaseBenchmark* benchmark)
+{
+	*benchmark = AssetDatabaseBenchmark();
+	if (count == 0)
+		return;
+
+	// synthetic assets with a meta like the ones of the editor. They are written with fopen, saving logs each file
+	App->file_system->CreateDirectory(ASSET_DATABASE_TEST_FOLDER);
+	std::vector<std::string> paths;
+	std::vector<std::string> metas;
+	std::string content(4096, 'a');
+	for (uint i = 0; i < count; ++i) {
+		std::string base = std::string(ASSET_DATABASE_TEST_FOLDER) + "asset_" + std::to_string(i);
+		paths.push_back(base + ".png");
+		metas.push_back(base + "_meta.alien");
+
+		std::string id = std::to_string(i);
+		content.replace(0, id.size(), id);
+		WriteFile(paths.back(), content);
+		WriteFile(metas.back(), "{\n\t\"Meta\": {\n\t\t\"ID\": \"" + std::to_string(App->resources->GetRandomID()) + "\"\n\t}\n}");
+	}
+	// the times of the files must be older than the records, the ones of the same second are always hashed
+	SDL_Delay(1100);
+
+	// like before, a meta parsed for each asset
+	j1PerfTimer timer;
+	for (uint i = 0; i < count; ++i) {
+		App->resources->GetIDFromAlienPath(metas[i].data());
+	}
+	benchmark->metas_ms = timer.ReadMs();
+
+	// no records, every file is hashed
+	AssetDatabase database;
+	AssetRecord* record = nullptr;
+	timer.Start();
+	for (uint i = 0; i < count; ++i) {
+		if (database.Check(paths[i].data(), ResourceType::RESOURCE_TEXTURE, AssetDatabase::GetTextureSettings(), &record) != AssetState::CLEAN) {
+			database.Store(paths[i].data(), ResourceType::RESOURCE_TEXTURE, AssetDatabase::GetTextureSettings());
+		}
+	}
+	database.Save(ASSET_DATABASE_TEST_FOLDER "assets.db");
+	benchmark->cold_ms = timer.ReadMs();
+
+	// with the records, only the time and size of each file
+	database.Load(ASSET_DATABASE_TEST_FOLDER "assets.db");
+	database.ResetCounters();
+	timer.Start();
+	for (uint i = 0; i < count; ++i) {
+		database.Check(paths[i].data(), ResourceType::RESOURCE_TEXTURE, AssetDatabase::GetTextureSettings(), &record);
+	}
+	benchmark->warm_ms = timer.ReadMs();
+	benchmark->warm_clean = database.clean;
+
+	// 1% of the files with other content
+	content.replace(0, 7, "changed");
+	for (uint i = 0; i < count; i += 100) {
+		WriteFile(paths[i], content);
+	}
+	database.Load(ASSET_DATABASE_TEST_FOLDER "assets.db");
+	database.ResetCounters();
+	timer.Start();
+	for (uint i = 0; i < count; ++i) {
+		if (database.Check(paths[i].data(), ResourceType::RESOURCE_TEXTURE, AssetDatabase::GetTextureSettings(), &record) != AssetState::CLEAN) {
+			database.Store(paths[i].data(), ResourceType::RESOURCE_TEXTURE, AssetDatabase::GetTextureSettings());
+		}
+	}
+	benchmark->changed_ms = timer.ReadMs();
+	benchmark->changed = database.changed;
+	benchmark->assets = count;
+
+	for (uint i = 0; i < count; ++i) {
+		remove(paths[i].data());
+		remove(metas[i].data());
+	}
+	remove(ASSET_DATABASE_TEST_FOLDER "assets.db");
+	App->file_system->Remove(ASSET_DATABASE_TEST_FOLDER);
+}
+
+// scanning synthetic assets parsing a meta for each like before, against the asset database without
+// records, with them and with 1% of the files changed
+bool TestAssetDatabase()
+{
+	const uint count = 10000;
+
+	AssetDatabaseBenchmark benchmark;
+	BenchmarkAssetDatabase(count, &benchmark);
+	TEST_CHECK(benchmark.assets == count);
+	TestReport("%u assets: %9.3f ms parsing the metas, %9.3f ms without records", benchmark.assets, benchmark.metas_ms, benchmark.cold_ms);
+	TestReport("%9.3f ms with the records (%u clean, %.1fx), %9.3f ms with %u changed", benchmark.warm_ms, benchmark.warm_clean,
+		(benchmark.warm_ms > 0.0) ? benchmark.metas_ms / benchmark.warm_ms : 0.0, benchmark.changed_ms, benchmark.changed);
+
+	// nothing is hashed again when the files didn't change, and only the ones written again are found changed
+	TEST_CHECK(benchmark.warm_clean == count);
+	TEST_CHECK(benchmark.changed == (count + 99) / 100);
+
+	return true;
+}
@@ -0,0 +1,119 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleResources.h"
+#include "ModuleRenderer3D.h"
+#include "ComponentCamera.h"
+#include "RenderQueue.h"
+#include "j1PerfTimer.h"
+
+struct BatchingBenchmark {
+	uint objects = 0;
+	// objects in the render queue of the test camera
+	uint drawn = 0;
+	// ms per frame and renderer counters of the last frame drawing the objects one by one
+	double per_object_ms = 0.0;
+	uint per_object_draw_calls = 0;
+	uint per_object_state_changes = 0;
+	// the same with the opaque objects grouped in batches
+	double batched_ms = 0.0;
+	uint batched_draw_calls = 0;
+	uint batched_state_changes = 0;
+	uint batches = 0;
+	uint batched_objects = 0;
+};
+
+// draw the render queue of a camera over a generated scene of a few primitives one object at a time and in batches,
+// counting the draw calls and the state changes of the renderer
+static void BenchmarkBatching(uint objects_count, uint frames, BatchingBenchmark* benchmark)
+{
+	*benchmark = BatchingBenchmark();
+
+	TestScene scene(objects_count, 1);
+	if (!scene.IsReady())
+		return;
+	// a few meshes, without textures the batches only change the mesh
+	const PrimitiveType primitives[] = { PrimitiveType::CUBE, PrimitiveType::SPHERE_ALIEN, PrimitiveType::DODECAHEDRON, PrimitiveType::OCTAHEDRON };
+	for (uint i = 0; i < scene.objects.size(); ++i) {
+		TestScene::SetMesh(scene.objects[i], App->resources->GetPrimitive(primitives[i % 4]));
+	}
+	ModuleObjects* module = App->objects;
+	module->transform_hierarchy.Update(scene.GetRoot());
+
+	// above the generated grid looking at its center, the editor camera could be looking anywhere
+	ComponentCamera* camera = new ComponentCamera(nullptr);
+	camera->SetCameraPosition({ 50.0F, 80.0F, -40.0F });
+	camera->Look({ 50.0F, 0.0F, 50.0F });
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, App->renderer3D->scene_frame_buffer);
+	App->renderer3D->SetCameraToDraw(camera);
+	module->ClearRenderQueues();
+	const RenderQueue* render_queue = module->GetRenderQueue(camera);
+	benchmark->drawn = render_queue->GetCount();
+
+	bool batches = module->use_render_batches;
+	j1PerfTimer timer;
+	for (uint i = 0; i < 2; ++i) {
+		module->use_render_batches = (i == 1);
+		double ms = 0.0;
+		for (uint j = 0; j < frames; ++j) {
+			App->renderer3D->draw_calls = 0;
+			App->renderer3D->state_changes = 0;
+			timer.Start();
+			module->DrawRenderQueue(render_queue, camera, false);
+			// the driver works after the calls return
+			glFinish();
+			ms += timer.ReadMs();
+		}
+		ms = (frames > 0) ? ms / frames : 0.0;
+
+		if (module->use_render_batches) {
+			benchmark->batched_ms = ms;
+			benchmark->batched_draw_calls = App->renderer3D->draw_calls;
+			benchmark->batched_state_changes = App->renderer3D->state_changes;
+			benchmark->batches = module->render_batcher.GetBatchesCount();
+			benchmark->batched_objects = module->render_batcher.GetBatchedObjects().size();
+		}
+		else {
+			benchmark->per_object_ms = ms;
+			benchmark->per_object_draw_calls = App->renderer3D->draw_calls;
+			benchmark->per_object_state_changes = App->renderer3D->state_changes;
+		}
+	}
+	module->use_render_batches = batches;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// the queue of this frame can't point to the deleted camera
+	module->ClearRenderQueues();
+	delete camera;
+	benchmark->objects = objects_count;
+}
+
+// the draw calls and state changes of the same render queue drawn one object at a time against the
+// batches of the same mesh and texture
+bool TestBatching()
+{
+	const uint objects[] = { 1000, 10000 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		BatchingBenchmark benchmark;
+		BenchmarkBatching(objects[i], 10, &benchmark);
+		TEST_CHECK(benchmark.objects == objects[i]);
+		TestReport("%6u objects, %6u drawn: %8.3f ms, %6u draw calls, %6u state changes one by one", objects[i], benchmark.drawn,
+			benchmark.per_object_ms, benchmark.per_object_draw_calls, benchmark.per_object_state_changes);
+		TestReport("%6u objects, %6u drawn: %8.3f ms, %6u draw calls, %6u state changes in %u batches of %u objects", objects[i], benchmark.drawn,
+			benchmark.batched_ms, benchmark.batched_draw_calls, benchmark.batched_state_changes, benchmark.batches, benchmark.batched_objects);
+		TEST_CHECK(benchmark.drawn > 0);
+		// every object is drawn once both ways, nothing of the generated scene needs its own state. A batch is one
+		// instanced draw call when the driver has the instanced arrays
+		TEST_CHECK(benchmark.per_object_draw_calls == benchmark.drawn);
+		TEST_CHECK(benchmark.batched_draw_calls == (GLEW_ARB_instanced_arrays ? benchmark.batches : benchmark.drawn));
+		TEST_CHECK(benchmark.batched_objects == benchmark.drawn);
+		// the state is set once per batch
+		TEST_CHECK(benchmark.batches > 0 && benchmark.batched_state_changes <= benchmark.batches * 2);
+		TEST_CHECK(benchmark.batched_state_changes < benchmark.per_object_state_changes);
+	}
+
+	return true;
+}
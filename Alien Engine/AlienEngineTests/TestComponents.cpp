@@ -0,0 +1,138 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "ComponentMaterial.h"
+#include "ComponentLight.h"
+#include "j1PerfTimer.h"
+
+struct ComponentLookupBenchmark {
+	uint objects = 0;
+	uint rounds = 0;
+	// ms of all the rounds looking up the transform, the mesh, the material and a light each object doesn't have
+	double linear_ms = 0.0;
+	double dynamic_cast_ms = 0.0;
+	double slots_ms = 0.0;
+	double slots_template_ms = 0.0;
+	// lookups where the slots didn't find the same component as the linear search
+	uint mismatches = 0;
+};
+
+// look the components of every object of a generated scene up searching the components vector by type, with
+// dynamic_cast, and with the slots of the object
+static void BenchmarkComponentLookup(uint objects_count, uint rounds, ComponentLookupBenchmark* benchmark)
+{
+	*benchmark = ComponentLookupBenchmark();
+
+	TestScene scene(objects_count);
+	if (!scene.IsReady())
+		return;
+	const std::vector<GameObject*>& objects = scene.objects;
+
+	const ComponentType types[] = { ComponentType::TRANSFORM, ComponentType::MESH, ComponentType::MATERIAL, ComponentType::LIGHT };
+	const uint types_count = sizeof(types) / sizeof(types[0]);
+	std::vector<Component*> found;
+	found.reserve(objects.size() * types_count);
+
+	// the found components are kept so the searches are not optimized out
+	j1PerfTimer timer;
+	for (uint round = 0; round < rounds; ++round) {
+		found.clear();
+		std::vector<GameObject*>::const_iterator item = objects.cbegin();
+		for (; item != objects.cend(); ++item) {
+			const std::vector<Component*>& components = TestScene::GetComponents(*item);
+			for (uint i = 0; i < types_count; ++i) {
+				Component* component = nullptr;
+				std::vector<Component*>::const_iterator comp = components.cbegin();
+				for (; comp != components.cend(); ++comp) {
+					if (*comp != nullptr && TestScene::GetType(*comp) == types[i]) {
+						component = *comp;
+						break;
+					}
+				}
+				found.push_back(component);
+			}
+		}
+	}
+	benchmark->linear_ms = timer.ReadMs();
+	std::vector<Component*> linear_found = found;
+
+	timer.Start();
+	for (uint round = 0; round < rounds; ++round) {
+		found.clear();
+		std::vector<GameObject*>::const_iterator item = objects.cbegin();
+		for (; item != objects.cend(); ++item) {
+			const std::vector<Component*>& list = TestScene::GetComponents(*item);
+			Component* components[] = { nullptr, nullptr, nullptr, nullptr };
+			std::vector<Component*>::const_iterator comp = list.cbegin();
+			for (; comp != list.cend() && components[0] == nullptr; ++comp) {
+				components[0] = dynamic_cast<ComponentTransform*>(*comp);
+			}
+			for (comp = list.cbegin(); comp != list.cend() && components[1] == nullptr; ++comp) {
+				components[1] = dynamic_cast<ComponentMesh*>(*comp);
+			}
+			for (comp = list.cbegin(); comp != list.cend() && components[2] == nullptr; ++comp) {
+				components[2] = dynamic_cast<ComponentMaterial*>(*comp);
+			}
+			for (comp = list.cbegin(); comp != list.cend() && components[3] == nullptr; ++comp) {
+				components[3] = dynamic_cast<ComponentLight*>(*comp);
+			}
+			found.insert(found.end(), components, components + types_count);
+		}
+	}
+	benchmark->dynamic_cast_ms = timer.ReadMs();
+
+	timer.Start();
+	for (uint round = 0; round < rounds; ++round) {
+		found.clear();
+		std::vector<GameObject*>::const_iterator item = objects.cbegin();
+		for (; item != objects.cend(); ++item) {
+			for (uint i = 0; i < types_count; ++i) {
+				found.push_back((*item)->GetComponent(types[i]));
+			}
+		}
+	}
+	benchmark->slots_ms = timer.ReadMs();
+
+	for (uint i = 0; i < found.size(); ++i) {
+		if (found[i] != linear_found[i]) {
+			++benchmark->mismatches;
+		}
+	}
+
+	timer.Start();
+	for (uint round = 0; round < rounds; ++round) {
+		found.clear();
+		std::vector<GameObject*>::const_iterator item = objects.cbegin();
+		for (; item != objects.cend(); ++item) {
+			found.push_back(TestScene::GetComponent<ComponentTransform>(*item));
+			found.push_back(TestScene::GetComponent<ComponentMesh>(*item));
+			found.push_back(TestScene::GetComponent<ComponentMaterial>(*item));
+			found.push_back(TestScene::GetComponent<ComponentLight>(*item));
+		}
+	}
+	benchmark->slots_template_ms = timer.ReadMs();
+
+	benchmark->objects = objects_count;
+	benchmark->rounds = rounds;
+}
+
+// looking the components up in the slots of each object against searching its components vector
+bool TestComponents()
+{
+	ComponentLookupBenchmark benchmark;
+	BenchmarkComponentLookup(50000, 10, &benchmark);
+	TEST_CHECK(benchmark.objects == 50000);
+	TestReport("%u objects, %u rounds of 4 lookups:", benchmark.objects, benchmark.rounds);
+	TestReport("  %9.3f ms searching by type", benchmark.linear_ms);
+	TestReport("  %9.3f ms with dynamic_cast", benchmark.dynamic_cast_ms);
+	TestReport("  %9.3f ms with the slots (%.1fx)", benchmark.slots_ms, (benchmark.slots_ms > 0.0) ? benchmark.linear_ms / benchmark.slots_ms : 0.0);
+	TestReport("  %9.3f ms with the typed slots (%.1fx)", benchmark.slots_template_ms,
+		(benchmark.slots_template_ms > 0.0) ? benchmark.dynamic_cast_ms / benchmark.slots_template_ms : 0.0);
+	// the slots must find what the search finds
+	TEST_CHECK(benchmark.mismatches == 0);
+
+	return true;
+}
@@ -0,0 +1,184 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleResources.h"
+#include "ModuleFileSystem.h"
+#include "ResourceTexture.h"
+#include "ParallelFor.h"
+#include "j1PerfTimer.h"
+
+struct CookBenchmark {
+	uint textures = 0;
+	float megapixels = 0.0F;
+	// textures of each format the cooker chooses
+	uint formats[(uint)TextureFormat::MAX] = { 0 };
+	// the threads and the ms they took
+	std::vector<std::pair<uint, double>> threads_ms;
+	// textures cooked to a different size than with one thread
+	uint mismatches = 0;
+};
+
+// decode the textures of the directory and cook them with 1, 2, 4... threads without writing the files or using GL
+static void BenchmarkCook(const char* directory, CookBenchmark* benchmark)
+{
+	*benchmark = CookBenchmark();
+
+	std::vector<std::string> files;
+	std::vector<std::string> directories;
+	App->file_system->DiscoverFiles(directory, files, directories, true);
+
+	struct Image {
+		unsigned char* pixels = nullptr;
+		uint width = 0;
+		uint height = 0;
+	};
+
+	// decoded once, only the mips and the compression are measured
+	std::vector<Image> images;
+	std::vector<std::string>::iterator item = files.begin();
+	for (; item != files.end(); ++item) {
+		std::string extension;
+		App->file_system->SplitFilePath((*item).data(), nullptr, nullptr, &extension);
+		if (!App->StringCmp(extension.data(), "png") && !App->StringCmp(extension.data(), "jpg") && !App->StringCmp(extension.data(), "tga") && !App->StringCmp(extension.data(), "dds"))
+			continue;
+
+		Image image;
+		image.pixels = App->importer->ReadTexturePixels((*item).data(), &image.width, &image.height);
+		if (image.pixels != nullptr) {
+			images.push_back(image);
+			benchmark->megapixels += (float)(image.width * image.height) / 1000000.0F;
+		}
+	}
+
+	benchmark->textures = images.size();
+
+	if (!images.empty()) {
+		for (uint i = 0; i < images.size(); ++i) {
+			++benchmark->formats[(uint)TextureCooker::ChooseFormat(images[i].pixels, images[i].width, images[i].height)];
+		}
+
+		// 1, 2, 4... and all the cores
+		std::vector<uint> threads_counts;
+		uint max_threads = GetParallelThreadsCount(0);
+		for (uint threads = 1; threads < max_threads; threads *= 2) {
+			threads_counts.push_back(threads);
+		}
+		threads_counts.push_back(max_threads);
+
+		// sizes of the files cooked with one thread, the others must give the same
+		std::vector<uint> first_sizes;
+		std::vector<uint>::iterator threads = threads_counts.begin();
+		for (; threads != threads_counts.end(); ++threads) {
+			std::vector<uint> sizes(images.size(), 0);
+			j1PerfTimer timer;
+			ParallelFor(images.size(), *threads, [&images, &sizes](uint i) {
+				delete[] TextureCooker::Cook(images[i].pixels, images[i].width, images[i].height, &sizes[i]);
+			});
+			benchmark->threads_ms.push_back({ *threads, timer.ReadMs() });
+
+			if (first_sizes.empty()) {
+				first_sizes = sizes;
+			}
+			else {
+				for (uint i = 0; i < sizes.size(); ++i) {
+					if (sizes[i] != first_sizes[i]) {
+						++benchmark->mismatches;
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<Image>::iterator image = images.begin();
+	for (; image != images.end(); ++image) {
+		delete[] (*image).pixels;
+	}
+}
+
+// the GL texture of the resource has the size and the levels of the file it was read from
+static bool CheckTexture(ResourceTexture* texture, uint old_id)
+{
+	TEST_CHECK(texture->id != 0);
+	// the old texture is deleted, GL can give its name again
+	TEST_CHECK(old_id == texture->id || !glIsTexture(old_id));
+
+	GLint width = 0;
+	GLint height = 0;
+	GLint max_level = 0;
+	glBindTexture(GL_TEXTURE_2D, texture->id);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &max_level);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	TEST_CHECK((uint)width == texture->width && (uint)height == texture->height);
+	TEST_CHECK((uint)max_level == TextureCooker::GetMipsCount(texture->width, texture->height) - 1);
+	TEST_CHECK(glGetError() == GL_NO_ERROR);
+
+	return true;
+}
+
+// cooking the textures of the assets with 1, 2, 4... threads, and a texture in use cooked again and loaded
+// over the one it had
+bool TestCook()
+{
+	// a yellow texture keeps its colors, a normal map half flat and half tilted loses the blue channel
+	std::vector<unsigned char> pixels(8 * 8 * 4, 255);
+	for (uint i = 0; i < pixels.size(); i += 4) {
+		pixels[i + 2] = 0;
+	}
+	TEST_CHECK(TextureCooker::ChooseFormat(pixels.data(), 8, 8) == TextureFormat::BC1);
+	for (uint i = 0; i < pixels.size(); i += 4) {
+		bool tilted = i >= pixels.size() / 2;
+		pixels[i] = tilted ? 204 : 128;
+		pixels[i + 1] = 128;
+		pixels[i + 2] = tilted ? 229 : 255;
+	}
+	TEST_CHECK(TextureCooker::ChooseFormat(pixels.data(), 8, 8) == TextureFormat::BC5);
+
+	CookBenchmark benchmark;
+	BenchmarkCook(TEXTURES_FOLDER, &benchmark);
+	TestReport("%u textures, %.2f megapixels (BC1 %u, BC3 %u, BC5 %u)", benchmark.textures, benchmark.megapixels,
+		benchmark.formats[(uint)TextureFormat::BC1], benchmark.formats[(uint)TextureFormat::BC3], benchmark.formats[(uint)TextureFormat::BC5]);
+	std::vector<std::pair<uint, double>>::iterator result = benchmark.threads_ms.begin();
+	for (; result != benchmark.threads_ms.end(); ++result) {
+		TestReport("%2u threads: %9.3f ms, %.2f megapixels/s", (*result).first, (*result).second,
+			((*result).second > 0.0) ? benchmark.megapixels * 1000.0 / (*result).second : 0.0);
+	}
+	TEST_CHECK(benchmark.textures > 0);
+	TEST_CHECK(benchmark.mismatches == 0);
+
+	// a texture of the assets nothing uses, loaded like a material would
+	ResourceTexture* texture = nullptr;
+	std::vector<Resource*>::iterator item = App->resources->resources.begin();
+	for (; item != App->resources->resources.end() && texture == nullptr; ++item) {
+		if (*item != nullptr && (*item)->GetType() == ResourceType::RESOURCE_TEXTURE && (*item)->references == 0 && !(*item)->loading
+			&& (*item)->IsReloadable() && App->file_system->Exists((*item)->GetAssetsPath())) {
+			texture = (ResourceTexture*)*item;
+		}
+	}
+	TEST_CHECK(texture != nullptr);
+	TEST_CHECK(App->objects->enable_instancies);
+
+	bool async = App->resources->async_loading;
+	App->resources->async_loading = false;
+	texture->IncreaseReferences();
+	App->resources->async_loading = async;
+
+	// read and uploaded again over the texture it has
+	uint old_id = texture->id;
+	bool loaded = texture->LoadMemory();
+	bool valid = loaded && CheckTexture(texture, old_id);
+
+	// cooked again while it is in use
+	old_id = texture->id;
+	std::vector<ResourceTexture*> textures(1, texture);
+	bool cooked = App->importer->CookTextures(textures) == 1;
+	valid = valid && cooked && CheckTexture(texture, old_id);
+
+	texture->DecreaseReferences();
+	TEST_CHECK(loaded);
+	TEST_CHECK(cooked);
+	TEST_CHECK(valid);
+
+	return true;
+}
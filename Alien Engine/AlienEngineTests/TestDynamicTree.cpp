@@ -0,0 +1,145 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleCamera3D.h"
+#include "ComponentTransform.h"
+#include "ComponentCamera.h"
+#include "FrustumCulling.h"
+#include "j1PerfTimer.h"
+#include <cmath>
+
+struct DynamicTreeBenchmark {
+	uint objects = 0;
+	uint frames = 0;
+	uint rays = 0;
+	// ms per frame keeping the tree up to date with a tenth of the objects moving
+	double update_ms = 0.0;
+	// ms per frame of the draw list of the editor camera walking the objects and from the tree
+	double brute_culling_ms = 0.0;
+	double tree_culling_ms = 0.0;
+	// ms of all the rays of the mouse picking against every object and against the tree
+	double brute_picking_ms = 0.0;
+	double tree_picking_ms = 0.0;
+	uint brute_drawn = 0;
+	uint tree_drawn = 0;
+	uint brute_hits = 0;
+	uint tree_hits = 0;
+};
+
+// move a tenth of the objects of a generated scene each frame and cull them walking the objects and with the
+// DynamicTree, then cast rays over the screen against every object and against the tree
+static void BenchmarkDynamicTree(uint objects_count, uint frames, uint rays, DynamicTreeBenchmark* benchmark)
+{
+	*benchmark = DynamicTreeBenchmark();
+
+	// flat, the brute force picking of a parent tests the box of all its children
+	TestScene scene(objects_count, 1);
+	if (!scene.IsReady())
+		return;
+	const std::vector<GameObject*>& objects = scene.objects;
+	ModuleObjects* module = App->objects;
+	module->transform_hierarchy.Update(scene.GetRoot());
+	module->dynamic_tree.Update(module->component_registry.GetComponents(ComponentType::MESH));
+
+	bool printing = module->printing_scene;
+	bool systems = module->use_component_systems;
+	bool use_tree = module->use_dynamic_tree;
+	module->printing_scene = false;
+	const ComponentCamera* camera = App->camera->fake_camera;
+	FrustumCulling frustum(TestScene::GetFrustum(camera));
+	std::vector<std::pair<float, GameObject*>> to_draw;
+	to_draw.reserve(objects.size());
+
+	j1PerfTimer timer;
+	for (uint frame = 0; frame < frames; ++frame) {
+		for (uint i = frame % 10; i < objects.size(); i += 10) {
+			ComponentTransform* transform = (ComponentTransform*)objects[i]->GetComponent(ComponentType::TRANSFORM);
+			float3 position = transform->GetLocalPosition();
+			position.y += ((frame % 2 == 0) ? 0.5F : -0.5F);
+			transform->SetLocalPosition(position.x, position.y, position.z);
+		}
+		module->transform_hierarchy.Update(scene.GetRoot());
+		timer.Start();
+		module->dynamic_tree.Update(module->component_registry.GetComponents(ComponentType::MESH));
+		benchmark->update_ms += timer.ReadMs();
+
+		module->use_component_systems = false;
+		to_draw.clear();
+		timer.Start();
+		module->SetDrawList(&to_draw, camera, frustum);
+		benchmark->brute_culling_ms += timer.ReadMs();
+		benchmark->brute_drawn = to_draw.size();
+
+		module->use_component_systems = true;
+		module->use_dynamic_tree = true;
+		to_draw.clear();
+		timer.Start();
+		module->SetDrawList(&to_draw, camera, frustum);
+		benchmark->tree_culling_ms += timer.ReadMs();
+		benchmark->tree_drawn = to_draw.size();
+	}
+
+	// rays from the editor camera over a grid of the screen
+	uint side = (uint)std::ceil(std::sqrt((float)rays));
+	std::vector<LineSegment> segments;
+	for (uint i = 0; i < rays; ++i) {
+		float x = ((i % side) + 0.5F) / side * 2.0F - 1.0F;
+		float y = ((i / side) + 0.5F) / side * 2.0F - 1.0F;
+		segments.push_back(TestScene::GetFrustum(camera).UnProjectLineSegment(x, y));
+	}
+
+	std::vector<std::pair<float, GameObject*>> hits;
+	const std::vector<GameObject*>& children = TestScene::GetChildren(scene.GetRoot());
+	timer.Start();
+	for (uint i = 0; i < segments.size(); ++i) {
+		std::vector<GameObject*>::const_iterator item = children.cbegin();
+		for (; item != children.cend(); ++item) {
+			if (*item != nullptr && (*item)->IsEnabled()) {
+				App->camera->CreateObjectsHitMap(&hits, (*item), segments[i]);
+			}
+		}
+	}
+	benchmark->brute_picking_ms = timer.ReadMs();
+	benchmark->brute_hits = hits.size();
+
+	hits.clear();
+	timer.Start();
+	for (uint i = 0; i < segments.size(); ++i) {
+		App->camera->CreateObjectsHitMap(&hits, &module->dynamic_tree, segments[i]);
+	}
+	benchmark->tree_picking_ms = timer.ReadMs();
+	benchmark->tree_hits = hits.size();
+
+	module->printing_scene = printing;
+	module->use_component_systems = systems;
+	module->use_dynamic_tree = use_tree;
+
+	benchmark->objects = objects_count;
+	benchmark->frames = frames;
+	benchmark->rays = rays;
+	if (frames > 0) {
+		benchmark->update_ms /= frames;
+		benchmark->brute_culling_ms /= frames;
+		benchmark->tree_culling_ms /= frames;
+	}
+}
+
+// culling and picking of moving objects with the DynamicTree against testing every object, as they grow
+bool TestDynamicTree()
+{
+	const uint objects[] = { 1000, 10000, 50000 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		DynamicTreeBenchmark benchmark;
+		BenchmarkDynamicTree(objects[i], 10, 100, &benchmark);
+		TEST_CHECK(benchmark.objects == objects[i]);
+		TestReport("%6u objects: update %8.3f ms, culling %8.3f ms before %8.3f ms with the tree, %u rays %9.3f ms before %8.3f ms with the tree",
+			objects[i], benchmark.update_ms, benchmark.brute_culling_ms, benchmark.tree_culling_ms, benchmark.rays, benchmark.brute_picking_ms, benchmark.tree_picking_ms);
+		// the tree must not lose or add objects
+		TEST_CHECK(benchmark.brute_drawn == benchmark.tree_drawn);
+		TEST_CHECK(benchmark.brute_hits == benchmark.tree_hits);
+	}
+
+	return true;
+}
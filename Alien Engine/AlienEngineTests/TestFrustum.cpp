@@ -0,0 +1,126 @@
+#include "Tests.h"
+#include "FrustumCulling.h"
+#include "j1PerfTimer.h"
+#include "Maths.h"
+#include "MathGeoLib/include/Geometry/Plane.h"
+#include "MathGeoLib/include/Algorithm/Random/LCG.h"
+#include <vector>
+#include <cmath>
+
+// the test of ModuleRenderer3D::IsInsideFrustum before FrustumCulling, a box is outside if its 8 corners are on the
+// positive side of any plane
+static bool IsInsideCorners(const Frustum& frustum, const AABB& aabb)
+{
+	float3 corners[8];
+	aabb.GetCornerPoints(corners);
+
+	Plane planes[6];
+	frustum.GetPlanes(planes);
+
+	for (uint i = 0; i < 6; ++i)
+	{
+		uint point_inside_plane = 8;
+
+		for (uint p = 0; p < 8; ++p)
+		{
+			if (planes[i].IsOnPositiveSide(corners[p]))
+			{
+				--point_inside_plane;
+			}
+		}
+
+		if (point_inside_plane == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static Frustum CreateFrustum(const float3& pos, const float3& look_at)
+{
+	Frustum frustum;
+	frustum.type = FrustumType::PerspectiveFrustum;
+	frustum.pos = pos;
+	frustum.front = (look_at - pos).Normalized();
+	float3 right = frustum.front.Cross(float3::unitY()).Normalized();
+	frustum.up = right.Cross(frustum.front).Normalized();
+	frustum.nearPlaneDistance = 0.1F;
+	frustum.farPlaneDistance = 200.0F;
+	frustum.verticalFov = 60.0F * (float)Maths::Deg2Rad();
+	frustum.horizontalFov = 2.0F * std::atan(std::tan(frustum.verticalFov * 0.5F) * 16.0F / 9.0F);
+	return frustum;
+}
+
+// FrustumCulling must give exactly what the corners test gave, box by box, and be faster
+bool TestFrustum()
+{
+	const uint boxes_count = 200000;
+	const Frustum frustums[] = {
+		CreateFrustum({ 25, 25, 25 }, { 0, 0, 0 }),
+		CreateFrustum({ 0, 2, -50 }, { 0, 2, 0 }),
+		CreateFrustum({ -80, 150, 10 }, { 20, 0, -30 }),
+	};
+
+	// boxes of every size around the frustums, a lot of them crossing the planes
+	LCG random(1234);
+	std::vector<AABB> boxes;
+	std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+	boxes.reserve(boxes_count);
+	for (uint i = 0; i < boxes_count; ++i) {
+		float3 center(random.Float(-250.0F, 250.0F), random.Float(-250.0F, 250.0F), random.Float(-250.0F, 250.0F));
+		float size = (i % 4 == 0) ? random.Float(10.0F, 100.0F) : random.Float(0.01F, 5.0F);
+		float3 half(random.Float(0.1F, 1.0F) * size, random.Float(0.1F, 1.0F) * size, random.Float(0.1F, 1.0F) * size);
+		boxes.push_back(AABB(center - half, center + half));
+		min_x.push_back(boxes[i].minPoint.x); min_y.push_back(boxes[i].minPoint.y); min_z.push_back(boxes[i].minPoint.z);
+		max_x.push_back(boxes[i].maxPoint.x); max_y.push_back(boxes[i].maxPoint.y); max_z.push_back(boxes[i].maxPoint.z);
+	}
+
+	std::vector<unsigned char> corners_inside(boxes_count);
+	std::vector<unsigned char> culling_inside(boxes_count);
+	std::vector<unsigned char> batch_inside(boxes_count);
+
+	for (uint f = 0; f < sizeof(frustums) / sizeof(frustums[0]); ++f) {
+		j1PerfTimer timer;
+		for (uint i = 0; i < boxes_count; ++i) {
+			corners_inside[i] = IsInsideCorners(frustums[f], boxes[i]) ? 1 : 0;
+		}
+		double corners_ms = timer.ReadMs();
+
+		// the planes are computed once per query, like the old test did per box
+		timer.Start();
+		FrustumCulling culling(frustums[f]);
+		for (uint i = 0; i < boxes_count; ++i) {
+			culling_inside[i] = culling.IsInside(boxes[i]) ? 1 : 0;
+		}
+		double culling_ms = timer.ReadMs();
+
+		timer.Start();
+		FrustumCulling batch(frustums[f]);
+		batch.AreInside(min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data(), boxes_count, batch_inside.data());
+		double batch_ms = timer.ReadMs();
+
+		uint inside = 0;
+		uint culling_mismatches = 0;
+		uint batch_mismatches = 0;
+		uint mask_mismatches = 0;
+		for (uint i = 0; i < boxes_count; ++i) {
+			inside += corners_inside[i];
+			culling_mismatches += (culling_inside[i] != corners_inside[i]) ? 1 : 0;
+			batch_mismatches += (batch_inside[i] != corners_inside[i]) ? 1 : 0;
+			// a box inside the whole frustum removes all the planes from the mask
+			uint plane_mask = FRUSTUM_PLANES_MASK;
+			bool masked = culling.IsInside(boxes[i], plane_mask);
+			mask_mismatches += (masked != (corners_inside[i] != 0)) ? 1 : 0;
+		}
+
+		TestReport("frustum %u: %u of %u boxes inside, corners %8.3f ms, IsInside %7.3f ms (%.1fx), AreInside %7.3f ms (%.1fx)", f, inside, boxes_count,
+			corners_ms, culling_ms, (culling_ms > 0.0) ? corners_ms / culling_ms : 0.0, batch_ms, (batch_ms > 0.0) ? corners_ms / batch_ms : 0.0);
+		TEST_CHECK(culling_mismatches == 0);
+		TEST_CHECK(batch_mismatches == 0);
+		TEST_CHECK(mask_mismatches == 0);
+	}
+
+	return true;
+}
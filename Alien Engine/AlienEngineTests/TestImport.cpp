@@ -0,0 +1,108 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleFileSystem.h"
+#include "ResourceMesh.h"
+#include "ParallelFor.h"
+#include "j1PerfTimer.h"
+
+struct ImportBenchmark {
+	uint models = 0;
+	uint meshes = 0;
+	// the threads and the ms they took
+	std::vector<std::pair<uint, double>> threads_ms;
+	// meshes serialized with a different size than with one thread
+	uint mismatches = 0;
+};
+
+// import the models of the directory without adding them, converting and serializing their meshes with 1, 2, 4...
+// threads. Only the time of those phases is measured, the files are not written
+static void BenchmarkImport(const char* directory, ImportBenchmark* benchmark)
+{
+	*benchmark = ImportBenchmark();
+
+	std::vector<const aiScene*> scenes;
+	ImportTestModels(directory, &scenes);
+
+	std::vector<const aiMesh*> ai_meshes;
+	std::vector<const aiScene*>::iterator item = scenes.begin();
+	for (; item != scenes.end(); ++item) {
+		for (uint i = 0; i < (*item)->mNumMeshes; ++i) {
+			ai_meshes.push_back((*item)->mMeshes[i]);
+		}
+	}
+
+	benchmark->models = scenes.size();
+	benchmark->meshes = ai_meshes.size();
+
+	if (!ai_meshes.empty()) {
+		// 1, 2, 4... and all the cores
+		std::vector<uint> threads_counts;
+		uint max_threads = GetParallelThreadsCount(0);
+		for (uint threads = 1; threads < max_threads; threads *= 2) {
+			threads_counts.push_back(threads);
+		}
+		threads_counts.push_back(max_threads);
+
+		// sizes of the meshes serialized with one thread, the others must give the same
+		std::vector<uint> first_sizes;
+		std::vector<uint>::iterator count = threads_counts.begin();
+		for (; count != threads_counts.end(); ++count) {
+			std::vector<ResourceMesh*> meshes;
+			for (uint i = 0; i < ai_meshes.size(); ++i) {
+				meshes.push_back(new ResourceMesh());
+			}
+			std::vector<uint> sizes(ai_meshes.size(), 0);
+
+			j1PerfTimer timer;
+			bool optimize = App->importer->optimize_meshes;
+			bool lods = App->importer->generate_lods;
+			ParallelFor(ai_meshes.size(), *count, [&meshes, &ai_meshes, &sizes, optimize, lods](uint i) {
+				ModuleImporter::ConvertMesh(meshes[i], ai_meshes[i], optimize, lods);
+				delete[] meshes[i]->SerializeMetaData(&sizes[i]);
+			});
+			benchmark->threads_ms.push_back({ *count, timer.ReadMs() });
+
+			if (first_sizes.empty()) {
+				first_sizes = sizes;
+			}
+			else {
+				for (uint i = 0; i < sizes.size(); ++i) {
+					if (sizes[i] != first_sizes[i]) {
+						++benchmark->mismatches;
+					}
+				}
+			}
+
+			std::vector<ResourceMesh*>::iterator mesh = meshes.begin();
+			for (; mesh != meshes.end(); ++mesh) {
+				delete* mesh;
+			}
+		}
+	}
+
+	std::vector<const aiScene*>::iterator scene = scenes.begin();
+	for (; scene != scenes.end(); ++scene) {
+		aiReleaseImport(*scene);
+	}
+}
+
+// converting and serializing the meshes of the assets models with 1, 2, 4... threads
+bool TestImport()
+{
+	ImportBenchmark benchmark;
+	BenchmarkImport(MODELS_FOLDER, &benchmark);
+	TestReport("%u models, %u meshes", benchmark.models, benchmark.meshes);
+
+	TEST_CHECK(benchmark.meshes > 0);
+	TEST_CHECK(!benchmark.threads_ms.empty());
+	double one_thread_ms = benchmark.threads_ms.front().second;
+	std::vector<std::pair<uint, double>>::iterator result = benchmark.threads_ms.begin();
+	for (; result != benchmark.threads_ms.end(); ++result) {
+		TestReport("%2u threads: %9.3f ms (%.1fx)", (*result).first, (*result).second, ((*result).second > 0.0) ? one_thread_ms / (*result).second : 0.0);
+	}
+	// the threads must give the same meshes
+	TEST_CHECK(benchmark.mismatches == 0);
+
+	return true;
+}
@@ -0,0 +1,100 @@
+#include "Tests.h"
+#include "ResourceMesh.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+
+// quads of each side of the grid of the test
+#define LOD_GRID_QUADS 32
+
+struct LODCheck {
+	// triangles of each level of the flat grid, triangles[0] is the full grid
+	uint triangles[MESH_MAX_LODS + 1] = { 0 };
+	// triangles of the flat grid simplified as much as possible, and of the curved one without error
+	uint flat_min_triangles = 0;
+	uint curved_triangles = 0;
+	// levels with an index of a vertex out of the grid
+	uint errors = 0;
+};
+
+// a grid of quads on y = 0 from (0, 0) to (1, 1), or bent up to a quarter in the middle if curved
+static void CreateGrid(bool curved, std::vector<float>* positions, std::vector<uint>* indices)
+{
+	const uint side = LOD_GRID_QUADS + 1;
+	for (uint y = 0; y < side; ++y) {
+		for (uint x = 0; x < side; ++x) {
+			float u = x / (float)LOD_GRID_QUADS;
+			float v = y / (float)LOD_GRID_QUADS;
+			positions->push_back(u);
+			positions->push_back(curved ? 0.25F * sinf(u * 3.14159F) * sinf(v * 3.14159F) : 0.0F);
+			positions->push_back(v);
+		}
+	}
+
+	for (uint y = 0; y < LOD_GRID_QUADS; ++y) {
+		for (uint x = 0; x < LOD_GRID_QUADS; ++x) {
+			uint a = y * side + x;
+			uint quad[6] = { a, a + side, a + 1, a + 1, a + side, a + side + 1 };
+			indices->insert(indices->end(), quad, quad + 6);
+		}
+	}
+}
+
+// simplify the grids like ResourceMesh::GenerateLODs, each level to MESH_LOD_RATIO of the one before, and count the
+// triangles
+static void CheckLODs(LODCheck* check)
+{
+	*check = LODCheck();
+
+	std::vector<float> positions;
+	std::vector<uint> indices;
+	CreateGrid(false, &positions, &indices);
+	uint vertex_count = positions.size() / 3;
+	std::vector<uint> simplified(indices.size());
+
+	check->triangles[0] = indices.size() / 3;
+	uint previous = indices.size();
+	for (uint i = 1; i <= MESH_MAX_LODS; ++i) {
+		uint target = (uint)(previous / 3 * MESH_LOD_RATIO) * 3;
+		uint count = MeshOptimizer::SimplifyMesh(simplified.data(), indices.data(), indices.size(), positions.data(), vertex_count, target, SIMPLIFY_MAX_ERROR);
+		for (uint j = 0; j < count; ++j) {
+			if (simplified[j] >= vertex_count) {
+				++check->errors;
+				break;
+			}
+		}
+		check->triangles[i] = count / 3;
+		previous = count;
+	}
+
+	// the borders are kept, the rest of a flat grid collapses without error
+	check->flat_min_triangles = MeshOptimizer::SimplifyMesh(simplified.data(), indices.data(), indices.size(), positions.data(), vertex_count, 0, SIMPLIFY_MAX_ERROR) / 3;
+
+	// every collapse of the curved grid moves the surface
+	positions.clear();
+	indices.clear();
+	CreateGrid(true, &positions, &indices);
+	check->curved_triangles = MeshOptimizer::SimplifyMesh(simplified.data(), indices.data(), indices.size(), positions.data(), vertex_count, 0, 0.0F) / 3;
+}
+
+// the LODs of a flat grid, each level with half the triangles of the one before, and the limits of the simplification:
+// the borders of the mesh and the error allowed
+bool TestLODs()
+{
+	LODCheck check;
+	CheckLODs(&check);
+	for (uint i = 0; i <= MESH_MAX_LODS; ++i) {
+		TestReport("level %u: %5u triangles", i, check.triangles[i]);
+	}
+	TestReport("%u triangles left with only the borders, %u of the curved grid without error", check.flat_min_triangles, check.curved_triangles);
+
+	const uint triangles = LOD_GRID_QUADS * LOD_GRID_QUADS * 2;
+	TEST_CHECK(check.errors == 0);
+	for (uint i = 0; i <= MESH_MAX_LODS; ++i) {
+		TEST_CHECK(check.triangles[i] == (triangles >> i));
+	}
+	// a triangle for each of the 4 * LOD_GRID_QUADS edges of the border
+	TEST_CHECK(check.flat_min_triangles == LOD_GRID_QUADS * 4);
+	TEST_CHECK(check.curved_triangles == triangles);
+
+	return true;
+}
@@ -0,0 +1,102 @@
+#include "Tests.h"
+#include "ParallelFor.h"
+#include "j1PerfTimer.h"
+#include <atomic>
+#include "mmgr/mmgr.h"
+
+struct MemoryThreadsBenchmark {
+	uint threads = 0;
+	// allocations made by the jobs and the ones mmgr counted while they ran
+	uint allocations = 0;
+	uint counted_allocations = 0;
+	double ms = 0.0;
+	// bytes and allocation units alive after the jobs freed everything, they must be the ones before them
+	uint leaked_bytes = 0;
+	uint leaked_units = 0;
+	// the list of allocation units is still whole after the threads changed it at the same time
+	bool valid_units = false;
+};
+
+// allocate and free with new[], new, malloc and realloc from all the threads at the same time, like the workers of
+// ParallelFor and the streamer threads do, keeping some allocations alive while the other threads change the list
+static void BenchmarkMemoryThreads(uint jobs, uint allocations_per_job, MemoryThreadsBenchmark* benchmark)
+{
+	*benchmark = MemoryThreadsBenchmark();
+	benchmark->threads = GetParallelThreadsCount(0);
+
+	// the threads of the pool are created the first time, before measuring
+	ParallelFor(benchmark->threads, benchmark->threads, [](uint i) {});
+
+	std::atomic<uint> allocations(0);
+	sMStats before = m_getMemoryStatistics();
+	j1PerfTimer timer;
+	ParallelFor(jobs, benchmark->threads, [&allocations, allocations_per_job](uint i) {
+		std::vector<char*> arrays;
+		std::vector<char*> blocks;
+		for (uint j = 0; j < allocations_per_job; ++j) {
+			uint size = 16 + ((i * 31 + j * 17) % 1024);
+			switch (j % 4) {
+			case 0:
+				arrays.push_back(new char[size]);
+				break;
+			case 1: {
+				uint* value = new uint(j);
+				delete value;
+				break;
+			}
+			case 2:
+				blocks.push_back((char*)malloc(size));
+				break;
+			case 3:
+				// realloc moves the allocation unit, it isn't a new one
+				free(realloc(malloc(size), size * 2));
+				break;
+			}
+			// the allocations of the vectors are not added, only the ones of the switch
+			++allocations;
+
+			// half of them freed while the other threads are still allocating
+			if (arrays.size() == 8) {
+				for (uint k = 0; k < 4; ++k) {
+					delete[] arrays.back();
+					arrays.pop_back();
+					free(blocks.back());
+					blocks.pop_back();
+				}
+			}
+		}
+		std::vector<char*>::iterator item = arrays.begin();
+		for (; item != arrays.end(); ++item) {
+			delete[] *item;
+		}
+		for (item = blocks.begin(); item != blocks.end(); ++item) {
+			free(*item);
+		}
+	});
+	benchmark->ms = timer.ReadMs();
+	sMStats after = m_getMemoryStatistics();
+
+	benchmark->allocations = allocations;
+	benchmark->counted_allocations = after.accumulatedAllocUnitCount - before.accumulatedAllocUnitCount;
+	benchmark->leaked_bytes = after.totalReportedMemory - before.totalReportedMemory;
+	benchmark->leaked_units = after.totalAllocUnitCount - before.totalAllocUnitCount;
+	benchmark->valid_units = m_validateAllAllocUnits();
+}
+
+// mmgr called from all the threads at the same time must count every allocation and give back every byte
+bool TestMemoryThreads()
+{
+	MemoryThreadsBenchmark benchmark;
+	BenchmarkMemoryThreads(256, 2000, &benchmark);
+	TestReport("%u threads, %u allocations in %9.3f ms, %u counted by mmgr", benchmark.threads, benchmark.allocations, benchmark.ms, benchmark.counted_allocations);
+	TestReport("%u bytes and %u allocations left after the jobs", benchmark.leaked_bytes, benchmark.leaked_units);
+
+	TEST_CHECK(benchmark.allocations == 256 * 2000);
+	// the vectors of the jobs and the job of ParallelFor are counted too
+	TEST_CHECK(benchmark.counted_allocations >= benchmark.allocations);
+	TEST_CHECK(benchmark.leaked_bytes == 0);
+	TEST_CHECK(benchmark.leaked_units == 0);
+	TEST_CHECK(benchmark.valid_units);
+
+	return true;
+}
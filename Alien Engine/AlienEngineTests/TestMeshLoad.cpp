@@ -0,0 +1,156 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleResources.h"
+#include "ModuleFileSystem.h"
+#include "ResourceMesh.h"
+#include "j1PerfTimer.h"
+#include <stdio.h>
+#include "mmgr/mmgr.h"
+
+struct MeshLoadBenchmark {
+	uint models = 0;
+	uint meshes = 0;
+	// bytes of the files of all the meshes
+	uint legacy_file_bytes = 0;
+	uint file_bytes = 0;
+	// ms loading all the meshes, from the file to the buffers, in the format before the header and in .alienMesh
+	// without and with the checksum
+	double legacy_ms = 0.0;
+	double load_ms = 0.0;
+	double checksum_ms = 0.0;
+	// biggest growth of the heap while loading one mesh
+	uint legacy_peak_bytes = 0;
+	uint peak_bytes = 0;
+	// loads that failed or gave a different mesh than the other format
+	uint failed = 0;
+	// files with more vertices in the header than in the sections, cut in half or with an index past the vertices,
+	// that were loaded anyway
+	uint corrupted_loaded = 0;
+};
+
+// save the meshes of the models of the directory in the old format and in .alienMesh and load them loads times,
+// measuring the time and the peak of the heap of each load
+static void BenchmarkMeshLoad(const char* directory, uint loads, MeshLoadBenchmark* benchmark)
+{
+	*benchmark = MeshLoadBenchmark();
+
+	std::vector<const aiScene*> scenes;
+	ImportTestModels(directory, &scenes);
+	benchmark->models = scenes.size();
+
+	const char* legacy_path = LIBRARY_MESHES_FOLDER "test_legacy.alienMesh";
+	const char* path = LIBRARY_MESHES_FOLDER "test.alienMesh";
+	bool checksum = App->resources->check_meshes_checksum;
+
+	std::vector<const aiScene*>::iterator item = scenes.begin();
+	for (; item != scenes.end(); ++item) {
+		for (uint i = 0; i < (*item)->mNumMeshes; ++i) {
+			ResourceMesh* mesh = new ResourceMesh();
+			ModuleImporter::ConvertMesh(mesh, (*item)->mMeshes[i], App->importer->optimize_meshes, App->importer->generate_lods);
+
+			uint legacy_size = 0;
+			char* legacy_data = mesh->SerializeLegacyMetaData(&legacy_size);
+			uint size = 0;
+			char* data = mesh->SerializeMetaData(&size);
+
+			// broken files must be refused instead of reading outside them, the checksum is off
+			App->resources->check_meshes_checksum = false;
+			App->file_system->Save(legacy_path, legacy_data, legacy_size / 2);
+			((AlienMeshHeader*)data)->num_vertex += 1;
+			App->file_system->Save(path, data, size);
+			((AlienMeshHeader*)data)->num_vertex -= 1;
+			const char* broken_paths[] = { legacy_path, path };
+			for (uint j = 0; j < 2; ++j) {
+				ResourceMesh* loaded = new ResourceMesh();
+				loaded->SetLibraryPath(broken_paths[j]);
+				if (loaded->LoadMemory()) {
+					++benchmark->corrupted_loaded;
+				}
+				delete loaded;
+			}
+
+			if (mesh->num_index > 0) {
+				uint first_index = mesh->index[0];
+				mesh->index[0] = mesh->num_vertex;
+				uint broken_size = 0;
+				char* broken_data = mesh->SerializeLegacyMetaData(&broken_size);
+				App->file_system->Save(legacy_path, broken_data, broken_size);
+				delete[] broken_data;
+				broken_data = mesh->SerializeMetaData(&broken_size);
+				App->file_system->Save(path, broken_data, broken_size);
+				delete[] broken_data;
+				mesh->index[0] = first_index;
+
+				for (uint j = 0; j < 2; ++j) {
+					ResourceMesh* loaded = new ResourceMesh();
+					loaded->SetLibraryPath(broken_paths[j]);
+					if (loaded->LoadMemory()) {
+						++benchmark->corrupted_loaded;
+					}
+					delete loaded;
+				}
+			}
+
+			App->file_system->Save(legacy_path, legacy_data, legacy_size);
+			App->file_system->Save(path, data, size);
+			benchmark->legacy_file_bytes += legacy_size;
+			benchmark->file_bytes += size;
+			delete[] legacy_data;
+			delete[] data;
+			++benchmark->meshes;
+
+			// the old format, the .alienMesh and the .alienMesh hashed
+			const char* paths[] = { legacy_path, path, path };
+			double* times[] = { &benchmark->legacy_ms, &benchmark->load_ms, &benchmark->checksum_ms };
+			uint* peaks[] = { &benchmark->legacy_peak_bytes, &benchmark->peak_bytes, nullptr };
+			for (uint j = 0; j < 3; ++j) {
+				App->resources->check_meshes_checksum = (j == 2);
+				for (uint k = 0; k < loads; ++k) {
+					ResourceMesh* loaded = new ResourceMesh();
+					loaded->SetLibraryPath(paths[j]);
+
+					m_resetPeakStatistics();
+					uint heap = m_getMemoryStatistics().totalReportedMemory;
+					j1PerfTimer timer;
+					bool ret = loaded->LoadMemory();
+					*times[j] += timer.ReadMs();
+					if (peaks[j] != nullptr) {
+						*peaks[j] = Max(*peaks[j], m_getMemoryStatistics().peakReportedMemory - heap);
+					}
+
+					if (!ret || loaded->num_vertex != mesh->num_vertex || loaded->num_index != mesh->num_index || loaded->GetBuffersSize() != mesh->GetBuffersSize()) {
+						++benchmark->failed;
+					}
+					delete loaded;
+				}
+			}
+			delete mesh;
+		}
+		aiReleaseImport(*item);
+	}
+
+	App->resources->check_meshes_checksum = checksum;
+	remove(legacy_path);
+	remove(path);
+}
+
+// loading the meshes of the assets models from the format before the header, copied to new arrays, against
+// the mapped .alienMesh, and files with broken sizes refused
+bool TestMeshLoad()
+{
+	MeshLoadBenchmark benchmark;
+	BenchmarkMeshLoad(MODELS_FOLDER, 5, &benchmark);
+	TestReport("%u models, %u meshes, %.2f KB of files before, %.2f KB now", benchmark.models, benchmark.meshes,
+		benchmark.legacy_file_bytes / 1024.0F, benchmark.file_bytes / 1024.0F);
+	TestReport("%9.3f ms loading before, %9.3f ms now, %9.3f ms with the checksum", benchmark.legacy_ms, benchmark.load_ms, benchmark.checksum_ms);
+	TestReport("%9.2f KB of peak heap in a load before, %9.2f KB now", benchmark.legacy_peak_bytes / 1024.0F, benchmark.peak_bytes / 1024.0F);
+
+	TEST_CHECK(benchmark.meshes > 0);
+	TEST_CHECK(benchmark.failed == 0);
+	TEST_CHECK(benchmark.corrupted_loaded == 0);
+	// the arrays point to the mapped file instead of being copied
+	TEST_CHECK(benchmark.peak_bytes < benchmark.legacy_peak_bytes);
+
+	return true;
+}
@@ -0,0 +1,113 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleFileSystem.h"
+#include "ResourceMesh.h"
+#include "j1PerfTimer.h"
+
+struct MeshMemoryBenchmark {
+	uint models = 0;
+	uint meshes = 0;
+	uint vertices = 0;
+	// meshes small enough for 16 bit indices
+	uint short_index_meshes = 0;
+	// bytes of the buffers of all the meshes, and the ones the floats and 32 bit indices layout would use
+	uint gpu_bytes = 0;
+	uint uncompressed_bytes = 0;
+	double upload_ms = 0.0;
+	// biggest difference between the vertex buffers read back from the GPU and the float arrays of the meshes
+	float max_position_error = 0.0F;
+	float max_normal_error = 0.0F;
+	float max_uv_error = 0.0F;
+};
+
+// import the meshes of the models of the directory and upload them without adding them, adding up their GPU
+// memory and reading the buffers back to compare them with the floats they come from
+static void BenchmarkMeshMemory(const char* directory, MeshMemoryBenchmark* benchmark)
+{
+	*benchmark = MeshMemoryBenchmark();
+
+	std::vector<const aiScene*> scenes;
+	ImportTestModels(directory, &scenes);
+	benchmark->models = scenes.size();
+
+	std::vector<const aiScene*>::iterator item = scenes.begin();
+	for (; item != scenes.end(); ++item) {
+		const aiScene* scene = *item;
+		for (uint i = 0; i < scene->mNumMeshes; ++i) {
+			ResourceMesh* mesh = new ResourceMesh();
+			ModuleImporter::ConvertMesh(mesh, scene->mMeshes[i], App->importer->optimize_meshes, App->importer->generate_lods);
+
+			j1PerfTimer timer;
+			mesh->InitBuffers();
+			benchmark->upload_ms += timer.ReadMs();
+
+			++benchmark->meshes;
+			benchmark->vertices += mesh->num_vertex;
+			benchmark->gpu_bytes += mesh->GetBuffersSize();
+			benchmark->uncompressed_bytes += mesh->GetUncompressedBuffersSize();
+			if (mesh->index_type == GL_UNSIGNED_SHORT) {
+				++benchmark->short_index_meshes;
+			}
+
+			char* data = new char[mesh->vertex_stride * mesh->num_vertex];
+			glBindBuffer(GL_ARRAY_BUFFER, mesh->id_vertex);
+			glGetBufferSubData(GL_ARRAY_BUFFER, 0, mesh->vertex_stride * mesh->num_vertex, data);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			for (uint j = 0; j < mesh->num_vertex; ++j) {
+				const char* vertex = data + j * mesh->vertex_stride;
+				float position[3];
+				memcpy(position, vertex, sizeof(float) * 3);
+				for (uint k = 0; k < 3; ++k) {
+					benchmark->max_position_error = Max(benchmark->max_position_error, fabsf(position[k] - mesh->vertex[j * 3 + k]));
+				}
+
+				if (mesh->normals != nullptr) {
+					uint packed = 0;
+					memcpy(&packed, vertex + mesh->normals_offset, sizeof(uint));
+					for (uint k = 0; k < 3; ++k) {
+						// sign extended from 10 or 8 bits
+						float normal = (mesh->normals_type == GL_INT_2_10_10_10_REV)
+							? ((int)(packed << (22 - k * 10)) >> 22) / 511.0F
+							: (signed char)((packed >> (k * 8)) & 0xFF) / 127.0F;
+						benchmark->max_normal_error = Max(benchmark->max_normal_error, fabsf(normal - mesh->normals[j * 3 + k]));
+					}
+				}
+
+				if (mesh->uv_cords != nullptr) {
+					short uv[2];
+					memcpy(uv, vertex + mesh->uv_offset, sizeof(short) * 2);
+					for (uint k = 0; k < 2; ++k) {
+						float value = uv[k] * mesh->uv_scale[k] + mesh->uv_bias[k];
+						benchmark->max_uv_error = Max(benchmark->max_uv_error, fabsf(value - mesh->uv_cords[j * 2 + k]));
+					}
+				}
+			}
+			delete[] data;
+			delete mesh;
+		}
+		aiReleaseImport(scene);
+	}
+}
+
+// the GPU memory of the meshes of the assets models with the interleaved vertex buffer, packed normals,
+// short uvs and 16 bit indices against floats and 32 bit indices, and how far the packed vertices are from the floats
+bool TestMeshMemory()
+{
+	MeshMemoryBenchmark benchmark;
+	BenchmarkMeshMemory(MODELS_FOLDER, &benchmark);
+	TestReport("%u models, %u meshes, %u vertices, %u meshes with 16 bit indices", benchmark.models, benchmark.meshes, benchmark.vertices, benchmark.short_index_meshes);
+	TestReport("%.2f KB before, %.2f KB now (%.1f%% saved), %.3f ms uploading", benchmark.uncompressed_bytes / 1024.0F, benchmark.gpu_bytes / 1024.0F,
+		(benchmark.uncompressed_bytes > 0) ? 100.0F * (benchmark.uncompressed_bytes - benchmark.gpu_bytes) / benchmark.uncompressed_bytes : 0.0F, benchmark.upload_ms);
+	TestReport("max errors: position %f, normal %f, uv %f", benchmark.max_position_error, benchmark.max_normal_error, benchmark.max_uv_error);
+
+	TEST_CHECK(benchmark.meshes > 0);
+	TEST_CHECK(benchmark.gpu_bytes < benchmark.uncompressed_bytes);
+	// the positions are copied, the normals lose less than a step of 8 bits and the uvs less than a step of 16
+	TEST_CHECK(benchmark.max_position_error == 0.0F);
+	TEST_CHECK(benchmark.max_normal_error < 1.0F / 127.0F);
+	TEST_CHECK(benchmark.max_uv_error < 0.001F);
+
+	return true;
+}
@@ -0,0 +1,92 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "GameObject.h"
+#include "PoolAllocator.h"
+#include "j1PerfTimer.h"
+#include <stdio.h>
+#include "mmgr/mmgr.h"
+
+struct ObjectMemoryBenchmark {
+	uint objects = 0;
+	uint object_size = 0;
+	// the load of the binary scene with the objects in the heap and in the pools
+	uint heap_allocations = 0;
+	uint pool_allocations = 0;
+	double heap_bytes_per_object = 0.0;
+	double pool_bytes_per_object = 0.0;
+	double heap_load_ms = 0.0;
+	double pool_load_ms = 0.0;
+	// objects in the scene after each load
+	uint heap_loaded = 0;
+	uint pool_loaded = 0;
+};
+
+// load a generated binary scene with the ObjectAllocator off and on, counting the allocations and the memory
+static void BenchmarkObjectMemory(uint objects_count, ObjectMemoryBenchmark* benchmark)
+{
+	*benchmark = ObjectMemoryBenchmark();
+
+	TestScene scene(objects_count);
+	if (!scene.IsReady())
+		return;
+	App->objects->SaveSceneBinary(TEST_SCENE_BINARY_FILE, "NONE");
+
+	bool pools = ObjectAllocator::enabled;
+	uint allocations[2] = { 0, 0 };
+	uint bytes[2] = { 0, 0 };
+	double ms[2] = { 0.0, 0.0 };
+	uint loaded[2] = { 0, 0 };
+
+	// the first load puts the objects in the heap, the second in the pools
+	for (uint pass = 0; pass < 2; ++pass) {
+		ObjectAllocator::enabled = pass == 1;
+		// the load starts from an empty scene and pools, the memory of the last objects is not reused
+		App->objects->ClearScene();
+		ObjectAllocator::ReleaseUnused();
+
+		sMStats before = m_getMemoryStatistics();
+		j1PerfTimer timer;
+		App->objects->LoadScene(TEST_SCENE_BINARY_FILE, false);
+		ms[pass] = timer.ReadMs();
+		sMStats after = m_getMemoryStatistics();
+		allocations[pass] = after.accumulatedAllocUnitCount - before.accumulatedAllocUnitCount;
+		bytes[pass] = after.totalReportedMemory - before.totalReportedMemory;
+		loaded[pass] = TestScene::CountObjects(scene.GetRoot());
+	}
+	ObjectAllocator::enabled = pools;
+	remove(TEST_SCENE_BINARY_FILE);
+
+	benchmark->objects = objects_count;
+	benchmark->object_size = sizeof(GameObject);
+	benchmark->heap_allocations = allocations[0];
+	benchmark->pool_allocations = allocations[1];
+	benchmark->heap_bytes_per_object = (objects_count > 0) ? (double)bytes[0] / objects_count : 0.0;
+	benchmark->pool_bytes_per_object = (objects_count > 0) ? (double)bytes[1] / objects_count : 0.0;
+	benchmark->heap_load_ms = ms[0];
+	benchmark->pool_load_ms = ms[1];
+	benchmark->heap_loaded = loaded[0];
+	benchmark->pool_loaded = loaded[1];
+}
+
+// loading a generated binary scene with the objects and components in the heap and in the pools of the
+// ObjectAllocator, counting the allocations and the memory of each object
+bool TestObjectMemory()
+{
+	const uint objects = 100000;
+
+	ObjectMemoryBenchmark benchmark;
+	BenchmarkObjectMemory(objects, &benchmark);
+	TEST_CHECK(benchmark.objects == objects);
+	TestReport("GameObject of %u bytes", benchmark.object_size);
+	TestReport("heap:  %9.3f ms, %8u allocations, %7.1f bytes per object", benchmark.heap_load_ms, benchmark.heap_allocations, benchmark.heap_bytes_per_object);
+	TestReport("pools: %9.3f ms, %8u allocations, %7.1f bytes per object", benchmark.pool_load_ms, benchmark.pool_allocations, benchmark.pool_bytes_per_object);
+
+	// the same scene from both, with less allocations from the pools
+	TEST_CHECK(benchmark.heap_loaded == objects);
+	TEST_CHECK(benchmark.pool_loaded == objects);
+	TEST_CHECK(benchmark.pool_allocations < benchmark.heap_allocations);
+
+	return true;
+}
@@ -0,0 +1,184 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleCamera3D.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "ComponentCamera.h"
+#include "FrustumCulling.h"
+#include "Octree.h"
+#include "j1PerfTimer.h"
+
+struct OctreeBuildBenchmark {
+	uint objects = 0;
+	// best of the builds of all the objects at once in the calling thread and with the ThreadPool
+	double single_thread_ms = 0.0;
+	double parallel_ms = 0.0;
+	uint single_thread_nodes = 0;
+	uint parallel_nodes = 0;
+	uint parallel_objects = 0;
+};
+
+struct OctreeBenchmark {
+	uint objects = 0;
+	uint nodes = 0;
+	uint bytes = 0;
+	double build_ms = 0.0;
+	// ms of the draw list of the editor camera from the octree
+	double traversal_ms = 0.0;
+	// ms of removing a tenth of the objects one by one and inserting them again
+	double remove_ms = 0.0;
+	double insert_ms = 0.0;
+	// ms of moving an object far outside the root
+	double grow_ms = 0.0;
+	// objects in the draw list, and inside the frustum testing all of them, after the changes
+	uint drawn = 0;
+	uint brute_drawn = 0;
+	// objects the octree doesn't find after the changes
+	uint missing = 0;
+};
+
+// build an octree of the objects of a generated scene builds times in one thread and in parallel, keeping the best
+static void BenchmarkOctreeBuild(uint objects_count, uint builds, OctreeBuildBenchmark* benchmark)
+{
+	*benchmark = OctreeBuildBenchmark();
+
+	TestScene scene(objects_count, 1);
+	if (!scene.IsReady())
+		return;
+	App->objects->transform_hierarchy.Update(scene.GetRoot());
+
+	// the generated objects are not static, they are only in this octree
+	Octree octree;
+	octree.SetBucket(App->objects->octree.GetBucket());
+	for (uint i = 0; i < builds; ++i) {
+		octree.parallel_build = false;
+		octree.Build(scene.objects);
+		if (i == 0 || octree.GetLastBuildMs() < benchmark->single_thread_ms) {
+			benchmark->single_thread_ms = octree.GetLastBuildMs();
+		}
+		benchmark->single_thread_nodes = octree.GetNodesCount();
+
+		octree.parallel_build = true;
+		octree.Build(scene.objects);
+		if (i == 0 || octree.GetLastBuildMs() < benchmark->parallel_ms) {
+			benchmark->parallel_ms = octree.GetLastBuildMs();
+		}
+		benchmark->parallel_nodes = octree.GetNodesCount();
+		benchmark->parallel_objects = octree.GetObjectsCount();
+	}
+	octree.Clear();
+	benchmark->objects = objects_count;
+}
+
+// build an octree of the objects of a generated scene, cull it with the editor camera, remove and insert a tenth of
+// the objects and move one far outside the root, checking the octree still has all of them
+static void BenchmarkOctree(uint objects_count, OctreeBenchmark* benchmark)
+{
+	*benchmark = OctreeBenchmark();
+
+	TestScene scene(objects_count, 1);
+	if (!scene.IsReady())
+		return;
+	const std::vector<GameObject*>& objects = scene.objects;
+	App->objects->transform_hierarchy.Update(scene.GetRoot());
+
+	// the generated objects are not static, they are only in this octree
+	Octree octree;
+	octree.SetBucket(App->objects->octree.GetBucket());
+	octree.Build(objects);
+	benchmark->build_ms = octree.GetLastBuildMs();
+	benchmark->nodes = octree.GetNodesCount();
+	benchmark->bytes = octree.GetBytesUsed();
+
+	const ComponentCamera* camera = App->camera->fake_camera;
+	FrustumCulling frustum(TestScene::GetFrustum(camera));
+	std::vector<std::pair<float, GameObject*>> to_draw;
+	to_draw.reserve(objects.size());
+	const uint traversals = 10;
+	for (uint i = 0; i < traversals; ++i) {
+		to_draw.clear();
+		octree.SetStaticDrawList(&to_draw, camera, frustum);
+		benchmark->traversal_ms += octree.GetLastTraversalMs() / traversals;
+	}
+
+	j1PerfTimer timer;
+	for (uint i = 0; i < objects.size(); i += 10) {
+		octree.Remove(objects[i], false);
+	}
+	benchmark->remove_ms = timer.ReadMs();
+
+	timer.Start();
+	for (uint i = 0; i < objects.size(); i += 10) {
+		octree.Insert(objects[i], false);
+	}
+	benchmark->insert_ms = timer.ReadMs();
+
+	if (!objects.empty()) {
+		ComponentTransform* transform = (ComponentTransform*)objects[0]->GetComponent(ComponentType::TRANSFORM);
+		transform->SetLocalPosition(10000.0F, 0.0F, -10000.0F);
+		App->objects->transform_hierarchy.Update(scene.GetRoot());
+		timer.Start();
+		octree.UpdateObject(objects[0]);
+		benchmark->grow_ms = timer.ReadMs();
+	}
+
+	to_draw.clear();
+	octree.SetStaticDrawList(&to_draw, camera, frustum);
+	benchmark->drawn = to_draw.size();
+
+	for (uint i = 0; i < objects.size(); ++i) {
+		ComponentMesh* mesh = (ComponentMesh*)objects[i]->GetComponent(ComponentType::MESH);
+		if (frustum.IsInside(TestScene::GetGlobalAABB(mesh))) {
+			++benchmark->brute_drawn;
+		}
+		if (!octree.Exists(objects[i])) {
+			++benchmark->missing;
+		}
+	}
+	if (octree.GetObjectsCount() != objects.size()) {
+		++benchmark->missing;
+	}
+
+	octree.Clear();
+	benchmark->objects = objects_count;
+}
+
+// building the octree with all the objects at once, in one thread and with the subtrees in the ThreadPool
+bool TestOctreeBuild()
+{
+	const uint objects[] = { 1000, 10000, 100000 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		OctreeBuildBenchmark benchmark;
+		BenchmarkOctreeBuild(objects[i], 5, &benchmark);
+		TEST_CHECK(benchmark.objects == objects[i]);
+		TestReport("%6u objects: %8.3f ms in one thread, %8.3f ms in parallel (%.1fx), %u nodes", objects[i], benchmark.single_thread_ms,
+			benchmark.parallel_ms, (benchmark.parallel_ms > 0.0) ? benchmark.single_thread_ms / benchmark.parallel_ms : 0.0, benchmark.parallel_nodes);
+		// the same tree with the nodes in another order
+		TEST_CHECK(benchmark.parallel_objects == objects[i]);
+		TEST_CHECK(benchmark.parallel_nodes == benchmark.single_thread_nodes);
+	}
+
+	return true;
+}
+
+// the octree in a node pool with the objects in flat ranges, culled, changed one object at a time and grown
+bool TestOctree()
+{
+	const uint objects[] = { 1000, 10000, 100000 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		OctreeBenchmark benchmark;
+		BenchmarkOctree(objects[i], &benchmark);
+		TEST_CHECK(benchmark.objects == objects[i]);
+		TestReport("%6u objects: %6u nodes, %8.1f KB, build %8.3f ms, culling %7.3f ms, remove %7.3f ms and insert %7.3f ms of %u, grow %.3f ms",
+			objects[i], benchmark.nodes, benchmark.bytes / 1024.0, benchmark.build_ms, benchmark.traversal_ms, benchmark.remove_ms, benchmark.insert_ms,
+			objects[i] / 10, benchmark.grow_ms);
+		TEST_CHECK(benchmark.missing == 0);
+		TEST_CHECK(benchmark.drawn == benchmark.brute_drawn);
+	}
+
+	return true;
+}
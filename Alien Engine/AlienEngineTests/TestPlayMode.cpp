@@ -0,0 +1,113 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ComponentTransform.h"
+#include "j1PerfTimer.h"
+#include <stdio.h>
+#include <cmath>
+
+struct PlayModeBenchmark {
+	uint objects = 0;
+	// the save and load of the scene files the play mode used before
+	double json_ms = 0.0;
+	double binary_ms = 0.0;
+	double snapshot_ms = 0.0;
+	double restore_ms = 0.0;
+	// with a tenth of the objects moved in the play mode
+	double restore_changed_ms = 0.0;
+	uint reused_changed = 0;
+	uint loaded_changed = 0;
+	// objects after the restore, and how far the local positions of all of them are from the ones before the play mode
+	uint restored = 0;
+	double position_error = 0.0;
+};
+
+// the objects of the scene parents first, and the sum of their local positions to compare the scene before and after
+static double GatherObjects(std::vector<GameObject*>* objects)
+{
+	const std::vector<GameObject*>& children = TestScene::GetChildren(App->objects->GetRoot(true));
+	objects->assign(children.begin(), children.end());
+	for (uint i = 0; i < objects->size(); ++i) {
+		const std::vector<GameObject*>& grandchildren = TestScene::GetChildren((*objects)[i]);
+		objects->insert(objects->end(), grandchildren.begin(), grandchildren.end());
+	}
+	double positions_sum = 0.0;
+	for (uint i = 0; i < objects->size(); ++i) {
+		float3 position = TestScene::GetComponent<ComponentTransform>((*objects)[i])->GetLocalPosition();
+		positions_sum += (double)position.x + (double)position.y + (double)position.z;
+	}
+	return positions_sum;
+}
+
+// enter and leave the play mode of a generated scene with the scene files and with the snapshot, with nothing
+// changed and with a tenth of the objects moved
+static void BenchmarkPlayMode(uint objects_count, PlayModeBenchmark* benchmark)
+{
+	*benchmark = PlayModeBenchmark();
+
+	TestScene scene(objects_count);
+	if (!scene.IsReady())
+		return;
+	ModuleObjects* module = App->objects;
+	benchmark->objects = objects_count;
+
+	// what entering and leaving the play mode cost with the scene files
+	j1PerfTimer timer;
+	module->SaveSceneJSON(TEST_SCENE_JSON_FILE, "NONE");
+	module->LoadScene(TEST_SCENE_JSON_FILE, false);
+	benchmark->json_ms = timer.ReadMs();
+	timer.Start();
+	module->SaveSceneBinary(TEST_SCENE_BINARY_FILE, "NONE");
+	module->LoadScene(TEST_SCENE_BINARY_FILE, false);
+	benchmark->binary_ms = timer.ReadMs();
+	remove(TEST_SCENE_JSON_FILE);
+	remove(TEST_SCENE_BINARY_FILE);
+
+	// nothing changed in the play mode
+	timer.Start();
+	module->TakePlaySnapshot();
+	benchmark->snapshot_ms = timer.ReadMs();
+	timer.Start();
+	module->RestorePlaySnapshot();
+	benchmark->restore_ms = timer.ReadMs();
+
+	// a tenth of the objects moved
+	module->TakePlaySnapshot();
+	std::vector<GameObject*> objects;
+	double positions_before = GatherObjects(&objects);
+	for (uint i = 0; i < objects.size(); i += 10) {
+		ComponentTransform* transform = TestScene::GetComponent<ComponentTransform>(objects[i]);
+		transform->SetLocalPosition(transform->GetLocalPosition() + float3(0.0F, 1.0F, 0.0F));
+	}
+	timer.Start();
+	module->RestorePlaySnapshot();
+	benchmark->restore_changed_ms = timer.ReadMs();
+	benchmark->reused_changed = module->play_objects_reused;
+	benchmark->loaded_changed = module->play_objects_loaded;
+	double positions_after = GatherObjects(&objects);
+	benchmark->restored = objects.size();
+	benchmark->position_error = std::abs(positions_after - positions_before);
+}
+
+// entering and leaving the play mode with the scene files against the snapshot in memory, which loads
+// again only the objects that changed
+bool TestPlayMode()
+{
+	const uint objects = 100000;
+
+	PlayModeBenchmark benchmark;
+	BenchmarkPlayMode(objects, &benchmark);
+	TEST_CHECK(benchmark.objects == objects);
+	TestReport("%u objects: scene files %9.3f ms JSON, %9.3f ms binary", objects, benchmark.json_ms, benchmark.binary_ms);
+	TestReport("snapshot %9.3f ms, restore %9.3f ms, restore with a tenth moved %9.3f ms (%u reused, %u loaded)", benchmark.snapshot_ms,
+		benchmark.restore_ms, benchmark.restore_changed_ms, benchmark.reused_changed, benchmark.loaded_changed);
+
+	// the scene is back as it was, with the objects that didn't move kept
+	TEST_CHECK(benchmark.restored == objects);
+	TEST_CHECK(benchmark.position_error < 0.001);
+	TEST_CHECK(benchmark.loaded_changed > 0 && benchmark.loaded_changed < objects);
+	TEST_CHECK(benchmark.reused_changed > 0);
+
+	return true;
+}
@@ -0,0 +1,112 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "GameObject.h"
+#include "GameObjectPool.h"
+#include "ResourcePrefab.h"
+#include "j1PerfTimer.h"
+#include <algorithm>
+#include "mmgr/mmgr.h"
+
+struct PoolBenchmark {
+	uint frames = 0;
+	uint spawns_per_frame = 0;
+	// heap allocations and ms per frame creating and deleting the objects, and spawning them from the pool
+	double instantiate_allocations = 0.0;
+	double pool_allocations = 0.0;
+	double instantiate_ms = 0.0;
+	double pool_ms = 0.0;
+	// instances the pool had to create in the frames, after it was prewarmed
+	uint pool_created = 0;
+};
+
+// spawn spawns_per_frame instances of the first prefab of the project each frame in an empty scene and remove the
+// ones a second old, creating and deleting them and with the object pool
+static void BenchmarkPool(uint frames, uint spawns_per_frame, PoolBenchmark* benchmark)
+{
+	*benchmark = PoolBenchmark();
+
+	ResourcePrefab* prefab = TestScene::GetFirstPrefab();
+	if (prefab == nullptr)
+		return;
+	TestScene scene;
+	if (!scene.IsReady())
+		return;
+
+	GameObjectPool& object_pool = App->objects->object_pool;
+	// the objects live a second at 60 fps, the slots of a frame are used again 60 frames later
+	const uint lifetime = 60;
+	std::vector<GameObject*> alive(lifetime * spawns_per_frame, nullptr);
+	uint allocations[2] = { 0, 0 };
+	double ms[2] = { 0.0, 0.0 };
+
+	// the first pass loads and deletes every object like Tank and Bullet did, the second spawns them from the pool
+	for (uint pass = 0; pass < 2; ++pass) {
+		GameObject* root = scene.GetRoot();
+		std::fill(alive.begin(), alive.end(), nullptr);
+		if (pass == 1) {
+			object_pool.Prewarm(prefab, alive.size(), root);
+		}
+		uint created = object_pool.created;
+
+		for (uint frame = 0; frame < frames; ++frame) {
+			uint frame_allocations = m_getMemoryStatistics().accumulatedAllocUnitCount;
+			j1PerfTimer timer;
+			GameObject** slots = &alive[(frame % lifetime) * spawns_per_frame];
+			for (uint i = 0; i < spawns_per_frame; ++i) {
+				if (pass == 0) {
+					if (slots[i] != nullptr) {
+						GameObject::DestroyInstantly(slots[i]);
+					}
+					prefab->ConvertToGameObjects(root, -1, { 0,0,0 }, false);
+					slots[i] = TestScene::GetChildren(root).back();
+				}
+				else {
+					if (slots[i] != nullptr) {
+						object_pool.Despawn(slots[i]);
+					}
+					slots[i] = object_pool.Spawn(prefab, { 0,0,0 }, root);
+				}
+			}
+			ms[pass] += timer.ReadMs();
+			allocations[pass] += m_getMemoryStatistics().accumulatedAllocUnitCount - frame_allocations;
+		}
+		if (pass == 1) {
+			benchmark->pool_created = object_pool.created - created;
+		}
+
+		// the scripts of the instances find their objects before they are deleted with them, the pool forgets its
+		// instances when they are deleted
+		App->objects->ResolveScriptObjects();
+		App->objects->ClearScene();
+	}
+
+	benchmark->frames = frames;
+	benchmark->spawns_per_frame = spawns_per_frame;
+	benchmark->instantiate_allocations = (frames > 0) ? (double)allocations[0] / frames : 0.0;
+	benchmark->pool_allocations = (frames > 0) ? (double)allocations[1] / frames : 0.0;
+	benchmark->instantiate_ms = (frames > 0) ? ms[0] / frames : 0.0;
+	benchmark->pool_ms = (frames > 0) ? ms[1] / frames : 0.0;
+}
+
+// spawning instances of the first prefab every frame and removing the ones a second old, creating and
+// deleting them like before against the object pool
+bool TestPool()
+{
+	const uint frames = 120;
+	const uint spawns_per_frame = 50;
+
+	PoolBenchmark benchmark;
+	BenchmarkPool(frames, spawns_per_frame, &benchmark);
+	TEST_CHECK(benchmark.frames == frames);
+	TestReport("%u spawns per frame, %u frames", spawns_per_frame, frames);
+	TestReport("instantiate: %9.1f allocations, %8.3f ms per frame", benchmark.instantiate_allocations, benchmark.instantiate_ms);
+	TestReport("pool:        %9.1f allocations, %8.3f ms per frame", benchmark.pool_allocations, benchmark.pool_ms);
+
+	// the prewarmed instances are enough for a second of spawns, none is created in the frames
+	TEST_CHECK(benchmark.pool_created == 0);
+	TEST_CHECK(benchmark.pool_allocations < benchmark.instantiate_allocations);
+
+	return true;
+}
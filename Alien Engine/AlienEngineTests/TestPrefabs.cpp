@@ -0,0 +1,83 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleResources.h"
+#include "ResourcePrefab.h"
+#include "j1PerfTimer.h"
+#include <string>
+
+struct PrefabBenchmark {
+	std::string name;
+	uint count = 0;
+	// instances parsing the library file and from the compiled template
+	double library_per_second = 0.0;
+	double compiled_per_second = 0.0;
+	// objects created by all the instances of each pass
+	uint library_objects = 0;
+	uint compiled_objects = 0;
+};
+
+// instantiate the first prefab of the project count times in an empty scene parsing its library file each time,
+// and from its compiled template
+static void BenchmarkPrefabs(uint count, PrefabBenchmark* benchmark)
+{
+	*benchmark = PrefabBenchmark();
+
+	ResourcePrefab* prefab = TestScene::GetFirstPrefab();
+	if (prefab == nullptr)
+		return;
+	TestScene scene;
+	if (!scene.IsReady())
+		return;
+
+	bool compiled = App->resources->use_compiled_prefabs;
+	double per_second[2] = { 0.0, 0.0 };
+	uint objects[2] = { 0, 0 };
+
+	// the first pass parses the library file for every instance, the second compiles it once
+	for (uint pass = 0; pass < 2; ++pass) {
+		App->resources->use_compiled_prefabs = pass == 1;
+		prefab->InvalidateCompiled();
+		GameObject* root = scene.GetRoot();
+
+		j1PerfTimer timer;
+		for (uint i = 0; i < count; ++i) {
+			prefab->ConvertToGameObjects(root, -1, { 0,0,0 }, false);
+		}
+		double ms = timer.ReadMs();
+		per_second[pass] = (ms > 0.0) ? count * 1000.0 / ms : 0.0;
+		objects[pass] = TestScene::CountObjects(root);
+
+		// the scripts of the instances find their objects before they are deleted with them
+		App->objects->ResolveScriptObjects();
+		App->objects->ClearScene();
+	}
+	App->resources->use_compiled_prefabs = compiled;
+
+	benchmark->name = prefab->GetName();
+	benchmark->count = count;
+	benchmark->library_per_second = per_second[0];
+	benchmark->compiled_per_second = per_second[1];
+	benchmark->library_objects = objects[0];
+	benchmark->compiled_objects = objects[1];
+}
+
+// instantiating the first prefab of the project parsing its library file for each instance like before,
+// against its compiled template
+bool TestPrefabs()
+{
+	const uint count = 1000;
+
+	PrefabBenchmark benchmark;
+	BenchmarkPrefabs(count, &benchmark);
+	TEST_CHECK(benchmark.count == count);
+	TestReport("%s x%u: %9.0f per second parsing the library file, %9.0f per second compiled (%.1fx)", benchmark.name.data(), count,
+		benchmark.library_per_second, benchmark.compiled_per_second, (benchmark.library_per_second > 0.0) ? benchmark.compiled_per_second / benchmark.library_per_second : 0.0);
+
+	// the template gives the same objects as the file
+	TEST_CHECK(benchmark.library_objects >= count);
+	TEST_CHECK(benchmark.compiled_objects == benchmark.library_objects);
+
+	return true;
+}
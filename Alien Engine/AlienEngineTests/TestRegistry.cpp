@@ -0,0 +1,91 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleResources.h"
+#include "Resource_.h"
+#include "j1PerfTimer.h"
+
+struct RegistryBenchmark {
+	uint resources = 0;
+	// searches by ID and by path
+	uint lookups = 0;
+	double hash_ms = 0.0;
+	double scan_ms = 0.0;
+	// searches where the registry didn't give the resource that iterating the resources finds first
+	uint mismatches = 0;
+};
+
+// search some of the resources by ID and by path with the registry and iterating the resources like before
+static void BenchmarkRegistry(uint lookups, RegistryBenchmark* benchmark)
+{
+	*benchmark = RegistryBenchmark();
+	std::vector<Resource*>& resources = App->resources->resources;
+	if (resources.empty())
+		return;
+
+	// the same resources spread over the list for both searches
+	std::vector<Resource*> to_find;
+	for (uint i = 0; i < lookups; ++i) {
+		Resource* resource = resources[(i * 7919) % resources.size()];
+		if (resource != nullptr)
+			to_find.push_back(resource);
+	}
+
+	std::vector<Resource*> hashed;
+	hashed.reserve(to_find.size() * 2);
+	j1PerfTimer timer;
+	std::vector<Resource*>::iterator item = to_find.begin();
+	for (; item != to_find.end(); ++item) {
+		hashed.push_back(App->resources->registry.GetByID((*item)->GetID()));
+		hashed.push_back(App->resources->registry.GetByPath((*item)->GetAssetsPath()));
+	}
+	benchmark->hash_ms = timer.ReadMs();
+
+	std::vector<Resource*> scanned;
+	scanned.reserve(to_find.size() * 2);
+	timer.Start();
+	for (item = to_find.begin(); item != to_find.end(); ++item) {
+		Resource* found = nullptr;
+		std::vector<Resource*>::iterator resource = resources.begin();
+		for (; resource != resources.end(); ++resource) {
+			if (*resource != nullptr && (*resource)->GetID() == (*item)->GetID()) {
+				found = *resource;
+				break;
+			}
+		}
+		scanned.push_back(found);
+
+		found = nullptr;
+		for (resource = resources.begin(); resource != resources.end(); ++resource) {
+			if (*resource != nullptr && App->StringCmp((*item)->GetAssetsPath(), (*resource)->GetAssetsPath())) {
+				found = *resource;
+				break;
+			}
+		}
+		scanned.push_back(found);
+	}
+	benchmark->scan_ms = timer.ReadMs();
+
+	for (uint i = 0; i < hashed.size(); ++i) {
+		if (hashed[i] != scanned[i]) {
+			++benchmark->mismatches;
+		}
+	}
+	benchmark->resources = resources.size();
+	benchmark->lookups = hashed.size();
+}
+
+// the resources of the assets found by ID and by path with the hash indices of the registry against
+// iterating the resources like before, both must find the same one
+bool TestRegistry()
+{
+	RegistryBenchmark benchmark;
+	BenchmarkRegistry(10000, &benchmark);
+	TestReport("%u resources, %u lookups: %8.3f ms iterating, %8.3f ms hashed (%.1fx)", benchmark.resources, benchmark.lookups,
+		benchmark.scan_ms, benchmark.hash_ms, (benchmark.hash_ms > 0.0) ? benchmark.scan_ms / benchmark.hash_ms : 0.0);
+
+	TEST_CHECK(benchmark.resources > 0);
+	TEST_CHECK(benchmark.lookups > 0);
+	TEST_CHECK(benchmark.mismatches == 0);
+
+	return true;
+}
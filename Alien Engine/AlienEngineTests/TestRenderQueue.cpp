@@ -0,0 +1,107 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleCamera3D.h"
+#include "ComponentTransform.h"
+#include "ComponentCamera.h"
+#include "RenderQueue.h"
+#include "j1PerfTimer.h"
+#include <algorithm>
+
+struct RenderQueueBenchmark {
+	uint objects = 0;
+	// ms per frame of filling a new list, decomposing the matrices for the distance, and std::sort by distance
+	double old_build_ms = 0.0;
+	double old_sort_ms = 0.0;
+	// ms per frame of filling the render queue of the camera and creating the keys and radix sorting them
+	double queue_build_ms = 0.0;
+	double queue_sort_ms = 0.0;
+	// items in the queue and pairs of them out of order after the last sort
+	uint count = 0;
+	uint unsorted = 0;
+};
+
+// fill the draw list of the editor camera with every object of a generated scene each frame and sort it, in a new
+// list with std::sort like before and in a RenderQueue
+static void BenchmarkRenderQueue(uint objects_count, uint frames, RenderQueueBenchmark* benchmark)
+{
+	*benchmark = RenderQueueBenchmark();
+
+	TestScene scene(objects_count, 1);
+	if (!scene.IsReady())
+		return;
+	const std::vector<GameObject*>& objects = scene.objects;
+	App->objects->transform_hierarchy.Update(scene.GetRoot());
+
+	// all the objects are visible, without the culling both ways only differ in the list and the sort
+	const Frustum& frustum = TestScene::GetFrustum(App->camera->fake_camera);
+	RenderQueue render_queue;
+	j1PerfTimer timer;
+	for (uint i = 0; i < frames; ++i) {
+		timer.Start();
+		std::vector<std::pair<float, GameObject*>> to_draw;
+		std::vector<GameObject*>::const_iterator item = objects.cbegin();
+		for (; item != objects.cend(); ++item) {
+			float3 pos, scale;
+			Quat rot;
+			((ComponentTransform*)(*item)->GetComponent(ComponentType::TRANSFORM))->GetGlobalMatrix().Decompose(pos, rot, scale);
+			to_draw.push_back({ frustum.pos.Distance(pos), *item });
+		}
+		benchmark->old_build_ms += timer.ReadMs();
+
+		timer.Start();
+		std::sort(to_draw.begin(), to_draw.end(), [](const std::pair<float, GameObject*> a, const std::pair<float, GameObject*> b) {
+			return a.first > b.first;
+		});
+		benchmark->old_sort_ms += timer.ReadMs();
+
+		timer.Start();
+		std::vector<std::pair<float, GameObject*>>* visible = render_queue.Begin(frustum);
+		for (item = objects.cbegin(); item != objects.cend(); ++item) {
+			float3 pos = ((ComponentTransform*)(*item)->GetComponent(ComponentType::TRANSFORM))->GetGlobalPosition();
+			visible->push_back({ frustum.pos.Distance(pos), *item });
+		}
+		benchmark->queue_build_ms += timer.ReadMs();
+
+		render_queue.Sort();
+		benchmark->queue_sort_ms += render_queue.GetLastSortMs();
+	}
+
+	if (frames > 0) {
+		benchmark->old_build_ms /= frames;
+		benchmark->old_sort_ms /= frames;
+		benchmark->queue_build_ms /= frames;
+		benchmark->queue_sort_ms /= frames;
+	}
+
+	const std::vector<RenderQueueItem>& items = render_queue.GetItems();
+	benchmark->count = render_queue.GetCount();
+	for (uint i = 1; i < items.size(); ++i) {
+		if (items[i - 1].key > items[i].key) {
+			++benchmark->unsorted;
+		}
+	}
+	benchmark->objects = objects_count;
+}
+
+// the draw list of a camera with every object visible, filled in a new list and sorted with std::sort
+// against the render queue reusing its memory and radix sorting the keys
+bool TestRenderQueue()
+{
+	const uint objects[] = { 10000, 50000 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		RenderQueueBenchmark benchmark;
+		BenchmarkRenderQueue(objects[i], 10, &benchmark);
+		TEST_CHECK(benchmark.objects == objects[i]);
+		TestReport("%6u objects: %8.3f ms building + %8.3f ms sorting before, %8.3f ms building + %8.3f ms sorting now (%.1fx)", objects[i],
+			benchmark.old_build_ms, benchmark.old_sort_ms, benchmark.queue_build_ms, benchmark.queue_sort_ms,
+			(benchmark.queue_build_ms + benchmark.queue_sort_ms > 0.0) ? (benchmark.old_build_ms + benchmark.old_sort_ms) / (benchmark.queue_build_ms + benchmark.queue_sort_ms) : 0.0);
+		// every object once and the keys in order
+		TEST_CHECK(benchmark.count == objects[i]);
+		TEST_CHECK(benchmark.unsorted == 0);
+	}
+
+	return true;
+}
@@ -0,0 +1,106 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleResources.h"
+#include "ModuleObjects.h"
+#include "ResourceMesh.h"
+#include "j1PerfTimer.h"
+
+// resources referenced and released by the benchmark
+#define RESIDENCY_TEST_MAX_RESOURCES 256
+
+struct ResidencyBenchmark {
+	uint resources = 0;
+	double cached_ms = 0.0;
+	double uncached_ms = 0.0;
+	uint hits = 0;
+	// meshes loaded with the CPU copies dropped that can't be picked by their triangles
+	uint unpickable = 0;
+};
+
+// reference and release the unused meshes and textures again and again, with the cache and without it, and load
+// them once dropping the CPU copies
+static void BenchmarkResidency(uint iterations, ResidencyBenchmark* benchmark)
+{
+	*benchmark = ResidencyBenchmark();
+	ModuleResources* resources = App->resources;
+
+	// only the resources nothing uses, the scene doesn't notice it
+	std::vector<Resource*> to_churn;
+	std::vector<Resource*>::iterator item = resources->resources.begin();
+	for (; item != resources->resources.end() && to_churn.size() < RESIDENCY_TEST_MAX_RESOURCES; ++item) {
+		if (*item != nullptr && ((*item)->GetType() == ResourceType::RESOURCE_MESH || (*item)->GetType() == ResourceType::RESOURCE_TEXTURE)
+			&& (*item)->references == 0 && !(*item)->loading && (*item)->IsReloadable()) {
+			to_churn.push_back(*item);
+		}
+	}
+	if (to_churn.empty() || !App->objects->enable_instancies)
+		return;
+
+	// the loads are synchronous so the time includes reading the files
+	bool async = resources->async_loading;
+	bool cache = resources->residency.cache_unreferenced;
+	bool drop = resources->residency.drop_cpu_copies;
+	resources->async_loading = false;
+
+	resources->residency.cache_unreferenced = false;
+	j1PerfTimer timer;
+	for (uint i = 0; i < iterations; ++i) {
+		for (item = to_churn.begin(); item != to_churn.end(); ++item) {
+			(*item)->IncreaseReferences();
+			(*item)->DecreaseReferences();
+		}
+	}
+	benchmark->uncached_ms = timer.ReadMs();
+
+	resources->residency.cache_unreferenced = true;
+	uint hits = resources->residency.GetHits();
+	timer.Start();
+	for (uint i = 0; i < iterations; ++i) {
+		for (item = to_churn.begin(); item != to_churn.end(); ++item) {
+			(*item)->IncreaseReferences();
+			(*item)->DecreaseReferences();
+		}
+	}
+	benchmark->cached_ms = timer.ReadMs();
+	benchmark->hits = resources->residency.GetHits() - hits;
+	benchmark->resources = to_churn.size();
+
+	// loaded again from the files, the cached ones still have their arrays
+	resources->residency.cache_unreferenced = false;
+	resources->residency.FreeCache();
+	resources->residency.drop_cpu_copies = true;
+	for (item = to_churn.begin(); item != to_churn.end(); ++item) {
+		(*item)->IncreaseReferences();
+		if ((*item)->GetType() == ResourceType::RESOURCE_MESH) {
+			ResourceMesh* mesh = (ResourceMesh*)*item;
+			if (mesh->num_index > 0 && (mesh->vertex == nullptr || mesh->index == nullptr)) {
+				++benchmark->unpickable;
+			}
+		}
+		(*item)->DecreaseReferences();
+	}
+
+	resources->async_loading = async;
+	resources->residency.cache_unreferenced = cache;
+	resources->residency.drop_cpu_copies = drop;
+}
+
+// the meshes and textures nothing uses referenced and released again and again with the cache of unreferenced
+// resources and without it, and loaded once dropping the CPU copies
+bool TestResidency()
+{
+	const uint iterations = 10;
+
+	ResidencyBenchmark benchmark;
+	BenchmarkResidency(iterations, &benchmark);
+	TestReport("%u resources x %u: %9.3f ms without cache, %9.3f ms cached (%u hits)", benchmark.resources, iterations,
+		benchmark.uncached_ms, benchmark.cached_ms, benchmark.hits);
+
+	TEST_CHECK(benchmark.resources > 0);
+	// the ones that fit in the budgets come back from the cache
+	TEST_CHECK(benchmark.hits > 0);
+	// the editor picks the meshes by their triangles
+	TEST_CHECK(benchmark.unpickable == 0);
+
+	return true;
+}
@@ -0,0 +1,160 @@
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleResources.h"
+#include "ModuleFileSystem.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "ComponentMaterial.h"
+#include "ComponentCamera.h"
+#include "ResourcePrefab.h"
+#include "Time.h"
+#include <stdio.h>
+#include <string>
+
+TestScene::TestScene(uint objects_count, uint depth)
+{
+	// the scripts would start and stop with every load
+	if (Time::IsInGameState())
+		return;
+
+	// the way the prefab scenes save the scene they replace
+	scene = App->objects->current_scene;
+	App->objects->SaveScene(nullptr, TEST_SCENE_BACKUP_FILE);
+	if (!App->file_system->Exists(TEST_SCENE_BACKUP_FILE))
+		return;
+	ready = true;
+
+	App->objects->ClearScene();
+	GameObject* root = GetRoot();
+	objects.reserve(objects_count);
+	for (uint i = 0; i < objects_count; ++i) {
+		GameObject* parent = nullptr;
+		if (depth == 0) {
+			parent = (i < 8) ? root : objects[i / 8 - 1];
+		}
+		else {
+			parent = (i % depth == 0) ? root : objects[i - 1];
+		}
+		GameObject* object = new GameObject(parent);
+		object->SetName(std::string("Test " + std::to_string(i)).data());
+		object->AddComponent(new ComponentTransform(object, { (float)(i % 100), (float)(i / 10000), (float)(i / 100 % 100) }, Quat::identity(), { 1,1,1 }));
+		ComponentMesh* mesh = new ComponentMesh(object);
+		mesh->mesh = App->resources->GetPrimitive(PrimitiveType::CUBE);
+		object->AddComponent(mesh);
+		object->AddComponent(new ComponentMaterial(object));
+		mesh->RecalculateAABB_OBB();
+		objects.push_back(object);
+	}
+}
+
+TestScene::~TestScene()
+{
+	if (!ready)
+		return;
+
+	// loaded without changing the scene, the undo actions are not deleted
+	App->objects->LoadScene(TEST_SCENE_BACKUP_FILE, false);
+	remove(TEST_SCENE_BACKUP_FILE);
+	App->objects->current_scene = scene;
+}
+
+bool TestScene::IsReady() const
+{
+	return ready;
+}
+
+GameObject* TestScene::GetRoot() const
+{
+	return App->objects->GetRoot(true);
+}
+
+void TestScene::RotateEagerly(ComponentTransform* transform, const Quat& rotation)
+{
+	transform->local_rotation = rotation;
+	transform->local_transformation = float4x4::FromTRS(transform->local_position, transform->local_rotation, transform->local_scale);
+	SolveEagerly(transform);
+}
+
+void TestScene::SolveEagerly(ComponentTransform* transform)
+{
+	GameObject* object = transform->game_object_attached;
+	ComponentTransform* parent = (object->parent != nullptr) ? (ComponentTransform*)object->parent->GetComponent(ComponentType::TRANSFORM) : nullptr;
+	transform->global_transformation = (parent != nullptr) ? parent->global_transformation * transform->local_transformation : transform->local_transformation;
+	transform->is_dirty = false;
+
+	std::vector<GameObject*>::iterator item = object->children.begin();
+	for (; item != object->children.end(); ++item) {
+		if (*item != nullptr) {
+			ComponentTransform* child = (ComponentTransform*)(*item)->GetComponent(ComponentType::TRANSFORM);
+			if (child != nullptr) {
+				SolveEagerly(child);
+			}
+		}
+	}
+
+	ComponentMesh* mesh = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+	if (mesh != nullptr) {
+		mesh->RecalculateAABB_OBB();
+	}
+}
+
+void TestScene::SetMesh(GameObject* object, ResourceMesh* mesh)
+{
+	ComponentMesh* component = (ComponentMesh*)object->GetComponent(ComponentType::MESH);
+	component->mesh = mesh;
+	component->RecalculateAABB_OBB();
+}
+
+const std::vector<GameObject*>& TestScene::GetChildren(const GameObject* object)
+{
+	return object->children;
+}
+
+const std::vector<Component*>& TestScene::GetComponents(const GameObject* object)
+{
+	return object->components;
+}
+
+const ComponentType& TestScene::GetType(const Component* component)
+{
+	return component->GetType();
+}
+
+void TestScene::AddComponent(GameObject* object, Component* component)
+{
+	object->AddComponent(component);
+}
+
+const Frustum& TestScene::GetFrustum(const ComponentCamera* camera)
+{
+	return camera->frustum;
+}
+
+AABB TestScene::GetGlobalAABB(const ComponentMesh* mesh)
+{
+	return mesh->GetGlobalAABB();
+}
+
+uint TestScene::CountObjects(const GameObject* object)
+{
+	uint count = 0;
+	std::vector<GameObject*>::const_iterator item = object->children.cbegin();
+	for (; item != object->children.cend(); ++item) {
+		if (*item != nullptr) {
+			count += 1 + CountObjects(*item);
+		}
+	}
+	return count;
+}
+
+ResourcePrefab* TestScene::GetFirstPrefab()
+{
+	std::vector<Resource*>::const_iterator item = App->resources->resources.cbegin();
+	for (; item != App->resources->resources.cend(); ++item) {
+		if (*item != nullptr && (*item)->GetType() == ResourceType::RESOURCE_PREFAB) {
+			return static_cast<ResourcePrefab*>(*item);
+		}
+	}
+	return nullptr;
+}
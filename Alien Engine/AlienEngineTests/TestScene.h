@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "MathGeoLib/include/MathGeoLib.h"
+#include "GameObject.h"
+
+class Component;
+class ComponentTransform;
+class ComponentMesh;
+class ComponentCamera;
+class ResourceMesh;
+class ResourcePrefab;
+class ResourceScene;
+
+// the scene of the editor while a test runs, loaded back when the fixture goes out of scope
+#define TEST_SCENE_BACKUP_FILE "Library/test_scene_backup.alienScene"
+// the test scene saved by the tests of the formats, removed after them
+#define TEST_SCENE_JSON_FILE "Library/test_scene.json"
+#define TEST_SCENE_BINARY_FILE "Library/test_scene.alienScene"
+
+// Saves the scene of the editor and empties it for a test, the scene is loaded back in the destructor. The undo
+// actions find their objects by ID, they still work after it. The engine keeps the parts of the objects the tests
+// compare against private, they are reached from here
+class TestScene {
+public:
+
+	// objects_count objects with a transform, a mesh and a material. With depth 0 each object has 8 children, else
+	// the objects are in chains of depth
+	TestScene(uint objects_count = 0, uint depth = 0);
+	~TestScene();
+
+	// false if the scene of the editor couldn't be saved or the play mode is running, then nothing was changed
+	bool IsReady() const;
+	GameObject* GetRoot() const;
+
+	// rotate the transform and solve its global matrix, its bounding boxes and the ones of all its children right
+	// away, how the transforms were solved before the TransformHierarchy
+	static void RotateEagerly(ComponentTransform* transform, const Quat& rotation);
+	// change the mesh of a generated object and its bounding boxes
+	static void SetMesh(GameObject* object, ResourceMesh* mesh);
+
+	static const std::vector<GameObject*>& GetChildren(const GameObject* object);
+	static const std::vector<Component*>& GetComponents(const GameObject* object);
+	static const ComponentType& GetType(const Component* component);
+	static void AddComponent(GameObject* object, Component* component);
+	template <class Comp>
+	static Comp* GetComponent(GameObject* object);
+	static const Frustum& GetFrustum(const ComponentCamera* camera);
+	static AABB GetGlobalAABB(const ComponentMesh* mesh);
+	// the objects under object at any depth
+	static uint CountObjects(const GameObject* object);
+	// the prefab the tests instantiate, nullptr if the project has none
+	static ResourcePrefab* GetFirstPrefab();
+
+private:
+
+	static void SolveEagerly(ComponentTransform* transform);
+
+public:
+
+	// the generated objects, parents first
+	std::vector<GameObject*> objects;
+
+private:
+
+	ResourceScene* scene = nullptr;
+	bool ready = false;
+};
+
+template<class Comp>
+inline Comp* TestScene::GetComponent(GameObject* object)
+{
+	return object->GetComponent<Comp>();
+}
@@ -0,0 +1,74 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "j1PerfTimer.h"
+#include <sys/stat.h>
+#include <stdio.h>
+
+struct SceneBenchmark {
+	uint objects = 0;
+	double json_save_ms = 0.0;
+	double json_load_ms = 0.0;
+	uint json_bytes = 0;
+	double binary_save_ms = 0.0;
+	double binary_load_ms = 0.0;
+	uint binary_bytes = 0;
+	// objects in the scene after each load
+	uint json_loaded = 0;
+	uint binary_loaded = 0;
+};
+
+// save a generated scene in JSON and in the binary format and load both back
+static void BenchmarkScenes(uint objects_count, SceneBenchmark* benchmark)
+{
+	*benchmark = SceneBenchmark();
+
+	TestScene scene(objects_count);
+	if (!scene.IsReady())
+		return;
+	benchmark->objects = objects_count;
+
+	j1PerfTimer timer;
+	App->objects->SaveSceneJSON(TEST_SCENE_JSON_FILE, "NONE");
+	benchmark->json_save_ms = timer.ReadMs();
+	timer.Start();
+	App->objects->SaveSceneBinary(TEST_SCENE_BINARY_FILE, "NONE");
+	benchmark->binary_save_ms = timer.ReadMs();
+
+	timer.Start();
+	App->objects->LoadScene(TEST_SCENE_JSON_FILE, false);
+	benchmark->json_load_ms = timer.ReadMs();
+	benchmark->json_loaded = TestScene::CountObjects(scene.GetRoot());
+	timer.Start();
+	App->objects->LoadScene(TEST_SCENE_BINARY_FILE, false);
+	benchmark->binary_load_ms = timer.ReadMs();
+	benchmark->binary_loaded = TestScene::CountObjects(scene.GetRoot());
+
+	struct stat file;
+	benchmark->json_bytes = (stat(TEST_SCENE_JSON_FILE, &file) == 0) ? (uint)file.st_size : 0;
+	benchmark->binary_bytes = (stat(TEST_SCENE_BINARY_FILE, &file) == 0) ? (uint)file.st_size : 0;
+	remove(TEST_SCENE_JSON_FILE);
+	remove(TEST_SCENE_BINARY_FILE);
+}
+
+// saving and loading generated scenes in JSON and in the binary format
+bool TestScenes()
+{
+	const uint objects[] = { 10000, 100000 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		SceneBenchmark benchmark;
+		BenchmarkScenes(objects[i], &benchmark);
+		TEST_CHECK(benchmark.objects == objects[i]);
+		TestReport("%6u objects JSON:   save %9.3f ms, load %9.3f ms, %7.2f MB", objects[i], benchmark.json_save_ms, benchmark.json_load_ms, benchmark.json_bytes / (1024.0F * 1024.0F));
+		TestReport("%6u objects binary: save %9.3f ms, load %9.3f ms, %7.2f MB", objects[i], benchmark.binary_save_ms, benchmark.binary_load_ms, benchmark.binary_bytes / (1024.0F * 1024.0F));
+
+		// both formats give back every object
+		TEST_CHECK(benchmark.json_loaded == objects[i]);
+		TEST_CHECK(benchmark.binary_loaded == objects[i]);
+		TEST_CHECK(benchmark.binary_bytes > 0 && benchmark.binary_bytes < benchmark.json_bytes);
+	}
+
+	return true;
+}
@@ -0,0 +1,113 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleFileSystem.h"
+#include "ResourceMesh.h"
+#include "ResourceStreamer.h"
+#include <stdio.h>
+
+// save the meshes of the models of the directory copies times in the library without adding them. The paths of the
+// files are added to paths and the caller removes them
+static void SaveTestMeshes(const char* directory, uint copies, std::vector<std::string>* paths)
+{
+	std::vector<const aiScene*> scenes;
+	ImportTestModels(directory, &scenes);
+
+	std::vector<const aiScene*>::iterator item = scenes.begin();
+	for (; item != scenes.end(); ++item) {
+		for (uint i = 0; i < (*item)->mNumMeshes; ++i) {
+			ResourceMesh* mesh = new ResourceMesh();
+			ModuleImporter::ConvertMesh(mesh, (*item)->mMeshes[i], App->importer->optimize_meshes, App->importer->generate_lods);
+
+			uint size = 0;
+			char* data = mesh->SerializeMetaData(&size);
+			for (uint j = 0; j < copies; ++j) {
+				std::string path = LIBRARY_MESHES_FOLDER "test_" + std::to_string(paths->size()) + ".alienMesh";
+				App->file_system->Save(path.data(), data, size);
+				paths->push_back(path);
+			}
+			delete[] data;
+			delete mesh;
+		}
+		aiReleaseImport(*item);
+	}
+}
+
+// the meshes of the assets models read by the streamer workers and uploaded a budget of time per frame
+// while the main loop runs, and stopped with loads still queued
+bool TestStreaming()
+{
+	const double budget_ms = 2.0;
+	const uint max_frames = 10000;
+
+	std::vector<std::string> paths;
+	SaveTestMeshes(MODELS_FOLDER, 10, &paths);
+	TEST_CHECK(!paths.empty());
+
+	ResourceStreamer streamer;
+	streamer.Start();
+	TEST_CHECK(streamer.IsRunning());
+
+	std::vector<ResourceMesh*> meshes;
+	for (uint i = 0; i < paths.size(); ++i) {
+		ResourceMesh* mesh = new ResourceMesh();
+		mesh->SetLibraryPath(paths[i].data());
+		meshes.push_back(mesh);
+		streamer.Load(mesh);
+	}
+
+	uint frames = 0;
+	uint frames_uploading = 0;
+	uint frames_over_budget = 0;
+	double max_upload_ms = 0.0;
+	while (frames < max_frames && streamer.GetTotalUploaded() < meshes.size()) {
+		App->Update();
+		streamer.Update(budget_ms);
+		++frames;
+
+		if (streamer.GetLastUploadCount() > 0) {
+			++frames_uploading;
+			if (streamer.GetLastUploadMs() > budget_ms) {
+				++frames_over_budget;
+			}
+			max_upload_ms = Max(max_upload_ms, streamer.GetLastUploadMs());
+		}
+	}
+	TestReport("%u meshes with %u workers in %u frames, %u uploading, %u over the %.1f ms budget", meshes.size(), streamer.GetWorkersCount(),
+		frames, frames_uploading, frames_over_budget, budget_ms);
+	TestReport("%.3f ms the slowest frame, %.3f ms the slowest upload", max_upload_ms, streamer.GetMaxResourceUploadMs());
+
+	TEST_CHECK(streamer.GetTotalUploaded() == meshes.size());
+	TEST_CHECK(streamer.GetPendingCount() == 0);
+	uint not_uploaded = 0;
+	for (uint i = 0; i < meshes.size(); ++i) {
+		if (meshes[i]->loading || meshes[i]->id_vertex == 0) {
+			++not_uploaded;
+		}
+	}
+	TEST_CHECK(not_uploaded == 0);
+	// the budget is checked after each upload, a frame only passes it by the last one
+	TEST_CHECK(max_upload_ms <= budget_ms + streamer.GetMaxResourceUploadMs());
+
+	// stopped with the meshes queued again, none of them is left loading
+	for (uint i = 0; i < meshes.size(); ++i) {
+		meshes[i]->FreeMemory();
+		streamer.Load(meshes[i]);
+	}
+	streamer.Stop();
+	TEST_CHECK(!streamer.IsRunning());
+	uint still_loading = 0;
+	for (uint i = 0; i < meshes.size(); ++i) {
+		if (meshes[i]->loading) {
+			++still_loading;
+		}
+		delete meshes[i];
+	}
+	TEST_CHECK(still_loading == 0);
+
+	for (uint i = 0; i < paths.size(); ++i) {
+		remove(paths[i].data());
+	}
+
+	return true;
+}
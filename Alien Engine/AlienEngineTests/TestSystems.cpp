@@ -0,0 +1,127 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ModuleCamera3D.h"
+#include "ComponentTransform.h"
+#include "ComponentLight.h"
+#include "ComponentCamera.h"
+#include "FrustumCulling.h"
+#include "j1PerfTimer.h"
+
+struct SystemsBenchmark {
+	uint objects = 0;
+	uint lights = 0;
+	uint cameras = 0;
+	uint frames = 0;
+	// ms per frame solving the transforms of the objects moved that frame
+	double transforms_ms = 0.0;
+	// ms per frame of the draw list of the editor camera walking the objects tree like before
+	double tree_ms = 0.0;
+	// the same with the systems over the arrays of the ComponentRegistry, and the time of each system
+	double systems_ms = 0.0;
+	double cameras_ms = 0.0;
+	double lights_ms = 0.0;
+	double meshes_ms = 0.0;
+	// objects in the draw list of both
+	uint tree_drawn = 0;
+	uint systems_drawn = 0;
+};
+
+// the draw list of the editor camera of a generated scene with some lights and cameras, walking the objects tree
+// and with the component systems, moving a hundredth of the objects each frame
+static void BenchmarkSystems(uint objects_count, uint frames, SystemsBenchmark* benchmark)
+{
+	*benchmark = SystemsBenchmark();
+
+	TestScene scene(objects_count);
+	if (!scene.IsReady())
+		return;
+	const std::vector<GameObject*>& objects = scene.objects;
+	for (uint i = 0; i < objects.size(); ++i) {
+		if (i % 1000 == 500) {
+			TestScene::AddComponent(objects[i], new ComponentLight(objects[i]));
+			++benchmark->lights;
+		}
+		if (i % 10000 == 5000) {
+			TestScene::AddComponent(objects[i], new ComponentCamera(objects[i]));
+			++benchmark->cameras;
+		}
+	}
+	ModuleObjects* module = App->objects;
+	module->transform_hierarchy.Update(scene.GetRoot());
+
+	// nothing is drawn and the culling is the same in both, the dynamic tree has its own test
+	bool printing = module->printing_scene;
+	bool systems = module->use_component_systems;
+	bool dynamic_tree = module->use_dynamic_tree;
+	module->printing_scene = false;
+	module->use_dynamic_tree = false;
+	const ComponentCamera* camera = App->camera->fake_camera;
+	FrustumCulling frustum(TestScene::GetFrustum(camera));
+	std::vector<std::pair<float, GameObject*>> to_draw;
+	to_draw.reserve(objects.size());
+
+	j1PerfTimer timer;
+	for (uint frame = 0; frame < frames; ++frame) {
+		for (uint i = frame % 100; i < objects.size(); i += 100) {
+			ComponentTransform* transform = (ComponentTransform*)objects[i]->GetComponent(ComponentType::TRANSFORM);
+			transform->SetLocalRotation(Quat::RotateY(0.01F * (frame + 1)));
+		}
+		timer.Start();
+		module->transform_hierarchy.Update(scene.GetRoot());
+		benchmark->transforms_ms += timer.ReadMs();
+
+		module->use_component_systems = false;
+		to_draw.clear();
+		timer.Start();
+		module->SetDrawList(&to_draw, camera, frustum);
+		benchmark->tree_ms += timer.ReadMs();
+		benchmark->tree_drawn = to_draw.size();
+
+		module->use_component_systems = true;
+		to_draw.clear();
+		timer.Start();
+		module->SetDrawList(&to_draw, camera, frustum);
+		benchmark->systems_ms += timer.ReadMs();
+		benchmark->systems_drawn = to_draw.size();
+		benchmark->cameras_ms += module->cameras_system_ms;
+		benchmark->lights_ms += module->lights_system_ms;
+		benchmark->meshes_ms += module->meshes_system_ms;
+	}
+
+	module->printing_scene = printing;
+	module->use_component_systems = systems;
+	module->use_dynamic_tree = dynamic_tree;
+
+	benchmark->objects = objects_count;
+	benchmark->frames = frames;
+	if (frames > 0) {
+		benchmark->transforms_ms /= frames;
+		benchmark->tree_ms /= frames;
+		benchmark->systems_ms /= frames;
+		benchmark->cameras_ms /= frames;
+		benchmark->lights_ms /= frames;
+		benchmark->meshes_ms /= frames;
+	}
+}
+
+// the draw list of a 100k objects scene from the component systems against walking the objects tree
+bool TestSystems()
+{
+	SystemsBenchmark benchmark;
+	BenchmarkSystems(100000, 10, &benchmark);
+	TEST_CHECK(benchmark.objects == 100000);
+	TestReport("%u objects, %u lights, %u cameras, %u frames", benchmark.objects, benchmark.lights, benchmark.cameras, benchmark.frames);
+	TestReport("  transforms %9.3f ms per frame", benchmark.transforms_ms);
+	TestReport("  tree walk  %9.3f ms per frame, %u drawn", benchmark.tree_ms, benchmark.tree_drawn);
+	TestReport("  systems    %9.3f ms per frame, %u drawn (%.1fx)", benchmark.systems_ms, benchmark.systems_drawn,
+		(benchmark.systems_ms > 0.0) ? benchmark.tree_ms / benchmark.systems_ms : 0.0);
+	TestReport("    cameras  %9.3f ms", benchmark.cameras_ms);
+	TestReport("    lights   %9.3f ms", benchmark.lights_ms);
+	TestReport("    meshes   %9.3f ms", benchmark.meshes_ms);
+	// both must cull the same objects
+	TEST_CHECK(benchmark.tree_drawn == benchmark.systems_drawn);
+
+	return true;
+}
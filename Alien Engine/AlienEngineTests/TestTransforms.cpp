@@ -0,0 +1,109 @@
+#include "Tests.h"
+#include "TestScene.h"
+#include "Application.h"
+#include "ModuleObjects.h"
+#include "ComponentTransform.h"
+#include "j1PerfTimer.h"
+#include <algorithm>
+#include <cmath>
+
+struct TransformBenchmark {
+	uint objects = 0;
+	// objects in each chain, 0 for a tree of 8 children per object
+	uint depth = 0;
+	uint frames = 0;
+	// ms per frame rotating every object, solving its children right away like before and with the TransformHierarchy
+	double eager_ms = 0.0;
+	double hierarchy_ms = 0.0;
+	// biggest difference between the global matrices of both
+	float max_error = 0.0F;
+};
+
+// rotate every object of a generated scene of chains of depth objects each frame, solving the global matrices and
+// the bounding boxes right away like before and once per frame with the TransformHierarchy
+static void BenchmarkTransforms(uint objects_count, uint depth, uint frames, TransformBenchmark* benchmark)
+{
+	*benchmark = TransformBenchmark();
+
+	TestScene scene(objects_count, depth);
+	if (!scene.IsReady())
+		return;
+
+	// the arrays are built before the passes
+	TransformHierarchy& hierarchy = App->objects->transform_hierarchy;
+	hierarchy.Update(scene.GetRoot());
+
+	std::vector<ComponentTransform*> transforms;
+	transforms.reserve(scene.objects.size());
+	std::vector<GameObject*>::iterator item = scene.objects.begin();
+	for (; item != scene.objects.end(); ++item) {
+		transforms.push_back((ComponentTransform*)(*item)->GetComponent(ComponentType::TRANSFORM));
+	}
+
+	// every transform changes before its children, each one solved the children changed before again
+	j1PerfTimer timer;
+	for (uint frame = 0; frame < frames; ++frame) {
+		Quat rotation = Quat::RotateY(0.01F * (frame + 1));
+		std::vector<ComponentTransform*>::iterator transform = transforms.begin();
+		for (; transform != transforms.end(); ++transform) {
+			TestScene::RotateEagerly(*transform, rotation);
+		}
+	}
+	double eager_ms = timer.ReadMs();
+
+	std::vector<float4x4> eager_globals;
+	eager_globals.reserve(transforms.size());
+	std::vector<ComponentTransform*>::iterator transform = transforms.begin();
+	for (; transform != transforms.end(); ++transform) {
+		eager_globals.push_back((*transform)->GetGlobalMatrix());
+	}
+
+	timer.Start();
+	for (uint frame = 0; frame < frames; ++frame) {
+		Quat rotation = Quat::RotateY(0.01F * (frame + 1));
+		for (transform = transforms.begin(); transform != transforms.end(); ++transform) {
+			(*transform)->SetLocalRotation(rotation);
+		}
+		hierarchy.Update(scene.GetRoot());
+	}
+	double hierarchy_ms = timer.ReadMs();
+
+	float max_error = 0.0F;
+	for (uint i = 0; i < transforms.size(); ++i) {
+		const float4x4& global = transforms[i]->GetGlobalMatrix();
+		for (uint row = 0; row < 4; ++row) {
+			for (uint column = 0; column < 4; ++column) {
+				max_error = std::max(max_error, std::abs(global[row][column] - eager_globals[i][row][column]));
+			}
+		}
+	}
+
+	benchmark->objects = objects_count;
+	benchmark->depth = depth;
+	benchmark->frames = frames;
+	benchmark->eager_ms = (frames > 0) ? eager_ms / frames : 0.0;
+	benchmark->hierarchy_ms = (frames > 0) ? hierarchy_ms / frames : 0.0;
+	benchmark->max_error = max_error;
+}
+
+// the dirty transforms solved in one pass per frame against solving the children of each change right away, from
+// flat scenes to deep chains
+bool TestTransforms()
+{
+	const uint objects[] = { 10000, 100000 };
+	const uint depths[] = { 1, 8, 32 };
+
+	for (uint i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i) {
+		for (uint j = 0; j < sizeof(depths) / sizeof(depths[0]); ++j) {
+			TransformBenchmark benchmark;
+			BenchmarkTransforms(objects[i], depths[j], 5, &benchmark);
+			TEST_CHECK(benchmark.objects == objects[i]);
+			TestReport("%6u objects, depth %2u: %9.3f ms per frame before, %8.3f ms with the hierarchy (%.1fx)", objects[i], depths[j],
+				benchmark.eager_ms, benchmark.hierarchy_ms, (benchmark.hierarchy_ms > 0.0) ? benchmark.eager_ms / benchmark.hierarchy_ms : 0.0);
+			// both ways must give the same matrices
+			TEST_CHECK(benchmark.max_error < 0.001F);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,89 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleResources.h"
+#include "ModuleObjects.h"
+#include "ResourceMesh.h"
+#include "MeshOptimizer.h"
+#include "j1PerfTimer.h"
+
+struct VertexCacheBenchmark {
+	uint meshes = 0;
+	uint cache_size = 0;
+	// the imported meshes as they are stored and with their triangles reordered again
+	VertexCacheStats stored;
+	VertexCacheStats optimized;
+	double optimize_ms = 0.0;
+};
+
+// simulate a FIFO vertex cache of cache_size vertices with the imported meshes as they are and optimized again,
+// the ones not loaded are loaded for it
+static void BenchmarkVertexCache(uint cache_size, VertexCacheBenchmark* benchmark)
+{
+	*benchmark = VertexCacheBenchmark();
+	benchmark->cache_size = cache_size;
+	// without the references the meshes the scene uses would be released
+	if (!App->objects->enable_instancies)
+		return;
+
+	// the loads are synchronous so the arrays are there
+	bool async = App->resources->async_loading;
+	App->resources->async_loading = false;
+
+	std::vector<Resource*>::iterator item = App->resources->resources.begin();
+	for (; item != App->resources->resources.end(); ++item) {
+		// only the imported ones, the primitives are not optimized
+		if (*item == nullptr || (*item)->GetType() != ResourceType::RESOURCE_MESH || (*item)->loading || !(*item)->IsReloadable())
+			continue;
+		ResourceMesh* mesh = static_cast<ResourceMesh*>(*item);
+		mesh->IncreaseReferences();
+		if (mesh->index == nullptr || mesh->vertex == nullptr || mesh->num_index < 3) {
+			mesh->DecreaseReferences();
+			continue;
+		}
+
+		VertexCacheStats mesh_stats = MeshOptimizer::AnalyzeVertexCache(mesh->index, mesh->num_index, mesh->num_vertex, cache_size);
+		benchmark->stored.transformed += mesh_stats.transformed;
+		benchmark->stored.triangles += mesh_stats.triangles;
+		benchmark->stored.vertices += mesh_stats.vertices;
+
+		// only the triangle order, the mesh keeps its arrays
+		std::vector<uint> indices(mesh->index, mesh->index + mesh->num_index);
+		j1PerfTimer timer;
+		MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), mesh->num_vertex);
+		benchmark->optimize_ms += timer.ReadMs();
+
+		mesh_stats = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), mesh->num_vertex, cache_size);
+		benchmark->optimized.transformed += mesh_stats.transformed;
+		benchmark->optimized.triangles += mesh_stats.triangles;
+		benchmark->optimized.vertices += mesh_stats.vertices;
+		++benchmark->meshes;
+
+		mesh->DecreaseReferences();
+	}
+
+	App->resources->async_loading = async;
+}
+
+// the FIFO vertex cache with the imported meshes as they are stored against their triangles reordered again,
+// the import already leaves them in the order the reorder would give
+bool TestVertexCache()
+{
+	const uint cache_sizes[] = { 8, VERTEX_CACHE_SIZE, 32 };
+
+	for (uint i = 0; i < sizeof(cache_sizes) / sizeof(cache_sizes[0]); ++i) {
+		VertexCacheBenchmark benchmark;
+		BenchmarkVertexCache(cache_sizes[i], &benchmark);
+		TestReport("cache of %2u, %u meshes: ACMR %.3f stored, %.3f optimized again, ATVR %.3f stored, %.3f optimized again (%.3f ms)", cache_sizes[i], benchmark.meshes,
+			benchmark.stored.GetACMR(), benchmark.optimized.GetACMR(), benchmark.stored.GetATVR(), benchmark.optimized.GetATVR(), benchmark.optimize_ms);
+
+		TEST_CHECK(benchmark.meshes > 0);
+		// 0.5 is the best a triangle list can do and 3 no reuse at all
+		TEST_CHECK(benchmark.stored.GetACMR() >= 0.5F && benchmark.stored.GetACMR() <= 3.0F);
+		if (cache_sizes[i] == VERTEX_CACHE_SIZE) {
+			// the overdraw order can cost up to its threshold, and reordering twice doesn't give exactly the same triangles
+			TEST_CHECK(benchmark.stored.transformed <= benchmark.optimized.transformed * OVERDRAW_CACHE_THRESHOLD * 1.05F);
+		}
+	}
+
+	return true;
+}
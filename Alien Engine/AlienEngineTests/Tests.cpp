@@ -0,0 +1,43 @@
+#include "Tests.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleFileSystem.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+void TestReport(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	printf("    ");
+	vprintf(format, args);
+	printf("\n");
+	va_end(args);
+}
+
+bool TestFailed(const char* file, int line, const char* condition)
+{
+	printf("    %s(%d) : check failed: %s\n", file, line, condition);
+	return false;
+}
+
+void ImportTestModels(const char* directory, std::vector<const aiScene*>* scenes)
+{
+	std::vector<std::string> files;
+	std::vector<std::string> directories;
+	App->file_system->DiscoverFiles(directory, files, directories, true);
+
+	std::vector<std::string>::iterator item = files.begin();
+	for (; item != files.end(); ++item) {
+		std::string extension;
+		App->file_system->SplitFilePath((*item).data(), nullptr, nullptr, &extension);
+		if (!App->StringCmp(extension.data(), "fbx"))
+			continue;
+
+		const aiScene* scene = aiImportFile((*item).data(), aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+			aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_GenBoundingBoxes);
+		if (scene != nullptr) {
+			scenes->push_back(scene);
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+
+typedef unsigned int uint;
+
+struct aiScene;
+
+// a test prints what it measured and returns false if any of its checks failed
+typedef bool(*TestFunction)();
+
+// one line of results under the name of the running test
+void TestReport(const char* format, ...);
+// print the check that failed, the test returns what it returns
+bool TestFailed(const char* file, int line, const char* condition);
+
+#define TEST_CHECK(condition) do { if (!(condition)) return TestFailed(__FILE__, __LINE__, #condition); } while (0)
+
+// import the fbx of the directory without adding them, the scenes are released with aiReleaseImport
+void ImportTestModels(const char* directory, std::vector<const aiScene*>* scenes);
+
+// TestTransforms.cpp
+bool TestTransforms();
+
+// TestComponents.cpp
+bool TestComponents();
+
+// TestSystems.cpp
+bool TestSystems();
+
+// TestDynamicTree.cpp
+bool TestDynamicTree();
+
+// TestFrustum.cpp
+bool TestFrustum();
+
+// TestOctree.cpp
+bool TestOctreeBuild();
+bool TestOctree();
+
+// TestRenderQueue.cpp
+bool TestRenderQueue();
+
+// TestBatching.cpp
+bool TestBatching();
+
+// TestMeshMemory.cpp
+bool TestMeshMemory();
+
+// TestMeshLoad.cpp
+bool TestMeshLoad();
+
+// TestStreaming.cpp
+bool TestStreaming();
+
+// TestRegistry.cpp
+bool TestRegistry();
+
+// TestResidency.cpp
+bool TestResidency();
+
+// TestImport.cpp
+bool TestImport();
+
+// TestVertexCache.cpp
+bool TestVertexCache();
+
+// TestLODs.cpp
+bool TestLODs();
+
+// TestCook.cpp
+bool TestCook();
+
+// TestAssetDatabase.cpp
+bool TestAssetDatabase();
+
+// TestArchive.cpp
+bool TestArchive();
+
+// TestScenes.cpp
+bool TestScenes();
+
+// TestPlayMode.cpp
+bool TestPlayMode();
+
+// TestPrefabs.cpp
+bool TestPrefabs();
+
+// TestPool.cpp
+bool TestPool();
+
+// TestObjectMemory.cpp
+bool TestObjectMemory();
+
+// TestMemoryThreads.cpp
+bool TestMemoryThreads();
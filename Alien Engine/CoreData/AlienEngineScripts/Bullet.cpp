@@ -9,6 +9,11 @@ Bullet::~Bullet()
 }
 
 void Bullet::Start()
+{
+	OnEnable();
+}
+
+void Bullet::OnEnable()
 {
 	time = Time::GetGameTime();
 	ComponentTransform* t_tr = (ComponentTransform*)GameObject::FindWithName("TankTurret")->GetComponent(ComponentType::TRANSFORM);
@@ -23,7 +28,7 @@ void Bullet::Update()
 	transform->SetLocalPosition(transform->GetLocalPosition() + bullet_direction.Mul(velocity * Time::GetDT()));
 	if ((time + life_time) < Time::GetGameTime())
 	{
-		GameObject::DestroyInstantly(game_object);
+		Prefab::Despawn(game_object);
 	}
 }
 
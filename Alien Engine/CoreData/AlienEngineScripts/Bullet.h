@@ -12,6 +12,8 @@ public:
 
 	void Start();
 	void Update();
+	// the bullets are spawned again from the pool, Start is only called the first time
+	void OnEnable();
 	void CleanUp();
 
 public:
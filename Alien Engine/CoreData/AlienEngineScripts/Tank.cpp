@@ -24,6 +24,8 @@ void Tank::Start()
 	{
 		turret_transform = (ComponentTransform*)turret->GetComponent(ComponentType::TRANSFORM);
 	}
+
+	bullet.Prewarm(20);
 }
 
 void Tank::Update()
@@ -39,7 +41,7 @@ void Tank::Shoot()
 	// Shooting
 	if (Input::GetMouseButtonDown(Input::MOUSE_LEFT_BUTTON))
 	{
-		GameObject* bullet_created = bullet.ConvertToGameObject((float3{ transform->GetGlobalPosition().x,transform->GetGlobalPosition().y + 1.5f,transform->GetGlobalPosition().z }) + turret_transform->forward * 1.2f);
+		GameObject* bullet_created = bullet.Spawn((float3{ transform->GetGlobalPosition().x,transform->GetGlobalPosition().y + 1.5f,transform->GetGlobalPosition().z }) + turret_transform->forward * 1.2f);
 
 		if (bullet_created != nullptr)
 		{